@@ -275,8 +275,8 @@ ssize_t on_send_instruction(void *conexion, instruction_t *inst)
 
 ssize_t on_send_instructions(void *conexion, t_list *instructions)
 {
-	void *stream = instructions_fold(instructions);
-	size_t size = list_size(instructions) * sizeof(instruction_t) + sizeof(uint32_t);
+	size_t size = 0;
+	void *stream = instructions_fold(instructions, &size);
 	ssize_t ret = conexion_enviar_stream(*(conexion_t *)conexion, CMD, stream, size);
 	free(stream);
 	return ret;
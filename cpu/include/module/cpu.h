@@ -18,11 +18,31 @@
 #include "instruction.h"
 #include "sync.h"
 #include "tlb.h"
+#include "async_client.h"
+#include "program_cache.h"
 
 #define MODULE_NAME "cpu"
 #define VALOR_INVALIDO UINT32_MAX
 #define PAGINA_VACIA UINT32_MAX
 
+/**
+ * @brief An operand read ahead of its instruction.
+ *
+ */
+typedef struct Prefetch
+{
+	// The pending read, NULL if none
+	async_request_t *request;
+	// The process it was read for
+	uint32_t pid;
+	// The logical address read
+	uint32_t address;
+	// The page of the address
+	uint32_t page;
+	// The memory_access_level_t sent
+	uint32_t level;
+} prefetch_t;
+
 /**
  * @brief CPU Module.
  *
@@ -51,6 +71,16 @@ typedef struct CPU
 	bool is_executing;
 	// TLB
 	tlb_t *tlb;
+	// Memory Connection for pipelined requests
+	conexion_t conexion_async;
+	// Client of the pipelined Memory Connection, NULL if not used
+	async_client_t *memory_async;
+	// Operand being prefetched
+	prefetch_t prefetch;
+	// Whether a WRITE was sent and Memory has not answered anything since
+	bool writes_pending;
+	// Programs already received, so that the Kernel only sends PCB deltas
+	program_cache_t programs;
 } cpu_t;
 
 int on_connect(void *conexion, bool offline_mode);
@@ -177,3 +207,12 @@ uint32_t get_entry_lvl_2(uint32_t direccion_logica, uint32_t tamanio_pagina, uin
 uint32_t request_table_2_entry(uint32_t tabla_primer_nivel, uint32_t desplazamiento);
 
 uint32_t request_frame(uint32_t tabla_segundo_nivel, uint32_t desplazamiento);
+
+/**
+ * @brief Translates a logical address in a single request: Memory walks both table levels.
+ *
+ * @param tabla_primer_nivel the process first level table
+ * @param direccion_logica the address to translate
+ * @return the frame
+ */
+uint32_t request_translation(uint32_t tabla_primer_nivel, uint32_t direccion_logica);
@@ -0,0 +1,101 @@
+/**
+ * @file program_cache.h
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Programs held by the CPU between dispatches
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "smartlist.h"
+#include "pcb.h"
+
+/**
+ * @brief A program held by the CPU.
+ *
+ */
+typedef struct ProgramCacheEntry
+{
+	// The process running it.
+	uint32_t pid;
+	// The program hash sent by the Kernel.
+	uint32_t hash;
+	// The instructions, NULL if the entry is free.
+	t_list *instructions;
+	// When it was last dispatched.
+	uint32_t last_use;
+} program_cache_entry_t;
+
+/**
+ * @brief The instructions of the last dispatched programs, keyed by (pid, program hash), least recently used out.
+ * Only the thread owning the PCB in execution touches it, so it is not synchronized.
+ *
+ */
+typedef struct ProgramCache
+{
+	// The entries.
+	program_cache_entry_t *entries;
+	// The amount of entries.
+	int capacity;
+	// Dispatches so far.
+	uint32_t clock;
+} program_cache_t;
+
+/**
+ * @brief Creates an empty cache.
+ *
+ * @param capacity the most programs held, 0 to hold none
+ * @return the cache
+ */
+program_cache_t program_cache_create(int capacity);
+
+/**
+ * @brief Looks up the program of a process.
+ *
+ * @param cache the cache
+ * @param pid the process
+ * @param hash the program hash
+ * @return the instructions, still owned by the cache, or NULL
+ */
+t_list *program_cache_get(program_cache_t *cache, uint32_t pid, uint32_t hash);
+
+/**
+ * @brief Holds the program of a process, replacing its previous one or the least recently used.
+ *
+ * @param cache the cache
+ * @param pid the process
+ * @param hash the program hash
+ * @param instructions the instructions
+ * @return whether the cache took the instructions; if not they are still the caller's
+ */
+bool program_cache_put(program_cache_t *cache, uint32_t pid, uint32_t hash, t_list *instructions);
+
+/**
+ * @brief Destroys a PCB that ran from the cache, leaving its instructions in it.
+ *
+ * @param cache the cache
+ * @param pcb the PCB
+ */
+void program_cache_release(program_cache_t *cache, pcb_t *pcb);
+
+/**
+ * @brief Drops the program of a process that ended.
+ *
+ * @param cache the cache
+ * @param pid the process
+ */
+void program_cache_drop(program_cache_t *cache, uint32_t pid);
+
+/**
+ * @brief Deallocates the cache and its programs.
+ *
+ * @param cache the cache
+ */
+void program_cache_destroy(program_cache_t *cache);
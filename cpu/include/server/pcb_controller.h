@@ -26,4 +26,13 @@
  */
 pcb_t *receive_pcb(int fd);
 
+/**
+ * @brief Receives the state of a PCB whose program the CPU should hold.
+ * If it does not, asks the Kernel for the whole PCB (PCB_MISS) instead.
+ *
+ * @param fd the file descriptor
+ * @return a new PCB instance, or NULL if the whole PCB was asked for
+ */
+pcb_t *receive_pcb_delta(int fd);
+
 ssize_t return_pcb(int fd, pcb_t *pcb, uint32_t time);
@@ -12,6 +12,7 @@
 #include "conexion_memoria.h"
 #include "cpu.h"
 #include "conexion.h"
+#include "receiver.h"
 #include "log.h"
 #include "cfg.h"
 #include "module.h"
@@ -40,6 +41,22 @@ static int conexion_init(cpu_t *cpu)
 	if (on_module_connect(&cpu->conexion, false) EQ SUCCESS)
 	{
 		LOG_DEBUG("[CPU:Client-Memory] :=> Connected at %s:%s", ip, port);
+		// Every memory access gets a reply: pool them instead of allocating each one.
+		receiver_attach(cpu->conexion.socket, RECEIVER_CAPACITY);
+	}
+
+	int window = pedidos_en_vuelo();
+
+	// A second connection, so that pipelined replies never mix with the blocking ones.
+	if (window > 0)
+	{
+		cpu->conexion_async = conexion_cliente_create(ip, port);
+
+		if (on_module_connect(&cpu->conexion_async, false) EQ SUCCESS)
+		{
+			cpu->memory_async = async_client_create(cpu->conexion_async, window);
+			LOG_DEBUG("[CPU:Client-Memory] :=> Pipelined connection at %s:%s [%d requests in flight]", ip, port, window);
+		}
 	}
 
 	return SUCCESS;
@@ -50,10 +67,8 @@ void handshake(cpu_t *cpu)
 
 	LOG_TRACE("[MMU] :=> Request page table size...");
 
-	opcode_t req_pg_size = SZ;
-
 	ssize_t bytes_sent = -1;
-	bytes_sent = connection_send_value(cpu->conexion, &req_pg_size, sizeof(req_pg_size));
+	bytes_sent = conexion_enviar_stream_vector(cpu->conexion, SZ, NULL, 0);
 
 	if (bytes_sent <= 0)
 	{
@@ -82,9 +97,7 @@ void handshake(cpu_t *cpu)
 	LOG_WARNING("[MMU] :=> Page Size after free: %d", cpu->page_size);
 
 	LOG_TRACE("[MMU] :=> Request Entries per Pages...");
-	opcode_t req_am_entry = ENTRIES;
-
-	ssize_t bytes_sent_for_am_entry = connection_send_value(cpu->conexion, &req_am_entry, sizeof(req_am_entry));
+	ssize_t bytes_sent_for_am_entry = conexion_enviar_stream_vector(cpu->conexion, ENTRIES, NULL, 0);
 
 	if (bytes_sent_for_am_entry <= 0)
 	{
@@ -17,10 +17,14 @@
 #include "cpu.h"
 #include "log.h"
 #include "cfg.h"
+#include "trace.h"
+#include "metrics.h"
 #include "conexion.h"
+#include "receiver.h"
 #include "accion.h"
 #include "instruction.h"
 #include "operands.h"
+#include "memory_access.h"
 #include <signal.h>
 #include "tlb.h"
 
@@ -40,6 +44,12 @@ static void handle_sigint(int signal)
 	}
 }
 
+static void handle_sigusr1(int signal)
+{
+	if (signal == SIGUSR1)
+		metrics_request_dump();
+}
+
 /**
  * @brief Initializes the CPU reference.
  *
@@ -66,6 +76,10 @@ static int on_cpu_init(cpu_t *cpu)
 	cpu->server_interrupt = servidor_create(ip(), puerto_escucha_interrupt());
 	cpu->has_interruption = false;
 	cpu->sync = init_sync();
+	cpu->memory_async = NULL;
+	cpu->prefetch.request = NULL;
+	cpu->writes_pending = false;
+	cpu->programs = program_cache_create(programas_en_cache());
 
 	return EXIT_SUCCESS;
 }
@@ -73,13 +87,21 @@ static int on_cpu_init(cpu_t *cpu)
 static int
 on_cpu_destroy(cpu_t *cpu)
 {
-	pcb_destroy(cpu->pcb);
+	program_cache_release(&cpu->programs, cpu->pcb);
+	program_cache_destroy(&cpu->programs);
 	LOG_DEBUG("PCB destroyed.");
 	servidor_destroy(&(cpu->server_dispatch));
 	LOG_DEBUG("Server Dispatch destroyed.");
 	servidor_destroy(&(cpu->server_interrupt));
 	LOG_DEBUG("Server Interrupt destroyed.");
+	receiver_detach(cpu->conexion.socket);
 	conexion_destroy(&(cpu->conexion));
+
+	if (cpu->memory_async)
+	{
+		async_client_destroy(cpu->memory_async);
+		conexion_destroy(&(cpu->conexion_async));
+	}
 	LOG_DEBUG("Server Interrupt destroyed.");
 	thread_manager_destroy(&cpu->tm);
 	LOG_DEBUG("CPU Thread Manager destroyed.");
@@ -148,6 +170,62 @@ instruction_t *instruction_fetch();
  */
 uint32_t fetch_operands(uint32_t logical_address);
 
+/**
+ * @brief Tells if an instruction is a plain memory access (READ or WRITE).
+ *
+ * @param instruction the instruction
+ * @return true if it can be batched
+ */
+static inline bool is_memory_access(instruction_t *instruction)
+{
+	return instruction->icode == C_REQUEST_READ || instruction->icode == C_REQUEST_WRITE;
+}
+
+/**
+ * @brief Executes a run of consecutive READ/WRITE instructions, starting at the one fetched,
+ * in a single MEMORY_BATCH round trip.
+ *
+ * @param cpu the CPU
+ * @param first the instruction fetched
+ * @param limit the most instructions to run
+ */
+static void execute_batch(cpu_t *cpu, instruction_t *first, int limit);
+
+/**
+ * @brief Reads ahead, without waiting, the operand of the next instruction if it is a READ or a COPY.
+ *
+ * @param cpu the CPU
+ */
+static void prefetch_next_operand(cpu_t *cpu);
+
+/**
+ * @brief Obtains a prefetched operand, waiting for it if still in flight.
+ * A prefetch of another address is discarded.
+ *
+ * @param cpu the CPU
+ * @param logical_address the address to read
+ * @param value where to store the value
+ * @return true if the address was prefetched
+ */
+static bool prefetch_take(cpu_t *cpu, uint32_t logical_address, uint32_t *value);
+
+/**
+ * @brief Discards the pending prefetch, if any. Must be called whenever the PCB leaves the CPU.
+ *
+ * @param cpu the CPU
+ */
+static void prefetch_discard(cpu_t *cpu);
+
+/**
+ * @brief Translates a logical address into a batch access, with the TLB when possible.
+ *
+ * @param cpu the CPU
+ * @param logical_address the address
+ * @param page where to store the page number
+ * @return the access, without op nor value
+ */
+static memory_access_t mmu_access(cpu_t *cpu, uint32_t logical_address, uint32_t *page);
+
 // ============================================================================================================
 //                               ***** Public Functions *****
 // ============================================================================================================
@@ -172,10 +250,17 @@ int on_init(cpu_t *cpu)
 	}
 
 	LOG_DEBUG("Configurations loaded.");
+
+	// Events are only recorded when TRAZA is set
+	trace_init(MODULE_NAME);
+	// Snapshots on SIGUSR1 and at exit
+	metrics_init(MODULE_NAME);
 	LOG_TRACE("Configurations loaded %s", ip());
 
 	// Attach del evento de interrupcion forzada.
 	signal(SIGINT, handle_sigint);
+	// Snapshot de las métricas a pedido.
+	signal(SIGUSR1, handle_sigusr1);
 
 	on_cpu_init(cpu);
 	LOG_DEBUG("Module started SUCCESSFULLY");
@@ -247,18 +332,28 @@ void cycle(cpu_t *cpu)
 		// Fetch
 		instruction = instruction_fetch(cpu);
 
-		if (instruction)
+		// Runs of READ/WRITE go to memory together
+		int batch = accesos_por_lote();
+
+		if (instruction && batch > 1 && is_memory_access(instruction) && cpu->prefetch.request == NULL)
+		{
+			LOG_DEBUG("[CPU|PCB#%d] :=> Instruction Fetched= #%d (batched)", pid, pc);
+			execute_batch(cpu, instruction, batch);
+		}
+		else if (instruction)
 		{
 			LOG_DEBUG("[CPU|PCB#%d] :=> Instruction Fetched= #%d", pid, pc);
 			// Operands to used
 			operands_t operandos = {0, 0};
+			// The program may be cached for later dispatches: operands go into a copy
+			instruction_t decoded = *instruction;
 
-			if (decode(instruction))
+			if (decode(&decoded))
 			{
 				LOG_TRACE("[CPU|PCB#%d] :=> Fetching operands...", pid);
-				uint32_t value = fetch_operands(instruction->param1);
-				instruction->param0 = operandos.op1;
-				instruction->param1 = value;
+				uint32_t value = fetch_operands(decoded.param1);
+				decoded.param0 = operandos.op1;
+				decoded.param1 = value;
 				LOG_DEBUG("[CPU|PCB#%d] :=> Operands Fetched...", pid);
 			}
 			else
@@ -267,7 +362,7 @@ void cycle(cpu_t *cpu)
 			}
 
 			LOG_TRACE("[CPU|PCB#%d] :=> Executing Instruction #%d...", pid, pc);
-			instruction_execute(instruction, cpu);
+			instruction_execute(&decoded, cpu);
 		}
 		else
 		{
@@ -278,6 +373,7 @@ void cycle(cpu_t *cpu)
 	else
 	{
 		LOG_ERROR("[CPU] :=> Interruption received.");
+		prefetch_discard(cpu);
 		cpu->pcb->status = PCB_READY;
 		tlb_reset(&(cpu->tlb));
 		return_pcb(cpu->server_dispatch.client, cpu->pcb, 0);
@@ -363,9 +459,13 @@ uint32_t instruction_execute(instruction_t *instruction, void *data)
 	uint32_t return_value = 0;
 	uint32_t pid = g_cpu.pcb->id;
 
+	metrics_add(METRIC_INSTRUCTIONS, 1);
+
 	switch (instruction->icode)
 	{
 	case C_REQUEST_NO_OP:
+		// Memory latency overlaps the NO_OP delay
+		prefetch_next_operand(&g_cpu);
 		execute_NO_OP(retardo_noop());
 		LOG_DEBUG("[CPU] :=> Executed instruction: NO_OP");
 		break;
@@ -413,6 +513,7 @@ void execute_NO_OP(uint time)
 void execute_IO(instruction_t *instruction, cpu_t *cpu)
 {
 	LOG_TRACE("[CPU] :=> Executing IO Instruction...");
+	prefetch_discard(cpu);
 	cpu->pcb->status = PCB_BLOCKED;
 
 	ssize_t bytes_sent = return_pcb(cpu->server_dispatch.client, cpu->pcb, instruction->param0);
@@ -439,6 +540,7 @@ void execute_EXIT(instruction_t *instruction, cpu_t *cpu)
 		}
 
 		tlb_reset(&(cpu->tlb));
+		prefetch_discard(cpu);
 
 		return_pcb(cpu->server_dispatch.client, cpu->pcb, instruction ? instruction->param0 : 0);
 	}
@@ -450,6 +552,11 @@ void execute_EXIT(instruction_t *instruction, cpu_t *cpu)
 
 uint32_t execute_READ(uint32_t logical_address)
 {
+	uint32_t prefetched = 0;
+
+	if (prefetch_take(&g_cpu, logical_address, &prefetched))
+		return prefetched;
+
 	LOG_TRACE("[CPU - MMU - Read] Getting the physical address from the logical address: %d", logical_address);
 	uint32_t physical_address = req_physical_address(&g_cpu, logical_address);
 
@@ -458,36 +565,28 @@ uint32_t execute_READ(uint32_t logical_address)
 	ssize_t bytes = -1;
 	uint32_t return_value = 0;
 
-	// Re-utilizo operands para aparte de enviar la direccion fisica, poder enviar el pcb-id
-	// (me evito usar el big-stream pq solo quiero leer)
-	operands_t *operands = malloc(sizeof(operands_t));
-
-	operands->op1 = physical_address;
-	operands->op2 = g_cpu.pcb->id;
+	// [PID][DIRECCION FISICA][PID]
+	struct iovec segments[] = {
+		{.iov_base = &g_cpu.pcb->id, .iov_len = sizeof(uint32_t)},
+		{.iov_base = &physical_address, .iov_len = sizeof(uint32_t)},
+		{.iov_base = &g_cpu.pcb->id, .iov_len = sizeof(uint32_t)},
+	};
 
-	void *send_stream = operandos_to_stream(operands);
-
-	// Serializo un Stream mas grande, que ahora contendrá:
-	// operands (direc. fisica y valor) y uint32_t (pcb->id)
-	void *big_stream = malloc(sizeof(uint32_t) + sizeof(operands_t));
-
-	memcpy(big_stream, &g_cpu.pcb->id, sizeof(uint32_t));
-	memcpy(big_stream + sizeof(uint32_t), send_stream, sizeof(operands_t));
-
-	// envio a memoria para leer, el operands que contiene la direc fisica y el id del pcb
-	conexion_enviar_stream(g_cpu.conexion, RD, big_stream, sizeof(operands_t) + sizeof(uint32_t));
-
-	free(send_stream);
+	// envio a memoria para leer, la direc fisica y el id del pcb
+	uint64_t sent = metrics_now();
+	conexion_enviar_stream_vector(g_cpu.conexion, RD, segments, 3);
 
 	void *receive_stream = conexion_recibir_stream(g_cpu.conexion.socket, &bytes);
+	metrics_record(METRIC_MEMORY_REQUEST_LATENCY, metrics_now() - sent);
 
 	LOG_TRACE("[CPU - Read] Bytes read: %ld", bytes);
 
 	return_value = *(uint32_t *)receive_stream;
 
 	LOG_INFO("[CPU - Read] Value Read: %d", return_value);
+	g_cpu.writes_pending = false;
 
-	free(receive_stream);
+	conexion_liberar_stream(g_cpu.conexion.socket, receive_stream);
 
 	return return_value;
 }
@@ -499,28 +598,19 @@ void execute_WRITE(uint32_t logical_address, uint32_t value)
 
 	LOG_INFO("[CPU - Write] Physical address calculated: %d", physical_address);
 
-	operands_t *operands = malloc(sizeof(operands_t));
-
-	operands->op1 = physical_address;
-	operands->op2 = value;
+	LOG_TRACE("[CPU - Write] Value to write: %d", value);
 
-	LOG_TRACE("[CPU - Write] Value to write: %d", operands->op2);
+	// [PID][DIRECCION FISICA][VALOR]
+	struct iovec segments[] = {
+		{.iov_base = &g_cpu.pcb->id, .iov_len = sizeof(uint32_t)},
+		{.iov_base = &physical_address, .iov_len = sizeof(uint32_t)},
+		{.iov_base = &value, .iov_len = sizeof(uint32_t)},
+	};
 
-	// Serializo un Stream mas grande, que ahora contendrá:
-	// operands (direc. fisica y valor) y uint32_t (pcb->id)
-	void *big_stream = malloc(sizeof(uint32_t) + sizeof(operands_t));
+	conexion_enviar_stream_vector(g_cpu.conexion, WT, segments, 3);
 
-	memcpy(big_stream, &g_cpu.pcb->id, sizeof(uint32_t));
-
-	void *send_stream = operandos_to_stream(operands);
-
-	memcpy(big_stream + sizeof(uint32_t), send_stream, sizeof(operands_t));
-
-	conexion_enviar_stream(g_cpu.conexion, WT, big_stream, sizeof(operands_t) + sizeof(uint32_t));
-
-	free(send_stream);
-	free(operands);
-	free(big_stream);
+	// WT has no reply: until Memory answers something else, it may not have been applied.
+	g_cpu.writes_pending = true;
 }
 
 uint32_t
@@ -531,6 +621,89 @@ execute_COPY(uint32_t param1, uint32_t param2)
 	return param2;
 }
 
+static void execute_batch(cpu_t *cpu, instruction_t *first, int limit)
+{
+	instruction_t *run[limit];
+	int count = 0;
+	int size = list_size(cpu->pcb->instructions);
+
+	run[count++] = first;
+
+	while (count < limit && (int)cpu->pcb->pc < size)
+	{
+		instruction_t *next = list_get(cpu->pcb->instructions, cpu->pcb->pc);
+
+		if (!is_memory_access(next))
+			break;
+
+		run[count++] = next;
+		cpu->pcb->pc++;
+	}
+
+	memory_access_t accesses[count];
+	memory_access_result_t results[count];
+	uint32_t pages[count];
+
+	for (int i = 0; i < count; i++)
+	{
+		accesses[i] = mmu_access(cpu, run[i]->param0, &pages[i]);
+		accesses[i].op = run[i]->icode == C_REQUEST_READ ? MEMORY_ACCESS_READ : MEMORY_ACCESS_WRITE;
+		accesses[i].value = run[i]->icode == C_REQUEST_WRITE ? run[i]->param1 : 0;
+	}
+
+	LOG_TRACE("[CPU - Batch] :=> Sending %d accesses to memory...", count);
+
+	uint64_t sent = metrics_now();
+
+	int answered = conexion_memory_batch(cpu->conexion, accesses, count, results);
+
+	if (answered <= 0)
+	{
+		LOG_ERROR("[CPU - Batch] :=> Memory did not answer the %d accesses, PCB #%d cannot go on.", count, cpu->pcb->id);
+		execute_EXIT(NULL, cpu);
+		return;
+	}
+
+	// The pc went past the whole run: it goes back to the first access Memory did not answer
+	if (answered < count)
+	{
+		LOG_ERROR("[CPU - Batch] :=> Memory answered %d of the %d accesses.", answered, count);
+		cpu->pcb->pc -= count - answered;
+		count = answered;
+	}
+
+	metrics_record(METRIC_MEMORY_REQUEST_LATENCY, metrics_now() - sent);
+	metrics_add(METRIC_INSTRUCTIONS, count);
+
+	cpu->writes_pending = false;
+
+	for (int i = 0; i < count; i++)
+	{
+		uint32_t frame = VALOR_INVALIDO;
+
+		if (results[i].frame == MEMORY_ACCESS_FAILED)
+		{
+			LOG_ERROR("[CPU - Batch] :=> Access to <%d> failed.", run[i]->param0);
+			continue;
+		}
+
+		if (accesses[i].level != MEMORY_ACCESS_FRAME && !page_in_TLB(cpu->tlb, pages[i], &frame))
+		{
+			cpu->tlb->replace(cpu->tlb, pages[i], results[i].frame);
+			LOG_INFO("[TLB] :=> ADDED: [Page: %d| Frame: %d]", pages[i], results[i].frame);
+		}
+
+		if (run[i]->icode == C_REQUEST_READ)
+		{
+			LOG_INFO("[CPU] => Executed READ (%d, %d)", run[i]->param0, results[i].value);
+		}
+		else
+		{
+			LOG_INFO("[CPU] :=> Executed WRITE (%d, %d)", run[i]->param0, run[i]->param1);
+		}
+	}
+}
+
 // ============================================================================================================
 //			   							***** MMU - TLB *****
 // ============================================================================================================
@@ -585,7 +758,6 @@ uint32_t req_physical_address(cpu_t *cpu, uint32_t logical_address)
 	// The Page Number of
 	uint32_t page_number = get_page_number(logical_address, cpu->page_size);
 	uint32_t frame = VALOR_INVALIDO;
-	uint32_t second_page;
 
 	/**
 	 * @brief
@@ -641,15 +813,20 @@ uint32_t req_physical_address(cpu_t *cpu, uint32_t logical_address)
 	 */
 	if (!page_in_TLB(cpu->tlb, page_number, &frame))
 	{
+		trace_event(TRACE_TLB_MISS, cpu->pcb->id, page_number, 0);
+		metrics_add(METRIC_TLB_MISSES, 1);
 		LOG_ERROR("[TLB] :=> Page Not Found");
 		LOG_WARNING("[MMU] :=> Accessing Memory...");
-		second_page = request_table_2_entry(cpu->pcb->page_table, get_entry_lvl_1(page_number, cpu->page_amount_entries));
-		frame = request_frame(second_page, get_entry_lvl_2(logical_address, cpu->page_size, cpu->page_amount_entries));
+		uint64_t sent = metrics_now();
+		frame = request_translation(cpu->pcb->page_table, logical_address);
+		metrics_record(METRIC_MEMORY_REQUEST_LATENCY, metrics_now() - sent);
 		cpu->tlb->replace(cpu->tlb, page_number, frame);
 		LOG_INFO("[TLB] :=> ADDED: [Page: %d| Frame: %d]", page_number, frame);
 	}
 	else
 	{
+		trace_event(TRACE_TLB_HIT, cpu->pcb->id, page_number, frame);
+		metrics_add(METRIC_TLB_HITS, 1);
 		LOG_INFO("[TLB] :=> MATCH: [Page: %d| Frame: %d]", page_number, frame);
 	}
 
@@ -660,6 +837,115 @@ uint32_t req_physical_address(cpu_t *cpu, uint32_t logical_address)
 	return physical_address;
 }
 
+static void prefetch_next_operand(cpu_t *cpu)
+{
+	// Only one operand ahead; and never past a WRITE Memory may not have applied yet.
+	if (cpu->memory_async == NULL || cpu->prefetch.request != NULL || cpu->writes_pending)
+		return;
+
+	if ((int)cpu->pcb->pc >= list_size(cpu->pcb->instructions))
+		return;
+
+	instruction_t *next = list_get(cpu->pcb->instructions, cpu->pcb->pc);
+
+	if (next->icode != C_REQUEST_READ && next->icode != C_REQUEST_COPY)
+		return;
+
+	// READ reads its first parameter, COPY its second.
+	uint32_t address = next->icode == C_REQUEST_READ ? next->param0 : next->param1;
+	memory_access_t access = mmu_access(cpu, address, &cpu->prefetch.page);
+	access.op = MEMORY_ACCESS_READ;
+	access.value = 0;
+
+	struct iovec segments[] = {{.iov_base = &access, .iov_len = sizeof(access)}};
+
+	cpu->prefetch.request = async_client_submit(cpu->memory_async, MEMORY_BATCH, segments, 1, NULL, NULL);
+	cpu->prefetch.pid = cpu->pcb->id;
+	cpu->prefetch.address = address;
+	cpu->prefetch.level = access.level;
+
+	if (cpu->prefetch.request)
+		LOG_DEBUG("[CPU - Prefetch] :=> Reading <%d> ahead...", address);
+}
+
+static bool prefetch_take(cpu_t *cpu, uint32_t logical_address, uint32_t *value)
+{
+	if (cpu->prefetch.request == NULL)
+		return false;
+
+	if (cpu->prefetch.pid != cpu->pcb->id || cpu->prefetch.address != logical_address)
+	{
+		prefetch_discard(cpu);
+		return false;
+	}
+
+	ssize_t size = ERROR;
+	void *reply = async_request_wait(cpu->memory_async, cpu->prefetch.request, &size);
+	cpu->prefetch.request = NULL;
+
+	memory_access_result_t result;
+	bool taken = memory_batch_results(reply, size, 1, &result) EQ 1 && result.frame != MEMORY_ACCESS_FAILED;
+	async_client_release(cpu->memory_async, reply);
+
+	if (!taken)
+	{
+		LOG_ERROR("[CPU - Prefetch] :=> Prefetch of <%d> failed, reading it again.", logical_address);
+		return false;
+	}
+
+	uint32_t frame = VALOR_INVALIDO;
+
+	if (cpu->prefetch.level != MEMORY_ACCESS_FRAME && !page_in_TLB(cpu->tlb, cpu->prefetch.page, &frame))
+	{
+		cpu->tlb->replace(cpu->tlb, cpu->prefetch.page, result.frame);
+		LOG_INFO("[TLB] :=> ADDED: [Page: %d| Frame: %d]", cpu->prefetch.page, result.frame);
+	}
+
+	LOG_INFO("[CPU - Read] Value Read: %d (prefetched)", result.value);
+	*value = result.value;
+
+	return true;
+}
+
+static void prefetch_discard(cpu_t *cpu)
+{
+	if (cpu->prefetch.request == NULL)
+		return;
+
+	async_client_release(cpu->memory_async, async_request_wait(cpu->memory_async, cpu->prefetch.request, NULL));
+	cpu->prefetch.request = NULL;
+	LOG_DEBUG("[CPU - Prefetch] :=> Prefetch of <%d> discarded.", cpu->prefetch.address);
+}
+
+static memory_access_t mmu_access(cpu_t *cpu, uint32_t logical_address, uint32_t *page)
+{
+	memory_access_t access = {.pid = cpu->pcb->id, .offset = get_offset(logical_address, cpu->page_size)};
+	uint32_t frame = VALOR_INVALIDO;
+
+	*page = get_page_number(logical_address, cpu->page_size);
+
+	if (page_in_TLB(cpu->tlb, *page, &frame))
+	{
+		trace_event(TRACE_TLB_HIT, access.pid, *page, frame);
+		metrics_add(METRIC_TLB_HITS, 1);
+		LOG_INFO("[TLB] :=> MATCH: [Page: %d| Frame: %d]", *page, frame);
+		access.level = MEMORY_ACCESS_FRAME;
+		access.index = frame;
+	}
+	else
+	{
+		// Memory walks both levels itself, in the same round trip as the access.
+		trace_event(TRACE_TLB_MISS, access.pid, *page, 0);
+		metrics_add(METRIC_TLB_MISSES, 1);
+		LOG_ERROR("[TLB] :=> Page Not Found");
+		access.level = MEMORY_ACCESS_LVL_1;
+		access.table = cpu->pcb->page_table;
+		access.index = *page;
+	}
+
+	return access;
+}
+
 uint32_t get_page_number(uint32_t logic_address, uint32_t page_size)
 {
 	return (uint32_t)logic_address / (uint32_t)page_size;
@@ -684,14 +970,13 @@ uint32_t request_table_2_entry(uint32_t id_lvl_1_table, uint32_t row_index)
 {
 	LOG_TRACE("[MMU] :=> Request Page of Second Table...");
 
-	operands_t *operands = malloc(sizeof(operands_t));
-
-	operands->op1 = id_lvl_1_table;
-	operands->op2 = row_index;
-
-	void *send_stream = operandos_to_stream(operands);
+	// [TABLA LVL1][ENTRADA]
+	struct iovec segments[] = {
+		{.iov_base = &id_lvl_1_table, .iov_len = sizeof(uint32_t)},
+		{.iov_base = &row_index, .iov_len = sizeof(uint32_t)},
+	};
 
-	conexion_enviar_stream(g_cpu.conexion, SND_PAGE, send_stream, sizeof(operands_t));
+	conexion_enviar_stream_vector(g_cpu.conexion, SND_PAGE, segments, 2);
 
 	uint32_t *ret_page_snd_level = connection_receive_value(g_cpu.conexion, sizeof(uint32_t));
 
@@ -708,31 +993,57 @@ uint32_t request_table_2_entry(uint32_t id_lvl_1_table, uint32_t row_index)
 	uint32_t ret_page = *ret_page_snd_level;
 
 	free(ret_page_snd_level);
-	free(send_stream);
-	free(operands);
 
 	return ret_page;
 }
 
-uint32_t request_frame(uint32_t tabla_segundo_nivel, uint32_t offset)
+uint32_t request_translation(uint32_t id_lvl_1_table, uint32_t logical_address)
 {
-	// ENVIO DE STREAM
+	LOG_TRACE("[MMU] :=> Request Translation of Logical Address <%d>...", logical_address);
 
-	LOG_TRACE("[MMU] :=> Request Frame value...");
+	// [PID][TABLA LVL1][DIRECCION LOGICA]
+	struct iovec segments[] = {
+		{.iov_base = &g_cpu.pcb->id, .iov_len = sizeof(uint32_t)},
+		{.iov_base = &id_lvl_1_table, .iov_len = sizeof(uint32_t)},
+		{.iov_base = &logical_address, .iov_len = sizeof(uint32_t)},
+	};
+
+	conexion_enviar_stream_vector(g_cpu.conexion, TRANSLATE, segments, 3);
+
+	uint32_t *frame = connection_receive_value(g_cpu.conexion, sizeof(uint32_t));
+
+	if (frame == NULL)
+	{
+		LOG_ERROR("[Memory-Client] :=> Frame can't be NULL");
+		return VALOR_INVALIDO;
+	}
+	else
+	{
+		LOG_DEBUG("[MMU] :=> Frame is: %d", *frame);
+	}
 
-	operands_t *operands = malloc(sizeof(operands_t));
+	uint32_t ret_frame = *frame;
+	g_cpu.writes_pending = false;
 
-	operands->op1 = tabla_segundo_nivel;
-	operands->op2 = offset;
+	free(frame);
+
+	return ret_frame;
+}
 
-	void *send_stream = operandos_to_stream(operands);
+uint32_t request_frame(uint32_t tabla_segundo_nivel, uint32_t offset)
+{
+	// ENVIO DE STREAM
 
-	void *big_stream = malloc(sizeof(uint32_t) + sizeof(operands_t));
+	LOG_TRACE("[MMU] :=> Request Frame value...");
 
-	memcpy(big_stream, &g_cpu.pcb->id, sizeof(uint32_t));
-	memcpy(big_stream + sizeof(uint32_t), send_stream, sizeof(operands_t));
+	// [PID][TABLA LVL2][ENTRADA]
+	struct iovec segments[] = {
+		{.iov_base = &g_cpu.pcb->id, .iov_len = sizeof(uint32_t)},
+		{.iov_base = &tabla_segundo_nivel, .iov_len = sizeof(uint32_t)},
+		{.iov_base = &offset, .iov_len = sizeof(uint32_t)},
+	};
 
-	conexion_enviar_stream(g_cpu.conexion, FRAME, big_stream, sizeof(operands_t) + sizeof(uint32_t));
+	conexion_enviar_stream_vector(g_cpu.conexion, FRAME, segments, 3);
 
 	// RECIBO DE UINT32_T
 
@@ -751,8 +1062,6 @@ uint32_t request_frame(uint32_t tabla_segundo_nivel, uint32_t offset)
 	uint32_t ret_frame = *frame;
 
 	free(frame);
-	free(send_stream);
-	free(operands);
 
 	return ret_frame;
 }
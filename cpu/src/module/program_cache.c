@@ -0,0 +1,118 @@
+/**
+ * @file program_cache.c
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Programs held by the CPU between dispatches
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdlib.h>
+
+#include "program_cache.h"
+#include "instruction.h"
+
+// ============================================================================================================
+//                               ***** Private Functions *****
+// ============================================================================================================
+
+static void program_cache_free(program_cache_entry_t *entry)
+{
+	list_smart_destroy(entry->instructions, instruction_destroy);
+	entry->instructions = NULL;
+}
+
+// ============================================================================================================
+//                               ***** Public Functions *****
+// ============================================================================================================
+
+program_cache_t program_cache_create(int capacity)
+{
+	program_cache_t cache;
+
+	cache.capacity = capacity > 0 ? capacity : 0;
+	cache.entries = calloc(cache.capacity, sizeof(program_cache_entry_t));
+	cache.clock = 0;
+
+	return cache;
+}
+
+t_list *program_cache_get(program_cache_t *cache, uint32_t pid, uint32_t hash)
+{
+	for (int i = 0; i < cache->capacity; i++)
+	{
+		program_cache_entry_t *entry = &cache->entries[i];
+
+		if (entry->instructions && entry->pid == pid && entry->hash == hash)
+		{
+			entry->last_use = ++cache->clock;
+			return entry->instructions;
+		}
+	}
+
+	return NULL;
+}
+
+bool program_cache_put(program_cache_t *cache, uint32_t pid, uint32_t hash, t_list *instructions)
+{
+	if (cache->capacity == 0)
+		return false;
+
+	// The previous program of the process, a free entry, or the least recently used
+	program_cache_entry_t *victim = &cache->entries[0];
+
+	for (int i = 0; i < cache->capacity; i++)
+	{
+		program_cache_entry_t *entry = &cache->entries[i];
+
+		if (entry->instructions && entry->pid == pid)
+		{
+			victim = entry;
+			break;
+		}
+
+		if (victim->instructions && (entry->instructions == NULL || entry->last_use < victim->last_use))
+			victim = entry;
+	}
+
+	if (victim->instructions != instructions)
+		program_cache_free(victim);
+
+	victim->pid = pid;
+	victim->hash = hash;
+	victim->instructions = instructions;
+	victim->last_use = ++cache->clock;
+
+	return true;
+}
+
+void program_cache_release(program_cache_t *cache, pcb_t *pcb)
+{
+	if (pcb == NULL)
+		return;
+
+	for (int i = 0; i < cache->capacity; i++)
+		if (pcb->instructions && cache->entries[i].instructions == pcb->instructions)
+			pcb->instructions = NULL;
+
+	pcb_destroy(pcb);
+}
+
+void program_cache_drop(program_cache_t *cache, uint32_t pid)
+{
+	for (int i = 0; i < cache->capacity; i++)
+		if (cache->entries[i].instructions && cache->entries[i].pid == pid)
+			program_cache_free(&cache->entries[i]);
+}
+
+void program_cache_destroy(program_cache_t *cache)
+{
+	for (int i = 0; i < cache->capacity; i++)
+		program_cache_free(&cache->entries[i]);
+
+	free(cache->entries);
+	cache->entries = NULL;
+	cache->capacity = 0;
+}
@@ -14,12 +14,20 @@
 #include "tlb.h"
 #include "log.h"
 #include "cfg.h"
+#include "trace.h"
+#include "metrics.h"
 
 // ============================================================================================================
 //                               ***** Private Functions *****
 // ============================================================================================================
 
 extern cpu_t g_cpu;
+
+// The process whose translations are cached, for the trace
+static inline uint32_t cached_pid(void)
+{
+	return g_cpu.pcb ? g_cpu.pcb->id : UINT32_MAX;
+}
 // tlb_t *g_tlb;
 
 tlb_t *tlb_create(uint32_t cant_entradas_TLB)
@@ -70,6 +78,8 @@ void replace_fifo(void *tlb, uint32_t nueva_pagina, uint32_t nuevo_frame)
 	else
 	{
 		LOG_INFO("[TLB-FIFO] :=> TLB[%d] Changed: [Page: %d, Frame: %d] -> [Page: %d, Frame: %d]", i, self[i].pagina, self[i].frame, nueva_pagina, nuevo_frame);
+		trace_event(TRACE_TLB_REPLACED, cached_pid(), self[i].pagina, nueva_pagina);
+		metrics_add(METRIC_TLB_REPLACEMENTS, 1);
 	}
 
 	self[i].pagina = nueva_pagina;
@@ -117,6 +127,8 @@ void replace_lru(void *tlb, uint32_t nueva_pagina, uint32_t nuevo_frame)
 
 	LOG_WARNING("[TLB-LRU] :=> Replacing TLB[%d]", pag_index_max);
 	LOG_INFO("[TLB-LRU] :=> TLB[%d] Changed: [Page: %d, Frame: %d] -> [Page: %d, Frame: %d]", pag_index_max, self[pag_index_max].pagina, self[pag_index_max].frame, nueva_pagina, nuevo_frame);
+	trace_event(TRACE_TLB_REPLACED, cached_pid(), self[pag_index_max].pagina, nueva_pagina);
+	metrics_add(METRIC_TLB_REPLACEMENTS, 1);
 	self[pag_index_max].frame = nuevo_frame;
 	self[pag_index_max].pagina = nueva_pagina;
 	self[pag_index_max].tiempo_ult_acceso = 0;
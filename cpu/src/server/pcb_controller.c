@@ -28,17 +28,86 @@ extern cpu_t g_cpu;
 //                                   ***** Public Functions  *****
 // ============================================================================================================
 
+/**
+ * @brief Hands a received PCB over to the execution cycle.
+ *
+ * @param pcb the PCB, NULL if it could not be received
+ * @param bytes the bytes received
+ * @return the PCB
+ */
+static pcb_t *start_execution(pcb_t *pcb, ssize_t bytes)
+{
+	if (pcb == NULL)
+	{
+		LOG_ERROR("[Server] :=> Malformed PCB received");
+		SIGNAL(g_cpu.sync.cpu_in_use);
+		return NULL;
+	}
+
+	g_cpu.pcb = pcb;
+	LOG_DEBUG("[Server] :=> PCB #%d received [%ld bytes]", pcb->id, bytes);
+	SIGNAL(g_cpu.sync.pcb_received);
+	return pcb;
+}
+
 pcb_t *receive_pcb(int fd)
 {
 	LOG_TRACE("[Server] :=> Requested execution. Awaiting...");
 	WAIT(g_cpu.sync.cpu_in_use);
 	ssize_t recv_bytes = -1;
 	pcb_t *pcb = NULL;
-	pcb = pcb_from_stream(servidor_recibir_stream(fd, &recv_bytes));
-	g_cpu.pcb = pcb;
-	LOG_DEBUG("[Server] :=> PCB #%d received [%ld bytes]", pcb->id, recv_bytes);
-	SIGNAL(g_cpu.sync.pcb_received);
-	return pcb;
+
+	// [PCB][PROGRAM]
+	void *stream = servidor_recibir_stream(fd, &recv_bytes);
+	wire_reader_t reader = wire_reader_create(stream, recv_bytes);
+	pcb = pcb_decode(&reader);
+	uint32_t program = wire_read_varint(&reader);
+	servidor_liberar_stream(fd, stream);
+
+	// Kept for the next dispatches of the process, which will only carry its state
+	if (pcb && !reader.failed && program_cache_put(&g_cpu.programs, pcb->id, program, pcb->instructions))
+		LOG_TRACE("[Server] :=> Program of PCB #%d cached", pcb->id);
+
+	return start_execution(pcb, recv_bytes);
+}
+
+pcb_t *receive_pcb_delta(int fd)
+{
+	LOG_TRACE("[Server] :=> Requested execution (delta). Awaiting...");
+	WAIT(g_cpu.sync.cpu_in_use);
+	ssize_t recv_bytes = -1;
+
+	// [PCB STATE][PROGRAM]
+	void *stream = servidor_recibir_stream(fd, &recv_bytes);
+	wire_reader_t reader = wire_reader_create(stream, recv_bytes);
+	pcb_t *pcb = new_pcb(0, 0, 0);
+	bool valid = pcb_decode_state(&reader, pcb);
+	uint32_t program = wire_read_varint(&reader);
+	servidor_liberar_stream(fd, stream);
+
+	t_list *instructions = valid && !reader.failed ? program_cache_get(&g_cpu.programs, pcb->id, program) : NULL;
+
+	if (instructions == NULL)
+	{
+		// The Kernel answers with the whole PCB
+		LOG_DEBUG("[Server] :=> Program of PCB #%d is not cached", pcb->id);
+		uint32_t id = pcb->id;
+		pcb_destroy(pcb);
+		SIGNAL(g_cpu.sync.cpu_in_use);
+
+		wire_writer_t writer;
+		wire_writer_init(&writer, WIRE_VARINT_MAX);
+		wire_write_varint(&writer, id);
+		enviar_stream(PCB_MISS, writer.buffer, writer.size, fd);
+		wire_writer_destroy(&writer);
+
+		return NULL;
+	}
+
+	list_destroy(pcb->instructions);
+	pcb->instructions = instructions;
+
+	return start_execution(pcb, recv_bytes);
 }
 
 ssize_t return_pcb(int fd, pcb_t *pcb, uint32_t time)
@@ -57,14 +126,15 @@ ssize_t return_pcb(int fd, pcb_t *pcb, uint32_t time)
 
 	LOG_WARNING("[Server] :=> Returning PCB #%d...", pcb->id);
 
-	size_t pcb_size = pcb_bytes_size(pcb);
-	void *stream = malloc(pcb_size + sizeof(time));
-	void *pcb_stream = pcb_to_stream(pcb);
+	// [PCB STATE][IO_TIME]: the Kernel still holds the instructions
+	wire_writer_t writer;
+	wire_writer_init(&writer, 7 * WIRE_VARINT_MAX);
+	pcb_encode_state(pcb, &writer);
+	wire_write_varint(&writer, time);
 
-	memcpy(stream, pcb_stream, pcb_size);
-	memcpy(stream + pcb_size, &time, sizeof(time));
+	ssize_t bytes_sent = enviar_stream(INOUT, writer.buffer, writer.size, fd);
 
-	ssize_t bytes_sent = servidor_enviar_stream(INOUT, fd, stream, pcb_size + sizeof(time));
+	wire_writer_destroy(&writer);
 
 	if (bytes_sent > 0)
 	{
@@ -75,7 +145,13 @@ ssize_t return_pcb(int fd, pcb_t *pcb, uint32_t time)
 		LOG_ERROR("[Server] :=> PCB<%d> did not return", pcb->id);
 	}
 
-	pcb_destroy(pcb);
+	uint32_t pid = pcb->id;
+	bool terminated = pcb->status == PCB_TERMINATED;
+
+	program_cache_release(&g_cpu.programs, pcb);
+
+	if (terminated)
+		program_cache_drop(&g_cpu.programs, pid);
 
 	// Reset the TLB
 	tlb_reset(&(g_cpu.tlb));
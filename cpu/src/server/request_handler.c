@@ -95,6 +95,18 @@ request_handler(void *fd)
 				receive_pcb(sender_fd);
 				break;
 
+			case PCB_DELTA:
+				receive_pcb_delta(sender_fd);
+				break;
+
+			// Answered by the connection layer
+			case SHM_LINK:
+				break;
+
+			case STATS:
+				servidor_enviar_metricas(sender_fd);
+				break;
+
 			default:
 				LOG_ERROR("[Server] :=> Client<%d>: Unrecognized operation code (%d)", sender_fd, opcode);
 				break;
@@ -0,0 +1,79 @@
+/**
+ * @file program_cache_test.c
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Program cache unit tests
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdlib.h>
+
+#include "program_cache.h"
+#include "instruction.h"
+#include "ctest.h"
+
+static t_list *program(uint32_t param)
+{
+	t_list *instructions = list_create();
+	list_add(instructions, instruction_create(C_REQUEST_NO_OP, param, 0));
+	list_add(instructions, instruction_create(C_REQUEST_EXIT, 0, 0));
+	return instructions;
+}
+
+CTEST(program_cache, when_full_then_leastRecentlyUsedIsEvicted)
+{
+	program_cache_t cache = program_cache_create(2);
+
+	t_list *first = program(1), *second = program(2), *third = program(3);
+	ASSERT_TRUE(program_cache_put(&cache, 1, instruction_list_hash(first), first));
+	ASSERT_TRUE(program_cache_put(&cache, 2, instruction_list_hash(second), second));
+
+	// The first one is dispatched again, so the second is the one to go
+	ASSERT_TRUE(first == program_cache_get(&cache, 1, instruction_list_hash(first)));
+	uint32_t second_hash = instruction_list_hash(second);
+	ASSERT_TRUE(program_cache_put(&cache, 3, instruction_list_hash(third), third));
+
+	ASSERT_NULL(program_cache_get(&cache, 2, second_hash));
+	ASSERT_TRUE(third == program_cache_get(&cache, 3, instruction_list_hash(third)));
+
+	// Another program for the same process is a miss
+	ASSERT_NULL(program_cache_get(&cache, 1, instruction_list_hash(third)));
+
+	program_cache_destroy(&cache);
+}
+
+CTEST(program_cache, when_pcbIsReleased_then_itsProgramStaysCached)
+{
+	program_cache_t cache = program_cache_create(1);
+
+	pcb_t *pcb = new_pcb(7, 64, 10);
+	list_destroy(pcb->instructions);
+	pcb->instructions = program(5);
+	uint32_t hash = instruction_list_hash(pcb->instructions);
+
+	ASSERT_TRUE(program_cache_put(&cache, pcb->id, hash, pcb->instructions));
+	program_cache_release(&cache, pcb);
+
+	t_list *cached = program_cache_get(&cache, 7, hash);
+	ASSERT_NOT_NULL(cached);
+	ASSERT_EQUAL(2, list_size(cached));
+
+	program_cache_drop(&cache, 7);
+	ASSERT_NULL(program_cache_get(&cache, 7, hash));
+
+	program_cache_destroy(&cache);
+}
+
+CTEST(program_cache, when_disabled_then_programsAreNotTaken)
+{
+	program_cache_t cache = program_cache_create(0);
+
+	t_list *instructions = program(1);
+	ASSERT_FALSE(program_cache_put(&cache, 1, instruction_list_hash(instructions), instructions));
+
+	list_destroy_and_destroy_elements(instructions, instruction_destroy);
+	program_cache_destroy(&cache);
+}
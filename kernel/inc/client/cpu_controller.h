@@ -49,14 +49,14 @@ cpu_controller_t *cpu_controller_on_init(cpu_controller_t *controller);
 void cpu_controller_destroy(cpu_controller_t *cpu_controller);
 
 /**
- * @brief Sends a PCB to a dispatch connection
+ * @brief Sends a PCB to a dispatch connection. The first time the whole PCB goes (PCB),
+ * afterwards only its state (PCB_DELTA), since the CPU keeps the program.
  *
  * @param connection_dispatch to sent
- * @param opcode the operation code
  * @param pcb the process control block
  * @return the number of bytes sent
  */
-ssize_t cpu_controller_send_pcb(conexion_t connection_dispatch, opcode_t opcode, pcb_t *pcb);
+ssize_t cpu_controller_send_pcb(conexion_t connection_dispatch, pcb_t *pcb);
 
 /**
  * @brief Sends an INTERRUPT signal to a interrupt connection.
@@ -67,10 +67,12 @@ ssize_t cpu_controller_send_pcb(conexion_t connection_dispatch, opcode_t opcode,
 ssize_t cpu_controller_send_interrupt(conexion_t connection_interrupt);
 
 /**
- * @brief Receives a PCB stream
+ * @brief Receives the state of the PCB sent, once the CPU returns it.
+ * If the CPU asks for the whole PCB instead (PCB_MISS), sends it and keeps waiting.
  *
  * @param connection_dispatch
+ * @param pcb the PCB sent, updated in place
  * @param io_time
- * @return void*
+ * @return the PCB or NULL if it could not be received
  */
-void *cpu_controller_receive_pcb(conexion_t connection_dispatch, uint32_t *io_time);
+void *cpu_controller_receive_pcb(conexion_t connection_dispatch, pcb_t *pcb, uint32_t *io_time);
@@ -15,32 +15,36 @@
 #include "pcb.h"
 
 /**
- * @brief Sends a PCB to a dispatch connection
+ * @brief Sends a PCB to Memory through the memory channel, without waiting for its acknowledge.
  *
  * @param opcode the operation code
  * @param pcb the process control block
- * @return the number of bytes sent
+ * @return the number of bytes sent, or ERROR
  */
 ssize_t swap_controller_send_pcb(opcode_t opcode, pcb_t *pcb);
 
 /**
- * @brief Request a PCB ID
+ * @brief Asks Memory to bring a swapped PCB back, without waiting for its acknowledge.
  *
  * @param pid the Process ID
- * @return the number of bytes sent
+ * @return the number of bytes sent, or ERROR
  */
 ssize_t swap_controller_request_pcb(uint32_t pid);
 
 /**
- * @brief Receives a PCB stream
+ * @brief Asks Memory for the page table of a new process, waiting for it.
+ * Other threads keep using the memory channel meanwhile.
  *
- * @return a PCB object
+ * @param pcb the new process
+ * @param page_table where to store the page table
+ * @return SUCCESS or ERROR
  */
-void *swap_controller_receive_pcb(void);
+int swap_controller_memory_init(pcb_t *pcb, uint32_t *page_table);
 
 /**
- * @brief Sends PID and page_table to memory
+ * @brief Sends PID and page_table to memory, without waiting for its acknowledge.
  *
+ * @return the number of bytes sent, or ERROR
  */
 ssize_t swap_controller_exit(pcb_t *pcb);
 
@@ -9,6 +9,7 @@
 #pragma once
 
 #include "server.h"
+#include "async_client.h"
 #include "thread_manager.h"
 #include "safe_list.h"
 #include "pids.h"
@@ -41,10 +42,10 @@ typedef struct Kernel
 	servidor_t server;
 	// Available PID pool
 	pids_t pids;
-	// Kernel instantiated PCBs.
-	safe_list_t *pcbs;
 	// Kernel-Memory Client dependency.
 	conexion_t conexion_memory;
+	// Kernel-Memory channel over conexion_memory: LTS, MTS and STS requests share it, matched by id.
+	async_client_t *memory;
 	// Kernel-CPU (Dispatch) connection dependency.
 	conexion_t conexion_dispatch;
 	// Kernel-CPU (Interrupt) connection dependency.
@@ -13,14 +13,28 @@
 
 #include "scheduler.h"
 
+// Resolution of the suspension deadlines [ms]
+#define MTS_TICK_MS 10
+
 typedef struct MTS_DTO
 {
 	// A Scheduler reference
 	scheduler_t *scheduler;
-	// Spied PCB
-	pcb_t *pcb;
+	// The PID of the spied PCB: it is looked up again once the deadline expires
+	uint32_t pid;
+	// The deadline: only the one still in suspensions[pid] suspends the PCB
+	timer_id_t timer;
 } mts_dto_t;
 
+/**
+ * @brief The MTS thread: suspends the PCBs whose deadline expired, one at a time.
+ * Swapping them out takes a while: it is not done on the timer thread, which fires every deadline.
+ *
+ * @param scheduler the Kernel scheduler unit.
+ * @return null ptr
+ */
+void *mts(void *scheduler);
+
 /**
  * @brief Notifyes the MTS that a process has been blocked so it can track the PCB blocked time.
  *
@@ -30,7 +44,15 @@ typedef struct MTS_DTO
 void notify_mts(scheduler_t *scheduler, pcb_t *pcb);
 
 /**
- * @brief Suspends a PCB
+ * @brief Stops tracking the blocked time of a PCB, once its IO finished.
+ *
+ * @param scheduler the Kernel scheduler unit.
+ * @param pid the PCB identifier.
+ */
+void cancel_tracking(scheduler_t *scheduler, uint32_t pid);
+
+/**
+ * @brief Suspends a PCB already moved to the BLOCKED SUS queue: frees its place in the multiprogramming and swaps it out
  *
  * @param scheduler the Kernel scheduler unit.
  * @param pcb a blocked PCB
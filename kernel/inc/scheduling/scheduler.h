@@ -12,9 +12,13 @@
 #pragma once
 
 #include "sem.h"
+#include "intrusive_queue.h"
+#include "mpmc_queue.h"
 #include "safe_queue.h"
 #include "pcb.h"
+#include "pcb_registry.h"
 #include "thread_manager.h"
+#include "timer_wheel.h"
 
 typedef struct Scheduler
 {
@@ -22,22 +26,24 @@ typedef struct Scheduler
 	sem_t *dom;
 	// Request to admit
 	sem_t *req_admit;
-	// Request to admit
-	sem_t *io_request;
-	// Allows Execution
-	sem_t *execute;
 	// Allows interruptions
 	bool interrupt;
-	// NEW Queue
-	safe_queue_t *new;
-	// READY Queue
-	safe_queue_t *ready;
-	// SUSPENDED READY Queue
-	safe_queue_t *ready_sus;
-	// BLOCKED Queue
-	safe_queue_t *blocked;
+	// NEW Queue (only pushed and popped: lock-free)
+	mpmc_queue_t *new;
+	// READY Queue (the STS blocks popping it)
+	intrusive_queue_t *ready;
+	// SUSPENDED READY Queue (only pushed and popped: lock-free)
+	mpmc_queue_t *ready_sus;
+	// BLOCKED Queue (the MTS removes from the middle of it)
+	intrusive_queue_t *blocked;
 	// SUSPENDED BLOCKED queue
-	safe_queue_t *blocked_sus;
+	intrusive_queue_t *blocked_sus;
+	// The blocked PCBs, in the order they asked for IO (the IO thread blocks popping it)
+	safe_queue_t *io_requests;
+	// Held while a blocked PCB is taken: by the IO thread for its burst, by the MTS to suspend it
+	pthread_mutex_t *taking;
+	// Every live PCB by PID, and the queue it is in: owns them
+	pcb_registry_t *pcbs;
 
 	// Current PCB estimation - Needed to preempt
 	uint32_t current_estimation;
@@ -51,7 +57,16 @@ typedef struct Scheduler
 	// Thread Tracker dependency.
 	thread_manager_t tm;
 
-	// Get scheduler next
+	// Suspension deadlines of the blocked PCBs
+	timer_wheel_t *timers;
+	// The suspension deadline of each blocked PCB, indexed by PID
+	timer_id_t *suspensions;
+	// Deadlines that expired, for the MTS thread to suspend their PCBs
+	safe_queue_t *expired;
+	// When each PCB last entered READY [us], indexed by PID
+	uint64_t *ready_since;
+
+	// Get scheduler next, waiting for one
 	void *(*get_next)(void *);
 } scheduler_t;
 
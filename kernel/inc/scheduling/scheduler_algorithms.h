@@ -14,7 +14,7 @@
 #include "scheduler.h"
 
 /**
- * @brief Get the next fifo object
+ * @brief Get the next fifo object, waiting for one to be ready
  *
  * @param scheduler the Scheduler object
  * @return a PCB
@@ -22,7 +22,7 @@
 void *get_next_fifo(void *scheduler);
 
 /**
- * @brief Get the next srt object
+ * @brief Get the next srt object, waiting for one to be ready
  *
  * @param scheduler the Scheduler object
  * @return a PCB
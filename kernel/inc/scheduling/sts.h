@@ -23,6 +23,14 @@ void *short_term_schedule(void *data);
  */
 void event(scheduler_t *scheduler, pcb_t *pcb);
 
+/**
+ * @brief Queues a PCB in READY, already marked as such
+ *
+ * @param scheduler the Kernel Scheduler unit
+ * @param pcb the ready PCB
+ */
+void enqueue_ready(scheduler_t *scheduler, pcb_t *pcb);
+
 /**
  * @brief Blocks a PCB
  *
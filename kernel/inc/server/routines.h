@@ -1,3 +1,12 @@
 #pragma once
 
+/**
+ * @brief Handles one request of a console.
+ *
+ * @param fd the console socket
+ * @param session the console state (its PID), allocated on first use
+ * @return the opcode handled, or <= 0 if the console disconnected
+ */
+int handle_request(int fd, void **session);
+
 void *routine(void *fd);
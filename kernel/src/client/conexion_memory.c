@@ -13,6 +13,9 @@
 
 extern kernel_t g_kernel;
 
+// Memory requests in flight at once, from every scheduler thread.
+#define MEMORY_CHANNEL_WINDOW 8
+
 /**
  * @brief Connects a Kernel to a Memory
  *
@@ -37,6 +40,7 @@ static int on_connect_memory(kernel_t *kernel)
 	if (on_module_connect(&kernel->conexion_memory, false) EQ SUCCESS)
 	{
 		LOG_DEBUG("[Memory Thread] :=> Connected as CLIENT at %s:%s", ip, port);
+		kernel->memory = async_client_create(kernel->conexion_memory, MEMORY_CHANNEL_WINDOW);
 	}
 
 	return SUCCESS;
@@ -12,6 +12,8 @@
 #include "cpu_controller.h"
 #include "pcb.h"
 #include "kernel.h"
+#include "instruction.h"
+#include "tuning.h"
 
 #define LOG_PCB(pcb)                                                                                                       \
 	{                                                                                                                      \
@@ -43,14 +45,46 @@ void cpu_controller_destroy(cpu_controller_t *cpu_controller)
 	pthread_mutex_destroy(&cpu_controller->cpu_interrupt);
 }
 
-ssize_t cpu_controller_send_pcb(conexion_t connection_dispatch, opcode_t opcode, pcb_t *pcb)
+/**
+ * @brief Sends the whole PCB: [PCB][PROGRAM]
+ *
+ * @param connection_dispatch to sent
+ * @param pcb the process control block
+ * @return the number of bytes sent
+ */
+static ssize_t cpu_controller_send_program(conexion_t connection_dispatch, pcb_t *pcb)
 {
 	ssize_t bytes_sent = -1;
-	void *stream = pcb_to_stream(pcb);
+	wire_writer_t writer;
+	wire_writer_init(&writer, pcb_bytes_size(pcb) + WIRE_VARINT_MAX);
+	pcb_encode(pcb, &writer);
+	wire_write_varint(&writer, pcb->program);
 
-	SAFE_STATEMENT(&this.cpu_dispatch, bytes_sent = conexion_enviar_stream(connection_dispatch, opcode, stream, pcb_bytes_size(pcb)));
+	SAFE_STATEMENT(&this.cpu_dispatch, bytes_sent = conexion_enviar_stream(connection_dispatch, PCB, writer.buffer, writer.size));
 
-	free(stream);
+	wire_writer_destroy(&writer);
+
+	return bytes_sent;
+}
+
+ssize_t cpu_controller_send_pcb(conexion_t connection_dispatch, pcb_t *pcb)
+{
+	if (pcb->program == 0)
+	{
+		pcb->program = instruction_list_hash(pcb->instructions);
+		return cpu_controller_send_program(connection_dispatch, pcb);
+	}
+
+	// [PCB STATE][PROGRAM]
+	ssize_t bytes_sent = -1;
+	wire_writer_t writer;
+	wire_writer_init(&writer, 7 * WIRE_VARINT_MAX);
+	pcb_encode_state(pcb, &writer);
+	wire_write_varint(&writer, pcb->program);
+
+	SAFE_STATEMENT(&this.cpu_dispatch, bytes_sent = conexion_enviar_stream(connection_dispatch, PCB_DELTA, writer.buffer, writer.size));
+
+	wire_writer_destroy(&writer);
 
 	return bytes_sent;
 }
@@ -58,27 +92,58 @@ ssize_t cpu_controller_send_pcb(conexion_t connection_dispatch, opcode_t opcode,
 ssize_t cpu_controller_send_interrupt(conexion_t connection_interrupt)
 {
 	ssize_t bytes_sent = -1;
-	opcode_t opcode = INT;
-	SAFE_STATEMENT(&this.cpu_interrupt, bytes_sent = connection_send_value(connection_interrupt, &opcode, sizeof(opcode_t)));
+	// Nothing is read back on this connection to push it out: a corked interrupt would wait for the next one
+	pthread_mutex_lock(&this.cpu_interrupt);
+	bytes_sent = conexion_enviar_stream_vector(connection_interrupt, INT, NULL, 0);
+	socket_flush(connection_interrupt.socket);
+	pthread_mutex_unlock(&this.cpu_interrupt);
 	return bytes_sent;
 }
 
 void *
-cpu_controller_receive_pcb(conexion_t connection_dispatch, uint32_t *io_time)
+cpu_controller_receive_pcb(conexion_t connection_dispatch, pcb_t *pcb, uint32_t *io_time)
 {
-	// Recover Stream from Connection
-	ssize_t bytes_received = 0;
-	void *stream = NULL;
-	SAFE_STATEMENT(&this.cpu_dispatch, stream = conexion_recibir_stream(connection_dispatch.socket, &bytes_received));
-	LOG_WARNING("[Client-Dispatch] :=> Package received [%ld bytes] ", bytes_received);
-
-	// Recover data from Stream
-	pcb_t *recovered_pcb = pcb_from_stream(stream);
-	memcpy(io_time, stream + pcb_bytes_size(recovered_pcb), sizeof(uint32_t));
-	LOG_PCB(recovered_pcb);
-
-	// Deallocate Stream
-	free(stream);
-
-	return recovered_pcb;
+	for (;;)
+	{
+		// Recover Stream from Connection
+		wire_header_t header;
+		void *stream = NULL;
+		SAFE_STATEMENT(&this.cpu_dispatch, stream = conexion_recibir_frame(connection_dispatch.socket, &header));
+
+		if (stream == NULL)
+		{
+			LOG_ERROR("[Client-Dispatch] :=> PCB #%d could not be received", pcb->id);
+			return NULL;
+		}
+
+		LOG_WARNING("[Client-Dispatch] :=> Package received [%u bytes] ", header.length);
+		wire_reader_t reader = wire_reader_create(stream, header.length);
+
+		// The CPU no longer holds the program: send it and wait again
+		if (header.opcode == PCB_MISS)
+		{
+			LOG_DEBUG("[Client-Dispatch] :=> CPU misses the program of PCB #%d", wire_read_varint(&reader));
+			free(stream);
+
+			if (cpu_controller_send_program(connection_dispatch, pcb) <= 0)
+				return NULL;
+
+			continue;
+		}
+
+		// Recover data from Stream: [PCB STATE][IO_TIME]
+		bool valid = pcb_decode_state(&reader, pcb);
+		*io_time = wire_read_varint(&reader);
+		free(stream);
+
+		if (!valid || reader.failed)
+		{
+			LOG_ERROR("[Client-Dispatch] :=> Malformed PCB received");
+			return NULL;
+		}
+
+		LOG_PCB(pcb);
+
+		return pcb;
+	}
 }
@@ -9,6 +9,7 @@
  *
  */
 #include "swap_controller.h"
+#include "operands.h"
 #include "pcb.h"
 #include "kernel.h"
 
@@ -20,16 +21,67 @@ extern kernel_t g_kernel;
 		LOG_INFO("[SWAP-Controller] :=> PCB<%d>(size: %lu, estimation: %d, pc: %d)", pcb->id, pcb->size, pcb->estimation, pcb->pc); \
 	}
 
+/**
+ * @brief Called from the memory channel once Memory acknowledges a request: [STATUS].
+ *
+ * @param reply the acknowledge, NULL if the connection was lost
+ * @param size its size
+ * @param opcode the operation acknowledged
+ */
+static void on_memory_ack(void *reply, ssize_t size, void *opcode)
+{
+	char *operation = opcode_to_string((opcode_t)(intptr_t)opcode);
+
+	if (reply == NULL || size < (ssize_t)sizeof(uint32_t))
+	{
+		LOG_ERROR("[SWAP-Controller] :=> Memory did not acknowledge <%s>", operation);
+	}
+	else if (*(uint32_t *)reply != SUCCESS)
+	{
+		LOG_WARNING("[SWAP-Controller] :=> Memory could not complete <%s>", operation);
+	}
+	else
+	{
+		LOG_TRACE("[SWAP-Controller] :=> Memory completed <%s>", operation);
+	}
+}
+
+/**
+ * @brief Sends a request through the memory channel; its acknowledge is only logged.
+ *
+ * @return the payload bytes handed to the channel, or ERROR if Memory is not connected or it could not be sent
+ */
+static ssize_t submit(opcode_t opcode, const struct iovec *segments, int count)
+{
+	if (g_kernel.memory == NULL)
+	{
+		LOG_WARNING("[SWAP-Controller] :=> Memory is not connected, <%s> was not sent", opcode_to_string(opcode));
+		return ERROR;
+	}
+
+	ssize_t size = 0;
+	for (int i = 0; i < count; i++)
+		size += segments[i].iov_len;
+
+	if (async_client_post(g_kernel.memory, opcode, segments, count, on_memory_ack, (void *)(intptr_t)opcode) EQ ERROR)
+	{
+		LOG_ERROR("[SWAP-Controller] :=> <%s> could not be sent to Memory", opcode_to_string(opcode));
+		return ERROR;
+	}
+
+	return size;
+}
+
 ssize_t
 swap_controller_send_pcb(opcode_t opcode, pcb_t *pcb)
 {
-	ssize_t bytes_sent = -1;
 	void *stream = pcb_to_stream(pcb);
 	LOG_WARNING("[SWAP-Controller] :=> Sending SWAP for PCB...");
 
 	LOG_PCB(pcb);
 
-	bytes_sent = conexion_enviar_stream(g_kernel.conexion_memory, opcode, stream, pcb_bytes_size(pcb));
+	struct iovec segment = {.iov_base = stream, .iov_len = pcb_bytes_size(pcb)};
+	ssize_t bytes_sent = submit(opcode, &segment, 1);
 
 	free(stream);
 
@@ -40,45 +92,55 @@ ssize_t
 swap_controller_request_pcb(uint32_t pid)
 {
 	LOG_TRACE("[SWAP-Controller] :=> Requesting PCB #%d", pid);
-	return conexion_enviar_stream(g_kernel.conexion_memory, RETRIEVE_SWAPPED_PCB, &pid, sizeof(pid));
+
+	struct iovec segment = {.iov_base = &pid, .iov_len = sizeof(pid)};
+
+	return submit(RETRIEVE_SWAPPED_PCB, &segment, 1);
 }
 
-void *
-swap_controller_receive_pcb(void)
+int swap_controller_memory_init(pcb_t *pcb, uint32_t *page_table)
 {
-	// Recover Stream from Connection
-	ssize_t bytes_received = 0;
-	void *stream = NULL;
-	stream = conexion_recibir_stream(g_kernel.conexion_memory.socket, &bytes_received);
-	LOG_WARNING("[SWAP-Controller] :=> SWAP metadata received [%ld bytes]", bytes_received);
+	if (g_kernel.memory == NULL)
+		return ERROR;
 
-	// Recover data from Stream
-	// pcb_t *recovered_pcb = pcb_from_stream(stream);
-	// LOG_PCB(recovered_pcb);
+	operands_t operands = {.op1 = pcb->id, .op2 = pcb->size};
+	void *stream = operandos_to_stream(&operands);
+	struct iovec segment = {.iov_base = stream, .iov_len = sizeof(operands_t)};
 
-	// Deallocate Stream
+	async_request_t *request = async_client_submit(g_kernel.memory, MEMORY_INIT, &segment, 1, NULL, NULL);
 	free(stream);
 
-	return NULL;
+	if (request == NULL)
+		return ERROR;
+
+	// Only this thread waits: the rest keep sending through the channel meanwhile
+	ssize_t size = ERROR;
+	uint32_t *reply = async_request_wait(g_kernel.memory, request, &size);
+
+	if (reply == NULL || size < (ssize_t)sizeof(uint32_t))
+	{
+		async_client_release(g_kernel.memory, reply);
+		return ERROR;
+	}
+
+	*page_table = *reply;
+	async_client_release(g_kernel.memory, reply);
+
+	return SUCCESS;
 }
 
 ssize_t swap_controller_exit(pcb_t *pcb)
 {
-	void *stream = NULL;
-
-	opcode_t pcb_terminated = PROCESS_TERMINATED;
 	uint32_t pid = pcb->id;
 	uint32_t page_table = pcb->page_table;
-	uint32_t size = sizeof(pid) + sizeof(page_table);
 
-	stream = malloc(size);
-	uint32_t offset = 0;
-	memcpy(stream, &pid, sizeof(pid));
-	offset += sizeof(pid);
-	memcpy(stream + offset, &page_table, sizeof(page_table));
+	// [PID][PAGE_TABLE]
+	struct iovec segments[] = {
+		{.iov_base = &pid, .iov_len = sizeof(pid)},
+		{.iov_base = &page_table, .iov_len = sizeof(page_table)},
+	};
 
-	ssize_t ret = conexion_enviar_stream(g_kernel.conexion_memory, pcb_terminated, stream, size);
+	ssize_t ret = submit(PROCESS_TERMINATED, segments, 2);
 	LOG_TRACE("[SWAP-Controller] :=> Request sent [%ld bytes]", ret);
-	free(stream);
 	return ret;
 }
@@ -17,7 +17,10 @@
 #include "lib.h"
 #include "log.h"
 #include "cfg.h"
+#include "trace.h"
+#include "metrics.h"
 #include "routines.h"
+#include "reactor.h"
 #include "thread_manager.h"
 #include "signals.h"
 #include "kernel.h"
@@ -68,7 +71,6 @@ static int on_init_kernel(kernel_t *kernel)
 {
 	kernel->server = servidor_create(ip(), puerto_escucha());
 	kernel->tm = new_thread_manager();
-	kernel->pcbs = new_safe_list();
 	kernel->pids = new_pids();
 	kernel->multiprogramming_grade = grado_multiprogramacion();
 	kernel->scheduler = new_scheduler(kernel->multiprogramming_grade, algoritmo_planificacion(), tiempo_maximo_bloqueado());
@@ -87,7 +89,6 @@ on_delete_kernel(kernel_t *kernel)
 	on_destroy_sync(&kernel->sync);
 	scheduler_delete(kernel->scheduler);
 	LOG_TRACE("Syncrhonizer Ended.");
-	safe_list_destroy_with(kernel->pcbs, pcb_destroy);
 	pids_destroy(&kernel->pids);
 
 	// Destroy CPU Connections
@@ -96,6 +97,7 @@ on_delete_kernel(kernel_t *kernel)
 	LOG_TRACE("CPU Connections Stoppped.");
 
 	// Destroy Memory Connection
+	async_client_destroy(kernel->memory);
 	conexion_destroy(&(kernel->conexion_memory));
 	LOG_TRACE("Memory Connection Stopped.");
 
@@ -177,6 +179,11 @@ int on_init(kernel_t *kernel)
 
 	LOG_DEBUG("Configurations loaded.");
 
+	// Events are only recorded when TRAZA is set
+	trace_init(MODULE_NAME);
+	// Snapshots on SIGUSR1 and at exit
+	metrics_init(MODULE_NAME);
+
 	if (on_init_kernel(kernel) EQ EXIT_SUCCESS)
 	{
 		LOG_DEBUG("kernel initializated");
@@ -242,8 +249,13 @@ handle_consoles(kernel_t *kernel)
 
 	LOG_DEBUG("[Server] :=> Server listening. Awaiting for connections.");
 
-	for (;;)
-		servidor_run(&(kernel->server), routine);
+	if (reactores() > 0)
+	{
+		servidor_run_reactor(&(kernel->server), reactores(), handle_request);
+		return;
+	}
+
+	servidor_run_acceptors(&(kernel->server), aceptadores(), routine);
 }
 
 static void
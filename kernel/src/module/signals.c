@@ -6,6 +6,7 @@
 #include "signals.h"
 #include "lib.h"
 #include "log.h"
+#include "metrics.h"
 #include "kernel.h"
 
 extern kernel_t g_kernel;
@@ -17,10 +18,11 @@ _sigint()
 	on_before_exit(&(g_kernel), SIGINT);
 }
 
+// Sin log: el handler no puede tomar el logger. Lo informa el thread que escribe el snapshot.
 static void
 _sigusr1()
 {
-	LOG_WARNING("Se capturó la señal SIGUSR1");
+	metrics_request_dump();
 }
 
 static void
@@ -14,14 +14,15 @@
 #include "pcb.h"
 #include "scheduler.h"
 #include "kernel.h"
+#include "trace.h"
 
 extern kernel_t *g_kernel;
 
 /**
- * @brief Retrieves a Blocked PCB
+ * @brief Waits for the next IO request, and takes its PCB out of the blocked queue it is in
  *
  * @param scheduler the scheduler which handles the queues
- * @return a blcoked PCB
+ * @return a blocked PCB, never NULL
  */
 static pcb_t *
 retrieve_pcb(scheduler_t *scheduler);
@@ -41,53 +42,34 @@ void *io_scheduler(void *scheduler)
 
 	for (;;)
 	{
-		int requests = 0;
-		sem_getvalue(s->io_request, &requests);
-
-		if (requests > 0)
-		{
-			LOG_TRACE("[IO] :=> There are <%d> IO requests", requests);
-		}
-		else
+		if (safe_queue_is_empty(s->io_requests))
 		{
 			LOG_WARNING("[IO] :=>  Waiting for an IO request");
 		}
 
-		WAIT(s->io_request);
+		pcb_t *pcb = retrieve_pcb(s);
 
-		LOG_TRACE("[IO] :=> Attending a Request...");
+		// IO request received
+		LOG_INFO("[IO] :=> PCB #%d requested IO", pcb->id);
+		// Execute IO Burst
+		LOG_TRACE("[IO] :=> PCB #%d Using IO for: %ds", pcb->id, pcb->io);
+		trace_event(TRACE_IO_STARTED, pcb->id, pcb->io, pcb->status EQ PCB_SUSPENDED_BLOCKED);
+		usleep(pcb->io * 1000);
+		trace_event(TRACE_IO_FINISHED, pcb->id, 0, 0);
 
-		pcb_t *pcb = NULL;
-		pcb = retrieve_pcb(s);
-
-		if (pcb)
-		{
-			// IO request received
-			LOG_INFO("[IO] :=> PCB #%d requested IO", pcb->id);
-			s->current_io = pcb->id;
-			// Execute IO Burst
-			LOG_TRACE("[IO] :=> PCB #%d Using IO for: %ds", pcb->id, pcb->io);
-			usleep(pcb->io * 1000);
-
-			LOG_INFO("[IO] :=> PCB #%d IO finished", pcb->id);
-
-			switch (pcb->status)
-			{
-			case PCB_SUSPENDED_BLOCKED:
-				suspended_event(s, pcb);
-				break;
-
-			default:
-				event(s, pcb);
-				break;
-			}
-		}
-		else
-		{
-			LOG_ERROR("[IO] :=> No PCB available when IO was signaled");
-		}
+		LOG_INFO("[IO] :=> PCB #%d IO finished", pcb->id);
+		cancel_tracking(s, pcb->id);
 
+		// Once released, the MTS no longer suspends it
+		pthread_mutex_lock(s->taking);
+		bool suspended = pcb->status EQ PCB_SUSPENDED_BLOCKED;
 		s->current_io = UINT32_MAX;
+		pthread_mutex_unlock(s->taking);
+
+		if (suspended)
+			suspended_event(s, pcb);
+		else
+			event(s, pcb);
 	}
 
 	return NULL;
@@ -96,26 +78,28 @@ void *io_scheduler(void *scheduler)
 static pcb_t *
 retrieve_pcb(scheduler_t *scheduler)
 {
-	pcb_t *pcb = NULL;
+	pcb_t *pcb = safe_queue_pop_wait(scheduler->io_requests);
 
-	pcb = safe_queue_pop(scheduler->blocked_sus);
+	LOG_TRACE("[IO] :=> Attending a Request...");
 
-	if (pcb == NULL)
-	{
-		pcb = safe_queue_pop(scheduler->blocked);
+	// The MTS moves PCBs from BLOCKED to BLOCKED SUS holding the same lock: the PCB is always in one of them
+	pthread_mutex_lock(scheduler->taking);
 
-		if (pcb == NULL)
-		{
-			LOG_ERROR("[IO] :=> No PCB available - THIS SHOULD NEVER HAPPEN");
-			return NULL;
-		}
+	scheduler->current_io = pcb->id;
 
+	if (pcb_registry_move(scheduler->pcbs, pcb->id, PCB_QUEUE_BLOCKED, PCB_QUEUE_NONE))
+	{
 		LOG_DEBUG("[IO] :=> Handling IO request for PCB #%d, which was <BLOCKED>", pcb->id);
+		intrusive_queue_remove(scheduler->blocked, pcb);
 	}
 	else
 	{
 		LOG_WARNING("[IO] :=> Handling IO request for PCB #%d, which was <SUSPENDED>", pcb->id);
+		pcb_registry_set(scheduler->pcbs, pcb->id, PCB_QUEUE_NONE);
+		intrusive_queue_remove(scheduler->blocked_sus, pcb);
 	}
 
+	pthread_mutex_unlock(scheduler->taking);
+
 	return pcb;
 }
@@ -12,12 +12,14 @@
 #include <stdlib.h>
 #include "kernel.h"
 #include "pcb_unit.h"
-#include "safe_queue.h"
+#include "intrusive_queue.h"
 #include "log.h"
+#include "trace.h"
 #include "accion.h"
 #include "mts.h"
+#include "sts.h"
 #include "cpu_controller.h"
-#include "operands.h"
+#include "swap_controller.h"
 
 // ============================================================================================================
 //                                   ***** Declarations *****
@@ -70,53 +72,35 @@ long_term_schedule(void *kernel_ref)
 void admit(kernel_t *kernel)
 {
 
-	safe_queue_t *new = kernel->scheduler.new;
-	safe_queue_t *ready = kernel->scheduler.ready;
-	conexion_t memory = kernel->conexion_memory;
-	operands_t operands;
+	mpmc_queue_t *new = kernel->scheduler.new;
+	intrusive_queue_t *ready = kernel->scheduler.ready;
 
 	if (new != NULL && ready != NULL)
 	{
 		LOG_TRACE("[LTS] :=> Admitting a process...");
 		// Sets to ready a new process and enqueues.
 		pcb_t *pcb = resume(&kernel->scheduler);
+		bool resumed = pcb != NULL;
 
 		// When cannot resume a process - A new one must be instead.
 		if (pcb == NULL)
 		{
-			pcb = safe_queue_pop(new);
+			pcb = mpmc_queue_pop(new);
 			LOG_TRACE("[LTS] :=> New process admitted");
 
 			// Request page table.
-			if (conexion_esta_conectada(memory))
+			if (kernel->memory != NULL)
 			{
 				LOG_TRACE("[LTS] :=> Request page table...");
 
-				uint32_t pcb_id = pcb->id;
-				uint32_t pcb_size = pcb->size;
-
-				operands.op1 = pcb_id;
-				operands.op2 = pcb_size;
-
-				void *stream = operandos_to_stream(&operands);
-
-				conexion_enviar_stream(memory, MEMORY_INIT, stream, sizeof(operands_t));
-				free(stream);
-
-				ssize_t bytes_received = -1;
-
-				uint32_t *page_ref = conexion_recibir_stream(kernel->conexion_memory.socket, &bytes_received);
-
-				if (bytes_received <= 0 && page_ref == NULL)
+				if (swap_controller_memory_init(pcb, &pcb->page_table) EQ ERROR)
 				{
 					LOG_ERROR("[LTS] :=> Couldn't receive page table");
 				}
 				else
 				{
-					pcb->page_table = *page_ref;
 					LOG_DEBUG("[LTS] :=> Page table  <%d> received", pcb->page_table);
 				}
-				free(page_ref);
 			}
 			else
 			{
@@ -130,7 +114,8 @@ void admit(kernel_t *kernel)
 
 			check_interruption(kernel, pcb);
 
-			safe_queue_push(ready, pcb);
+			enqueue_ready(&kernel->scheduler, pcb);
+			trace_event(TRACE_PROCESS_ADMITTED, pcb->id, pcb->page_table, resumed);
 
 			LOG_INFO("[LTS] :=> PCB #%d  moved to Ready Queue", pcb->id);
 		}
@@ -138,8 +123,6 @@ void admit(kernel_t *kernel)
 		{
 			LOG_ERROR("[LTS] :=> No process to be admit - PCB cannot be NULL");
 		}
-
-		SIGNAL(kernel->scheduler.execute);
 	}
 	else
 	{
@@ -13,56 +13,102 @@
 #include "pcb.h"
 #include "time.h"
 #include "log.h"
+#include "trace.h"
+#include "metrics.h"
 #include "opcode.h"
 #include "swap_controller.h"
 
-void *track_time(void *scheduler_data);
+void track_time(void *scheduler_data);
+
+void suspend_expired(mts_dto_t *dto);
 
 void notify_mts(scheduler_t *scheduler, pcb_t *pcb)
 {
 	LOG_TRACE("[MTS] :=> Notified of PCB #%d...", pcb->id);
 
+	// Deadlines are kept by PID
+	if (pcb->id >= PIDS)
+	{
+		LOG_ERROR("[MTS] :=> PCB #%d is beyond the PIDs tracked, it will not be suspended", pcb->id);
+		return;
+	}
+
 	mts_dto_t *dto = malloc(sizeof(mts_dto_t));
 
 	dto->scheduler = scheduler;
-	dto->pcb = pcb;
+	dto->pid = pcb->id;
 
-	thread_manager_launch(&scheduler->tm, track_time, dto);
+	LOG_DEBUG("[MTS] :=> Tracking PCB #%d", pcb->id);
+
+	// The MTS reads the timer under the same lock: it is there even if the deadline expires right away
+	pthread_mutex_lock(scheduler->taking);
+	dto->timer = timer_wheel_schedule(scheduler->timers, scheduler->max_blocked_time, track_time, dto);
+	scheduler->suspensions[pcb->id] = dto->timer;
+	pthread_mutex_unlock(scheduler->taking);
 }
 
-void *track_time(void *dto)
+void cancel_tracking(scheduler_t *scheduler, uint32_t pid)
 {
-	LOG_WARNING("[MTS] :=> Tracking...");
-
-	// Cast to type SCHEDULER
-	scheduler_t *s = ((mts_dto_t *)dto)->scheduler;
-	// Cast to type PCB
-	pcb_t *pcb = ((mts_dto_t *)dto)->pcb;
+	void *dto = NULL;
 
-	if (pcb == NULL || s == NULL)
+	if (pid < PIDS && timer_wheel_cancel(scheduler->timers, scheduler->suspensions[pid], &dto))
 	{
-		LOG_ERROR("[MTS] :=> PCB or Scheduler NULL - THIS SHOULD NEVER HAPPEN");
-		return NULL;
+		LOG_TRACE("[MTS] :=> Stopped tracking PCB #%d", pid);
+		free(dto);
 	}
+}
 
-	uint32_t pid = pcb->id;
+void *mts(void *scheduler)
+{
+	scheduler_t *s = scheduler;
+
+	for (;;)
+		suspend_expired(safe_queue_pop_wait(s->expired));
+
+	return NULL;
+}
+
+void track_time(void *dto)
+{
+	// On the timer thread: only hands it over to the MTS thread
+	safe_queue_push(((mts_dto_t *)dto)->scheduler->expired, dto);
+}
+
+void suspend_expired(mts_dto_t *dto)
+{
+	scheduler_t *s = dto->scheduler;
+	uint32_t pid = dto->pid;
 
-	// Get current time
-	LOG_DEBUG("[MTS] :=> Tracking PCB #%d", pid);
-	usleep(s->max_blocked_time * 1000);
 	LOG_TRACE("[MTS] :=> Suspension Tracker for PCB #%d finished", pid);
 
-	if (pcb_exists(s->blocked, pid) || s->current_io == pid)
+	// Claims it from the BLOCKED queue, unless the IO scheduler took it first
+	pthread_mutex_lock(s->taking);
+
+	// A deadline of an earlier block, whose IO finished before it was handled: the PCB may have blocked
+	// again since then, or ended, and it is not suspended for it
+	bool current = s->suspensions[pid] EQ dto->timer;
+	free(dto);
+
+	pcb_t *pcb = NULL;
+
+	if (current && (pcb = pcb_registry_move(s->pcbs, pid, PCB_QUEUE_BLOCKED, PCB_QUEUE_BLOCKED_SUS)))
+		intrusive_queue_remove(s->blocked, pcb);
+	else if (current && s->current_io == pid && (pcb = pcb_registry_get(s->pcbs, pid)))
+		pcb_registry_set(s->pcbs, pid, PCB_QUEUE_BLOCKED_SUS);
+
+	if (pcb)
 	{
-		LOG_INFO("[MTS] :=> PCB #%d has been blocked for %dms", pid, s->max_blocked_time);
-		pcb_t *removed = pcb_remove_by_id(s->blocked, pid);
-		suspend(s, removed == NULL ? pcb : removed);
+		pcb->status = PCB_SUSPENDED_BLOCKED;
+		intrusive_queue_push(s->blocked_sus, pcb);
 	}
 
-	free(dto);
-	thread_manager_end_thread(&s->tm);
+	pthread_mutex_unlock(s->taking);
 
-	return NULL;
+	if (pcb)
+	{
+		LOG_INFO("[MTS] :=> PCB #%d has been blocked for %dms", pid, s->max_blocked_time);
+		suspend(s, pcb);
+	}
 }
 
 void suspend(scheduler_t *scheduler, pcb_t *pcb)
@@ -76,16 +122,20 @@ void suspend(scheduler_t *scheduler, pcb_t *pcb)
 	uint32_t pid = pcb->id;
 	SIGNAL(scheduler->dom);
 	LOG_ERROR("[MTS] :=> Blocked PCB #%d has been SUSPENDED", pid);
-	pcb->status = PCB_SUSPENDED_BLOCKED;
-	safe_queue_push(scheduler->blocked_sus, pcb);
-	swap_controller_send_pcb(SWAP_PCB, pcb);
+	trace_event(TRACE_PROCESS_SUSPENDED, pid, scheduler->max_blocked_time, 0);
+	metrics_add(METRIC_SUSPENSIONS, 1);
+
+	if (swap_controller_send_pcb(SWAP_PCB, pcb) EQ ERROR)
+	{
+		LOG_ERROR("[MTS] :=> PCB #%d could not be swapped out, it stays in Memory", pid);
+	}
 }
 
 pcb_t *resume(scheduler_t *scheduler)
 {
 	pcb_t *pcb = NULL;
 
-	pcb = safe_queue_pop(scheduler->ready_sus);
+	pcb = mpmc_queue_pop(scheduler->ready_sus);
 
 	if (pcb != NULL)
 	{
@@ -99,18 +149,25 @@ void suspended_event(scheduler_t *scheduler, pcb_t *pcb)
 {
 	LOG_DEBUG("[MTS] :=> Event occured for suspended PCB #%d", pcb->id);
 
-	if (pcb_exists(scheduler->blocked_sus, pcb->id))
+	if (pcb_registry_move(scheduler->pcbs, pcb->id, PCB_QUEUE_BLOCKED_SUS, PCB_QUEUE_READY_SUS))
 	{
-
-		pcb = pcb_remove_by_id(scheduler->blocked_sus, pcb->id);
+		intrusive_queue_remove(scheduler->blocked_sus, pcb);
 	}
 	else
 	{
 		LOG_WARNING("[MTS] :=> PCB #%d not found in BLOCKED SUS Queue (Probably Already removed)", pcb->id);
+		pcb_registry_set(scheduler->pcbs, pcb->id, PCB_QUEUE_READY_SUS);
 	}
 
 	pcb->status = PCB_SUSPENDED_READY;
-	safe_queue_push(scheduler->ready_sus, pcb);
+	trace_event(TRACE_PROCESS_SUSPENDED_READY, pcb->id, 0, 0);
+	// Holds a PCB per PID: it is never full
+	if (!mpmc_queue_push(scheduler->ready_sus, pcb))
+	{
+		LOG_ERROR("[MTS] :=> SUSPENDED Ready queue is full, PCB #%d dropped - THIS SHOULD NEVER HAPPEN", pcb->id);
+		return;
+	}
+
 	SIGNAL(scheduler->req_admit);
 	LOG_INFO("[MTS] :=> PCB #%d moved to SUSPENDED Ready", pcb->id);
 }
@@ -17,6 +17,7 @@
 #include "kernel.h"
 #include "cpu_controller.h"
 #include "scheduler_algorithms.h"
+#include "mts.h"
 
 scheduler_t new_scheduler(int dom, char *algorithm, uint32_t max_blocked_time)
 {
@@ -25,11 +26,15 @@ scheduler_t new_scheduler(int dom, char *algorithm, uint32_t max_blocked_time)
 	s.current_io = UINT32_MAX;
 
 	// Init queues
-	s.new = new_safe_queue();
-	s.ready = new_safe_queue();
-	s.ready_sus = new_safe_queue();
-	s.blocked = new_safe_queue();
-	s.blocked_sus = new_safe_queue();
+	s.new = new_mpmc_queue(PIDS);
+	s.ready = new_intrusive_queue(offsetof(pcb_t, link));
+	s.ready_sus = new_mpmc_queue(PIDS);
+	s.blocked = new_intrusive_queue(offsetof(pcb_t, link));
+	s.blocked_sus = new_intrusive_queue(offsetof(pcb_t, link));
+	s.io_requests = new_safe_queue();
+	s.taking = malloc(sizeof(pthread_mutex_t));
+	pthread_mutex_init(s.taking, NULL);
+	s.pcbs = new_pcb_registry(PIDS);
 
 	// Init Algorithm
 	s.interrupt = !strcmp(algorithm, "FIFO") == 0;
@@ -42,15 +47,17 @@ scheduler_t new_scheduler(int dom, char *algorithm, uint32_t max_blocked_time)
 	// Init Thread Manager
 	s.tm = new_thread_manager();
 
+	// One thread tracks every blocked PCB
+	s.timers = timer_wheel_create(MTS_TICK_MS);
+	s.suspensions = calloc(PIDS, sizeof(timer_id_t));
+	s.expired = new_safe_queue();
+	s.ready_since = calloc(PIDS, sizeof(uint64_t));
+
 	// Init semaphores
 	s.dom = malloc(sizeof(sem_t));
-	s.io_request = malloc(sizeof(sem_t));
 	s.req_admit = malloc(sizeof(sem_t));
-	s.execute = malloc(sizeof(sem_t));
 	sem_init(s.dom, SHARE_BETWEEN_THREADS, dom);
-	sem_init(s.io_request, SHARE_BETWEEN_THREADS, 0);
 	sem_init(s.req_admit, SHARE_BETWEEN_THREADS, 0);
-	sem_init(s.execute, SHARE_BETWEEN_THREADS, 0);
 
 	return s;
 }
@@ -58,30 +65,40 @@ scheduler_t new_scheduler(int dom, char *algorithm, uint32_t max_blocked_time)
 void scheduler_start(scheduler_t *scheduler)
 {
 	thread_manager_launch(&scheduler->tm, io_scheduler, scheduler);
+	thread_manager_launch(&scheduler->tm, mts, scheduler);
 }
 
 void scheduler_delete(scheduler_t scheduler)
 {
 
-	// Destroy queues
-	safe_queue_destroy(scheduler.new, pcb_destroy);
-	safe_queue_destroy(scheduler.ready, pcb_destroy);
-	safe_queue_destroy(scheduler.ready_sus, pcb_destroy);
-	safe_queue_destroy(scheduler.blocked, pcb_destroy);
-	safe_queue_destroy(scheduler.blocked_sus, pcb_destroy);
+	// Destroy queues, then the PCBs they pointed at
+	mpmc_queue_destroy(scheduler.new, NULL);
+	intrusive_queue_destroy(scheduler.ready);
+	mpmc_queue_destroy(scheduler.ready_sus, NULL);
+	intrusive_queue_destroy(scheduler.blocked);
+	intrusive_queue_destroy(scheduler.blocked_sus);
+	safe_queue_destroy(scheduler.io_requests, NULL);
+	pcb_registry_destroy(scheduler.pcbs, pcb_destroy);
 
 	// Destroy Thread Manager
 	thread_manager_destroy(&scheduler.tm);
 
+	// Destroy suspension trackers
+	for (uint32_t pid = 0; pid < PIDS; pid++)
+		cancel_tracking(&scheduler, pid);
+
+	timer_wheel_destroy(scheduler.timers);
+	safe_queue_destroy(scheduler.expired, free);
+	free(scheduler.suspensions);
+	free(scheduler.ready_since);
+
 	// Destroy semaphores
 	sem_destroy(scheduler.dom);
 	free(scheduler.dom);
 	sem_destroy(scheduler.req_admit);
 	free(scheduler.req_admit);
-	sem_destroy(scheduler.io_request);
-	free(scheduler.io_request);
-	sem_destroy(scheduler.execute);
-	free(scheduler.execute);
+	pthread_mutex_destroy(scheduler.taking);
+	free(scheduler.taking);
 }
 
 void *schedule(void *data)
@@ -14,11 +14,13 @@ void *get_next_fifo(void *scheduler)
 {
 	scheduler_t *s = (scheduler_t *)scheduler;
 
-	return safe_queue_pop(s->ready);
+	return intrusive_queue_pop_wait(s->ready);
 }
 
 void *get_next_srt(void *scheduler)
 {
-	safe_queue_sort(((scheduler_t *)scheduler)->ready, pcb_sort_by_estimation);
-	return get_next_fifo(scheduler);
+	scheduler_t *s = (scheduler_t *)scheduler;
+
+	// Chosen under the same lock it is popped, so a PCB arriving in between cannot jump the order
+	return intrusive_queue_pop_first(s->ready, pcb_sort_by_estimation);
 }
@@ -14,6 +14,8 @@
 #include "pcb_unit.h"
 #include "cpu_controller.h"
 #include "log.h"
+#include "trace.h"
+#include "metrics.h"
 #include "cfg.h"
 #include "mts.h"
 #include "swap_controller.h"
@@ -35,12 +37,19 @@ void *short_term_schedule(void *data)
 
 	for (;;)
 	{
-		WAIT(sched.execute);
 		pcb_t *pcb = NULL;
 		pcb = sched.get_next(&sched);
 
 		if (pcb)
+		{
+			metrics_gauge_add(METRIC_READY_QUEUE, -1);
+
+			if (pcb->id < PIDS)
+				metrics_record(METRIC_DISPATCH_LATENCY, metrics_now() - sched.ready_since[pcb->id]);
+
+			pcb_registry_set(sched.pcbs, pcb->id, PCB_QUEUE_NONE);
 			execute(kernel, pcb);
+		}
 	}
 
 	return NULL;
@@ -58,14 +67,13 @@ void execute(kernel_t *kernel, pcb_t *pcb)
 
 	// Send PCB to CPU so it can execute it
 	ssize_t bytes_sent = -1;
-	bytes_sent = cpu_controller_send_pcb(kernel->conexion_dispatch, PCB, pcb);
+	bytes_sent = cpu_controller_send_pcb(kernel->conexion_dispatch, pcb);
 
 	if (bytes_sent > 0)
 	{
+		trace_event(TRACE_PROCESS_DISPATCHED, pcb->id, pcb->estimation, 0);
 		LOG_INFO("[STS] :=> Sent PCB #%d for EXECUTION [%ld bytes]", pcb->id, bytes_sent);
 		LOG_WARNING("[STS] :=> PCB #%d estimated to use CPU for %dms", pcb->id, pcb->estimation);
-		pcb_destroy(pcb);
-		pcb = NULL;
 	}
 	else
 	{
@@ -77,12 +85,20 @@ void execute(kernel_t *kernel, pcb_t *pcb)
 
 	// WAIT for PCB to leave CPU - Include IO time
 	uint32_t io_time = 0;
-	pcb = (pcb_t *)cpu_controller_receive_pcb(kernel->conexion_dispatch, &io_time);
+
+	if (cpu_controller_receive_pcb(kernel->conexion_dispatch, pcb, &io_time) == NULL)
+	{
+		LOG_ERROR("[STS] :=> PCB #%d did not return from CPU - Terminated", pcb->id);
+		terminate(kernel, pcb);
+		return;
+	}
 
 	// Time real CPU usage
 	gettimeofday(&stop, NULL);
 	real_usage = time_diff_ms(start, stop);
 	pcb->real = real_usage;
+	trace_event(TRACE_PROCESS_RETURNED, pcb->id, pcb->real, pcb->status);
+	metrics_record(METRIC_CPU_BURST, pcb->real);
 	LOG_TRACE("[STS] :=> PCB #%d returned from CPU %dms", pcb->id, pcb->real);
 	kernel->scheduler.current_estimation = 0;
 
@@ -118,14 +134,17 @@ void execute(kernel_t *kernel, pcb_t *pcb)
 		terminate(kernel, pcb);
 		break;
 	}
-
-	SIGNAL(kernel->scheduler.execute);
 }
 
 void terminate(kernel_t *kernel, pcb_t *pcb)
 {
 	LOG_TRACE("[KERNEL] :=> PCB #%d(Table#%d) Requesting FREE memory...", pcb->id, pcb->page_table);
-	swap_controller_exit(pcb);
+	if (swap_controller_exit(pcb) EQ ERROR)
+	{
+		LOG_ERROR("[KERNEL] :=> Memory of PCB #%d could not be released", pcb->id);
+	}
+	trace_event(TRACE_PROCESS_EXITED, pcb->id, pcb->page_table, 0);
+	pcb_registry_remove(kernel->scheduler.pcbs, pcb->id);
 	pcb_destroy(pcb);
 	pcb = NULL;
 	SIGNAL(kernel->scheduler.dom);
@@ -135,18 +154,20 @@ void block(scheduler_t *scheduler, pcb_t *pcb, uint32_t io_time)
 {
 	pcb->io = io_time;
 	re_schedule(pcb);
-	safe_queue_push(scheduler->blocked, pcb);
+	trace_event(TRACE_PROCESS_BLOCKED, pcb->id, io_time, pcb->estimation);
+	pcb_registry_set(scheduler->pcbs, pcb->id, PCB_QUEUE_BLOCKED);
+	intrusive_queue_push(scheduler->blocked, pcb);
 	notify_mts(scheduler, pcb);
-	SIGNAL(scheduler->io_request);
+	safe_queue_push(scheduler->io_requests, pcb);
 }
 
 void event(scheduler_t *scheduler, pcb_t *pcb)
 {
 	LOG_TRACE("[STS] :=> PCB #%d has been unblocked", pcb->id);
 	pcb->status = PCB_READY;
-	safe_queue_push(scheduler->ready, pcb);
+	trace_event(TRACE_PROCESS_UNBLOCKED, pcb->id, 0, 0);
+	enqueue_ready(scheduler, pcb);
 	check_interruption(&g_kernel, pcb);
-	SIGNAL(scheduler->execute);
 }
 
 void pre_empt(scheduler_t *scheduler, pcb_t *pcb)
@@ -156,9 +177,21 @@ void pre_empt(scheduler_t *scheduler, pcb_t *pcb)
 	else
 		pcb->estimation = pcb->real - pcb->estimation;
 
-	safe_queue_push(scheduler->ready, pcb);
+	trace_event(TRACE_PROCESS_PREEMPTED, pcb->id, pcb->estimation, 0);
+	metrics_add(METRIC_PREEMPTIONS, 1);
+	enqueue_ready(scheduler, pcb);
 };
 
+void enqueue_ready(scheduler_t *scheduler, pcb_t *pcb)
+{
+	if (pcb->id < PIDS)
+		scheduler->ready_since[pcb->id] = metrics_now();
+
+	metrics_gauge_add(METRIC_READY_QUEUE, 1);
+	pcb_registry_set(scheduler->pcbs, pcb->id, PCB_QUEUE_READY);
+	intrusive_queue_push(scheduler->ready, pcb);
+}
+
 void re_schedule(pcb_t *pcb)
 {
 	double alpha = alfa();
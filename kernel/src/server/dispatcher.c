@@ -48,11 +48,11 @@ void *dispatch_handle_instruction(void *args, uint32_t *pid)
 	list_iterate(instructions, log_instruction);
 
 	LOG_WARNING("[Server] :=> Recovering a PCB with PID: <%d>", *pid);
-	pcb_t *pcb = get_pcb_by_pid(g_kernel.pcbs->_list, *pid);
+	pcb_t *pcb = pcb_registry_move(g_kernel.scheduler.pcbs, *pid, PCB_QUEUE_ADMISSION, PCB_QUEUE_NEW);
 
 	if (pcb == NULL)
 	{
-		LOG_ERROR("[Server] :=> PCB with PID: <%d> not found", *pid);
+		LOG_ERROR("[Server] :=> PCB with PID: <%d> not found waiting for its instructions", *pid);
 		return NULL;
 	}
 	else
@@ -62,7 +62,13 @@ void *dispatch_handle_instruction(void *args, uint32_t *pid)
 
 	pcb->instructions = instructions;
 
-	safe_queue_push(g_kernel.scheduler.new, pcb);
+	// Holds a PCB per PID: it is never full
+	if (!mpmc_queue_push(g_kernel.scheduler.new, pcb))
+	{
+		LOG_ERROR("[Server] :=> NEW queue is full, PCB <%d> dropped - THIS SHOULD NEVER HAPPEN", *pid);
+		return NULL;
+	}
+
 	LOG_DEBUG("[Server] :=> The PCB <%d> was moved to NEW queue", *pid);
 	SIGNAL(g_kernel.scheduler.req_admit);
 
@@ -88,7 +94,7 @@ void *dispatch_handle_syscall(void *args, uint32_t *pid)
 			LOG_DEBUG("[Server] :=> PID <%d> was assigned", *pid);
 			ssize_t process_size = accion->param;
 			pcb_t *new_process = new_pcb(*pid, process_size, estimacion_inicial());
-			safe_list_add(g_kernel.pcbs, new_process);
+			pcb_registry_add(g_kernel.scheduler.pcbs, new_process, PCB_QUEUE_ADMISSION);
 		}
 		else
 		{
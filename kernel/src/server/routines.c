@@ -7,6 +7,7 @@
 #include "log.h"
 #include "cfg.h"
 #include "pcb.h"
+#include "metrics.h"
 
 // ============================================================================================================
 //                                   ***** Definiciones y Estructuras  *****
@@ -43,69 +44,112 @@ static t_list *recibir_instructions(int fd)
 {
 	ssize_t size = ERROR;
 	void *stream = servidor_recibir_stream(fd, &size);
-	return instruction_list_from(stream);
+	wire_reader_t reader = wire_reader_create(stream, size);
+	t_list *instructions = instruction_list_decode(&reader);
+
+	if (reader.failed)
+		LOG_ERROR("[Server] :=> Client <%d> sent a malformed instruction list", fd);
+
+	servidor_liberar_stream(fd, stream);
+	return instructions;
+}
+
+/**
+ * @brief Responde la foto de las métricas, con las colas de bloqueados al día.
+ *
+ * @param fd the socket of the client
+ */
+static void enviar_metricas(int fd)
+{
+	// Only READY is counted on every move: the blocked ones are counted when asked
+	metrics_gauge_set(METRIC_BLOCKED_QUEUE, (int64_t)intrusive_queue_size(g_kernel.scheduler.blocked));
+	metrics_gauge_set(METRIC_SUSPENDED_QUEUE, (int64_t)intrusive_queue_size(g_kernel.scheduler.blocked_sus));
+
+	if (servidor_enviar_metricas(fd) <= 0)
+	{
+		LOG_ERROR("[Server] :=> Could not send the metrics to Client <%d>", fd);
+	}
 }
 
 // ============================================================================================================
 //                                   ***** Funciones Publicas  *****
 // ============================================================================================================
-// TAKES SENDER FD AS INPUT
-void *routine(void *fd)
+int handle_request(int sender_fd, void **session)
 {
-	int sender_fd = 0;
-	uint32_t sender_pid = 0;
+	// The PID of the console, assigned on its NEW_PROCESS syscall.
+	if (*session == NULL)
+		*session = calloc(1, sizeof(uint32_t));
 
-	memcpy((void *)&sender_fd, fd, sizeof(int));
-	free(fd);
+	uint32_t *sender_pid = *session;
 
-	for (;;)
-	{
-		int opcode = servidor_recibir_operacion(sender_fd);
+	int opcode = servidor_recibir_operacion(sender_fd);
 
-		if (opcode <= 0)
+	if (opcode <= 0)
+	{
+		if (opcode == DC)
 		{
-			if (opcode == DC)
-			{
-				// Connection closed
-				LOG_WARNING("[Server] :=> Client <%d> has ended connection", sender_fd);
-			}
-			else
-			{
-				LOG_ERROR("[Server] :=> Error while recieving a message from Client <%d>", sender_fd);
-				LOG_DEBUG("[Server] :=> Lost connection with Client <%d>", sender_fd);
-			}
-
-			servidor_desconectar_cliente(sender_fd); // Bye!
-
-			thread_manager_end_thread(&g_kernel.server.tm);
-
-			return NULL;
+			// Connection closed
+			LOG_WARNING("[Server] :=> Client <%d> has ended connection", sender_fd);
 		}
 		else
 		{
-			// We got some good server from a client
-			LOG_TRACE("[Server] :=> Client<%d> Requests <%s> operation.", sender_fd, opcode_to_string(opcode));
-
-			switch (opcode)
-			{
-			case MSG:
-				dispatch_imprimir_mensaje((void *)recibir_mensaje(sender_fd));
-				break;
-
-			case SYS:
-				dispatch_handle_syscall((void *)accion_recibir(sender_fd), &sender_pid);
-				break;
-
-			case CMD:
-				dispatch_handle_instruction((void *)recibir_instructions(sender_fd), &sender_pid);
-				break;
-
-			default:
-				LOG_ERROR("[Server] :=> Client<%d> sent an unrecognized operation code (%d)", sender_fd, opcode);
-				break;
-			}
+			LOG_ERROR("[Server] :=> Error while recieving a message from Client <%d>", sender_fd);
+			LOG_DEBUG("[Server] :=> Lost connection with Client <%d>", sender_fd);
 		}
+
+		return opcode;
 	}
 
+	// We got some good server from a client
+	LOG_TRACE("[Server] :=> Client<%d> Requests <%s> operation.", sender_fd, opcode_to_string(opcode));
+
+	switch (opcode)
+	{
+	case MSG:
+		dispatch_imprimir_mensaje((void *)recibir_mensaje(sender_fd));
+		break;
+
+	case SYS:
+		dispatch_handle_syscall((void *)accion_recibir(sender_fd), sender_pid);
+		break;
+
+	case CMD:
+		dispatch_handle_instruction((void *)recibir_instructions(sender_fd), sender_pid);
+		break;
+
+	// Answered by the connection layer
+	case SHM_LINK:
+		break;
+
+	case STATS:
+		enviar_metricas(sender_fd);
+		break;
+
+	default:
+		LOG_ERROR("[Server] :=> Client<%d> sent an unrecognized operation code (%d)", sender_fd, opcode);
+		break;
+	}
+
+	return opcode;
+}
+
+// TAKES SENDER FD AS INPUT
+void *routine(void *fd)
+{
+	int sender_fd = 0;
+	void *session = NULL;
+
+	memcpy((void *)&sender_fd, fd, sizeof(int));
+	free(fd);
+
+	while (handle_request(sender_fd, &session) > 0)
+		;
+
+	free(session);
+
+	servidor_desconectar_cliente(sender_fd); // Bye!
+
+	thread_manager_end_thread(&g_kernel.server.tm);
+
 	return NULL;
 }
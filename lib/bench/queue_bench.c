@@ -0,0 +1,162 @@
+/**
+ * @file queue_bench.c
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Compares safe_queue_t against mpmc_queue_t under scheduler-like contention
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ * Each scenario has producers and consumers hammering one queue, the way the dispatcher, the IO scheduler
+ * and the MTS push PCBs that the LTS and STS pop. Consumers retry an empty pop after yielding the CPU, where a
+ * scheduler would sleep on its semaphore: the worst case for both queues. Both hold at most CAPACITY elements,
+ * the bound of the mpmc ring: producers wait for room in either, so neither one runs ahead of its consumers.
+ * Run it with `make bench`.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <stdatomic.h>
+
+#include "safe_queue.h"
+#include "mpmc_queue.h"
+
+// Elements each producer pushes.
+#define OPERATIONS 500000
+
+// The most elements a queue holds at once, for both of them.
+#define CAPACITY 1024
+
+/**
+ * @brief A queue under test, behind the push/pop API both share.
+ *
+ */
+typedef struct BenchQueue
+{
+	const char *name;
+	void *(*create)(void);
+	void (*destroy)(void *);
+	int (*push)(void *, void *);
+	void *(*pop)(void *);
+} bench_queue_t;
+
+/**
+ * @brief A run: a queue, how many threads push and pop it, and how many pops are left.
+ *
+ */
+typedef struct BenchRun
+{
+	const bench_queue_t *queue;
+	void *instance;
+	_Atomic long remaining;
+	// Elements pushed or about to be, and not popped yet.
+	_Atomic long queued;
+} bench_run_t;
+
+static void *safe_create(void) { return new_safe_queue(); }
+static void safe_destroy(void *queue) { safe_queue_destroy(queue, NULL); }
+static int safe_push(void *queue, void *element) { return safe_queue_push(queue, element), 1; }
+static void *safe_pop(void *queue) { return safe_queue_pop(queue); }
+
+static void *mpmc_create(void) { return new_mpmc_queue(CAPACITY); }
+static void mpmc_destroy(void *queue) { mpmc_queue_destroy(queue, NULL); }
+static int mpmc_push(void *queue, void *element) { return mpmc_queue_push(queue, element); }
+static void *mpmc_pop(void *queue) { return mpmc_queue_pop(queue); }
+
+static const bench_queue_t queues[] = {
+	{"safe_queue (mutex)", safe_create, safe_destroy, safe_push, safe_pop},
+	{"mpmc_queue (lock-free)", mpmc_create, mpmc_destroy, mpmc_push, mpmc_pop},
+};
+
+static void *producer(void *data)
+{
+	bench_run_t *run = data;
+
+	for (uintptr_t i = 1; i <= OPERATIONS; i++)
+	{
+		// A slot is taken before pushing: the unbounded queue is held to the same CAPACITY
+		long queued = run->queued;
+
+		while (queued >= CAPACITY || !atomic_compare_exchange_weak(&run->queued, &queued, queued + 1))
+			if (queued >= CAPACITY)
+			{
+				sched_yield();
+				queued = run->queued;
+			}
+
+		while (!run->queue->push(run->instance, (void *)i))
+			sched_yield();
+	}
+
+	return NULL;
+}
+
+static void *consumer(void *data)
+{
+	bench_run_t *run = data;
+
+	while (run->remaining > 0)
+		if (run->queue->pop(run->instance))
+		{
+			run->queued--;
+			run->remaining--;
+		}
+		else
+			sched_yield();
+
+	return NULL;
+}
+
+static double seconds(struct timespec since)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - since.tv_sec) + (now.tv_nsec - since.tv_nsec) / 1e9;
+}
+
+/**
+ * @brief Runs a scenario on a queue.
+ *
+ * @return nanoseconds per element, pushed and popped
+ */
+static double bench(const bench_queue_t *queue, int producers, int consumers)
+{
+	bench_run_t run = {.queue = queue, .instance = queue->create(), .remaining = (long)producers * OPERATIONS};
+	pthread_t threads[producers + consumers];
+
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	for (int i = 0; i < producers + consumers; i++)
+		pthread_create(&threads[i], NULL, i < producers ? producer : consumer, &run);
+
+	for (int i = 0; i < producers + consumers; i++)
+		pthread_join(threads[i], NULL);
+
+	double elapsed = seconds(start);
+	queue->destroy(run.instance);
+
+	return elapsed * 1e9 / ((double)producers * OPERATIONS);
+}
+
+int main(void)
+{
+	// dispatcher -> LTS, then dispatcher + IO + MTS -> LTS + STS, then twice as many
+	int scenarios[][2] = {{1, 1}, {3, 2}, {6, 4}};
+
+	printf("%-24s %12s %12s\n", "queue", "prod/cons", "ns/element");
+
+	for (size_t s = 0; s < sizeof(scenarios) / sizeof(scenarios[0]); s++)
+		for (size_t q = 0; q < sizeof(queues) / sizeof(queues[0]); q++)
+		{
+			char threads[16];
+			sprintf(threads, "%d/%d", scenarios[s][0], scenarios[s][1]);
+			printf("%-24s %12s %12.1f\n", queues[q].name, threads, bench(&queues[q], scenarios[s][0], scenarios[s][1]));
+		}
+
+	return EXIT_SUCCESS;
+}
@@ -119,6 +119,27 @@ reemplazo_tlb(void);
 
 int entradas_tlb(void);
 
+/**
+ * Lee cuántas instrucciones READ/WRITE consecutivas se envían a memoria en un mismo lote.
+ *
+ * @return los accesos por lote, 1 (default) para un acceso por instrucción
+ */
+int accesos_por_lote(void);
+
+/**
+ * Lee cuántos pedidos asincrónicos a memoria pueden estar en vuelo a la vez.
+ *
+ * @return los pedidos en vuelo, 0 (default) para no usar una conexión asincrónica
+ */
+int pedidos_en_vuelo(void);
+
+/**
+ * Lee cuántos programas (listas de instrucciones) guarda la CPU para no recibirlos en cada despacho.
+ *
+ * @return los programas en caché, 8 (default); 0 para recibir siempre el PCB completo
+ */
+int programas_en_cache(void);
+
 // -----------------------------------------------------------
 //  Memoria
 // -----------------------------------------------------------
@@ -138,3 +159,85 @@ int marcos_por_proceso(void);
 int retardo_swap(void);
 
 char *path_swap(void);
+
+// -----------------------------------------------------------
+//  Servidor
+// -----------------------------------------------------------
+
+/**
+ * Lee la cantidad de hilos reactor del servidor (epoll).
+ *
+ * @return los hilos reactor, 0 (default) para un hilo por cliente
+ */
+int reactores(void);
+
+/**
+ * Lee la cantidad de hilos aceptadores del servidor sin reactores, cada uno con su socket de escucha.
+ *
+ * @return los hilos aceptadores, 1 (default) para aceptar desde un único hilo
+ */
+int aceptadores(void);
+
+/**
+ * Lee la cantidad de hilos reutilizables de cada servidor y planificador, que atienden a los clientes y tareas en
+ * lugar de crear un hilo para cada uno.
+ *
+ * @return los hilos, 0 (default) para crear un hilo por cliente o tarea
+ */
+int hilos_trabajadores(void);
+
+/**
+ * Lee el transporte de las conexiones con los demás módulos.
+ *
+ * @return "TCP" (default), o "SHM" para usar memoria compartida si ambos extremos están en el mismo host
+ */
+char *transporte(void);
+
+/**
+ * Lee si las conexiones TCP envían cada frame apenas se escribe (TCP_NODELAY).
+ *
+ * @return 1 (default) sin Nagle, 0 con Nagle
+ */
+int sin_demora(void);
+
+/**
+ * Lee si las conexiones TCP retienen los frames hasta terminar cada tanda (TCP_CORK).
+ *
+ * @return 1 para agrupar, 0 (default) para no hacerlo
+ */
+int agrupar_envios(void);
+
+/**
+ * Lee el tamaño del buffer de envío de los sockets (SO_SNDBUF).
+ *
+ * @return los bytes, 0 (default) para el del sistema
+ */
+int buffer_envio(void);
+
+/**
+ * Lee el tamaño del buffer de recepción de los sockets (SO_RCVBUF).
+ *
+ * @return los bytes, 0 (default) para el del sistema
+ */
+int buffer_recepcion(void);
+
+/**
+ * Lee el nivel mínimo de los logs del módulo; los menores que el SSKI_LOG_MAX de compilación no existen.
+ *
+ * @return "TRACE" (default), "DEBUG", "INFO", "WARNING" o "ERROR"
+ */
+char *nivel_log(void);
+
+/**
+ * Lee si se graban los eventos de planificación y memoria en archivos binarios (ver trace.h).
+ *
+ * @return 1 para grabarlos, 0 (default) para no hacerlo
+ */
+int traza(void);
+
+/**
+ * Lee cuántos eventos guarda cada hilo antes de pisar los más viejos.
+ *
+ * @return los eventos, 16384 (default) por hilo
+ */
+int traza_registros(void);
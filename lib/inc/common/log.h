@@ -9,6 +9,27 @@
 #include "lib.h"
 #include <commons/log.h>
 
+// ============================================================================================================
+//                               ***** Nivel Máximo de Compilación *****
+// ============================================================================================================
+
+/**
+ * El nivel más bajo que se compila, un t_log_level (-DSSKI_LOG_MAX=LOG_LEVEL_INFO, o `make SSKI_LOG_MAX=INFO`):
+ * los logs de niveles menores quedan detrás de un if constante en falso, y el compilador los descarta por
+ * completo, mensajes incluidos. Por defecto se compilan todos.
+ */
+#ifndef SSKI_LOG_MAX
+#define SSKI_LOG_MAX LOG_LEVEL_TRACE
+#endif
+
+/**
+ * Si un mensaje del nivel se loggearía: se compila (una constante, así el if desaparece cuando no) y el nivel
+ * de la configuración lo deja pasar. Sirve para no armar lo que sólo se quiere para loggear (tablas, dumps).
+ *
+ * @param level TRACE, DEBUG, INFO, WARNING o ERROR
+ */
+#define LOG_ENABLED(level) (LOG_LEVEL_##level >= SSKI_LOG_MAX && logger_enabled(LOG_LEVEL_##level))
+
 // ============================================================================================================
 //                               ***** Funciones Públicas, Declaraciones *****
 // ============================================================================================================
@@ -32,14 +53,22 @@ int log_init(char *app_name, bool consola);
 void log_close(void);
 
 /**
- * @brief Garantiza mutua exclusión del logger. (WAIT)
+ * @brief Encola un mensaje en el buffer del hilo que loggea, sin locks ni I/O: un hilo aparte lo escribe
+ * después, junto con los demás. Si el buffer está lleno el mensaje se descarta (y se avisa cuántos), salvo
+ * los [ERROR], que esperan a que haya lugar.
+ *
+ * @param level el nivel del mensaje
+ * @param format el formatting, como printf
  */
-void logger_lock();
+void logger_write(t_log_level level, const char *format, ...) __attribute__((format(printf, 2, 3)));
 
 /**
- * @brief Libera el logger de un lock. (SIGNAL)
+ * Cambia el nivel mínimo que se loggea, por ejemplo con el NIVEL_LOG de la configuración. No puede bajar del
+ * SSKI_LOG_MAX con que se compiló: esos logs ya no existen.
+ *
+ * @param level el nivel mínimo
  */
-void logger_unlock();
+void logger_set_level(t_log_level level);
 
 // -----------------------------------------------------------
 //  Getter
@@ -52,6 +81,14 @@ void logger_unlock();
  */
 t_log *logger(void);
 
+/**
+ * Si hay logger y su nivel deja pasar los mensajes de un nivel.
+ *
+ * @param level el nivel del mensaje
+ * @return true si se loggearía
+ */
+bool logger_enabled(t_log_level level);
+
 // -----------------------------------------------------------
 //  Loggins
 // ------------------------------------------------------------
@@ -62,12 +99,10 @@ t_log *logger(void);
  * @param info el mensaje de información a loggear
  * @param __VA_ARGS__ el formatting del logging.
  */
-#define LOG_INFO(...)                    \
-	if (logger())                        \
-	{                                    \
-		logger_lock();                   \
-		log_info(logger(), __VA_ARGS__); \
-		logger_unlock();                 \
+#define LOG_INFO(...)                              \
+	if (LOG_ENABLED(INFO))                         \
+	{                                              \
+		logger_write(LOG_LEVEL_INFO, __VA_ARGS__); \
 	}
 
 /**
@@ -76,12 +111,10 @@ t_log *logger(void);
  * @param error el mensaje de error a loggear
  * @param __VA_ARGS__ el formatting del logging.
  */
-#define LOG_ERROR(...)                    \
-	if (logger())                         \
-	{                                     \
-		logger_lock();                    \
-		log_error(logger(), __VA_ARGS__); \
-		logger_unlock();                  \
+#define LOG_ERROR(...)                              \
+	if (LOG_ENABLED(ERROR))                         \
+	{                                               \
+		logger_write(LOG_LEVEL_ERROR, __VA_ARGS__); \
 	}
 /**
  * Loggea. si puede, un mensaje con nivel [DEBUG]
@@ -89,12 +122,10 @@ t_log *logger(void);
  * @param debug el mensaje de debugging a loggear
  * @param __VA_ARGS__ el formatting del logging.
  */
-#define LOG_DEBUG(...)                    \
-	if (logger())                         \
-	{                                     \
-		logger_lock();                    \
-		log_debug(logger(), __VA_ARGS__); \
-		logger_unlock();                  \
+#define LOG_DEBUG(...)                              \
+	if (LOG_ENABLED(DEBUG))                         \
+	{                                               \
+		logger_write(LOG_LEVEL_DEBUG, __VA_ARGS__); \
 	}
 
 /**
@@ -103,12 +134,10 @@ t_log *logger(void);
  * @param warning el mensaje de advertencia a loggear
  * @param __VA_ARGS__ el formatting del logging.
  */
-#define LOG_WARNING(...)                    \
-	if (logger())                           \
-	{                                       \
-		logger_lock();                      \
-		log_warning(logger(), __VA_ARGS__); \
-		logger_unlock();                    \
+#define LOG_WARNING(...)                              \
+	if (LOG_ENABLED(WARNING))                         \
+	{                                                 \
+		logger_write(LOG_LEVEL_WARNING, __VA_ARGS__); \
 	}
 /**
  * Loggea. si puede, un mensaje con nivel [TRACE]
@@ -116,10 +145,8 @@ t_log *logger(void);
  * @param trace el mensaje de tracing a loggear
  * @param __VA_ARGS__ el formatting del logging.
  */
-#define LOG_TRACE(...)                    \
-	if (logger())                         \
-	{                                     \
-		logger_lock();                    \
-		log_trace(logger(), __VA_ARGS__); \
-		logger_unlock();                  \
+#define LOG_TRACE(...)                              \
+	if (LOG_ENABLED(TRACE))                         \
+	{                                               \
+		logger_write(LOG_LEVEL_TRACE, __VA_ARGS__); \
 	}
@@ -0,0 +1,233 @@
+/**
+ * @file metrics.h
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Metrics of every module: counters, gauges and latency histograms, written without locks.
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#pragma once
+
+// ============================================================================================================
+//                               		***** Includes *****
+// ============================================================================================================
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// ============================================================================================================
+//                               		***** Definitions *****
+// ============================================================================================================
+
+// Values below it get a bucket each; above, there are 16 buckets per power of two (~6% error).
+#define HISTOGRAM_EXACT 32
+// Buckets of a histogram: enough for any 64 bits value.
+#define HISTOGRAM_BUCKETS ((64 - 5) * (HISTOGRAM_EXACT / 2) + HISTOGRAM_EXACT)
+// Extension of the snapshot files, next to the logs.
+#define METRICS_EXTENSION ".metrics"
+
+/**
+ * @brief How a metric adds up.
+ *
+ */
+typedef enum MetricKind
+{
+	// Only grows: a sum of what every thread added.
+	METRIC_COUNTER,
+	// Goes up and down: the last value.
+	METRIC_GAUGE,
+	// A distribution of values: count, mean, percentiles and max.
+	METRIC_HISTOGRAM,
+	// A counter, also broken down by process.
+	METRIC_PROCESS_COUNTER,
+	// A gauge, the sum of one per process.
+	METRIC_PROCESS_GAUGE,
+} metric_kind_t;
+
+/**
+ * @brief Every metric, named <module>.<what>; each module only reports its own.
+ *
+ */
+typedef enum Metric
+{
+	// Kernel
+	METRIC_READY_QUEUE,
+	METRIC_BLOCKED_QUEUE,
+	METRIC_SUSPENDED_QUEUE,
+	METRIC_DISPATCH_LATENCY,
+	METRIC_CPU_BURST,
+	METRIC_PREEMPTIONS,
+	METRIC_SUSPENSIONS,
+	// CPU
+	METRIC_INSTRUCTIONS,
+	METRIC_TLB_HITS,
+	METRIC_TLB_MISSES,
+	METRIC_TLB_REPLACEMENTS,
+	METRIC_MEMORY_REQUEST_LATENCY,
+	// Memory
+	METRIC_MEMORY_READS,
+	METRIC_MEMORY_WRITES,
+	METRIC_FRAMES_IN_USE,
+	METRIC_PROCESS_FRAMES,
+	METRIC_PAGE_FAULTS,
+	METRIC_FRAME_REPLACEMENTS,
+	METRIC_SWAP_OUT_BYTES,
+	METRIC_SWAP_IN_BYTES,
+	METRIC_SWAP_LATENCY,
+	// The amount of metrics, not a metric.
+	METRICS,
+} metric_t;
+
+// ============================================================================================================
+//                               		***** Functions Declarations *****
+// ============================================================================================================
+
+/**
+ * @brief Prepares the snapshots of a module: metrics_request_dump writes one from a thread of its own (for
+ * signal handlers), and another one is written at exit. Metrics are recorded with or without it.
+ *
+ * @param app_name the module name, as in log_init
+ * @return SUCCESS or ERROR
+ */
+int metrics_init(char *app_name);
+
+/**
+ * @brief Asks for a snapshot, to be written as soon as possible. Async signal safe, for SIGUSR1.
+ *
+ */
+void metrics_request_dump(void);
+
+/**
+ * @brief Writes a snapshot in <app>.metrics, in the logs folder, replacing the previous one.
+ *
+ */
+void metrics_dump(void);
+
+/**
+ * @brief The current time for latencies, from a monotonic clock.
+ *
+ * @return microseconds
+ */
+uint64_t metrics_now(void);
+
+// -----------------------------------------------------------
+//  Recording
+// ------------------------------------------------------------
+
+/**
+ * @brief Adds to a counter, in the shard of the calling thread: no locks, no atomic read-modify-writes.
+ *
+ * @param metric a counter
+ * @param amount how much
+ */
+void metrics_add(metric_t metric, uint64_t amount);
+
+/**
+ * @brief Adds to a per-process counter, both to its total and to the process.
+ *
+ * @param metric a per-process counter
+ * @param pid the process
+ * @param amount how much
+ */
+void metrics_add_process(metric_t metric, uint32_t pid, uint64_t amount);
+
+/**
+ * @brief Moves a gauge.
+ *
+ * @param metric a gauge
+ * @param delta how much, negative to go down
+ */
+void metrics_gauge_add(metric_t metric, int64_t delta);
+
+/**
+ * @brief Sets a gauge.
+ *
+ * @param metric a gauge
+ * @param value the new value
+ */
+void metrics_gauge_set(metric_t metric, int64_t value);
+
+/**
+ * @brief Moves the gauge of a process, and so their sum.
+ *
+ * @param metric a per-process gauge
+ * @param pid the process
+ * @param delta how much, negative to go down
+ */
+void metrics_gauge_add_process(metric_t metric, uint32_t pid, int64_t delta);
+
+/**
+ * @brief Sets the gauge of a process, 0 once it ends.
+ *
+ * @param metric a per-process gauge
+ * @param pid the process
+ * @param value the new value
+ */
+void metrics_gauge_set_process(metric_t metric, uint32_t pid, int64_t value);
+
+/**
+ * @brief Records a value in a histogram, in the shard of the calling thread.
+ *
+ * @param metric a histogram
+ * @param value the value, in the unit of the histogram
+ */
+void metrics_record(metric_t metric, uint64_t value);
+
+// -----------------------------------------------------------
+//  Reading
+// ------------------------------------------------------------
+
+/**
+ * @brief Adds up a counter, or the values recorded in a histogram, across threads.
+ *
+ * @param metric a counter or histogram
+ * @return its total
+ */
+uint64_t metrics_count(metric_t metric);
+
+/**
+ * @brief The count of a per-process counter, or the value of a per-process gauge, for one process.
+ *
+ * @param metric a per-process counter or gauge
+ * @param pid the process
+ * @return its count or value
+ */
+uint64_t metrics_process_count(metric_t metric, uint32_t pid);
+
+/**
+ * @brief The current value of a gauge.
+ *
+ * @param metric a gauge, or per-process gauge for their sum
+ * @return its value
+ */
+int64_t metrics_gauge(metric_t metric);
+
+/**
+ * @brief A percentile of a histogram, within the precision of its buckets.
+ *
+ * @param metric a histogram
+ * @param quantile between 0 and 1, 0.99 for the p99
+ * @return the value, 0 if nothing was recorded
+ */
+uint64_t metrics_percentile(metric_t metric, double quantile);
+
+/**
+ * @brief The name of a metric, with its unit if it has one.
+ *
+ * @param metric the metric
+ * @return its name
+ */
+const char *metrics_name(metric_t metric);
+
+/**
+ * @brief Writes the metrics of the module as text, one per line.
+ *
+ * @param buffer where to write
+ * @param size the size of the buffer
+ * @return the length of the snapshot, which may be larger than the buffer, as snprintf
+ */
+size_t metrics_format(char *buffer, size_t size);
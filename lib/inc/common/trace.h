@@ -0,0 +1,191 @@
+/**
+ * @file trace.h
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Binary event recorder: fixed-size records in a memory mapped ring file per thread.
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#pragma once
+
+// ============================================================================================================
+//                               		***** Includes *****
+// ============================================================================================================
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// ============================================================================================================
+//                               		***** Definitions *****
+// ============================================================================================================
+
+// First bytes of every trace file.
+#define TRACE_MAGIC "SSKITRC"
+// Bumped whenever the layout of the header or the records changes.
+#define TRACE_VERSION 1
+// Records a thread keeps by default before overwriting the oldest ones.
+#define TRACE_DEFAULT_RECORDS 16384
+// Extension of the trace files, next to the logs.
+#define TRACE_EXTENSION ".trace"
+
+/**
+ * @brief The module that recorded an event.
+ *
+ */
+typedef enum TraceModule
+{
+	TRACE_MODULE_UNKNOWN,
+	TRACE_MODULE_KERNEL,
+	TRACE_MODULE_CPU,
+	TRACE_MODULE_MEMORY,
+	TRACE_MODULE_CONSOLE,
+} trace_module_t;
+
+/**
+ * @brief What happened. The meaning of the two arguments of each one is next to it.
+ *
+ */
+typedef enum TraceEvent
+{
+	// LTS: NEW or SUSPENDED READY -> READY (page table, 1 if it was suspended)
+	TRACE_PROCESS_ADMITTED,
+	// STS: READY -> EXEC (estimation in ms, -)
+	TRACE_PROCESS_DISPATCHED,
+	// STS: back from the CPU (real usage in ms, status)
+	TRACE_PROCESS_RETURNED,
+	// STS: EXEC -> READY (remaining estimation in ms, -)
+	TRACE_PROCESS_PREEMPTED,
+	// STS: EXEC -> BLOCKED (IO time in ms, next estimation in ms)
+	TRACE_PROCESS_BLOCKED,
+	// STS: BLOCKED -> READY (-, -)
+	TRACE_PROCESS_UNBLOCKED,
+	// STS: EXEC -> EXIT (page table, -)
+	TRACE_PROCESS_EXITED,
+	// MTS: BLOCKED -> SUSPENDED BLOCKED (max blocked time in ms, -)
+	TRACE_PROCESS_SUSPENDED,
+	// MTS: SUSPENDED BLOCKED -> SUSPENDED READY (-, -)
+	TRACE_PROCESS_SUSPENDED_READY,
+	// IO: the burst starts (IO time in ms, 1 if suspended)
+	TRACE_IO_STARTED,
+	// IO: the burst ends (-, -)
+	TRACE_IO_FINISHED,
+	// CPU: translation found in the TLB (page, frame)
+	TRACE_TLB_HIT,
+	// CPU: translation not in the TLB (page, -)
+	TRACE_TLB_MISS,
+	// CPU: a TLB entry is overwritten (old page, new page)
+	TRACE_TLB_REPLACED,
+	// Memory: a page is not present (second level table, index)
+	TRACE_PAGE_FAULT,
+	// Memory: a frame is swapped out for another one (replaced frame, new frame)
+	TRACE_FRAME_REPLACED,
+	// Memory: a swapped page comes back (frame, second level table)
+	TRACE_PAGE_UNSWAPPED,
+	// The amount of events, not an event.
+	TRACE_EVENTS,
+} trace_event_t;
+
+/**
+ * @brief An event: 32 bytes, with no pointers, so that files are read as they are.
+ *
+ */
+typedef struct TraceRecord
+{
+	// CLOCK_MONOTONIC in nanoseconds: the same clock for every process in the host.
+	uint64_t timestamp;
+	// A trace_module_t.
+	uint16_t module;
+	// A trace_event_t.
+	uint16_t event;
+	// The process (PCB) it is about, UINT32_MAX if none.
+	uint32_t pid;
+	// Whatever the event says.
+	uint64_t args[2];
+} trace_record_t;
+
+/**
+ * @brief The beginning of a trace file, followed by `capacity` records.
+ *
+ */
+typedef struct TraceHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t record_size;
+	uint64_t capacity;
+	// The OS process and thread that wrote it.
+	uint32_t process;
+	uint32_t thread;
+	// Records written since the file was created: the last `capacity` ones are in the ring, record N
+	// at N % capacity. Published after the record itself.
+	uint64_t written;
+	// Padding to 64 bytes, so that records stay aligned.
+	uint8_t reserved[24];
+} trace_header_t;
+
+// ============================================================================================================
+//                               		***** Functions Declarations *****
+// ============================================================================================================
+
+/**
+ * @brief Starts recording if TRAZA is set in the module configuration; call it after config_init. Each
+ * thread gets its file on its first event, as <app>.<tid>.trace in the logs folder.
+ *
+ * @param app_name the module name, as in log_init
+ * @return SUCCESS, also when tracing is off, or ERROR
+ */
+int trace_init(char *app_name);
+
+/**
+ * @brief Starts recording in a folder, no matter the configuration.
+ *
+ * @param folder where the files go, ending with '/'
+ * @param app_name the module name
+ * @param records how many records each thread keeps
+ * @return SUCCESS or ERROR
+ */
+int trace_start(const char *folder, const char *app_name, uint32_t records);
+
+/**
+ * @brief Stops recording and unmaps the file of the calling thread; the others are unmapped as their
+ * threads end, or with the process.
+ *
+ */
+void trace_close(void);
+
+/**
+ * @brief Tells whether events are being recorded.
+ *
+ * @return true if they are
+ */
+bool trace_active(void);
+
+/**
+ * @brief Records an event in the ring of the calling thread: no locks and no syscalls, but the first one.
+ * Does nothing if tracing is off.
+ *
+ * @param event what happened
+ * @param pid the process it is about, UINT32_MAX if none
+ * @param arg0 first argument of the event
+ * @param arg1 second argument of the event
+ */
+void trace_event(trace_event_t event, uint32_t pid, uint64_t arg0, uint64_t arg1);
+
+/**
+ * @brief The name of an event, as the decoder shows it.
+ *
+ * @param event the event
+ * @return its name, "UNKNOWN" if out of range
+ */
+const char *trace_event_name(uint16_t event);
+
+/**
+ * @brief The name of a module.
+ *
+ * @param module the module
+ * @return its name, "unknown" if out of range
+ */
+const char *trace_module_name(uint16_t module);
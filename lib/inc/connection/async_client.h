@@ -0,0 +1,152 @@
+/**
+ * @file async_client.h
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Pipelined request/response client
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sys/uio.h>
+
+#include "conexion.h"
+
+// ============================================================================================================
+//                                   ***** Public Types  *****
+// ============================================================================================================
+
+/**
+ * @brief Called from the client reader thread once a reply arrives.
+ *
+ * @param reply the reply payload, released after the call; NULL if the connection was lost
+ * @param size the payload size or ERROR
+ * @param data the data given on submit
+ */
+typedef void (*async_callback_t)(void *reply, ssize_t size, void *data);
+
+/**
+ * @brief A request in flight: a future to wait on, unless it was submitted with a callback.
+ *
+ * @class
+ */
+typedef struct AsyncRequest
+{
+	// @private The id echoed by the server.
+	uint32_t id;
+	// @private Whether the reply arrived (or the connection was lost).
+	bool done;
+	// @private The reply payload.
+	void *reply;
+	// @private The reply size or ERROR.
+	ssize_t size;
+	// @private The completion callback, if any.
+	async_callback_t callback;
+	// @private The callback data.
+	void *data;
+} async_request_t;
+
+/**
+ * @brief A client that keeps up to a window of requests in flight over one connection.
+ *
+ * Every frame carries a request id in its header, and the server must echo it in the reply header
+ * (see servidor_id_recibido). Replies are matched by id, so they may come back in any order.
+ * The connection must be dedicated: the client reader thread is the only one receiving from it.
+ *
+ * @class
+ */
+typedef struct AsyncClient
+{
+	// @private The connection.
+	conexion_t conexion;
+	// @private The thread receiving replies.
+	pthread_t reader;
+	// @private Guards the requests in flight.
+	pthread_mutex_t mutex;
+	// @private Guards the socket writes.
+	pthread_mutex_t sending;
+	// @private Signaled whenever a request is done.
+	pthread_cond_t completed;
+	// @private The free slots of the window.
+	sem_t window;
+	// @private The requests in flight (window slots).
+	async_request_t **in_flight;
+	// @private The window size.
+	int capacity;
+	// @private The next request id.
+	uint32_t next_id;
+	// @private Whether the connection is still alive.
+	bool running;
+} async_client_t;
+
+// ============================================================================================================
+//                                   ***** Public Functions  *****
+// ============================================================================================================
+
+/**
+ * @brief Creates a client over a connected socket and starts receiving its replies.
+ *
+ * @param conexion a connection, dedicated to this client
+ * @param window the most requests in flight; submitting blocks while it is full
+ * @return the client
+ */
+async_client_t *async_client_create(conexion_t conexion, int window);
+
+/**
+ * @brief Sends a request without waiting for its reply.
+ *
+ * @param client the client
+ * @param opcode the operation
+ * @param segments the payload
+ * @param count the amount of segments
+ * @param callback called with the reply, or NULL to wait on the returned future
+ * @param data passed to the callback
+ * @return the future to wait on; NULL if a callback was given or the request could not be sent
+ */
+async_request_t *async_client_submit(async_client_t *client, opcode_t opcode, const struct iovec *segments, int count, async_callback_t callback, void *data);
+
+/**
+ * @brief Sends a request whose reply goes to a callback, telling whether it could be sent.
+ *
+ * @param client the client
+ * @param opcode the operation
+ * @param segments the payload
+ * @param count the amount of segments
+ * @param callback called with the reply, or with NULL if the connection is lost first
+ * @param data passed to the callback
+ * @return SUCCESS, or ERROR if it could not be sent (the callback may still be called with NULL)
+ */
+int async_client_post(async_client_t *client, opcode_t opcode, const struct iovec *segments, int count, async_callback_t callback, void *data);
+
+/**
+ * @brief Waits for the reply of a request and deallocates it.
+ *
+ * @param client the client
+ * @param request the future returned on submit
+ * @param size where to store the reply size or ERROR
+ * @return the reply payload, to release with async_client_release, or NULL if the connection was lost
+ */
+void *async_request_wait(async_client_t *client, async_request_t *request, ssize_t *size);
+
+/**
+ * @brief Releases a reply returned by async_request_wait.
+ *
+ * @param client the client it came from
+ * @param reply the reply payload or NULL
+ */
+void async_client_release(async_client_t *client, void *reply);
+
+/**
+ * @brief Stops the client; requests still in flight fail. Does not close the connection.
+ * Nothing must be waiting on a request.
+ *
+ * @param client the client
+ */
+void async_client_destroy(async_client_t *client);
@@ -14,7 +14,9 @@
 #include <string.h>
 #include <unistd.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include "opcode.h"
+#include "wire.h"
 
 // ============================================================================================================
 //                               ***** Tipos (y estructuras) *****
@@ -46,6 +48,7 @@ typedef struct Connection
 
 /**
  * Crea una socket para un CLIENTE. Debe ser destruido.
+ * Si el IP o el PUERTO es una ruta unix:// el socket es local (AF_UNIX, SOCK_SEQPACKET).
  *
  * @param ip el número de IP a conectarse
  * @param puerto el número de puerto a conectarse
@@ -55,6 +58,7 @@ conexion_t conexion_cliente_create(char *ip, char *puerto);
 
 /**
  * Crea una socket para un SERVER. Debe ser destruida
+ * Si el IP o el PUERTO es una ruta unix:// el socket es local (AF_UNIX, SOCK_SEQPACKET).
  *
  * @param ip el número de IP a conectarse
  * @param puerto el número de puerto a conectarse
@@ -89,6 +93,16 @@ int conexion_conectar(conexion_t *);
  */
 int conexion_escuchar(conexion_t *);
 
+/**
+ * Abre otro socket de escucha en la misma dirección que un SERVER ya escuchando (SO_REUSEPORT),
+ * no bloqueante: el kernel reparte las conexiones nuevas entre todos ellos.
+ * Recién entonces se habilita SO_REUSEPORT, también en el socket original.
+ *
+ * @param conexion la referencia a la estructura de conexion, ya escuchando
+ * @returns el nuevo socket de escucha, o ERROR si la dirección no lo admite (un socket unix)
+ */
+int conexion_escuchar_otra(const conexion_t *);
+
 /**
  * Realiza la desconexion propiamente dicha de un CLIENTE.
  *
@@ -157,8 +171,70 @@ ssize_t enviar_stream(opcode_t opcode, void *stream, size_t stream_size, int soc
  */
 ssize_t conexion_enviar_stream(conexion_t is_conexion, opcode_t opcode, void *stream, size_t size);
 
+/**
+ * @brief Envía un stream fragmentado al socket en una única llamada (sendmsg).
+ *
+ * El frame enviado es idéntico al de enviar_stream: [HEADER][SEGMENTOS...] (ver wire.h)
+ * pero sin serializar en un buffer intermedio.
+ *
+ * @param opcode    el codigo de operacion
+ * @param segments  los segmentos del payload, en orden
+ * @param count     la cantidad de segmentos
+ * @param socket    el socket a enviarlo
+ * @return los bytes enviados o ERROR.
+ */
+ssize_t enviar_stream_vector(opcode_t opcode, const struct iovec *segments, int count, int socket);
+
+/**
+ * @brief Envía un stream fragmentado al socket, con un id de pedido en el header.
+ *
+ * @param opcode    el codigo de operacion
+ * @param id        el id del pedido, que un servidor pipelined devuelve en su respuesta
+ * @param segments  los segmentos del payload, en orden
+ * @param count     la cantidad de segmentos
+ * @param socket    el socket a enviarlo
+ * @return los bytes enviados o ERROR.
+ */
+ssize_t enviar_frame(opcode_t opcode, uint32_t id, const struct iovec *segments, int count, int socket);
+
+/**
+ * @brief Envía un stream fragmentado a la conexión.
+ *
+ * @param conexion la conexión a la cual enviar
+ * @param opcode el código de operación
+ * @param segments los segmentos del payload, en orden
+ * @param count la cantidad de segmentos
+ * @return los bytes enviados o ERROR.
+ */
+ssize_t conexion_enviar_stream_vector(conexion_t is_conexion, opcode_t opcode, const struct iovec *segments, int count);
+
+/**
+ * @brief Recibe un frame del socket.
+ *
+ * @param socket el socket
+ * @param header donde decodificar el header recibido
+ * @return el payload recibido, a liberar con conexion_liberar_stream, o NULL si error o vacío.
+ */
+void *conexion_recibir_frame(int socket, wire_header_t *header);
+
+/**
+ * @brief Recibe un stream del socket.
+ *
+ * @param socket el socket
+ * @param bytes_size los bytes recibidos, incluyendo el header
+ * @return el stream recibido, a liberar con conexion_liberar_stream, o NULL si error.
+ */
 void *conexion_recibir_stream(int socket, ssize_t *bytes_size);
 
+/**
+ * @brief Libera un stream recibido. Si el socket tiene un receptor asociado
+ * el stream es un slice del mismo y se devuelve al receptor.
+ *
+ * @param socket el socket del que se recibió
+ * @param stream el stream recibido
+ */
+void conexion_liberar_stream(int socket, void *stream);
+
 ssize_t
 connection_send_value(conexion_t self, void * value, size_t size_of_value);
 
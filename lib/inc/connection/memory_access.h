@@ -0,0 +1,116 @@
+/**
+ * @file memory_access.h
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Batched memory accesses (MEMORY_BATCH)
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "conexion.h"
+
+// The result frame when an access could not be translated.
+#define MEMORY_ACCESS_FAILED UINT32_MAX
+
+// ============================================================================================================
+//                                   ***** Public Types  *****
+// ============================================================================================================
+
+/**
+ * @brief The operation of a memory access.
+ *
+ */
+typedef enum MemoryAccessOp
+{
+	// Read the value at the address
+	MEMORY_ACCESS_READ,
+	// Write the value at the address
+	MEMORY_ACCESS_WRITE
+} memory_access_op_t;
+
+/**
+ * @brief What the table and index of a memory access refer to.
+ *
+ */
+typedef enum MemoryAccessLevel
+{
+	// Not a level: a zeroed access is rejected rather than taken as already translated
+	MEMORY_ACCESS_INVALID,
+	// Already translated (TLB hit): the index is the frame
+	MEMORY_ACCESS_FRAME,
+	// The table is a second level table, the index one of its entries
+	MEMORY_ACCESS_LVL_2,
+	// The table is the first level table, the index the page number: Memory walks both levels
+	MEMORY_ACCESS_LVL_1
+} memory_access_level_t;
+
+/**
+ * @brief One entry of a MEMORY_BATCH request: translates (pid, table, index) to a frame
+ * and reads or writes at its offset.
+ *
+ */
+typedef struct MemoryAccess
+{
+	// The process accessing.
+	uint32_t pid;
+	// A memory_access_level_t.
+	uint32_t level;
+	// The page table, unused if already translated.
+	uint32_t table;
+	// The page table entry or page number, or the frame if already translated.
+	uint32_t index;
+	// The offset within the page.
+	uint32_t offset;
+	// A memory_access_op_t.
+	uint32_t op;
+	// The value to write.
+	uint32_t value;
+} memory_access_t;
+
+/**
+ * @brief One entry of a MEMORY_BATCH reply, in the same order as the request.
+ *
+ */
+typedef struct MemoryAccessResult
+{
+	// The frame accessed, or MEMORY_ACCESS_FAILED.
+	uint32_t frame;
+	// The value read (or written).
+	uint32_t value;
+} memory_access_result_t;
+
+// ============================================================================================================
+//                                   ***** Public Functions  *****
+// ============================================================================================================
+
+/**
+ * @brief The payload of a MEMORY_BATCH request is [accesses...] and the reply's is [results...];
+ * the reply echoes the request id of the header so that batches can be pipelined (see async_client.h).
+ *
+ * Sends a batch of accesses to Memory and waits for their results, in a single round trip.
+ *
+ * @param conexion the connection to Memory
+ * @param accesses the accesses to perform, in order
+ * @param count the amount of accesses
+ * @param results where to copy the results (count entries)
+ * @return the amount of results received, or ERROR if there was no answer or it was not a MEMORY_BATCH one
+ */
+int conexion_memory_batch(conexion_t conexion, memory_access_t *accesses, int count, memory_access_result_t *results);
+
+/**
+ * @brief Copies the results out of a MEMORY_BATCH reply payload.
+ *
+ * @param payload the results
+ * @param size the payload size
+ * @param count the most results to copy
+ * @param results where to copy them
+ * @return the amount of results copied or ERROR
+ */
+int memory_batch_results(void *payload, ssize_t size, int count, memory_access_result_t *results);
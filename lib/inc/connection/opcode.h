@@ -62,7 +62,19 @@ typedef enum Opcode
 	// Memory for new Process
 	MEMORY_INIT,
 	// Process ends signal
-	PROCESS_TERMINATED
+	PROCESS_TERMINATED,
+	// Batch of memory accesses
+	MEMORY_BATCH,
+	// Logical Address to Frame
+	TRANSLATE,
+	// PCB without its instructions, the CPU already holds the program
+	PCB_DELTA,
+	// The CPU does not hold the program of a PCB_DELTA
+	PCB_MISS,
+	// Shared-memory link offer, answered by the connection layer itself
+	SHM_LINK,
+	// Metrics snapshot of the module, as text
+	STATS
 } opcode_t;
 
 // ============================================================================================================
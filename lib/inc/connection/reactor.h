@@ -0,0 +1,63 @@
+/**
+ * @file reactor.h
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Event-loop (epoll) server engine
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#pragma once
+
+#include "server.h"
+
+// Events fetched per epoll_wait.
+#define REACTOR_EVENTS 64
+
+// ============================================================================================================
+//                                   ***** Public Types  *****
+// ============================================================================================================
+
+/**
+ * @brief Handles ONE request of a client: reads the opcode and its payload and replies.
+ *
+ * Runs on a reactor thread, which serves nobody else meanwhile: it must not block beyond reading the rest
+ * of the frame. Waiting on a condition, a reply from another module or a delay stalls every client of that
+ * reactor; such work must be handed to a thread of its own (see thread_manager_launch), which replies.
+ *
+ * @param socket the client file descriptor
+ * @param session a per-connection slot the handler may allocate; it is freed when the client disconnects
+ * @return the opcode handled, or <= 0 if the client disconnected (DC) or failed
+ */
+typedef int (*reactor_handler_t)(int socket, void **session);
+
+// ============================================================================================================
+//                                   ***** Public Functions  *****
+// ============================================================================================================
+
+/**
+ * @brief Serves every client of a listening server from a fixed set of reactor threads.
+ * Alternative to looping on servidor_run, which spawns a thread per client.
+ *
+ * Each reactor has its own epoll set and its own SO_REUSEPORT listener on the same port, and serves
+ * only the clients it accepted; a socket is armed one-shot, so the handler can do blocking reads for
+ * the rest of the frame. The handler runs on the reactor thread: while it waits, so does every other
+ * client of that reactor, which does not suit a module that delays each request (Memory uses acceptors).
+ * Returns once servidor_stop_reactor is called and every reactor thread ended, their clients closed.
+ *
+ * @param server a server already listening
+ * @param reactors the amount of reactor threads (the caller thread is one of them)
+ * @param handler the per-request handler
+ * @return EXIT_SUCCESS, or SERVER_RUNTIME_ERROR if an epoll set failed
+ */
+int servidor_run_reactor(servidor_t *server, int reactors, reactor_handler_t handler);
+
+/**
+ * @brief Stops the reactors of a server, from any thread; servidor_run_reactor returns once they ended.
+ * The server can not be served by reactors again, even if it was stopped before it ran.
+ *
+ * @param server the server
+ */
+void servidor_stop_reactor(servidor_t *server);
@@ -0,0 +1,122 @@
+/**
+ * @file receiver.h
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Per-connection pooled receive buffer
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#pragma once
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <sys/types.h>
+
+// Default bytes buffered per connection.
+#define RECEIVER_CAPACITY 4096
+// Highest file descriptor that can have a receiver attached.
+#define RECEIVERS_MAX 1024
+
+// ============================================================================================================
+//                                   ***** Public Class  *****
+// ============================================================================================================
+
+/**
+ * @brief A receive ring bound to a socket.
+ *
+ * Reads from the socket in bulk and hands out slices of its own buffer, so that
+ * small messages cost neither an allocation nor a syscall each.
+ * A slice is valid until released; the buffer is only compacted once every slice was released.
+ *
+ * @class
+ */
+typedef struct Receiver
+{
+	// @private The socket being read.
+	int socket;
+	// @private The buffered bytes.
+	char *buffer;
+	// @private The buffer size.
+	size_t capacity;
+	// @private The first unread byte.
+	size_t head;
+	// @private One past the last byte read from the socket.
+	size_t tail;
+	// @private The slices not yet released.
+	int slices;
+} receiver_t;
+
+// ============================================================================================================
+//                                   ***** Public Functions  *****
+// ============================================================================================================
+
+/**
+ * @brief Attaches a receiver to a socket. Every stream received from it
+ * through the connection API will then be a pooled slice.
+ *
+ * @param socket the socket to attach to
+ * @param capacity the bytes to buffer
+ * @return the attached receiver or NULL if the socket can not have one
+ */
+receiver_t *receiver_attach(int socket, size_t capacity);
+
+/**
+ * @brief Detaches and deallocates the receiver of a socket, if any.
+ *
+ * @param socket the socket
+ */
+void receiver_detach(int socket);
+
+/**
+ * @brief Obtains the receiver attached to a socket.
+ *
+ * @param socket the socket
+ * @return the receiver or NULL if none is attached
+ */
+receiver_t *receiver_of(int socket);
+
+/**
+ * @brief Copies the next bytes of the socket into a destination.
+ *
+ * @param receiver the receiver
+ * @param destination where to copy
+ * @param size the bytes to read
+ * @return the bytes read, 0 if the peer disconnected or ERROR
+ */
+ssize_t receiver_recv(receiver_t *receiver, void *destination, size_t size);
+
+/**
+ * @brief Obtains the next bytes of the socket without copying them when possible.
+ *
+ * @param receiver the receiver
+ * @param size the bytes to read
+ * @return a slice that must be released with receiver_release, or NULL if error
+ */
+void *receiver_slice(receiver_t *receiver, size_t size);
+
+/**
+ * @brief Releases a slice obtained from a receiver.
+ *
+ * @param receiver the receiver
+ * @param slice the slice
+ */
+void receiver_release(receiver_t *receiver, void *slice);
+
+/**
+ * @brief Tells how many bytes were read from the socket but not yet consumed.
+ *
+ * @param socket the socket
+ * @return the bytes buffered, 0 if none or no receiver is attached
+ */
+size_t receiver_pending(int socket);
+
+/**
+ * @brief Releases a stream received from a socket, whether it is a pooled slice or not.
+ *
+ * @param socket the socket the stream was received from
+ * @param stream the stream
+ */
+void receiver_release_stream(int socket, void *stream);
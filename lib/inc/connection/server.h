@@ -10,6 +10,7 @@
 
 #include "conexion.h"
 #include <stdint.h>
+#include <stdatomic.h>
 #include <poll.h>
 #include "thread_manager.h"
 
@@ -32,8 +33,10 @@ typedef struct Servidor
 	conexion_t conexion;
 	// Si inició o no
 	bool iniciado;
-	// Last client socket accepted
-	int client;
+	// Last client socket accepted, by whichever acceptor or reactor thread took it
+	_Atomic int client;
+	// Readable once the reactors serving it must stop (see servidor_stop_reactor)
+	int stop;
 	// Thread Tracker
 	thread_manager_t tm;
 } servidor_t;
@@ -82,6 +85,18 @@ int servidor_escuchar(servidor_t *servidor);
  */
 void servidor_run(servidor_t *is_servidor, void *(*rutina)(void *));
 
+/**
+ * Atiende clientes desde varios hilos aceptadores, un hilo por cliente como servidor_run.
+ * Cada aceptador tiene su propio socket de escucha en el mismo puerto (SO_REUSEPORT) y acepta sin bloquearse,
+ * así una avalancha de clientes no se encola detrás de un único accept. No retorna salvo error.
+ *
+ * @param servidor un servidor ya escuchando
+ * @param aceptadores la cantidad de hilos aceptadores (el llamador es uno de ellos)
+ * @param rutina la rutina del hilo de cada cliente, que recibe un int * con el socket
+ * @returns SERVER_RUNTIME_ERROR
+ */
+int servidor_run_acceptors(servidor_t *servidor, int aceptadores, void *(*rutina)(void *));
+
 /**
  * @brief Accepts a client
  *
@@ -90,6 +105,15 @@ void servidor_run(servidor_t *is_servidor, void *(*rutina)(void *));
  */
 int server_accept_client(servidor_t *server);
 
+/**
+ * Acepta un cliente de un socket de escucha del servidor y le aplica el ajuste de sockets del módulo (ver tuning.h).
+ *
+ * @param server el servidor
+ * @param listener el socket de escucha, el del servidor o uno de conexion_escuchar_otra
+ * @returns el socket del cliente, o -1 si error (errno EAGAIN si el socket no bloquea y no hay clientes)
+ */
+int server_accept_client_from(servidor_t *server, int listener);
+
 /**
  * @brief Cierra la conexión del cliente especificado.
  *
@@ -102,22 +126,40 @@ void servidor_desconectar_cliente(int socket);
 // ------------------------------------------------------------
 
 /**
- * Recibe operaciones del cliente indicado
+ * Recibe operaciones del cliente indicado. Una oferta de memoria compartida (SHM_LINK) ya llega
+ * respondida: no tiene payload que recibir.
  *
  * @param socket el filedescriptor del cliente
  * @returns opcode
  */
 int servidor_recibir_operacion(int socket);
 
+/**
+ * Consulta el id de pedido del último frame recibido del cliente, para devolverlo en la respuesta.
+ *
+ * @param socket el filedescriptor del cliente
+ * @returns el id de pedido (0 si el cliente no lo usa)
+ */
+uint32_t servidor_id_recibido(int socket);
+
 /**
  * @brief Recibe un stream del cliente indicado
  *
  * @param socket el filedescriptor del cliente
  * @param bytes referencia a la cantidad de bytes recibidos
- * @return El stream recibido.
+ * @return El stream recibido, a liberar con servidor_liberar_stream.
  */
 void *servidor_recibir_stream(int socket, ssize_t *bytes);
 
+/**
+ * @brief Libera un stream recibido del cliente. Si el socket tiene un receptor
+ * asociado (receiver_attach) el stream es un slice del mismo y se devuelve al receptor.
+ *
+ * @param socket el filedescriptor del cliente
+ * @param stream el stream recibido
+ */
+void servidor_liberar_stream(int socket, void *stream);
+
 /**
  * @brief Recibe un mensaje del cliente indicado
  *
@@ -163,3 +205,15 @@ uint32_t servidor_recibir_accion(int socket);
  * @return los bytes enviados
  */
 ssize_t servidor_enviar_accion(int socket, void *accion);
+
+// ------------------------------------------------------------
+//  Métricas
+// ------------------------------------------------------------
+
+/**
+ * @brief Responde un pedido STATS con la foto de las métricas del módulo (ver metrics_format), como texto.
+ *
+ * @param socket el filedescriptor del cliente
+ * @return los bytes enviados
+ */
+ssize_t servidor_enviar_metricas(int socket);
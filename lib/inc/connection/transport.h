@@ -0,0 +1,153 @@
+/**
+ * @file transport.h
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Per-socket transports: shared-memory links and record (SOCK_SEQPACKET) sockets
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+// Bytes of each direction of a shared-memory link (a power of two).
+#define TRANSPORT_RING_CAPACITY (64 * 1024)
+// How long a blocked side sleeps before checking whether its peer is still there.
+#define TRANSPORT_POLL_MS 100
+// Bytes of a record at most: a larger frame leaves a record socket in several.
+#define TRANSPORT_RECORD_MAX (64 * 1024)
+
+// ============================================================================================================
+//                                   ***** Public Class  *****
+// ============================================================================================================
+
+/**
+ * @brief One direction of a link: a single-producer single-consumer byte ring, mapped by both processes.
+ * Positions only grow, wrapping at 2^32; a side waiting on it sleeps on the futex word.
+ *
+ */
+typedef struct ShmRing
+{
+	// The next byte to read, written by the consumer.
+	_Atomic uint32_t head;
+	// The next byte to write, written by the producer.
+	_Atomic uint32_t tail;
+	// Bumped on every move of head or tail: the futex word.
+	_Atomic uint32_t sequence;
+	// The sides sleeping on the sequence.
+	_Atomic uint32_t waiters;
+	// Set once either side leaves the link.
+	_Atomic uint32_t closed;
+	// The data size.
+	uint32_t capacity;
+	// The data.
+	char data[];
+} shm_ring_t;
+
+/**
+ * @brief A connection whose bytes travel through shared memory instead of its socket.
+ * The socket stays open: it carried the handshake and tells when the peer is gone.
+ *
+ * @class
+ */
+typedef struct Transport
+{
+	// @private The socket the link replaces.
+	int socket;
+	// @private The mapped segment holding both rings.
+	void *segment;
+	// @private The bytes to send.
+	shm_ring_t *tx;
+	// @private The bytes received.
+	shm_ring_t *rx;
+	// @private Serializes the local writers, so the ring keeps a single producer.
+	pthread_mutex_t sending;
+	// @private Serializes the local readers, so the ring keeps a single consumer.
+	pthread_mutex_t receiving;
+	// @private The holders of the link: the table of links and each send or recv on it. The last one unmaps it.
+	_Atomic int references;
+} transport_t;
+
+// ============================================================================================================
+//                                   ***** Public Functions  *****
+// ============================================================================================================
+
+/**
+ * @brief Tells if the module configuration asks for shared-memory links (TRANSPORTE=SHM).
+ *
+ * @return true if it does
+ */
+bool transport_shm_enabled(void);
+
+/**
+ * @brief Client side: creates a shared-memory link and offers it to the server on a connected socket.
+ * On success every byte sent or received through the connection API travels through it.
+ *
+ * @param socket the connected socket
+ * @return SUCCESS, or ERROR if the server declined it (the socket keeps working as is)
+ */
+int transport_shm_connect(int socket);
+
+/**
+ * @brief Server side: answers a link offer, mapping the named segment if links are enabled.
+ *
+ * @param socket the client
+ * @param name the segment name sent by the client
+ * @param enabled whether this side takes links, see transport_shm_enabled
+ * @return SUCCESS if the link is in use, ERROR if it was declined
+ */
+int transport_shm_accept(int socket, const char *name, bool enabled);
+
+/**
+ * @brief Marks a connected SOCK_SEQPACKET socket. Each frame then leaves it in as few records as possible,
+ * and each read takes a whole record: the bytes beyond the ones asked for wait in a per-socket stage,
+ * so that a frame header and its payload cost a single syscall.
+ *
+ * @param socket the socket
+ */
+void transport_records_attach(int socket);
+
+/**
+ * @brief Gets the link of a socket, without holding it: only tells whether there is one.
+ *
+ * @param socket the socket
+ * @return the link, or NULL if the socket is plain
+ */
+transport_t *transport_of(int socket);
+
+/**
+ * @brief Leaves the link of a socket, if any, waking up the peer, and drops its record stage and tuning state. Call it before closing the socket.
+ *
+ * @param socket the socket
+ */
+void transport_detach(int socket);
+
+/**
+ * @brief sendmsg(2), through the socket link if it has one; a link or a record socket takes every byte before returning.
+ *
+ * @param socket the socket
+ * @param segments the segments
+ * @param count the amount of segments
+ * @return the bytes sent or ERROR
+ */
+ssize_t transport_send(int socket, const struct iovec *segments, int count);
+
+/**
+ * @brief recv(2), through the socket link or record stage if it has one. Only MSG_WAITALL is honored on those.
+ *
+ * @param socket the socket
+ * @param buffer where to copy
+ * @param size the most bytes to receive
+ * @param flags recv flags
+ * @return the bytes received, 0 if the peer left or ERROR
+ */
+ssize_t transport_recv(int socket, void *buffer, size_t size, int flags);
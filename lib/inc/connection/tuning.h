@@ -0,0 +1,93 @@
+/**
+ * @file tuning.h
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Per-connection socket tuning: Nagle, corking and buffer sizes
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#pragma once
+
+#include <stdbool.h>
+
+// ============================================================================================================
+//                                   ***** Public Types  *****
+// ============================================================================================================
+
+/**
+ * @brief How a connection socket sends.
+ *
+ */
+typedef struct SocketTuning
+{
+	// Send each frame as soon as it is written (TCP_NODELAY), instead of waiting for the previous one to be acknowledged.
+	bool nodelay;
+	// Hold the frames in the kernel (TCP_CORK) until the connection is flushed, so that a burst leaves in full segments.
+	bool cork;
+	// SO_SNDBUF in bytes, 0 for the system default.
+	int send_buffer;
+	// SO_RCVBUF in bytes, 0 for the system default.
+	int receive_buffer;
+} socket_tuning_t;
+
+// ============================================================================================================
+//                                   ***** Public Functions  *****
+// ============================================================================================================
+
+/**
+ * @brief Reads the tuning from the module configuration (SIN_DEMORA, AGRUPAR_ENVIOS, BUFFER_ENVIO, BUFFER_RECEPCION).
+ *
+ * @return the tuning
+ */
+socket_tuning_t socket_tuning_from_config(void);
+
+/**
+ * @brief Sets the buffer sizes of a socket. Call it before connect or listen, so that the TCP window is scaled
+ * accordingly; the sockets accepted from a listener inherit them.
+ *
+ * @param socket the socket
+ * @param tuning the tuning
+ * @return SUCCESS, or ERROR if an option was refused
+ */
+int socket_tuning_buffers(int socket, socket_tuning_t tuning);
+
+/**
+ * @brief Sets Nagle and corking on a connected TCP socket; sockets of other families are left as they are.
+ *
+ * @param socket the socket
+ * @param tuning the tuning
+ * @return SUCCESS, or ERROR if an option was refused
+ */
+int socket_tuning_apply(int socket, socket_tuning_t tuning);
+
+/**
+ * @brief Notes that bytes were written to a socket; they wait for a flush if it is corked.
+ *
+ * @param socket the socket
+ */
+void socket_tuning_sent(int socket);
+
+/**
+ * @brief Notes that bytes were read from a socket: TCP_QUICKACK is armed again, if the socket uses it.
+ *
+ * @param socket the socket
+ */
+void socket_tuning_received(int socket);
+
+/**
+ * @brief Pushes out what a corked socket holds, if anything. The connection layer flushes a socket before blocking
+ * on it, so a request never waits in the kernel for its own reply; call it whenever a burst ends without a read.
+ *
+ * @param socket the socket
+ */
+void socket_flush(int socket);
+
+/**
+ * @brief Drops the tuning state of a socket. Call it before closing the socket.
+ *
+ * @param socket the socket
+ */
+void socket_tuning_forget(int socket);
@@ -0,0 +1,190 @@
+/**
+ * @file wire.h
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Wire format: frame header and payload codecs
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "opcode.h"
+
+/**
+ * Every frame is [HEADER][PAYLOAD], the header being little-endian regardless of the host:
+ *
+ *          [ MAGIC 1 ][ VERSION 1 ][ OPCODE 2 ][ REQUEST ID 4 ][ LENGTH 4 ]
+ *
+ * Variable sized payloads (PCBs, instructions) are encoded field by field as LEB128 varints,
+ * so they never depend on struct layouts nor enum sizes.
+ */
+
+// Marks the start of every frame ('S' from SSKI).
+#define WIRE_MAGIC 0x53
+// The wire format version, bumped on any incompatible change.
+#define WIRE_VERSION 1
+// The bytes of a frame header.
+#define WIRE_HEADER_SIZE 12
+// The most bytes a uint32 takes as a varint.
+#define WIRE_VARINT_MAX 5
+// The largest payload accepted, anything above is taken as a corrupted frame.
+#define WIRE_PAYLOAD_MAX (64u << 20)
+
+// Fixed-size payloads (memory accesses, operands, frame replies) travel as host words.
+#if __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "The wire format sends fixed-size fields as little-endian words"
+#endif
+
+// ============================================================================================================
+//                                   ***** Public Types  *****
+// ============================================================================================================
+
+/**
+ * @brief A decoded frame header.
+ *
+ */
+typedef struct WireHeader
+{
+	// The operation.
+	opcode_t opcode;
+	// The request id, echoed by pipelined servers; 0 otherwise.
+	uint32_t id;
+	// The bytes of the payload following the header.
+	uint32_t length;
+} wire_header_t;
+
+/**
+ * @brief A growable buffer to encode a payload into.
+ *
+ */
+typedef struct WireWriter
+{
+	// The encoded bytes, owned by the writer until released.
+	uint8_t *buffer;
+	// The bytes written.
+	size_t size;
+	// The bytes allocated.
+	size_t capacity;
+} wire_writer_t;
+
+/**
+ * @brief A bounded cursor over a received payload. Reading past its end fails it instead of overrunning.
+ *
+ */
+typedef struct WireReader
+{
+	// The payload.
+	const uint8_t *buffer;
+	// The payload size.
+	size_t size;
+	// The bytes read.
+	size_t offset;
+	// Whether a read ran out of bytes or found a malformed value.
+	bool failed;
+} wire_reader_t;
+
+// ============================================================================================================
+//                                   ***** Public Functions  *****
+// ============================================================================================================
+
+// -----------------------------------------------------------
+//  Header
+// ------------------------------------------------------------
+
+/**
+ * @brief Encodes a frame header.
+ *
+ * @param buffer at least WIRE_HEADER_SIZE bytes
+ * @param opcode the operation
+ * @param id the request id
+ * @param length the payload size
+ */
+void wire_header_encode(void *buffer, opcode_t opcode, uint32_t id, uint32_t length);
+
+/**
+ * @brief Decodes a frame header, checking its magic, version and length.
+ *
+ * @param buffer WIRE_HEADER_SIZE bytes received
+ * @param header where to decode it
+ * @return whether the header is valid
+ */
+bool wire_header_decode(const void *buffer, wire_header_t *header);
+
+// -----------------------------------------------------------
+//  Fixed-size fields
+// ------------------------------------------------------------
+
+/**
+ * @brief Stores a uint32 as little-endian.
+ *
+ * @param buffer at least 4 bytes
+ * @param value the value
+ */
+void wire_put_u32(void *buffer, uint32_t value);
+
+/**
+ * @brief Loads a little-endian uint32.
+ *
+ * @param buffer at least 4 bytes
+ * @return the value
+ */
+uint32_t wire_get_u32(const void *buffer);
+
+// -----------------------------------------------------------
+//  Varints
+// ------------------------------------------------------------
+
+/**
+ * @brief The bytes a value takes as a varint.
+ *
+ * @param value the value
+ * @return between 1 and WIRE_VARINT_MAX
+ */
+size_t wire_varint_size(uint32_t value);
+
+/**
+ * @brief Initializes an empty writer. Must be destroyed unless its buffer is taken.
+ *
+ * @param writer the writer
+ * @param capacity the bytes to allocate up front (it grows as needed)
+ */
+void wire_writer_init(wire_writer_t *writer, size_t capacity);
+
+/**
+ * @brief Appends a varint.
+ *
+ * @param writer the writer
+ * @param value the value
+ */
+void wire_write_varint(wire_writer_t *writer, uint32_t value);
+
+/**
+ * @brief Deallocates the writer buffer.
+ *
+ * @param writer the writer
+ */
+void wire_writer_destroy(wire_writer_t *writer);
+
+/**
+ * @brief Creates a reader over a payload.
+ *
+ * @param buffer the payload
+ * @param size the payload size, SIZE_MAX if it is already trusted (e.g. a local file)
+ * @return the reader
+ */
+wire_reader_t wire_reader_create(const void *buffer, size_t size);
+
+/**
+ * @brief Reads a varint.
+ *
+ * @param reader the reader
+ * @return the value, or 0 if the reader failed
+ */
+uint32_t wire_read_varint(wire_reader_t *reader);
@@ -14,6 +14,8 @@
 #include <inttypes.h>
 #include "opcode.h"
 #include "conexion.h"
+#include "wire.h"
+#include "smartlist.h"
 
 /**
  * @brief Instruction ID Code
@@ -88,11 +90,27 @@ instruction_t *instruction_create(instcode_t icode, uint32_t param0, uint32_t pa
  */
 void instruction_destroy(void *instruction);
 
+/**
+ * @brief Appends an instruction to a payload: [ICODE][PARAM0][PARAM1] as varints.
+ *
+ * @param instruction to be encoded
+ * @param writer the payload being written
+ */
+void instruction_encode(instruction_t *instruction, wire_writer_t *writer);
+
+/**
+ * @brief Reads an instruction from a payload.
+ *
+ * @param reader the payload being read
+ * @return a new instruction, or NULL (and the reader failed) if it is malformed.
+ */
+instruction_t *instruction_decode(wire_reader_t *reader);
+
 /**
  * @brief Maps an instruction to a Stream.
  *
  * @param instruction to be mapped
- * @return a serialized stream containing an instruction.
+ * @return a serialized stream containing an instruction, at most 3 * WIRE_VARINT_MAX bytes.
  */
 void *instruction_to_stream(void *instruction);
 
@@ -105,9 +123,33 @@ void *instruction_to_stream(void *instruction);
 instruction_t *instruction_from_stream(void *stream);
 
 /**
- * @brief List instructions from a stream.
+ * @brief Appends a list of instructions to a payload: [COUNT][INSTRUCTION]...
+ *
+ * @param instructions the list
+ * @param writer the payload being written
+ */
+void instruction_list_encode(t_list *instructions, wire_writer_t *writer);
+
+/**
+ * @brief Reads a list of instructions from a payload. Stops at the first malformed one.
+ *
+ * @param reader the payload being read
+ * @return a list, possibly shorter than announced if the reader failed.
+ */
+t_list *instruction_list_decode(wire_reader_t *reader);
+
+/**
+ * @brief Identifies a program by its instructions.
+ *
+ * @param instructions the list
+ * @return a hash of the list, never 0.
+ */
+uint32_t instruction_list_hash(t_list *instructions);
+
+/**
+ * @brief List instructions from a trusted stream.
  *
- * @param stream must be [size (uint32_t)][data (instruction_t)][data...]
+ * @param stream must be [COUNT][INSTRUCTION]... (see instruction_list_encode)
  * @return a list.
  */
 void *instruction_list_from(void *stream);
@@ -11,12 +11,14 @@
 
 #pragma once
 
+#include <stddef.h>
 #include "smartlist.h"
 
 /**
  * @brief Reduces a List of instructions
  *
  * @param instructions list to be reduced
+ * @param size where to store the stream size
  * @return a stream of an instruction list
  */
-void *instructions_fold(t_list *instructions);
+void *instructions_fold(t_list *instructions, size_t *size);
@@ -13,8 +13,9 @@
 
 #include <inttypes.h>
 #include <stdlib.h>
+#include "wire.h"
 #include "smartlist.h"
-#include "safe_queue.h"
+#include "intrusive_queue.h"
 
 typedef enum Status
 {
@@ -52,6 +53,10 @@ typedef struct PCB
 	uint32_t io;
 	// Real CPU usage
 	uint32_t real;
+	// Hash of the instructions, 0 until the program is first sent to the CPU.
+	uint32_t program;
+	// Links of the state queue it waits in.
+	queue_link_t link;
 } pcb_t;
 
 /**
@@ -71,32 +76,63 @@ pcb_t *new_pcb(uint32_t id, size_t size, uint32_t estimation);
  */
 void pcb_destroy(void *pcb);
 
+/**
+ * @brief Appends a PCB to a payload (see pcb_to_stream).
+ *
+ * @param pcb the instance.
+ * @param writer the payload being written
+ */
+void pcb_encode(pcb_t *pcb, wire_writer_t *writer);
+
+/**
+ * @brief Reads a PCB from a payload.
+ *
+ * @param reader the payload being read
+ * @return a recovered PCB instance, or NULL (and the reader failed) if it is malformed.
+ */
+pcb_t *pcb_decode(wire_reader_t *reader);
+
+/**
+ * @brief Appends the state of a PCB, everything but its instructions, to a payload.
+ *
+ * @param pcb the instance.
+ * @param writer the payload being written
+ */
+void pcb_encode_state(pcb_t *pcb, wire_writer_t *writer);
+
+/**
+ * @brief Reads the state of a PCB (see pcb_encode_state) into an instance, keeping its instructions.
+ *
+ * @param reader the payload being read
+ * @param pcb the instance to update
+ * @return whether the state was valid; if not the instance is left as it was.
+ */
+bool pcb_decode_state(wire_reader_t *reader, pcb_t *pcb);
+
 /**
  * @brief Serializes a PCB.
  *
  * @param pcb the instance.
- * @return a stream containing the pcb data.
+ * @return a stream of pcb_bytes_size(pcb) bytes containing the pcb data.
  */
 void *pcb_to_stream(pcb_t *pcb);
 
 /**
- * @brief Obtains the size in bytes of a PCB instance.
+ * @brief Obtains the size in bytes of a serialized PCB instance.
  *
  * @param pcb the instance.
- * @return the number of bytes in use.
+ * @return the number of bytes pcb_to_stream takes.
  */
 size_t pcb_bytes_size(pcb_t *pcb);
 
 /**
- * @brief Recovers a PCB from a stream.
+ * @brief Recovers a PCB from a trusted stream (e.g. a SWAP file).
  *
  * @param stream to be deserialized
  * @return a recovered PCB instance
  */
 pcb_t *pcb_from_stream(void *stream);
 
-pcb_t *get_pcb_by_pid(t_list *pcbs, uint32_t pid);
-
 /**
  * @brief Tells what PCB should go before the other.
  *
@@ -115,21 +151,3 @@ bool pcb_sort_by_estimation(void *e1, void *e2);
  * @return uint32_t
  */
 uint32_t pcb_get_param_for(pcb_t *pcb, int instruction, int param);
-
-/**
- * @brief Tells if a PCB exists in a queue
- *
- * @param queue a thread safe queue
- * @param id a PID
- * @return wether a PCB is present in the given queue or not
- */
-bool pcb_exists(safe_queue_t *queue, uint32_t id);
-
-/**
- * @brief Removes a PCB from a queue.
- *
- * @param queue a thread safe queue
- * @param id the process id
- * @return a PCB with the given ID or null if not found
- */
-pcb_t *pcb_remove_by_id(safe_queue_t *queue, uint32_t id);
@@ -0,0 +1,134 @@
+/**
+ * @file pcb_registry.h
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Live PCBs indexed by PID
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "pcb.h"
+
+/**
+ * @brief The state queue a PCB is waiting in.
+ *
+ */
+typedef enum PcbQueue
+{
+	// In no queue: executing, doing IO, or not registered at all
+	PCB_QUEUE_NONE,
+	// Created, waiting for its instructions
+	PCB_QUEUE_ADMISSION,
+	PCB_QUEUE_NEW,
+	PCB_QUEUE_READY,
+	PCB_QUEUE_READY_SUS,
+	PCB_QUEUE_BLOCKED,
+	PCB_QUEUE_BLOCKED_SUS
+} pcb_queue_t;
+
+/**
+ * @brief A slot per PID, holding its PCB and the queue it is in.
+ *
+ */
+typedef struct PcbRegistryEntry
+{
+	pcb_t *pcb;
+	pcb_queue_t queue;
+} pcb_registry_entry_t;
+
+/**
+ * @brief Every live PCB, directly indexed by its PID: lookups and moves between queues take constant time,
+ * however many processes there are. The registry owns the PCBs; the queues only point at them.
+ *
+ * @class
+ */
+typedef struct PcbRegistry
+{
+	// @private Guards the entries.
+	pthread_mutex_t _mtx;
+	// @private The entries, one per PID.
+	pcb_registry_entry_t *entries;
+	// @private The amount of entries: every PID is lower.
+	uint32_t capacity;
+} pcb_registry_t;
+
+/**
+ * @brief Creates an empty registry.
+ *
+ * @param capacity the amount of PIDs, the pool they are taken from
+ * @return a new registry
+ */
+pcb_registry_t *new_pcb_registry(uint32_t capacity);
+
+/**
+ * @brief Deallocates a registry and the PCBs still registered. Nobody else may be using it.
+ *
+ * @param registry the registry
+ * @param destroyer deallocates a PCB, may be NULL
+ */
+void pcb_registry_destroy(pcb_registry_t *registry, void (*destroyer)(void *));
+
+/**
+ * @brief Registers a PCB under its PID.
+ *
+ * @param registry the registry
+ * @param pcb the PCB
+ * @param queue the queue it starts in
+ * @return false if its PID is out of range or already taken
+ */
+bool pcb_registry_add(pcb_registry_t *registry, pcb_t *pcb, pcb_queue_t queue);
+
+/**
+ * @brief Finds a PCB by its PID.
+ *
+ * @param registry the registry
+ * @param pid the PID
+ * @return the PCB, or NULL if there is none
+ */
+pcb_t *pcb_registry_get(pcb_registry_t *registry, uint32_t pid);
+
+/**
+ * @brief Tells the queue a PCB is in.
+ *
+ * @param registry the registry
+ * @param pid the PID
+ * @return the queue, PCB_QUEUE_NONE if it is in none or not registered
+ */
+pcb_queue_t pcb_registry_queue(pcb_registry_t *registry, uint32_t pid);
+
+/**
+ * @brief Records that a PCB is now in a queue, wherever it was.
+ *
+ * @param registry the registry
+ * @param pid the PID
+ * @param queue the queue it is in
+ */
+void pcb_registry_set(pcb_registry_t *registry, uint32_t pid, pcb_queue_t queue);
+
+/**
+ * @brief Records that a PCB moved between queues, only if it was in the first one: checking and moving is
+ * atomic, so when two threads race for the same PCB just one of them gets it.
+ *
+ * @param registry the registry
+ * @param pid the PID
+ * @param from the queue it should be in
+ * @param to the queue it moves to
+ * @return the PCB, or NULL if it was not in the first queue
+ */
+pcb_t *pcb_registry_move(pcb_registry_t *registry, uint32_t pid, pcb_queue_t from, pcb_queue_t to);
+
+/**
+ * @brief Unregisters a PCB, without deallocating it.
+ *
+ * @param registry the registry
+ * @param pid the PID
+ * @return the PCB, or NULL if there was none
+ */
+pcb_t *pcb_registry_remove(pcb_registry_t *registry, uint32_t pid);
@@ -0,0 +1,184 @@
+/**
+ * @file read_mostly_list.h
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Thread safe list read without locks, for tables written far less than they are read.
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#pragma once
+
+// ============================================================================================================
+//                               		***** Includes *****
+// ============================================================================================================
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+// ============================================================================================================
+//                               		***** Definitions *****
+// ============================================================================================================
+
+// Slots allocated at once: a chunk never moves once published.
+#define READ_MOSTLY_CHUNK 256
+// Chunks a list can have, READ_MOSTLY_CHUNK * READ_MOSTLY_CHUNKS elements at most.
+#define READ_MOSTLY_CHUNKS 1024
+
+// ============================================================================================================
+//                               		***** Class Declarations *****
+// ============================================================================================================
+
+/**
+ * @brief A list of indexed slots where reads take no lock: a slot is an atomic pointer in a chunk that is
+ * never moved nor freed until the list is destroyed, so a reader loads it while a writer publishes another
+ * one. Writers still take a mutex among themselves.
+ * An element is only freed after a grace period: readers that keep what they got wrap it in
+ * read_mostly_list_enter/leave, and read_mostly_list_take empties a slot and waits for every reader that
+ * entered before, so that nobody can still be using what it returns.
+ *
+ * @author Tomás Sánchez
+ */
+typedef struct ReadMostlyList
+{
+
+	// ! Private:
+
+	/**
+	 * @brief Serializes writers; readers never take it.
+	 * @private
+	 */
+	pthread_mutex_t _mtx;
+
+	/**
+	 * @brief The chunks of slots, allocated as the list grows.
+	 * @private
+	 */
+	_Atomic(void *) *_Atomic _chunks[READ_MOSTLY_CHUNKS];
+
+	/**
+	 * @brief The amount of slots in use, published after their contents.
+	 * @private
+	 */
+	_Atomic uint32_t _size;
+
+	/**
+	 * @brief Bumped by every grace period: readers count themselves in the parity they entered with.
+	 * @private
+	 */
+	_Atomic uint32_t _epoch;
+
+	/**
+	 * @brief Readers inside, by the parity of the epoch they entered with.
+	 * @private
+	 */
+	_Atomic uint32_t _readers[2];
+
+	/**
+	 * @brief Serializes grace periods, apart from writers: a writer may be a reader too.
+	 * @private
+	 */
+	pthread_mutex_t _grace;
+
+	/**
+	 * @brief Signaled by the last reader of a parity to leave, while a grace period waits for it.
+	 * @private
+	 */
+	pthread_cond_t _left;
+
+	/**
+	 * @brief Whether a grace period is waiting: readers only signal then.
+	 * @private
+	 */
+	atomic_bool _waiting;
+
+	// ! Public:
+
+} read_mostly_list_t;
+
+// ============================================================================================================
+//                               		***** Functions Declarations *****
+// ============================================================================================================
+
+/**
+ * @brief Instances a new empty list.
+ *
+ * @return an empty read-mostly list.
+ */
+read_mostly_list_t *new_read_mostly_list(void);
+
+/**
+ * @brief Destroys the list and, if a destroyer is given, the elements left. Nobody else may be using it.
+ *
+ * @param list the list itself
+ * @param destroyer a consumer function to destroy the elements, may be NULL
+ */
+void read_mostly_list_destroy(read_mostly_list_t *list, void (*destroyer)(void *));
+
+/**
+ * @brief Gets the element at a position, without locking.
+ *
+ * @param list the list itself
+ * @param index the position
+ * @return the element, or NULL if the position is empty or out of range
+ */
+void *read_mostly_list_get(read_mostly_list_t *list, uint32_t index);
+
+/**
+ * @brief Counts the slots of the list, empty ones included, without locking.
+ *
+ * @param list the list itself
+ * @return the amount of slots
+ */
+uint32_t read_mostly_list_size(read_mostly_list_t *list);
+
+/**
+ * @brief Places an element in a slot; the list grows up to it if needed.
+ *
+ * @param list the list itself
+ * @param index the position
+ * @param element the element, NULL to empty the slot
+ * @return false if the position is past the most the list can hold
+ */
+bool read_mostly_list_set(read_mostly_list_t *list, uint32_t index, void *element);
+
+/**
+ * @brief Places an element in the first empty slot, or at the end; finding and taking it is atomic.
+ *
+ * @param list the list itself
+ * @param element the element
+ * @param reuse whether to look for an emptied slot first, or always append
+ * @return the position it took, or UINT32_MAX if the list is full
+ */
+uint32_t read_mostly_list_put(read_mostly_list_t *list, void *element, bool reuse);
+
+/**
+ * @brief Empties a slot and waits until every reader that could have got its element has left.
+ * Must not be called from inside a read section, it would wait for itself.
+ *
+ * @param list the list itself
+ * @param index the position
+ * @return the element it had, which nobody is using anymore, or NULL if it was empty
+ */
+void *read_mostly_list_take(read_mostly_list_t *list, uint32_t index);
+
+/**
+ * @brief Starts a read section: the elements got until read_mostly_list_leave are not freed meanwhile.
+ * Sections may nest.
+ *
+ * @param list the list itself
+ * @return the token to leave with
+ */
+uint32_t read_mostly_list_enter(read_mostly_list_t *list);
+
+/**
+ * @brief Ends a read section.
+ *
+ * @param list the list itself
+ * @param token what read_mostly_list_enter returned
+ */
+void read_mostly_list_leave(read_mostly_list_t *list, uint32_t token);
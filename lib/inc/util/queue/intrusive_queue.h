@@ -0,0 +1,141 @@
+/**
+ * @file intrusive_queue.h
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Thread safe queue linking elements through a field of their own
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <pthread.h>
+
+struct IntrusiveQueue;
+
+/**
+ * @brief The links an element embeds to be queued. An element is in one queue at most.
+ *
+ */
+typedef struct QueueLink
+{
+	struct QueueLink *prev;
+	struct QueueLink *next;
+	// The queue it is in, NULL if none: only changes under that queue's lock.
+	struct IntrusiveQueue *queue;
+} queue_link_t;
+
+/**
+ * @brief A doubly linked queue through the links embedded in its elements: pushing, popping and removing
+ * from the middle neither allocate nor free, they only rewire pointers. Like safe_queue_t, every operation
+ * takes a lock, and pops can wait for a push.
+ *
+ * @class
+ */
+typedef struct IntrusiveQueue
+{
+	// @private Thread safety ensurer.
+	pthread_mutex_t _mtx;
+	// @private Signaled on every push.
+	pthread_cond_t _pushed;
+	// @private Sentinel: its next is the first element, its prev the last one.
+	queue_link_t _head;
+	// @private Where the link is inside an element.
+	size_t _offset;
+	// @private The amount of elements.
+	size_t _size;
+} intrusive_queue_t;
+
+/**
+ * @brief Initializes the links of an element, before it is first pushed.
+ *
+ * @param link the links
+ */
+void queue_link_init(queue_link_t *link);
+
+/**
+ * @brief Creates an empty queue.
+ *
+ * @param link_offset where the elements keep their links, offsetof(type, field)
+ * @return a new queue
+ */
+intrusive_queue_t *new_intrusive_queue(size_t link_offset);
+
+/**
+ * @brief Unlinks the elements left and deallocates the queue, not the elements.
+ *
+ * @param queue the queue
+ */
+void intrusive_queue_destroy(intrusive_queue_t *queue);
+
+/**
+ * @brief Adds an element at the end of the queue.
+ *
+ * @param queue the queue
+ * @param element the element, which must not be in a queue
+ * @return false if it already was in one, and nothing changed
+ */
+bool intrusive_queue_push(intrusive_queue_t *queue, void *element);
+
+/**
+ * @brief Removes the first element of the queue.
+ *
+ * @param queue the queue
+ * @return the element, or NULL if the queue is empty
+ */
+void *intrusive_queue_pop(intrusive_queue_t *queue);
+
+/**
+ * @brief Removes the first element of the queue, waiting for one if it is empty.
+ *
+ * @param queue the queue
+ * @return the element, never NULL
+ */
+void *intrusive_queue_pop_wait(intrusive_queue_t *queue);
+
+/**
+ * @brief Waits for an element and removes the one that goes first; among equals, the one queued first.
+ *
+ * @param queue the queue
+ * @param comparator should return true if the first element goes before, or together with, the second one
+ * @return the element, never NULL
+ */
+void *intrusive_queue_pop_first(intrusive_queue_t *queue, bool (*comparator)(void *, void *));
+
+/**
+ * @brief Removes an element from wherever it is in the queue.
+ *
+ * @param queue the queue
+ * @param element the element
+ * @return false if it was not in this queue
+ */
+bool intrusive_queue_remove(intrusive_queue_t *queue, void *element);
+
+/**
+ * @brief Tells whether an element is in the queue.
+ *
+ * @param queue the queue
+ * @param element the element
+ * @return true if it is
+ */
+bool intrusive_queue_contains(intrusive_queue_t *queue, void *element);
+
+/**
+ * @brief Tells whether the queue is empty.
+ *
+ * @param queue the queue
+ * @return true if no element is queued
+ */
+bool intrusive_queue_is_empty(intrusive_queue_t *queue);
+
+/**
+ * @brief Counts the elements in the queue.
+ *
+ * @param queue the queue
+ * @return the amount of elements
+ */
+size_t intrusive_queue_size(intrusive_queue_t *queue);
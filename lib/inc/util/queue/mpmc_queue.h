@@ -0,0 +1,99 @@
+/**
+ * @file mpmc_queue.h
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Lock-free bounded multi-producer multi-consumer queue
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+// Keeps the producer and consumer positions apart, so they do not bounce the same cache line.
+#define MPMC_CACHE_LINE 64
+
+/**
+ * @brief A slot of the ring: its sequence tells whose turn it is to use it.
+ *
+ */
+typedef struct MpmcCell
+{
+	// Its position while empty, that position + 1 once filled.
+	_Atomic size_t sequence;
+	// The element.
+	void *element;
+} mpmc_cell_t;
+
+/**
+ * @brief A ring of cells claimed with a compare-and-swap on the positions (Vyukov): neither push nor pop
+ * lock or allocate. Unlike safe_queue_t it is bounded and only pushes, pops and peeks; a scheduling queue
+ * that is never sorted nor searched can use either one.
+ *
+ * @class
+ */
+typedef struct MpmcQueue
+{
+	// @private The cells.
+	mpmc_cell_t *cells;
+	// @private The amount of cells minus one (a power of two minus one).
+	size_t mask;
+	// @private The next position to push.
+	_Alignas(MPMC_CACHE_LINE) _Atomic size_t tail;
+	// @private The next position to pop.
+	_Alignas(MPMC_CACHE_LINE) _Atomic size_t head;
+} mpmc_queue_t;
+
+/**
+ * @brief Creates a queue.
+ *
+ * @param capacity the most elements it holds, rounded up to a power of two
+ * @return a new queue
+ */
+mpmc_queue_t *new_mpmc_queue(size_t capacity);
+
+/**
+ * @brief Deallocates a queue and the elements left in it. Nobody else may be using it.
+ *
+ * @param queue the queue
+ * @param destroyer deallocates an element, may be NULL
+ */
+void mpmc_queue_destroy(mpmc_queue_t *queue, void (*destroyer)(void *));
+
+/**
+ * @brief Adds an element at the end of the queue.
+ *
+ * @param queue the queue
+ * @param element the element
+ * @return false if the queue is full
+ */
+bool mpmc_queue_push(mpmc_queue_t *queue, void *element);
+
+/**
+ * @brief Removes the first element of the queue.
+ *
+ * @param queue the queue
+ * @return the element, or NULL if the queue is empty
+ */
+void *mpmc_queue_pop(mpmc_queue_t *queue);
+
+/**
+ * @brief Peeks the first element of the queue; another thread may pop it right after.
+ *
+ * @param queue the queue
+ * @return the element, or NULL if the queue is empty
+ */
+void *mpmc_queue_peek(mpmc_queue_t *queue);
+
+/**
+ * @brief Tells whether the queue is empty, as of the call.
+ *
+ * @param queue the queue
+ * @return true if no element is queued
+ */
+bool mpmc_queue_is_empty(mpmc_queue_t *queue);
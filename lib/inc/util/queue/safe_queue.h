@@ -1,5 +1,6 @@
 #pragma once
 
+#include <stdint.h>
 #include <pthread.h>
 #include <commons/collections/queue.h>
 
@@ -14,6 +15,12 @@ typedef struct SafeQueue
 	 */
 	pthread_mutex_t _mtx;
 
+	/**
+	 * @brief Signaled on every push, so that a blocked pop wakes up exactly when there is an element.
+	 * @private
+	 */
+	pthread_cond_t _pushed;
+
 	/**
 	 * @brief queue implementation.
 	 * @private
@@ -61,6 +68,33 @@ void safe_queue_push(safe_queue_t *queue, void *element);
  */
 void *safe_queue_pop(safe_queue_t *queue);
 
+/**
+ * @brief Removes the first element of the queue, waiting for one if it is empty.
+ *
+ * @param queue the safe queue itself
+ * @return void* first element of the queue, never NULL
+ */
+void *safe_queue_pop_wait(safe_queue_t *queue);
+
+/**
+ * @brief Removes the first element of the queue, waiting up to a timeout for one if it is empty.
+ *
+ * @param queue the safe queue itself
+ * @param timeout_ms the most milliseconds to wait
+ * @return void* first element of the queue, or NULL if none arrived in time
+ */
+void *safe_queue_pop_timed(safe_queue_t *queue, uint32_t timeout_ms);
+
+/**
+ * @brief Waits for an element and removes as many as there are, up to a maximum, under a single lock.
+ *
+ * @param queue the safe queue itself
+ * @param elements where to leave them, in order
+ * @param max the most elements to remove
+ * @return the amount of elements removed, at least 1
+ */
+int safe_queue_drain(safe_queue_t *queue, void **elements, int max);
+
 /**
  * @brief Safe Peeks a queue of elements
  *
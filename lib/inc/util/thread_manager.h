@@ -10,6 +10,7 @@
 
 #include "lib.h"
 #include "log.h"
+#include "thread_pool.h"
 #include <pthread.h>
 
 #define N_THREADS 6
@@ -29,6 +30,8 @@ typedef struct ThreadManager
 	int max_threads;
 	// Si se inició o no
 	bool init;
+	// Los hilos reutilizables, NULL para crear un hilo por rutina
+	thread_pool_t *pool;
 } thread_manager_t;
 
 // ============================================================================================================
@@ -69,6 +72,15 @@ void mutex_unlock();
  */
 thread_manager_t new_thread_manager();
 
+/**
+ * @brief Runs the routines of a manager on a pool of reusable workers. A routine launched while every
+ * worker is busy still gets a thread of its own.
+ *
+ * @param tm the manager
+ * @param workers the amount of workers, 0 to keep a thread per routine
+ */
+void thread_manager_use_pool(thread_manager_t *tm, int workers);
+
 /**
  * @brief Frees the memory usage of a thread manager.
  *
@@ -123,7 +135,8 @@ void thread_manager_terminar_thread(void);
 void thread_manager_terminar_thread_all(void);
 
 /**
- * @brief Ends the current thread.
+ * @brief Ends the current thread. On a pool worker running a routine of this manager it returns
+ * EXIT_SUCCESS instead, so that the worker is reused: the caller must return from its routine right after.
  *
  * ! DO NOT CALL THIS METHOD FROM THE MAIN THREAD.
  *
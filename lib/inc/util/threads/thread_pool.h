@@ -0,0 +1,135 @@
+/**
+ * @file thread_pool.h
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Fixed-size pool of worker threads
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+// ============================================================================================================
+//                                   ***** Public Types  *****
+// ============================================================================================================
+
+/**
+ * @brief A routine handed to a worker.
+ *
+ */
+typedef struct ThreadPoolTask
+{
+	// The routine.
+	void *(*routine)(void *);
+	// Its argument.
+	void *args;
+	// Whoever submitted it, see thread_pool_task_owner.
+	const void *owner;
+} thread_pool_task_t;
+
+/**
+ * @brief What a pool has done so far.
+ *
+ */
+typedef struct ThreadPoolStats
+{
+	// The workers alive.
+	int workers;
+	// The workers running a task.
+	int busy;
+	// Tasks taken.
+	uint64_t submitted;
+	// Tasks whose routine returned.
+	uint64_t completed;
+	// Tasks refused because no worker was idle.
+	uint64_t rejected;
+	// The most tasks ever waiting in the queue.
+	int peak_queued;
+} thread_pool_stats_t;
+
+/**
+ * @brief Workers started once and reused for every task, fed by a bounded queue shared by any amount of
+ * submitters and workers. A task is only taken when an idle worker is there to run it: the routines of this
+ * project may run for as long as a client stays connected, so a task queued behind them could wait forever.
+ *
+ * @class
+ */
+typedef struct ThreadPool
+{
+	// @private The queue, as many slots as workers.
+	thread_pool_task_t *tasks;
+	// @private The slots.
+	int capacity;
+	// @private The next task to run.
+	int head;
+	// @private The tasks queued.
+	int queued;
+	// @private The workers waiting for a task.
+	int idle;
+	// @private The workers alive.
+	int alive;
+	// @private Set once the pool is shut down.
+	bool stopping;
+	// @private Set once shutdown returned with busy workers: the last of them frees the pool.
+	bool abandoned;
+	// @private The statistics.
+	thread_pool_stats_t stats;
+	// @private Guards everything above.
+	pthread_mutex_t mutex;
+	// @private Signaled when a task is queued or the pool shuts down.
+	pthread_cond_t ready;
+	// @private Signaled when a worker goes idle or leaves.
+	pthread_cond_t changed;
+} thread_pool_t;
+
+// ============================================================================================================
+//                                   ***** Public Functions  *****
+// ============================================================================================================
+
+/**
+ * @brief Starts a pool, returning once every worker waits for tasks.
+ *
+ * @param workers the amount of workers
+ * @return the pool, or NULL if no worker could be started
+ */
+thread_pool_t *thread_pool_create(int workers);
+
+/**
+ * @brief Hands a routine to an idle worker, never waiting for one.
+ *
+ * @param pool the pool
+ * @param routine the routine
+ * @param args its argument
+ * @param owner whoever submits it, told back by thread_pool_task_owner while it runs
+ * @return true if a worker took it, false if every worker is busy or the pool is shutting down
+ */
+bool thread_pool_submit(thread_pool_t *pool, void *(*routine)(void *), void *args, const void *owner);
+
+/**
+ * @brief Tells who submitted the task the calling thread runs.
+ *
+ * @return the owner, or NULL if the caller is not a pool worker
+ */
+const void *thread_pool_task_owner(void);
+
+/**
+ * @brief Reads the statistics of a pool.
+ *
+ * @param pool the pool
+ * @return a copy of them
+ */
+thread_pool_stats_t thread_pool_stats(thread_pool_t *pool);
+
+/**
+ * @brief Stops taking tasks and lets the idle workers go. Busy workers leave once their task returns,
+ * and the last of them frees the pool: it must not be used anymore.
+ *
+ * @param pool the pool
+ */
+void thread_pool_shutdown(thread_pool_t *pool);
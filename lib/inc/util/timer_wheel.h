@@ -0,0 +1,135 @@
+/**
+ * @file timer_wheel.h
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Cancelable timers fired by a single thread
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <time.h>
+
+// Buckets of the wheel: a timer further than a lap away waits in its bucket for as many laps.
+#define TIMER_WHEEL_SLOTS 256
+
+// No timer: timer_wheel_schedule never returns it.
+#define TIMER_NONE 0
+
+// ============================================================================================================
+//                                   ***** Public Types  *****
+// ============================================================================================================
+
+/**
+ * @brief Identifies a scheduled timer; it stays unique after the timer fires or is canceled.
+ *
+ */
+typedef uint64_t timer_id_t;
+
+/**
+ * @brief Called from the wheel thread when a timer expires. It may schedule and cancel timers.
+ *
+ * @param data the data the timer was scheduled with
+ */
+typedef void (*timer_callback_t)(void *data);
+
+/**
+ * @brief A timer, linked in its bucket or in the free entries.
+ *
+ */
+typedef struct TimerEntry
+{
+	// The tick it expires at.
+	uint64_t expiry;
+	// What to call.
+	timer_callback_t callback;
+	// Its argument.
+	void *data;
+	// Bumped every time the entry is released, so that stale ids are told apart.
+	uint32_t generation;
+	// The previous entry of the bucket, -1 if first.
+	int32_t prev;
+	// The next entry of the bucket or of the free entries, -1 if last.
+	int32_t next;
+} timer_entry_t;
+
+/**
+ * @brief A hashed timing wheel: timers hang from the bucket of their expiry tick, so scheduling and canceling
+ * are O(1), and one thread walks a bucket per tick firing what expired. It sleeps until the next tick only
+ * while timers are pending.
+ *
+ * @class
+ */
+typedef struct TimerWheel
+{
+	// @private The entries, indexed by the low half of an id.
+	timer_entry_t *entries;
+	// @private The amount of entries.
+	int32_t capacity;
+	// @private The first free entry, -1 if none.
+	int32_t free;
+	// @private The first entry of each bucket, -1 if empty.
+	int32_t slots[TIMER_WHEEL_SLOTS];
+	// @private The timers pending.
+	int armed;
+	// @private The last tick walked.
+	uint64_t tick;
+	// @private Milliseconds per tick.
+	uint32_t tick_ms;
+	// @private When tick 0 was.
+	struct timespec start;
+	// @private Cleared to stop the thread.
+	bool running;
+	// @private The thread firing the timers.
+	pthread_t thread;
+	// @private Guards everything above.
+	pthread_mutex_t mutex;
+	// @private Signaled when the first timer is armed or the wheel stops.
+	pthread_cond_t changed;
+} timer_wheel_t;
+
+// ============================================================================================================
+//                                   ***** Public Functions  *****
+// ============================================================================================================
+
+/**
+ * @brief Creates a wheel and starts its thread.
+ *
+ * @param tick_ms the resolution: a timer fires within a tick after its delay
+ * @return the wheel
+ */
+timer_wheel_t *timer_wheel_create(uint32_t tick_ms);
+
+/**
+ * @brief Schedules a timer.
+ *
+ * @param wheel the wheel
+ * @param delay_ms how long from now
+ * @param callback what to call once it expires
+ * @param data its argument
+ * @return the timer
+ */
+timer_id_t timer_wheel_schedule(timer_wheel_t *wheel, uint32_t delay_ms, timer_callback_t callback, void *data);
+
+/**
+ * @brief Cancels a timer that did not fire yet.
+ *
+ * @param wheel the wheel
+ * @param timer the timer
+ * @param data where to leave the data it was scheduled with, may be NULL
+ * @return true if it was canceled, false if it already fired, is firing or was canceled before
+ */
+bool timer_wheel_cancel(timer_wheel_t *wheel, timer_id_t timer, void **data);
+
+/**
+ * @brief Stops the wheel thread and deallocates the wheel. Pending timers never fire: their data is the caller's.
+ *
+ * @param wheel the wheel
+ */
+void timer_wheel_destroy(timer_wheel_t *wheel);
@@ -7,6 +7,8 @@
  */
 
 #include "cfg.h"
+#include "log.h"
+#include "trace.h"
 #include <commons/config.h>
 // getcwd
 #include <limits.h>
@@ -65,6 +67,24 @@ double config_double(char *key);
  */
 long config_long(char *key);
 
+/**
+ * Obtiene el key-value de la config, o un valor por defecto si la key no existe.
+ *
+ * @param key el valor de la key a leer
+ * @param por_defecto el valor si la key no está
+ * @return el valor int obtenido
+ */
+int config_int_or(char *key, int por_defecto);
+
+/**
+ * Obtiene el key-value de la config, o un valor por defecto si la key no existe.
+ *
+ * @param key el valor de la key a leer
+ * @param por_defecto el valor si la key no está
+ * @return el valor string obtenido
+ */
+char *config_string_or(char *key, char *por_defecto);
+
 // ============================================================================================================
 //                               ***** Funciones Privadas - Definiciones *****
 // ============================================================================================================
@@ -98,6 +118,16 @@ inline long config_long(char *key)
 	return config_get_long_value(this, key);
 }
 
+inline int config_int_or(char *key, int por_defecto)
+{
+	return this && config_has_property(this, key) ? config_int(key) : por_defecto;
+}
+
+inline char *config_string_or(char *key, char *por_defecto)
+{
+	return this && config_has_property(this, key) ? config_string(key) : por_defecto;
+}
+
 // ============================================================================================================
 //                               ***** Funciones Públicas, Definiciones *****
 // ============================================================================================================
@@ -134,6 +164,16 @@ int config_init(char *app_name)
 		return ERROR;
 	}
 
+	// El nivel de logs de este módulo, si el logger ya arrancó
+	int nivel = log_level_from_string(nivel_log());
+
+	if (nivel >= LOG_LEVEL_TRACE && nivel <= LOG_LEVEL_ERROR)
+		logger_set_level(nivel);
+	else
+	{
+		LOG_WARNING("[Config] :=> NIVEL_LOG=%s no es un nivel de log válido", nivel_log());
+	}
+
 	return SUCCESS;
 }
 
@@ -326,6 +366,27 @@ int entradas_tlb(void)
 	return config_int(ENTRADAS_TLB);
 }
 
+#define ACCESOS_POR_LOTE "ACCESOS_POR_LOTE"
+
+int accesos_por_lote(void)
+{
+	return config_int_or(ACCESOS_POR_LOTE, 1);
+}
+
+#define PEDIDOS_EN_VUELO "PEDIDOS_EN_VUELO"
+
+int pedidos_en_vuelo(void)
+{
+	return config_int_or(PEDIDOS_EN_VUELO, 0);
+}
+
+#define PROGRAMAS_EN_CACHE "PROGRAMAS_EN_CACHE"
+
+int programas_en_cache(void)
+{
+	return config_int_or(PROGRAMAS_EN_CACHE, 8);
+}
+
 // -----------------------------------------------------------
 //  Memoria
 // -----------------------------------------------------------
@@ -385,3 +446,84 @@ char *path_swap(void)
 {
 	return config_string(PATH_SWAP);
 }
+
+// -----------------------------------------------------------
+//  Servidor
+// -----------------------------------------------------------
+
+#define REACTORES "REACTORES"
+
+int reactores(void)
+{
+	return config_int_or(REACTORES, 0);
+}
+
+#define ACEPTADORES "ACEPTADORES"
+
+int aceptadores(void)
+{
+	return config_int_or(ACEPTADORES, 1);
+}
+
+#define HILOS_TRABAJADORES "HILOS_TRABAJADORES"
+
+int hilos_trabajadores(void)
+{
+	return config_int_or(HILOS_TRABAJADORES, 0);
+}
+
+#define TRANSPORTE "TRANSPORTE"
+
+char *transporte(void)
+{
+	return config_string_or(TRANSPORTE, "TCP");
+}
+
+#define SIN_DEMORA "SIN_DEMORA"
+
+int sin_demora(void)
+{
+	return config_int_or(SIN_DEMORA, 1);
+}
+
+#define AGRUPAR_ENVIOS "AGRUPAR_ENVIOS"
+
+int agrupar_envios(void)
+{
+	return config_int_or(AGRUPAR_ENVIOS, 0);
+}
+
+#define BUFFER_ENVIO "BUFFER_ENVIO"
+
+int buffer_envio(void)
+{
+	return config_int_or(BUFFER_ENVIO, 0);
+}
+
+#define BUFFER_RECEPCION "BUFFER_RECEPCION"
+
+int buffer_recepcion(void)
+{
+	return config_int_or(BUFFER_RECEPCION, 0);
+}
+
+#define NIVEL_LOG "NIVEL_LOG"
+
+char *nivel_log(void)
+{
+	return config_string_or(NIVEL_LOG, "TRACE");
+}
+
+#define TRAZA "TRAZA"
+
+int traza(void)
+{
+	return config_int_or(TRAZA, 0);
+}
+
+#define TRAZA_REGISTROS "TRAZA_REGISTROS"
+
+int traza_registros(void)
+{
+	return config_int_or(TRAZA_REGISTROS, TRACE_DEFAULT_RECORDS);
+}
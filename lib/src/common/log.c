@@ -10,8 +10,20 @@
 #include "log.h"
 // strcat
 #include <string.h>
-// mutex
+// malloc
+#include <stdlib.h>
+// threads
 #include <pthread.h>
+// atomics
+#include <stdatomic.h>
+// va_list
+#include <stdarg.h>
+// sched_yield
+#include <sched.h>
+// gettid
+#include <sys/syscall.h>
+// clock_gettime
+#include <time.h>
 // getcwd
 #include <limits.h>
 
@@ -21,13 +33,254 @@
 
 // Único y estático Logger.
 static t_log *this;
-// Mutex del logger
-static pthread_mutex_t mutex;
 // El mínimoo nivel de loggeo.
 #define MIN_LEVEL LOG_LEVEL_TRACE
 // Si la consola va a estar activa
 #define CONSOLA_ACITVA true
 
+// Largo máximo de un mensaje: los más largos se truncan.
+#define LOG_MESSAGE_MAX 512
+// Mensajes que un hilo puede tener pendientes de escribir.
+#define LOG_RING_SIZE 256
+// Bytes que el escritor junta antes de escribir.
+#define LOG_BATCH_SIZE (64 * 1024)
+// Cada cuánto revisa el escritor los buffers cuando no hay nada pendiente [us].
+#define LOG_IDLE_US 2000
+
+/**
+ * @brief Un mensaje ya formateado, esperando a ser escrito.
+ *
+ */
+typedef struct LogRecord
+{
+	struct timespec time;
+	pid_t thread;
+	t_log_level level;
+	char message[LOG_MESSAGE_MAX];
+} log_record_t;
+
+/**
+ * @brief Los mensajes pendientes de un hilo: él solo los agrega, el escritor solo los saca.
+ *
+ */
+typedef struct LogRing
+{
+	log_record_t records[LOG_RING_SIZE];
+	// Próximo lugar a llenar (lo mueve el hilo dueño).
+	_Alignas(64) _Atomic size_t tail;
+	// Próximo mensaje a escribir (lo mueve el escritor).
+	_Alignas(64) _Atomic size_t head;
+	// Mensajes descartados por encontrar el buffer lleno.
+	_Atomic unsigned long dropped;
+	// Su hilo terminó: otro lo puede adoptar.
+	_Atomic bool orphaned;
+	// El siguiente buffer registrado, fijo una vez publicado.
+	struct LogRing *next;
+} log_ring_t;
+
+// Los buffers de todos los hilos que alguna vez loggearon; nunca se liberan, se reutilizan.
+static _Atomic(log_ring_t *) rings;
+// El buffer del hilo actual.
+static __thread log_ring_t *own;
+// El id del hilo actual, 0 hasta que loggea.
+static __thread pid_t own_thread;
+// Marca el buffer como huérfano cuando su hilo termina.
+static pthread_key_t ring_key;
+static pthread_once_t ring_key_once = PTHREAD_ONCE_INIT;
+// El hilo que escribe.
+static pthread_t writer;
+static _Atomic bool writing;
+
+// ============================================================================================================
+//                               ***** Funciones Privadas *****
+// ============================================================================================================
+
+static void orphan_ring(void *ring)
+{
+	atomic_store(&((log_ring_t *)ring)->orphaned, true);
+}
+
+static void create_ring_key(void)
+{
+	pthread_key_create(&ring_key, orphan_ring);
+}
+
+/**
+ * @brief Obtiene el buffer del hilo actual: adopta el de un hilo terminado o, si no hay, registra uno nuevo.
+ *
+ */
+static log_ring_t *own_ring(void)
+{
+	if (own)
+		return own;
+
+	for (log_ring_t *ring = atomic_load(&rings); ring && !own; ring = ring->next)
+	{
+		bool orphaned = true;
+
+		if (atomic_compare_exchange_strong(&ring->orphaned, &orphaned, false))
+			own = ring;
+	}
+
+	if (!own)
+	{
+		own = calloc(1, sizeof(log_ring_t));
+		own->next = atomic_load(&rings);
+
+		while (!atomic_compare_exchange_weak(&rings, &own->next, own))
+			;
+	}
+
+	own_thread = (pid_t)syscall(SYS_gettid);
+	pthread_setspecific(ring_key, own);
+
+	return own;
+}
+
+/**
+ * @brief Agrega una línea con el formato de las commons a un lote.
+ *
+ * @return los bytes agregados, nunca más de los que entran: una línea que no entra se trunca
+ */
+static size_t format_line(char *batch, size_t used, t_log_level level, struct timespec time, pid_t thread, const char *message)
+{
+	struct tm local;
+	localtime_r(&time.tv_sec, &local);
+
+	size_t free_space = LOG_BATCH_SIZE - used;
+	int length = snprintf(batch + used, free_space, "[%s] %02d:%02d:%02d:%03ld %s/(%d:%d): %s\n",
+						  log_level_as_string(level), local.tm_hour, local.tm_min, local.tm_sec, time.tv_nsec / 1000000,
+						  this->program_name, getpid(), thread, message);
+
+	if (length <= 0)
+		return 0;
+
+	// snprintf cuenta lo que hubiera escrito, no lo que escribió
+	return (size_t)length < free_space ? (size_t)length : free_space - 1;
+}
+
+static void write_batch(char *batch, size_t used)
+{
+	if (used EQ 0)
+		return;
+
+	if (this->file)
+	{
+		fwrite(batch, 1, used, (FILE *)this->file);
+		fflush((FILE *)this->file);
+	}
+
+	if (this->is_active_console)
+	{
+		fwrite(batch, 1, used, stdout);
+		fflush(stdout);
+	}
+}
+
+/**
+ * @brief Escribe el lote si una línea más podría no entrar.
+ *
+ */
+static void make_room(char *batch, size_t *used)
+{
+	if (LOG_BATCH_SIZE - *used < LOG_MESSAGE_MAX + 128)
+	{
+		write_batch(batch, *used);
+		*used = 0;
+	}
+}
+
+static bool before(struct timespec a, struct timespec b)
+{
+	return a.tv_sec < b.tv_sec || (a.tv_sec EQ b.tv_sec && a.tv_nsec < b.tv_nsec);
+}
+
+/**
+ * @brief Escribe lo pendiente en todos los buffers, intercalando los mensajes por hora.
+ *
+ * @return cuántos mensajes escribió
+ */
+static size_t drain(char *batch)
+{
+	size_t used = 0, drained = 0;
+
+	for (;;)
+	{
+		log_ring_t *first = NULL;
+		log_record_t *record = NULL;
+
+		for (log_ring_t *ring = atomic_load(&rings); ring; ring = ring->next)
+		{
+			size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+
+			if (head EQ atomic_load_explicit(&ring->tail, memory_order_acquire))
+				continue;
+
+			log_record_t *candidate = &ring->records[head % LOG_RING_SIZE];
+
+			if (record EQ NULL || before(candidate->time, record->time))
+			{
+				first = ring;
+				record = candidate;
+			}
+		}
+
+		if (record EQ NULL)
+			break;
+
+		make_room(batch, &used);
+		used += format_line(batch, used, record->level, record->time, record->thread, record->message);
+		atomic_store_explicit(&first->head, atomic_load_explicit(&first->head, memory_order_relaxed) + 1, memory_order_release);
+		drained++;
+	}
+
+	for (log_ring_t *ring = atomic_load(&rings); ring; ring = ring->next)
+	{
+		unsigned long dropped = atomic_exchange(&ring->dropped, 0);
+
+		if (dropped > 0)
+		{
+			char message[LOG_MESSAGE_MAX];
+			struct timespec now;
+			clock_gettime(CLOCK_REALTIME, &now);
+			snprintf(message, sizeof(message), "Log buffer full: %lu messages were dropped", dropped);
+			make_room(batch, &used);
+			used += format_line(batch, used, LOG_LEVEL_WARNING, now, 0, message);
+		}
+	}
+
+	write_batch(batch, used);
+
+	return drained;
+}
+
+/**
+ * @brief El escritor: vacía los buffers por lotes hasta que se cierra el logger, y una vez más al cerrarse.
+ *
+ */
+static void *write_logs(void *unused)
+{
+	(void)unused;
+	char *batch = malloc(LOG_BATCH_SIZE);
+
+	for (;;)
+	{
+		bool closing = !atomic_load(&writing);
+
+		if (drain(batch) EQ 0)
+		{
+			if (closing)
+				break;
+
+			usleep(LOG_IDLE_US);
+		}
+	}
+
+	free(batch);
+
+	return NULL;
+}
+
 // ============================================================================================================
 //                               ***** Funciones Públicas, Definiciones *****
 // ============================================================================================================
@@ -64,7 +317,11 @@ int log_init(char *app_name, bool consola)
 
 	if (this)
 	{
-		pthread_mutex_init(&mutex, NULL);
+		pthread_once(&ring_key_once, create_ring_key);
+
+		if (!atomic_exchange(&writing, true))
+			pthread_create(&writer, NULL, write_logs, NULL);
+
 		return SUCCESS;
 	}
 	else
@@ -78,12 +335,21 @@ inline void log_close(void)
 {
 	if (this)
 	{
-		pthread_mutex_destroy(&mutex);
+		// Lo que quede se escribe antes de cerrar
+		if (atomic_exchange(&writing, false))
+			pthread_join(writer, NULL);
+
 		log_destroy(this);
 		this = NULL;
 	}
 }
 
+void logger_set_level(t_log_level level)
+{
+	if (this)
+		this->detail = level;
+}
+
 // -----------------------------------------------------------
 //  Getter
 // ------------------------------------------------------------
@@ -93,11 +359,40 @@ t_log *logger(void)
 	return this;
 }
 
-void logger_lock(void)
+bool logger_enabled(t_log_level level)
 {
-	pthread_mutex_lock(&mutex);
+	return this && level >= this->detail;
 }
-void logger_unlock(void)
+
+void logger_write(t_log_level level, const char *format, ...)
 {
-	pthread_mutex_unlock(&mutex);
+	if (this EQ NULL || level < this->detail)
+		return;
+
+	log_ring_t *ring = own_ring();
+	size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+	// Lleno: el escritor se atrasó
+	while (tail - atomic_load_explicit(&ring->head, memory_order_acquire) >= LOG_RING_SIZE)
+	{
+		if (level < LOG_LEVEL_ERROR || !atomic_load(&writing))
+		{
+			atomic_fetch_add(&ring->dropped, 1);
+			return;
+		}
+
+		sched_yield();
+	}
+
+	log_record_t *record = &ring->records[tail % LOG_RING_SIZE];
+	clock_gettime(CLOCK_REALTIME, &record->time);
+	record->thread = own_thread;
+	record->level = level;
+
+	va_list arguments;
+	va_start(arguments, format);
+	vsnprintf(record->message, LOG_MESSAGE_MAX, format, arguments);
+	va_end(arguments);
+
+	atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
 }
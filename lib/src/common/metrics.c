@@ -0,0 +1,517 @@
+/**
+ * @file metrics.c
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Metrics of every module: counters, gauges and latency histograms, written without locks.
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <semaphore.h>
+
+#include "metrics.h"
+#include "lib.h"
+#include "log.h"
+
+// ============================================================================================================
+//                               ***** Definitions *****
+// ============================================================================================================
+
+typedef struct MetricInfo
+{
+	const char *name;
+	metric_kind_t kind;
+} metric_info_t;
+
+static const metric_info_t METRIC_INFO[METRICS] = {
+	[METRIC_READY_QUEUE] = {"kernel.ready_queue", METRIC_GAUGE},
+	[METRIC_BLOCKED_QUEUE] = {"kernel.blocked_queue", METRIC_GAUGE},
+	[METRIC_SUSPENDED_QUEUE] = {"kernel.suspended_queue", METRIC_GAUGE},
+	[METRIC_DISPATCH_LATENCY] = {"kernel.dispatch_latency_us", METRIC_HISTOGRAM},
+	[METRIC_CPU_BURST] = {"kernel.cpu_burst_ms", METRIC_HISTOGRAM},
+	[METRIC_PREEMPTIONS] = {"kernel.preemptions", METRIC_COUNTER},
+	[METRIC_SUSPENSIONS] = {"kernel.suspensions", METRIC_COUNTER},
+	[METRIC_INSTRUCTIONS] = {"cpu.instructions", METRIC_COUNTER},
+	[METRIC_TLB_HITS] = {"cpu.tlb_hits", METRIC_COUNTER},
+	[METRIC_TLB_MISSES] = {"cpu.tlb_misses", METRIC_COUNTER},
+	[METRIC_TLB_REPLACEMENTS] = {"cpu.tlb_replacements", METRIC_COUNTER},
+	[METRIC_MEMORY_REQUEST_LATENCY] = {"cpu.memory_request_latency_us", METRIC_HISTOGRAM},
+	[METRIC_MEMORY_READS] = {"memory.reads", METRIC_COUNTER},
+	[METRIC_MEMORY_WRITES] = {"memory.writes", METRIC_COUNTER},
+	[METRIC_FRAMES_IN_USE] = {"memory.frames_in_use", METRIC_GAUGE},
+	[METRIC_PROCESS_FRAMES] = {"memory.process_frames", METRIC_PROCESS_GAUGE},
+	[METRIC_PAGE_FAULTS] = {"memory.page_faults", METRIC_PROCESS_COUNTER},
+	[METRIC_FRAME_REPLACEMENTS] = {"memory.frame_replacements", METRIC_COUNTER},
+	[METRIC_SWAP_OUT_BYTES] = {"memory.swap_out_bytes", METRIC_COUNTER},
+	[METRIC_SWAP_IN_BYTES] = {"memory.swap_in_bytes", METRIC_COUNTER},
+	[METRIC_SWAP_LATENCY] = {"memory.swap_latency_us", METRIC_HISTOGRAM},
+};
+
+/**
+ * @brief The values a thread recorded in a histogram: only that thread writes them.
+ *
+ */
+typedef struct Histogram
+{
+	_Atomic uint64_t buckets[HISTOGRAM_BUCKETS];
+	_Atomic uint64_t count;
+	_Atomic uint64_t sum;
+	_Atomic uint64_t max;
+} histogram_t;
+
+/**
+ * @brief What a thread recorded. It is never freed: when the thread ends, the next new one adopts it and
+ * keeps adding, so that totals never go back.
+ *
+ */
+typedef struct MetricsShard
+{
+	_Atomic uint64_t counters[METRICS];
+	// Allocated on the first value, by the owner.
+	_Atomic(histogram_t *) histograms[METRICS];
+	_Atomic bool orphaned;
+	struct MetricsShard *next;
+} metrics_shard_t;
+
+// Every shard: only ever pushed.
+static _Atomic(metrics_shard_t *) shards;
+// The shard of the current thread.
+static __thread metrics_shard_t *own;
+
+static pthread_key_t shard_key;
+static pthread_once_t shard_key_once = PTHREAD_ONCE_INIT;
+
+// Gauges are shared: the last value wins.
+static _Atomic int64_t gauges[METRICS];
+// Per-process breakdowns, allocated on first use; gauges go down by wrapping around.
+static _Atomic(_Atomic uint64_t *) by_process[METRICS];
+
+// The module reported, and where its snapshots go.
+static char app[MAX_CHARS];
+static char dump_path[MAX_CHARS * 2];
+static uint64_t started;
+// Wakes the thread that writes snapshots.
+static sem_t dump_requests;
+static _Atomic bool dumping;
+
+// ============================================================================================================
+//                               ***** Private Functions *****
+// ============================================================================================================
+
+static void orphan_shard(void *shard)
+{
+	atomic_store(&((metrics_shard_t *)shard)->orphaned, true);
+}
+
+static void create_shard_key(void)
+{
+	pthread_key_create(&shard_key, orphan_shard);
+}
+
+/**
+ * @brief The shard of the current thread: adopts the one of an ended thread or, if none, registers a new one.
+ *
+ */
+static metrics_shard_t *own_shard(void)
+{
+	if (own)
+		return own;
+
+	pthread_once(&shard_key_once, create_shard_key);
+
+	for (metrics_shard_t *shard = atomic_load(&shards); shard && !own; shard = shard->next)
+	{
+		bool orphaned = true;
+
+		if (atomic_compare_exchange_strong(&shard->orphaned, &orphaned, false))
+			own = shard;
+	}
+
+	if (!own)
+	{
+		own = calloc(1, sizeof(metrics_shard_t));
+		own->next = atomic_load(&shards);
+
+		while (!atomic_compare_exchange_weak(&shards, &own->next, own))
+			;
+	}
+
+	pthread_setspecific(shard_key, own);
+
+	return own;
+}
+
+// Only the owner writes: a plain load and store is enough, readers just see it a bit later
+static inline void bump(_Atomic uint64_t *value, uint64_t amount)
+{
+	atomic_store_explicit(value, atomic_load_explicit(value, memory_order_relaxed) + amount, memory_order_relaxed);
+}
+
+static uint32_t bucket_of(uint64_t value)
+{
+	if (value < HISTOGRAM_EXACT)
+		return (uint32_t)value;
+
+	uint32_t shift = 63 - __builtin_clzll(value) - 4;
+
+	return shift * (HISTOGRAM_EXACT / 2) + (uint32_t)(value >> shift);
+}
+
+// The highest value of a bucket
+static uint64_t bucket_top(uint32_t bucket)
+{
+	if (bucket < HISTOGRAM_EXACT)
+		return bucket;
+
+	uint32_t shift = bucket / (HISTOGRAM_EXACT / 2) - 1;
+	uint64_t top = bucket % (HISTOGRAM_EXACT / 2) + HISTOGRAM_EXACT / 2;
+
+	return ((top + 1) << shift) - 1;
+}
+
+static _Atomic uint64_t *process_counts(metric_t metric)
+{
+	_Atomic uint64_t *counts = atomic_load_explicit(&by_process[metric], memory_order_acquire);
+
+	if (counts EQ NULL)
+	{
+		_Atomic uint64_t *allocated = calloc(PIDS, sizeof(_Atomic uint64_t));
+
+		if (atomic_compare_exchange_strong(&by_process[metric], &counts, allocated))
+			counts = allocated;
+		else
+			free(allocated);
+	}
+
+	return counts;
+}
+
+/**
+ * @brief Adds up the histograms of every thread.
+ *
+ */
+static void merge_histogram(metric_t metric, histogram_t *total)
+{
+	memset(total, 0, sizeof(histogram_t));
+
+	for (metrics_shard_t *shard = atomic_load(&shards); shard; shard = shard->next)
+	{
+		histogram_t *histogram = atomic_load_explicit(&shard->histograms[metric], memory_order_acquire);
+
+		if (histogram EQ NULL)
+			continue;
+
+		for (uint32_t i = 0; i < HISTOGRAM_BUCKETS; i++)
+			total->buckets[i] += atomic_load_explicit(&histogram->buckets[i], memory_order_relaxed);
+
+		total->count += atomic_load_explicit(&histogram->count, memory_order_relaxed);
+		total->sum += atomic_load_explicit(&histogram->sum, memory_order_relaxed);
+
+		uint64_t max = atomic_load_explicit(&histogram->max, memory_order_relaxed);
+
+		if (max > total->max)
+			total->max = max;
+	}
+}
+
+static uint64_t percentile_of(histogram_t *histogram, double quantile)
+{
+	if (histogram->count EQ 0)
+		return 0;
+
+	uint64_t rank = (uint64_t)(quantile * (double)histogram->count);
+	uint64_t seen = 0;
+
+	if (rank EQ 0)
+		rank = 1;
+
+	for (uint32_t i = 0; i < HISTOGRAM_BUCKETS; i++)
+	{
+		seen += histogram->buckets[i];
+
+		if (seen >= rank)
+			return bucket_top(i) < histogram->max ? bucket_top(i) : histogram->max;
+	}
+
+	return histogram->max;
+}
+
+static void *write_dumps(void *unused)
+{
+	(void)unused;
+
+	for (;;)
+	{
+		sem_wait(&dump_requests);
+		// Logged here, as the handler that asked for it cannot use the logger
+		LOG_WARNING("[Metrics] :=> Snapshot requested");
+		metrics_dump();
+	}
+
+	return NULL;
+}
+
+// ============================================================================================================
+//                               ***** Public Functions *****
+// ============================================================================================================
+
+int metrics_init(char *app_name)
+{
+	if (strlen(app_name) >= MAX_CHARS)
+		return ERROR;
+
+	strcpy(app, app_name);
+	started = metrics_now();
+
+	// Next to the logs, as log_init finds them
+	char cwd[MAX_CHARS] = "";
+
+	if (getcwd(cwd, sizeof(cwd)) != NULL && strstr(cwd, app_name) EQ NULL && strstr(cwd, "build") EQ NULL)
+		snprintf(dump_path, sizeof(dump_path), "%s/log/%s%s", cwd, app_name, METRICS_EXTENSION);
+	else
+		snprintf(dump_path, sizeof(dump_path), "../log/%s%s", app_name, METRICS_EXTENSION);
+
+	if (!atomic_exchange(&dumping, true))
+	{
+		pthread_t writer;
+		sem_init(&dump_requests, 0, 0);
+
+		if (pthread_create(&writer, NULL, write_dumps, NULL) != 0)
+		{
+			atomic_store(&dumping, false);
+			return ERROR;
+		}
+
+		pthread_detach(writer);
+		atexit(metrics_dump);
+	}
+
+	LOG_DEBUG("[Metrics] :=> Snapshots go to %s (kill -USR1 %d)", dump_path, getpid());
+
+	return SUCCESS;
+}
+
+void metrics_request_dump(void)
+{
+	if (atomic_load(&dumping))
+		sem_post(&dump_requests);
+}
+
+void metrics_dump(void)
+{
+	size_t length = metrics_format(NULL, 0);
+	char *snapshot = malloc(length + 1);
+	metrics_format(snapshot, length + 1);
+
+	FILE *file = fopen(dump_path, "w");
+
+	if (file)
+	{
+		fputs(snapshot, file);
+		fclose(file);
+		LOG_INFO("[Metrics] :=> Snapshot written to %s", dump_path);
+	}
+	else
+	{
+		LOG_ERROR("[Metrics] :=> Could not write the snapshot to %s", dump_path);
+	}
+
+	free(snapshot);
+}
+
+uint64_t metrics_now(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (uint64_t)now.tv_sec * 1000000ull + (uint64_t)now.tv_nsec / 1000ull;
+}
+
+// -----------------------------------------------------------
+//  Recording
+// ------------------------------------------------------------
+
+void metrics_add(metric_t metric, uint64_t amount)
+{
+	bump(&own_shard()->counters[metric], amount);
+}
+
+void metrics_add_process(metric_t metric, uint32_t pid, uint64_t amount)
+{
+	metrics_add(metric, amount);
+
+	if (pid < PIDS)
+		atomic_fetch_add_explicit(&process_counts(metric)[pid], amount, memory_order_relaxed);
+}
+
+void metrics_gauge_add(metric_t metric, int64_t delta)
+{
+	atomic_fetch_add_explicit(&gauges[metric], delta, memory_order_relaxed);
+}
+
+void metrics_gauge_set(metric_t metric, int64_t value)
+{
+	atomic_store_explicit(&gauges[metric], value, memory_order_relaxed);
+}
+
+void metrics_gauge_add_process(metric_t metric, uint32_t pid, int64_t delta)
+{
+	metrics_gauge_add(metric, delta);
+
+	if (pid < PIDS)
+		atomic_fetch_add_explicit(&process_counts(metric)[pid], (uint64_t)delta, memory_order_relaxed);
+}
+
+void metrics_gauge_set_process(metric_t metric, uint32_t pid, int64_t value)
+{
+	if (pid >= PIDS)
+		return;
+
+	uint64_t previous = atomic_exchange_explicit(&process_counts(metric)[pid], (uint64_t)value, memory_order_relaxed);
+
+	metrics_gauge_add(metric, value - (int64_t)previous);
+}
+
+void metrics_record(metric_t metric, uint64_t value)
+{
+	metrics_shard_t *shard = own_shard();
+	histogram_t *histogram = atomic_load_explicit(&shard->histograms[metric], memory_order_relaxed);
+
+	if (histogram EQ NULL)
+	{
+		histogram = calloc(1, sizeof(histogram_t));
+		atomic_store_explicit(&shard->histograms[metric], histogram, memory_order_release);
+	}
+
+	bump(&histogram->buckets[bucket_of(value)], 1);
+	bump(&histogram->count, 1);
+	bump(&histogram->sum, value);
+
+	if (value > atomic_load_explicit(&histogram->max, memory_order_relaxed))
+		atomic_store_explicit(&histogram->max, value, memory_order_relaxed);
+}
+
+// -----------------------------------------------------------
+//  Reading
+// ------------------------------------------------------------
+
+uint64_t metrics_count(metric_t metric)
+{
+	uint64_t total = 0;
+
+	for (metrics_shard_t *shard = atomic_load(&shards); shard; shard = shard->next)
+	{
+		if (METRIC_INFO[metric].kind EQ METRIC_HISTOGRAM)
+		{
+			histogram_t *histogram = atomic_load_explicit(&shard->histograms[metric], memory_order_acquire);
+			total += histogram ? atomic_load_explicit(&histogram->count, memory_order_relaxed) : 0;
+		}
+		else
+			total += atomic_load_explicit(&shard->counters[metric], memory_order_relaxed);
+	}
+
+	return total;
+}
+
+uint64_t metrics_process_count(metric_t metric, uint32_t pid)
+{
+	_Atomic uint64_t *counts = atomic_load_explicit(&by_process[metric], memory_order_acquire);
+
+	return counts && pid < PIDS ? atomic_load_explicit(&counts[pid], memory_order_relaxed) : 0;
+}
+
+int64_t metrics_gauge(metric_t metric)
+{
+	return atomic_load_explicit(&gauges[metric], memory_order_relaxed);
+}
+
+uint64_t metrics_percentile(metric_t metric, double quantile)
+{
+	histogram_t total;
+	merge_histogram(metric, &total);
+
+	return percentile_of(&total, quantile);
+}
+
+const char *metrics_name(metric_t metric)
+{
+	return metric < METRICS ? METRIC_INFO[metric].name : "unknown";
+}
+
+size_t metrics_format(char *buffer, size_t size)
+{
+	size_t length = 0;
+	size_t prefix = strlen(app);
+
+// Keeps counting past the end of the buffer, as snprintf does
+#define APPEND(...) length += (size_t)snprintf(length < size ? buffer + length : NULL, length < size ? size - length : 0, __VA_ARGS__)
+
+	if (size > 0)
+		buffer[0] = '\0';
+
+	APPEND("# %s metrics after %lus\n", prefix ? app : "all", (unsigned long)((metrics_now() - started) / 1000000));
+
+	for (metric_t metric = 0; metric < METRICS; metric++)
+	{
+		const metric_info_t *info = &METRIC_INFO[metric];
+
+		// Only the metrics of this module
+		if (prefix && (strncmp(info->name, app, prefix) != 0 || info->name[prefix] != '.'))
+			continue;
+
+		switch (info->kind)
+		{
+		case METRIC_GAUGE:
+			APPEND("%s %ld\n", info->name, (long)metrics_gauge(metric));
+			break;
+
+		case METRIC_HISTOGRAM:
+		{
+			histogram_t total;
+			merge_histogram(metric, &total);
+			APPEND("%s count=%lu mean=%lu p50=%lu p90=%lu p99=%lu max=%lu\n", info->name,
+				   (unsigned long)total.count, (unsigned long)(total.count ? total.sum / total.count : 0),
+				   (unsigned long)percentile_of(&total, 0.5), (unsigned long)percentile_of(&total, 0.9),
+				   (unsigned long)percentile_of(&total, 0.99), (unsigned long)total.max);
+			break;
+		}
+
+		case METRIC_PROCESS_COUNTER:
+			APPEND("%s %lu", info->name, (unsigned long)metrics_count(metric));
+
+			for (uint32_t pid = 0; pid < PIDS; pid++)
+				if (metrics_process_count(metric, pid) > 0)
+					APPEND(" pid%u=%lu", pid, (unsigned long)metrics_process_count(metric, pid));
+
+			APPEND("\n");
+			break;
+
+		case METRIC_PROCESS_GAUGE:
+			APPEND("%s %ld", info->name, (long)metrics_gauge(metric));
+
+			for (uint32_t pid = 0; pid < PIDS; pid++)
+				if (metrics_process_count(metric, pid) != 0)
+					APPEND(" pid%u=%ld", pid, (long)metrics_process_count(metric, pid));
+
+			APPEND("\n");
+			break;
+
+		default:
+			APPEND("%s %lu\n", info->name, (unsigned long)metrics_count(metric));
+			break;
+		}
+	}
+
+#undef APPEND
+
+	return length;
+}
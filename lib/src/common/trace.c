@@ -0,0 +1,282 @@
+/**
+ * @file trace.c
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Binary event recorder: fixed-size records in a memory mapped ring file per thread.
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+// gettid
+#include <sys/syscall.h>
+
+#include "trace.h"
+#include "cfg.h"
+#include "log.h"
+
+// ============================================================================================================
+//                               ***** Definitions *****
+// ============================================================================================================
+
+static const char *const EVENT_NAMES[TRACE_EVENTS] = {
+	[TRACE_PROCESS_ADMITTED] = "ADMITTED",
+	[TRACE_PROCESS_DISPATCHED] = "DISPATCHED",
+	[TRACE_PROCESS_RETURNED] = "RETURNED",
+	[TRACE_PROCESS_PREEMPTED] = "PREEMPTED",
+	[TRACE_PROCESS_BLOCKED] = "BLOCKED",
+	[TRACE_PROCESS_UNBLOCKED] = "UNBLOCKED",
+	[TRACE_PROCESS_EXITED] = "EXITED",
+	[TRACE_PROCESS_SUSPENDED] = "SUSPENDED",
+	[TRACE_PROCESS_SUSPENDED_READY] = "SUSPENDED_READY",
+	[TRACE_IO_STARTED] = "IO_STARTED",
+	[TRACE_IO_FINISHED] = "IO_FINISHED",
+	[TRACE_TLB_HIT] = "TLB_HIT",
+	[TRACE_TLB_MISS] = "TLB_MISS",
+	[TRACE_TLB_REPLACED] = "TLB_REPLACED",
+	[TRACE_PAGE_FAULT] = "PAGE_FAULT",
+	[TRACE_FRAME_REPLACED] = "FRAME_REPLACED",
+	[TRACE_PAGE_UNSWAPPED] = "PAGE_UNSWAPPED",
+};
+
+static const char *const MODULE_NAMES[] = {
+	[TRACE_MODULE_UNKNOWN] = "unknown",
+	[TRACE_MODULE_KERNEL] = "kernel",
+	[TRACE_MODULE_CPU] = "cpu",
+	[TRACE_MODULE_MEMORY] = "memory",
+	[TRACE_MODULE_CONSOLE] = "console",
+};
+
+#define MODULES (sizeof(MODULE_NAMES) / sizeof(MODULE_NAMES[0]))
+
+// The decoder reads the files as they are: the layout cannot move silently
+_Static_assert(sizeof(trace_header_t) EQ 64, "trace header must be 64 bytes");
+_Static_assert(sizeof(trace_record_t) EQ 32, "trace records must be 32 bytes");
+
+// Whether events are recorded.
+static _Atomic bool active;
+// Bumped on every start, so that threads drop the files of a previous one.
+static _Atomic uint32_t session;
+// Where and how the files of this session are created; only written before it is active.
+static char folder[MAX_CHARS];
+static char app[MAX_CHARS];
+static uint16_t module;
+static uint32_t capacity;
+
+// Unmaps the file of a thread when it ends.
+static pthread_key_t ring_key;
+static pthread_once_t ring_key_once = PTHREAD_ONCE_INIT;
+
+// The file of the current thread, and the session it belongs to.
+static __thread trace_header_t *own;
+static __thread uint32_t own_session;
+// So that a thread that could not create its file does not retry on every event.
+static __thread bool own_failed;
+
+// ============================================================================================================
+//                               ***** Private Functions *****
+// ============================================================================================================
+
+static size_t ring_size(trace_header_t *ring)
+{
+	return sizeof(trace_header_t) + ring->capacity * sizeof(trace_record_t);
+}
+
+static void unmap_ring(void *ring)
+{
+	munmap(ring, ring_size(ring));
+}
+
+static void create_ring_key(void)
+{
+	pthread_key_create(&ring_key, unmap_ring);
+}
+
+static void drop_own_ring(void)
+{
+	if (own)
+	{
+		pthread_setspecific(ring_key, NULL);
+		unmap_ring(own);
+	}
+
+	own = NULL;
+	own_failed = false;
+}
+
+/**
+ * @brief Creates and maps the file of the current thread, sized for the whole ring up front.
+ *
+ */
+static trace_header_t *map_ring(void)
+{
+	uint32_t thread = (uint32_t)syscall(SYS_gettid);
+	char path[MAX_CHARS * 2];
+	if (snprintf(path, sizeof(path), "%s%s.%u%s", folder, app, thread, TRACE_EXTENSION) >= (int)sizeof(path))
+		return NULL;
+
+	int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+	if (fd EQ ERROR)
+		return NULL;
+
+	size_t size = sizeof(trace_header_t) + (size_t)capacity * sizeof(trace_record_t);
+	trace_header_t *ring = ftruncate(fd, (off_t)size) EQ ERROR
+							   ? MAP_FAILED
+							   : mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if (ring EQ MAP_FAILED)
+		return NULL;
+
+	memcpy(ring->magic, TRACE_MAGIC, sizeof(TRACE_MAGIC));
+	ring->version = TRACE_VERSION;
+	ring->record_size = sizeof(trace_record_t);
+	ring->capacity = capacity;
+	ring->process = (uint32_t)getpid();
+	ring->thread = thread;
+	ring->written = 0;
+
+	return ring;
+}
+
+static trace_header_t *own_ring(void)
+{
+	uint32_t current = atomic_load_explicit(&session, memory_order_acquire);
+
+	if (own_session != current)
+	{
+		drop_own_ring();
+		own_session = current;
+	}
+
+	if (own || own_failed)
+		return own;
+
+	pthread_once(&ring_key_once, create_ring_key);
+	own = map_ring();
+	own_failed = own EQ NULL;
+
+	if (own)
+		pthread_setspecific(ring_key, own);
+	else
+	{
+		LOG_ERROR("[Trace] :=> Could not create the trace file of thread %ld", (long)syscall(SYS_gettid));
+	}
+
+	return own;
+}
+
+static uint16_t module_of(const char *app_name)
+{
+	for (uint16_t i = 1; i < MODULES; i++)
+		if (strcmp(app_name, MODULE_NAMES[i]) EQ 0)
+			return i;
+
+	return TRACE_MODULE_UNKNOWN;
+}
+
+// ============================================================================================================
+//                               ***** Public Functions *****
+// ============================================================================================================
+
+int trace_init(char *app_name)
+{
+	if (!traza())
+		return SUCCESS;
+
+	// Next to the logs, as log_init finds them
+	char cwd[MAX_CHARS] = "";
+	char trace_folder[MAX_CHARS] = "../log/";
+
+	if (getcwd(cwd, sizeof(cwd)) != NULL && strstr(cwd, app_name) EQ NULL && strstr(cwd, "build") EQ NULL)
+		if (snprintf(trace_folder, sizeof(trace_folder), "%s/log/", cwd) >= (int)sizeof(trace_folder))
+			return ERROR;
+
+	int records = traza_registros();
+
+	if (trace_start(trace_folder, app_name, records > 0 ? (uint32_t)records : TRACE_DEFAULT_RECORDS) EQ ERROR)
+	{
+		LOG_ERROR("[Trace] :=> Could not start tracing in %s", trace_folder);
+		return ERROR;
+	}
+
+	LOG_INFO("[Trace] :=> Recording events in %s%s.<tid>%s", trace_folder, app_name, TRACE_EXTENSION);
+
+	return SUCCESS;
+}
+
+int trace_start(const char *trace_folder, const char *app_name, uint32_t records)
+{
+	if (records EQ 0 || strlen(trace_folder) >= MAX_CHARS || strlen(app_name) >= MAX_CHARS)
+		return ERROR;
+
+	atomic_store(&active, false);
+
+	strcpy(folder, trace_folder);
+	strcpy(app, app_name);
+	module = module_of(app_name);
+	capacity = records;
+
+	atomic_fetch_add_explicit(&session, 1, memory_order_release);
+	atomic_store(&active, true);
+
+	return SUCCESS;
+}
+
+void trace_close(void)
+{
+	atomic_store(&active, false);
+	drop_own_ring();
+}
+
+bool trace_active(void)
+{
+	return atomic_load_explicit(&active, memory_order_relaxed);
+}
+
+void trace_event(trace_event_t event, uint32_t pid, uint64_t arg0, uint64_t arg1)
+{
+	if (!atomic_load_explicit(&active, memory_order_relaxed))
+		return;
+
+	trace_header_t *ring = own_ring();
+
+	if (ring EQ NULL)
+		return;
+
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	// Only this thread writes here: the counter is published for whoever reads the file meanwhile
+	uint64_t written = ring->written;
+	trace_record_t *record = (trace_record_t *)(ring + 1) + written % ring->capacity;
+
+	record->timestamp = (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+	record->module = module;
+	record->event = (uint16_t)event;
+	record->pid = pid;
+	record->args[0] = arg0;
+	record->args[1] = arg1;
+
+	__atomic_store_n(&ring->written, written + 1, __ATOMIC_RELEASE);
+}
+
+const char *trace_event_name(uint16_t event)
+{
+	return event < TRACE_EVENTS ? EVENT_NAMES[event] : "UNKNOWN";
+}
+
+const char *trace_module_name(uint16_t module_id)
+{
+	return module_id < MODULES ? MODULE_NAMES[module_id] : MODULE_NAMES[TRACE_MODULE_UNKNOWN];
+}
@@ -101,7 +101,7 @@ ssize_t accion_enviar(accion_t *accion, int socket)
 
 	if (stream)
 	{
-		bytes = send(socket, stream, accion_size(), 0);
+		bytes = fd_send_value(socket, stream, accion_size());
 		free(stream);
 	}
 
@@ -113,7 +113,7 @@ accion_t *accion_recibir(int socket)
 	ssize_t size = ERROR;
 	void *stream = servidor_recibir_stream(socket, &size);
 	accion_t *accion = accion_from_stream(stream);
-	free(stream);
+	servidor_liberar_stream(socket, stream);
 
 	return accion;
 }
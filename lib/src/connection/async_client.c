@@ -0,0 +1,311 @@
+/**
+ * @file async_client.c
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Pipelined request/response client
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+
+#include "async_client.h"
+#include "tuning.h"
+#include "sem.h"
+#include "lib.h"
+#include "log.h"
+
+// ============================================================================================================
+//                                   ***** Private Definitions  *****
+// ============================================================================================================
+
+/**
+ * @brief Receives replies and completes their requests, until the connection is lost.
+ *
+ * @param client the client
+ * @return null ptr
+ */
+static void *async_client_reader(void *client);
+
+/**
+ * @brief Completes a request: runs its callback or wakes up its waiter. Frees the window slot.
+ *
+ * @param client the client
+ * @param request the request, already out of the window
+ * @param reply the reply payload or NULL
+ * @param size the reply size or ERROR
+ */
+static void async_client_complete(async_client_t *client, async_request_t *request, void *reply, ssize_t size);
+
+/**
+ * @brief Registers a request in the window and sends it.
+ *
+ * @param sent where to store whether it was sent
+ * @return the future to wait on; NULL if a callback was given or the request could not be sent
+ */
+static async_request_t *async_client_send(async_client_t *client, opcode_t opcode, const struct iovec *segments, int count, async_callback_t callback, void *data, bool *sent);
+
+/**
+ * @brief Takes a request out of the window. Must be called holding the client mutex.
+ *
+ * @param client the client
+ * @param id the request id
+ * @return the request or NULL if none has that id
+ */
+static async_request_t *async_client_take(async_client_t *client, uint32_t id)
+{
+	for (int i = 0; i < client->capacity; i++)
+	{
+		async_request_t *request = client->in_flight[i];
+
+		if (request && request->id EQ id)
+		{
+			client->in_flight[i] = NULL;
+			return request;
+		}
+	}
+
+	return NULL;
+}
+
+// ============================================================================================================
+//                                   ***** Private Functions  *****
+// ============================================================================================================
+
+static void *async_client_reader(void *data)
+{
+	async_client_t *client = data;
+
+	for (;;)
+	{
+		wire_header_t header;
+		void *stream = conexion_recibir_frame(client->conexion.socket, &header);
+
+		if (stream == NULL)
+			break;
+
+		uint32_t id = header.id;
+		ssize_t size = header.length;
+
+		pthread_mutex_lock(&client->mutex);
+		async_request_t *request = async_client_take(client, id);
+		pthread_mutex_unlock(&client->mutex);
+
+		if (request == NULL)
+		{
+			LOG_WARNING("[Async-Client] :=> Reply for unknown request #%d dropped.", id);
+			conexion_liberar_stream(client->conexion.socket, stream);
+			continue;
+		}
+
+		async_client_complete(client, request, stream, size);
+	}
+
+	LOG_DEBUG("[Async-Client] :=> Connection lost, failing the requests in flight.");
+
+	pthread_mutex_lock(&client->mutex);
+	client->running = false;
+	async_request_t *lost[client->capacity];
+
+	for (int i = 0; i < client->capacity; i++)
+	{
+		lost[i] = client->in_flight[i];
+		client->in_flight[i] = NULL;
+	}
+	pthread_mutex_unlock(&client->mutex);
+
+	for (int i = 0; i < client->capacity; i++)
+		if (lost[i])
+			async_client_complete(client, lost[i], NULL, ERROR);
+
+	return NULL;
+}
+
+static void async_client_complete(async_client_t *client, async_request_t *request, void *reply, ssize_t size)
+{
+	if (request->callback)
+	{
+		request->callback(reply, size, request->data);
+		async_client_release(client, reply);
+		free(request);
+	}
+	else
+	{
+		pthread_mutex_lock(&client->mutex);
+		request->reply = reply;
+		request->size = size;
+		request->done = true;
+		pthread_cond_broadcast(&client->completed);
+		pthread_mutex_unlock(&client->mutex);
+	}
+
+	SIGNAL(&client->window);
+}
+
+// ============================================================================================================
+//                                   ***** Public Functions  *****
+// ============================================================================================================
+
+async_client_t *async_client_create(conexion_t conexion, int window)
+{
+	async_client_t *client = malloc(sizeof(async_client_t));
+
+	client->conexion = conexion;
+	client->capacity = window > 0 ? window : 1;
+	client->in_flight = calloc(client->capacity, sizeof(async_request_t *));
+	client->next_id = 0;
+	client->running = true;
+
+	pthread_mutex_init(&client->mutex, NULL);
+	pthread_mutex_init(&client->sending, NULL);
+	pthread_cond_init(&client->completed, NULL);
+	sem_init(&client->window, SHARE_BETWEEN_THREADS, client->capacity);
+
+	pthread_create(&client->reader, NULL, async_client_reader, client);
+
+	return client;
+}
+
+async_request_t *async_client_submit(async_client_t *client, opcode_t opcode, const struct iovec *segments, int count, async_callback_t callback, void *data)
+{
+	bool sent;
+
+	return async_client_send(client, opcode, segments, count, callback, data, &sent);
+}
+
+int async_client_post(async_client_t *client, opcode_t opcode, const struct iovec *segments, int count, async_callback_t callback, void *data)
+{
+	bool sent;
+	async_client_send(client, opcode, segments, count, callback, data, &sent);
+
+	return sent ? SUCCESS : ERROR;
+}
+
+static async_request_t *async_client_send(async_client_t *client, opcode_t opcode, const struct iovec *segments, int count, async_callback_t callback, void *data, bool *sent)
+{
+	*sent = false;
+
+	// A full window waits for replies: the requests in it must not stay corked
+	if (sem_trywait(&client->window) EQ ERROR)
+	{
+		socket_flush(client->conexion.socket);
+		WAIT(&client->window);
+	}
+
+	async_request_t *request = malloc(sizeof(async_request_t));
+	request->done = false;
+	request->reply = NULL;
+	request->size = ERROR;
+	request->callback = callback;
+	request->data = data;
+
+	// Registered before sending: the reply may arrive before send returns.
+	pthread_mutex_lock(&client->mutex);
+
+	if (!client->running)
+	{
+		pthread_mutex_unlock(&client->mutex);
+		free(request);
+		SIGNAL(&client->window);
+		return NULL;
+	}
+
+	request->id = client->next_id++;
+
+	for (int i = 0; i < client->capacity; i++)
+	{
+		if (client->in_flight[i] == NULL)
+		{
+			client->in_flight[i] = request;
+			break;
+		}
+	}
+
+	pthread_mutex_unlock(&client->mutex);
+
+	uint32_t id = request->id;
+
+	pthread_mutex_lock(&client->sending);
+	ssize_t bytes = conexion_esta_conectada(client->conexion) ? enviar_frame(opcode, id, segments, count, client->conexion.socket) : ERROR;
+	pthread_mutex_unlock(&client->sending);
+
+	if (bytes <= 0)
+	{
+		LOG_ERROR("[Async-Client] :=> Request #%d could not be sent.", id);
+
+		pthread_mutex_lock(&client->mutex);
+		bool pending = async_client_take(client, id) != NULL;
+		pthread_mutex_unlock(&client->mutex);
+
+		if (pending)
+		{
+			free(request);
+			SIGNAL(&client->window);
+		}
+		// The reader failed it already: a future is still ours to free.
+		else if (callback == NULL)
+		{
+			async_client_release(client, async_request_wait(client, request, NULL));
+		}
+
+		return NULL;
+	}
+
+	*sent = true;
+
+	// Nobody waits on a callback: it leaves now; a future leaves once it is waited on
+	if (callback)
+		socket_flush(client->conexion.socket);
+
+	return callback ? NULL : request;
+}
+
+void *async_request_wait(async_client_t *client, async_request_t *request, ssize_t *size)
+{
+	socket_flush(client->conexion.socket);
+
+	pthread_mutex_lock(&client->mutex);
+
+	while (!request->done)
+		pthread_cond_wait(&client->completed, &client->mutex);
+
+	pthread_mutex_unlock(&client->mutex);
+
+	void *reply = request->reply;
+
+	if (size)
+		*size = request->size;
+
+	free(request);
+
+	return reply;
+}
+
+void async_client_release(async_client_t *client, void *reply)
+{
+	// The reply may be a slice of a receiver attached to the socket, not a heap block of its own
+	if (reply)
+		conexion_liberar_stream(client->conexion.socket, reply);
+}
+
+void async_client_destroy(async_client_t *client)
+{
+	if (client == NULL)
+		return;
+
+	// Wakes up the reader, which fails what is still in flight.
+	shutdown(client->conexion.socket, SHUT_RDWR);
+	pthread_join(client->reader, NULL);
+
+	pthread_mutex_destroy(&client->mutex);
+	pthread_mutex_destroy(&client->sending);
+	pthread_cond_destroy(&client->completed);
+	sem_destroy(&client->window);
+
+	free(client->in_flight);
+	free(client);
+}
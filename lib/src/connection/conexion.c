@@ -7,11 +7,20 @@
  */
 #include <signal.h>
 #include <netdb.h>
+#include <sys/un.h>
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
 
 #include "lib.h"
 #include "conexion.h"
 #include "buffer.h"
 #include "package.h"
+#include "receiver.h"
+#include "transport.h"
+#include "tuning.h"
+#include "wire.h"
+#include "log.h"
 
 // ============================================================================================================
 //                               ***** Conexion -  Definiciones *****
@@ -30,6 +39,52 @@
  */
 static int _address(char *, char *, conexion_t *);
 
+/**
+ * Arma la dirección de un socket unix (AF_UNIX, SOCK_SEQPACKET) a partir de una ruta unix://.
+ * Si la ruta está en el PUERTO se usa tal cual; si está en el IP se le agrega el puerto (unix:///tmp/sski + 8001
+ * es /tmp/sski.8001), así un mismo IP sirve a varios servidores.
+ *
+ * @param ip el ip a conectarse
+ * @param puerto el puerto de conexión
+ * @param conexion la referencia de la conexion a direccionar
+ * @returns SUCCESS, ERROR si la ruta es demasiado larga, o NOT_UNIX si ninguno es una ruta unix://
+ */
+static int _unix_address(char *, char *, conexion_t *);
+
+// Prefijo de las rutas de sockets unix en IP/PUERTO
+#define UNIX_PREFIX "unix://"
+// Resultado de _unix_address cuando la dirección es de red
+#define NOT_UNIX (SUCCESS + 1)
+
+/**
+ * Envía todos los segmentos, reintentando ante escrituras parciales. Usa el enlace de memoria compartida del socket si lo tiene.
+ * Toma el lock de envío del socket: otro hilo que envía por el mismo socket espera a que salgan todos.
+ *
+ * @param socket el socket destino
+ * @param segments los segmentos a enviar (se modifican al avanzar)
+ * @param count la cantidad de segmentos
+ * @returns los bytes enviados o ERROR
+ */
+static ssize_t _send_segments(int, struct iovec *, int);
+
+// Cantidad de segmentos que se arman en el stack antes de recurrir al heap
+#define SEGMENTOS_EN_STACK 64
+
+// Límite de segmentos por sendmsg (POSIX garantiza al menos 16, Linux admite 1024)
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+// Un lock de envío por socket: los frames de dos hilos que escriben el mismo socket no se intercalan
+static pthread_mutex_t envios[RECEIVERS_MAX];
+static pthread_once_t envios_iniciados = PTHREAD_ONCE_INIT;
+
+static void _iniciar_envios(void)
+{
+	for (int i = 0; i < RECEIVERS_MAX; i++)
+		pthread_mutex_init(&envios[i], NULL);
+}
+
 // ============================================================================================================
 //                               ***** Funciones Privadas - Definiciones *****
 // ============================================================================================================
@@ -38,11 +93,51 @@ static int _address(char *, char *, conexion_t *);
 //  Misc
 // ------------------------------------------------------------
 
+int _unix_address(char *ip, char *port, conexion_t *this)
+{
+	// Variable local ruta - la ruta del socket
+	char path[sizeof(((struct sockaddr_un *)NULL)->sun_path)];
+	int length;
+
+	if (port && strncmp(port, UNIX_PREFIX, strlen(UNIX_PREFIX)) EQ 0)
+		length = snprintf(path, sizeof(path), "%s", port + strlen(UNIX_PREFIX));
+	else if (ip && strncmp(ip, UNIX_PREFIX, strlen(UNIX_PREFIX)) EQ 0)
+		length = snprintf(path, sizeof(path), "%s.%s", ip + strlen(UNIX_PREFIX), port);
+	else
+		return NOT_UNIX;
+
+	if (length >= (int)sizeof(path))
+	{
+		LOG_ERROR("[Conexion] :=> Unix socket path too long: %s", path);
+		return ERROR;
+	}
+
+	// La addrinfo y su sockaddr en un solo bloque, que conexion_destroy libera
+	struct addrinfo *info = calloc(1, sizeof(struct addrinfo) + sizeof(struct sockaddr_un));
+	struct sockaddr_un *address = (struct sockaddr_un *)(info + 1);
+
+	address->sun_family = AF_UNIX;
+	strcpy(address->sun_path, path);
+
+	info->ai_family = AF_UNIX;
+	info->ai_socktype = SOCK_SEQPACKET;
+	info->ai_protocol = 0;
+	info->ai_addr = (struct sockaddr *)address;
+	info->ai_addrlen = sizeof(struct sockaddr_un);
+
+	this->info_server = info;
+
+	return SUCCESS;
+}
+
 int _address(char *ip, char *port, conexion_t *this)
 {
 	// Estructura local hints - Las hints para la creacion del socket.
 	struct addrinfo hints;
-	int rv = -1;
+	int rv = _unix_address(ip, port, this);
+
+	if (rv != NOT_UNIX)
+		return rv;
 
 	// Seteos de memoria a las hints -- No importa como funciona
 	memset(&hints, 0, sizeof(hints));
@@ -58,6 +153,57 @@ int _address(char *ip, char *port, conexion_t *this)
 	return SUCCESS;
 }
 
+ssize_t _send_segments(int socket, struct iovec *segments, int count)
+{
+	// Variable a Exportar bytes - Los bytes enviados
+	ssize_t total = 0;
+
+	// Variable local envio - El lock del socket, tomado hasta que sale el último segmento
+	pthread_mutex_t *envio = NULL;
+
+	if (socket >= 0 && socket < RECEIVERS_MAX)
+	{
+		pthread_once(&envios_iniciados, _iniciar_envios);
+		envio = &envios[socket];
+		pthread_mutex_lock(envio);
+	}
+
+	while (count > 0)
+	{
+		ssize_t sent = transport_send(socket, segments, count > IOV_MAX ? IOV_MAX : count);
+
+		if (sent EQ ERROR)
+		{
+			if (errno EQ EINTR)
+				continue;
+			total = ERROR;
+			break;
+		}
+
+		total += sent;
+
+		// Descarto los segmentos enviados completos
+		while (count > 0 && (size_t)sent >= segments->iov_len)
+		{
+			sent -= segments->iov_len;
+			segments++;
+			count--;
+		}
+
+		// Y avanzo dentro del segmento enviado parcialmente
+		if (count > 0)
+		{
+			segments->iov_base = (char *)segments->iov_base + sent;
+			segments->iov_len -= sent;
+		}
+	}
+
+	if (envio)
+		pthread_mutex_unlock(envio);
+
+	return total;
+}
+
 // -----------------------------------------------------------
 //  Streams
 // ------------------------------------------------------------
@@ -69,36 +215,49 @@ bool tiene_mensaje(char *msg)
 
 ssize_t enviar_str(char *str, int socket)
 {
-	// Estructura Local paquete - el paquete a enviar
-	package_t *package = package_create(MSG, str);
-
-	// Local stream - el paquete serializado, requiere free(1)
-	void *stream = package_serialize(package);
-
-	// Variable a Exportar bytes - Los bytes enviados o ERROR (-1)
-	ssize_t bytes_sent = send(socket, stream, package_get_real_size(package), 0);
+	// String + '\0'
+	return enviar_stream(MSG, str, strlen(str) + 1, socket);
+}
 
-	free(stream);
+ssize_t enviar_stream(opcode_t opcode, void *str, size_t size, int socket)
+{
+	struct iovec segment = {.iov_base = str, .iov_len = size};
 
-	package_destroy(package);
+	return enviar_stream_vector(opcode, &segment, 1, socket);
+}
 
-	return bytes_sent;
+ssize_t enviar_stream_vector(opcode_t opcode, const struct iovec *segments, int count, int socket)
+{
+	return enviar_frame(opcode, 0, segments, count, socket);
 }
 
-ssize_t enviar_stream(opcode_t opcode, void *str, size_t size, int socket)
+ssize_t enviar_frame(opcode_t opcode, uint32_t id, const struct iovec *segments, int count, int socket)
 {
-	// Estructura Local paquete - el paquete a enviar
-	package_t *package = new_package_for(opcode, size, str);
+	/**
+	 *          [ HEADER ][ SEGMENT_0 ]...[ SEGMENT_N ]
+	 */
+	size_t size = 0;
+	for (int i = 0; i < count; i++)
+		size += segments[i].iov_len;
 
-	// Local stream - el paquete serializado, requiere free(1)
-	void *stream = package_serialize(package);
+	if (size > WIRE_PAYLOAD_MAX)
+		return ERROR;
 
-	// Variable a Exportar bytes - Los bytes enviados o ERROR (-1)
-	ssize_t bytes_sent = send(socket, stream, package_get_real_size(package), 0);
+	uint8_t header[WIRE_HEADER_SIZE];
+	wire_header_encode(header, opcode, id, size);
 
-	free(stream);
+	// Estructura Local segmentos - el header seguido de los segmentos del llamador
+	struct iovec local[SEGMENTOS_EN_STACK];
+	struct iovec *frame = count + 1 <= SEGMENTOS_EN_STACK ? local : malloc(sizeof(struct iovec) * (count + 1));
 
-	package_destroy(package);
+	frame[0] = (struct iovec){.iov_base = header, .iov_len = WIRE_HEADER_SIZE};
+	memcpy(frame + 1, segments, sizeof(struct iovec) * count);
+
+	// Variable a Exportar bytes - Los bytes enviados o ERROR (-1)
+	ssize_t bytes_sent = _send_segments(socket, frame, count + 1);
+
+	if (frame != local)
+		free(frame);
 
 	return bytes_sent;
 }
@@ -152,6 +311,10 @@ conexion_t conexion_servidor_create(char *ip, char *port)
 		// Lose the pesky "address already in use" error message
 		setsockopt(that.socket, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(int));
 
+		// Un socket unix que quedó de una ejecución anterior también impide el bind
+		if (_info->ai_family EQ AF_UNIX)
+			unlink(((struct sockaddr_un *)_info->ai_addr)->sun_path);
+
 		// Avoids a blocking accept state (ADDS BUSY WAITING)
 		// fcntl(es_conexion.socket, F_SETFL, O_NONBLOCK);
 
@@ -176,8 +339,11 @@ conexion_t conexion_servidor_create(char *ip, char *port)
 inline void conexion_destroy(conexion_t *this)
 {
 	conexion_desconectar(this);
-	// Libero la información del server
-	freeaddrinfo(this->info_server);
+	// Libero la información del server (la de un socket unix es un solo bloque, ver _unix_address)
+	if (this->info_server && this->info_server->ai_family EQ AF_UNIX)
+		free(this->info_server);
+	else
+		freeaddrinfo(this->info_server);
 }
 
 // ------------------------------------------------------------
@@ -186,16 +352,31 @@ inline void conexion_destroy(conexion_t *this)
 
 inline int conexion_conectar(conexion_t *this)
 {
+	socket_tuning_t tuning = socket_tuning_from_config();
+
+	// Los buffers antes de conectar, así la ventana TCP se negocia con ellos
+	socket_tuning_buffers(this->socket, tuning);
+
 	// Conecto, y guardo si se pudo conectar
 	this->conectado =
 		connect(this->socket, this->info_server->ai_addr, this->info_server->ai_addrlen) != ERROR;
 
+	if (this->conectado)
+		socket_tuning_apply(this->socket, tuning);
+
+	// Los sockets unix conservan los límites de cada mensaje: se leen de a registros
+	if (this->conectado && this->info_server->ai_family EQ AF_UNIX)
+		transport_records_attach(this->socket);
+
 	// Devuelvo si tuvo exito o error
 	return this->conectado ? this->socket : ERROR;
 }
 
 inline int conexion_escuchar(conexion_t *this)
 {
+	// Los clientes aceptados heredan los buffers del socket de escucha
+	socket_tuning_buffers(this->socket, socket_tuning_from_config());
+
 	// Escucho, y guardo el resultado de si se pudo abrir la escucha
 
 	this->conectado = listen(this->socket, SOMAXCONN) != ERROR;
@@ -203,8 +384,41 @@ inline int conexion_escuchar(conexion_t *this)
 	return this->conectado ? SUCCESS : ERROR;
 }
 
+int conexion_escuchar_otra(const conexion_t *this)
+{
+	// Estructura local dirección - la dirección ya bindeada (con su puerto, aunque se haya pedido el 0)
+	struct sockaddr_storage address;
+	socklen_t length = sizeof(address);
+	int yes = 1;
+
+	if (getsockname(this->socket, (struct sockaddr *)&address, &length) EQ ERROR || address.ss_family EQ AF_UNIX)
+		return ERROR;
+
+	int listener = socket(address.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+	if (listener EQ ERROR)
+		return ERROR;
+
+	setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(int));
+	socket_tuning_buffers(listener, socket_tuning_from_config());
+
+	// Recién acá el puerto pasa a compartirse: un servidor con una sola escucha nunca lo hace.
+	// Linux lo admite con el socket original ya escuchando, y lo suma al grupo del nuevo
+	if (setsockopt(this->socket, SOL_SOCKET, SO_REUSEPORT, &yes, sizeof(int)) EQ ERROR
+		|| setsockopt(listener, SOL_SOCKET, SO_REUSEPORT, &yes, sizeof(int)) EQ ERROR
+		|| bind(listener, (struct sockaddr *)&address, length) EQ ERROR
+		|| listen(listener, SOMAXCONN) EQ ERROR)
+	{
+		close(listener);
+		return ERROR;
+	}
+
+	return listener;
+}
+
 inline int conexion_desconectar(const conexion_t *this)
 {
+	transport_detach(this->socket);
 	return close(this->socket);
 }
 
@@ -244,47 +458,77 @@ inline ssize_t conexion_enviar_stream(conexion_t this, opcode_t opcode, void *st
 	return conexion_esta_conectada(this) ? enviar_stream(opcode, strean, size, this.socket) : ERROR;
 }
 
-void *conexion_recibir_stream(int socket, ssize_t *bytes_size)
+inline ssize_t conexion_enviar_stream_vector(conexion_t this, opcode_t opcode, const struct iovec *segments, int count)
+{
+	return conexion_esta_conectada(this) ? enviar_stream_vector(opcode, segments, count, this.socket) : ERROR;
+}
+
+void *conexion_recibir_frame(int socket, wire_header_t *header)
 {
 	/**
 	 * Referencia a Exportar buffer - el buffer recibido;
 	 */
 	void *buffer_stream;
 
-	// Variable local tamaño
-	size_t opcode = 0;
+	// Receptor asociado al socket, si lo hay
+	receiver_t *receiver = receiver_of(socket);
+
+	// Buffer local header - el header sin decodificar
+	uint8_t buffer_header[WIRE_HEADER_SIZE];
 
 	// Valor de Retorno bytes - Los bytes recibidos o ERROR
-	ssize_t recv_ret = recv(socket, &opcode, sizeof(int), MSG_WAITALL);
+	ssize_t recv_ret = receiver ? receiver_recv(receiver, buffer_header, WIRE_HEADER_SIZE) : transport_recv(socket, buffer_header, WIRE_HEADER_SIZE, MSG_WAITALL);
 
-	if (recv_ret EQ ERROR)
+	if (recv_ret < WIRE_HEADER_SIZE)
 		return NULL;
 
-	size_t size = 0;
-
-	recv_ret = recv(socket, &size, sizeof(int), MSG_WAITALL);
+	if (!wire_header_decode(buffer_header, header))
+	{
+		LOG_ERROR("[Conexion] :=> Socket <%d> received a frame with an invalid header", socket);
+		return NULL;
+	}
 
-	if (size == 0 || recv_ret <= 0)
+	if (header->length == 0)
 		return NULL;
 
-	buffer_stream = malloc(size);
+	if (receiver)
+		return receiver_slice(receiver, header->length);
 
-	recv_ret = recv(socket, buffer_stream, size, MSG_WAITALL);
+	buffer_stream = malloc(header->length);
 
-	if (recv_ret EQ ERROR)
+	recv_ret = transport_recv(socket, buffer_stream, header->length, MSG_WAITALL);
+
+	if (recv_ret < (ssize_t)header->length)
 	{
 		free(buffer_stream);
 		return NULL;
 	}
 
-	*bytes_size = size + 2 * sizeof(int);
+	return buffer_stream;
+}
+
+void *conexion_recibir_stream(int socket, ssize_t *bytes_size)
+{
+	wire_header_t header;
+
+	void *buffer_stream = conexion_recibir_frame(socket, &header);
+
+	if (buffer_stream)
+		*bytes_size = header.length + WIRE_HEADER_SIZE;
 
 	return buffer_stream;
 }
 
+inline void conexion_liberar_stream(int socket, void *stream)
+{
+	receiver_release_stream(socket, stream);
+}
+
 ssize_t fd_send_value(int self, void *value, size_t size_of_value)
 {
-	return send(self, value, size_of_value, 0);
+	struct iovec segment = {.iov_base = value, .iov_len = size_of_value};
+
+	return _send_segments(self, &segment, 1);
 }
 
 ssize_t
@@ -304,7 +548,11 @@ connection_receive_value(conexion_t self, size_t size_of_value)
 
 	void *value = malloc(size_of_value);
 
-	if (recv(self.socket, value, size_of_value, MSG_WAITALL) <= 0)
+	receiver_t *receiver = receiver_of(self.socket);
+
+	ssize_t received = receiver ? receiver_recv(receiver, value, size_of_value) : transport_recv(self.socket, value, size_of_value, MSG_WAITALL);
+
+	if (received <= 0)
 	{
 		free(value);
 		return NULL;
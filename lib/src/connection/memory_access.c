@@ -0,0 +1,56 @@
+/**
+ * @file memory_access.c
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Batched memory accesses (MEMORY_BATCH)
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <string.h>
+
+#include "memory_access.h"
+#include "lib.h"
+
+// ============================================================================================================
+//                                   ***** Public Functions  *****
+// ============================================================================================================
+
+int conexion_memory_batch(conexion_t conexion, memory_access_t *accesses, int count, memory_access_result_t *results)
+{
+	if (count <= 0)
+		return 0;
+
+	// [ACCESOS...] - one request at a time, no request id is needed to match the reply
+	struct iovec segments[] = {{.iov_base = accesses, .iov_len = count * sizeof(memory_access_t)}};
+
+	if (conexion_enviar_stream_vector(conexion, MEMORY_BATCH, segments, 1) <= 0)
+		return ERROR;
+
+	wire_header_t header;
+	void *stream = conexion_recibir_frame(conexion.socket, &header);
+
+	if (stream == NULL)
+		return ERROR;
+
+	// Anything else is not an answer to this batch
+	int received = header.opcode EQ MEMORY_BATCH ? memory_batch_results(stream, header.length, count, results) : ERROR;
+
+	conexion_liberar_stream(conexion.socket, stream);
+
+	return received;
+}
+
+int memory_batch_results(void *payload, ssize_t size, int count, memory_access_result_t *results)
+{
+	if (payload == NULL || size < 0)
+		return ERROR;
+
+	int received = size / sizeof(memory_access_result_t);
+	received = received > count ? count : received;
+	memcpy(results, payload, received * sizeof(memory_access_result_t));
+
+	return received;
+}
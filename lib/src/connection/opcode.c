@@ -58,6 +58,20 @@ char *opcode_to_string(opcode_t opcode)
 		return "Memory Write";
 	case MEMORY_INIT:
 		return "Init Memory for PCB";
+	case PROCESS_TERMINATED:
+		return "Process Terminated";
+	case MEMORY_BATCH:
+		return "Memory Batch";
+	case TRANSLATE:
+		return "Translate Address";
+	case PCB_DELTA:
+		return "PCB Delta";
+	case PCB_MISS:
+		return "PCB Program Missing";
+	case SHM_LINK:
+		return "Shared Memory Link";
+	case STATS:
+		return "Metrics Snapshot";
 	default:
 		return "Unrecognized";
 	}
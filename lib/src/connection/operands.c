@@ -1,5 +1,6 @@
 #include <inttypes.h>
 #include "operands.h"
+#include "wire.h"
 
 
 void *operandos_to_stream(void *operandos){
@@ -7,12 +8,9 @@ void *operandos_to_stream(void *operandos){
 	operands_t *this = (operands_t *)operandos;
 	void *stream = malloc(sizeof(operands_t));
 
-	size_t offset = 0lu;
-
-	memcpy(stream + offset, &this->op1, sizeof(uint32_t));
-	offset += sizeof(uint32_t);
-	memcpy(stream + offset, &this->op2, sizeof(uint32_t));
-	offset += sizeof(uint32_t);
+	// [OP1][OP2] as little-endian words
+	wire_put_u32(stream, this->op1);
+	wire_put_u32(stream + sizeof(uint32_t), this->op2);
 
 	return stream;
 }
@@ -21,16 +19,8 @@ operands_t operandos_from_stream(void *stream)
 {
 	operands_t ret;
 
-	uint32_t op1 = 0u, op2 = 0u;
-
-	size_t offset = 0lu;
-	memcpy(&op1, stream + offset, sizeof(uint32_t));
-	offset += sizeof(uint32_t);
-	memcpy(&op2, stream + offset, sizeof(uint32_t));
-	offset += sizeof(uint32_t);
-
-	ret.op1 = op1;
-	ret.op2 = op2;
+	ret.op1 = wire_get_u32(stream);
+	ret.op2 = wire_get_u32(stream + sizeof(uint32_t));
 
 	return ret;
 }
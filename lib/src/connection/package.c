@@ -13,6 +13,7 @@
 #include <stdlib.h>
 
 #include "package.h"
+#include "wire.h"
 
 // ============================================================================================================
 //                                   ***** Public Functions  *****
@@ -63,8 +64,8 @@ void package_destroy(package_t *package)
 size_t
 package_get_real_size(package_t *package)
 {
-	// Bytes occupied by buffer + Bytes occupied by <size> number + Opcode's bytes)
-	return package->buffer->size + sizeof(int) + sizeof(opcode_t);
+	// Bytes occupied by buffer + Bytes occupied by the frame header
+	return package->buffer->size + WIRE_HEADER_SIZE;
 }
 
 void *package_serialize(package_t *package)
@@ -76,21 +77,12 @@ void *package_serialize(package_t *package)
 	void *stream = NULL;
 	stream = malloc(bytes);
 
-	// Stream offset
-	size_t offset = 0;
-
-	// Copy bytes incrementing the offset
+	// Copy the header and then the data
 	/**
-	 *          [ OPCODE ][ DATA_SIZE ][ DATA ]
+	 *          [ HEADER ][ DATA ]
 	 */
-	memcpy(stream + offset, &(package->opcode), sizeof(opcode_t));
-	offset += sizeof(opcode_t);
-
-	memcpy(stream + offset, &(package->buffer->size), sizeof(int));
-	offset += sizeof(int);
-
-	memcpy(stream + offset, package->buffer->stream, package->buffer->size);
-	offset += package->buffer->size;
+	wire_header_encode(stream, package->opcode, 0, package->buffer->size);
+	memcpy(stream + WIRE_HEADER_SIZE, package->buffer->stream, package->buffer->size);
 
 	return stream;
 }
@@ -0,0 +1,397 @@
+/**
+ * @file reactor.c
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Event-loop (epoll) server engine
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+
+#include "reactor.h"
+#include "receiver.h"
+#include "transport.h"
+#include "tuning.h"
+#include "lib.h"
+#include "log.h"
+
+// ============================================================================================================
+//                                   ***** Private Definitions  *****
+// ============================================================================================================
+
+/**
+ * @brief A reactor thread: its listener and the clients it accepted, which only it serves.
+ *
+ */
+typedef struct Reactor
+{
+	// The listening server.
+	servidor_t *server;
+	// The per-request handler.
+	reactor_handler_t handler;
+	// The epoll set holding the listener and every client of this reactor.
+	int epoll;
+	// Its own listener, or the server one when the address can not be shared.
+	int listener;
+	// Whether a client is in its epoll set, indexed by socket.
+	bool clients[RECEIVERS_MAX];
+	// The handler sessions, indexed by socket.
+	void *sessions[RECEIVERS_MAX];
+	// Its loop plus the shared-memory clients still being served: the last one frees it.
+	_Atomic int references;
+} reactor_t;
+
+/**
+ * @brief A client handed over to its own thread.
+ *
+ */
+typedef struct ReactorClient
+{
+	// The reactor it came from.
+	reactor_t *reactor;
+	// The client.
+	int socket;
+} reactor_client_t;
+
+/**
+ * @brief Waits for events and serves them, until the server is stopped.
+ *
+ * @param reactor the reactor
+ * @return EXIT_SUCCESS once stopped, or SERVER_RUNTIME_ERROR if epoll failed, as an intptr_t
+ */
+static void *reactor_loop(void *reactor);
+
+/**
+ * @brief Closes the clients and the listener of a stopped reactor, and lets go of it.
+ *
+ * @param reactor the reactor
+ */
+static void reactor_stop(reactor_t *reactor);
+
+/**
+ * @brief Lets go of a reference to a reactor, freeing it if it was the last one.
+ *
+ * @param reactor the reactor
+ */
+static void reactor_release(reactor_t *reactor);
+
+/**
+ * @brief Accepts every client pending on the reactor listener and arms them.
+ *
+ * @param reactor the reactor
+ */
+static void reactor_accept(reactor_t *reactor);
+
+/**
+ * @brief Creates a reactor with its own epoll set, listening on a non-blocking listener.
+ *
+ * @param server the listening server
+ * @param handler the per-request handler
+ * @param listener the listener
+ * @param shared whether other reactors wait on the same listener
+ * @return the reactor, or NULL if its epoll set could not be created
+ */
+static reactor_t *reactor_create(servidor_t *server, reactor_handler_t handler, int listener, bool shared);
+
+/**
+ * @brief Serves the requests a client has ready, then re-arms it.
+ *
+ * @param reactor the reactor
+ * @param socket the client
+ */
+static void reactor_serve(reactor_t *reactor, int socket);
+
+/**
+ * @brief Serves a shared-memory client on a thread of its own: epoll can not see its ring.
+ *
+ * @param client the reactor_client_t
+ * @return null ptr
+ */
+static void *reactor_serve_linked(void *client);
+
+/**
+ * @brief Removes a client from the reactor and closes it.
+ *
+ * @param reactor the reactor
+ * @param socket the client
+ */
+static void reactor_close(reactor_t *reactor, int socket);
+
+/**
+ * @brief Arms a client for its next request.
+ *
+ * @param reactor the reactor
+ * @param socket the client
+ * @param operation EPOLL_CTL_ADD or EPOLL_CTL_MOD
+ * @return the epoll_ctl result
+ */
+static inline int reactor_arm(reactor_t *reactor, int socket, int operation)
+{
+	struct epoll_event event = {.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT, .data.fd = socket};
+
+	return epoll_ctl(reactor->epoll, operation, socket, &event);
+}
+
+// ============================================================================================================
+//                                   ***** Private Functions  *****
+// ============================================================================================================
+
+static void *reactor_loop(void *data)
+{
+	reactor_t *reactor = data;
+	struct epoll_event events[REACTOR_EVENTS];
+	intptr_t result = EXIT_SUCCESS;
+
+	for (bool running = true; running;)
+	{
+		int ready = epoll_wait(reactor->epoll, events, REACTOR_EVENTS, -1);
+
+		if (ready EQ ERROR)
+		{
+			if (errno EQ EINTR)
+				continue;
+
+			LOG_ERROR("[Reactor] :=> epoll_wait failed: %s", strerror(errno));
+			result = SERVER_RUNTIME_ERROR;
+			break;
+		}
+
+		for (int i = 0; i < ready; i++)
+		{
+			if (events[i].data.fd EQ reactor->server->stop)
+				running = false;
+			else if (events[i].data.fd EQ reactor->listener)
+				reactor_accept(reactor);
+			else
+				reactor_serve(reactor, events[i].data.fd);
+		}
+	}
+
+	reactor_stop(reactor);
+
+	return (void *)result;
+}
+
+static void reactor_stop(reactor_t *reactor)
+{
+	for (int socket = 0; socket < RECEIVERS_MAX; socket++)
+		if (reactor->clients[socket])
+			reactor_close(reactor, socket);
+
+	if (reactor->listener != reactor->server->conexion.socket)
+		close(reactor->listener);
+
+	reactor_release(reactor);
+}
+
+static void reactor_release(reactor_t *reactor)
+{
+	if (atomic_fetch_sub(&reactor->references, 1) > 1)
+		return;
+
+	close(reactor->epoll);
+	free(reactor);
+}
+
+static void reactor_accept(reactor_t *reactor)
+{
+	int socket;
+
+	// The listener is non-blocking: drain it until EAGAIN.
+	while ((socket = server_accept_client_from(reactor->server, reactor->listener)) > 0)
+	{
+		if (receiver_attach(socket, RECEIVER_CAPACITY) == NULL)
+		{
+			LOG_ERROR("[Reactor] :=> Client <%d> exceeds the reactor capacity.", socket);
+			servidor_desconectar_cliente(socket);
+			continue;
+		}
+
+		reactor->sessions[socket] = NULL;
+		reactor->clients[socket] = true;
+
+		if (reactor_arm(reactor, socket, EPOLL_CTL_ADD) EQ ERROR)
+		{
+			LOG_ERROR("[Reactor] :=> Client <%d> could not be armed.", socket);
+			reactor->clients[socket] = false;
+			receiver_detach(socket);
+			servidor_desconectar_cliente(socket);
+		}
+	}
+}
+
+static void reactor_serve(reactor_t *reactor, int socket)
+{
+	int opcode;
+
+	// Frames already buffered by the receiver will not raise another event: serve them too.
+	do
+		opcode = reactor->handler(socket, &reactor->sessions[socket]);
+	while (opcode > 0 && receiver_pending(socket) > 0);
+
+	// The replies to every request served leave together
+	socket_flush(socket);
+
+	if (opcode > 0 && transport_of(socket))
+	{
+		epoll_ctl(reactor->epoll, EPOLL_CTL_DEL, socket, NULL);
+		reactor->clients[socket] = false;
+		atomic_fetch_add(&reactor->references, 1);
+
+		reactor_client_t *client = malloc(sizeof(reactor_client_t));
+		client->reactor = reactor;
+		client->socket = socket;
+		thread_manager_launch(&reactor->server->tm, reactor_serve_linked, client);
+		return;
+	}
+
+	if (opcode <= 0 || reactor_arm(reactor, socket, EPOLL_CTL_MOD) EQ ERROR)
+		reactor_close(reactor, socket);
+}
+
+static void *reactor_serve_linked(void *data)
+{
+	reactor_client_t *client = data;
+	reactor_t *reactor = client->reactor;
+	int socket = client->socket;
+	free(client);
+
+	LOG_DEBUG("[Reactor] :=> Client <%d> is linked through shared memory, serving it on its own thread.", socket);
+
+	while (reactor->handler(socket, &reactor->sessions[socket]) > 0)
+		;
+
+	reactor_close(reactor, socket);
+	reactor_release(reactor);
+
+	return NULL;
+}
+
+static void reactor_close(reactor_t *reactor, int socket)
+{
+	epoll_ctl(reactor->epoll, EPOLL_CTL_DEL, socket, NULL);
+	reactor->clients[socket] = false;
+	receiver_detach(socket);
+
+	free(reactor->sessions[socket]);
+	reactor->sessions[socket] = NULL;
+
+	servidor_desconectar_cliente(socket);
+}
+
+static reactor_t *reactor_create(servidor_t *server, reactor_handler_t handler, int listener, bool shared)
+{
+	reactor_t *reactor = calloc(1, sizeof(reactor_t));
+	reactor->server = server;
+	reactor->handler = handler;
+	reactor->listener = listener;
+	reactor->references = 1;
+	reactor->epoll = epoll_create1(EPOLL_CLOEXEC);
+
+	if (reactor->epoll EQ ERROR)
+	{
+		LOG_ERROR("[Reactor] :=> Could not create the epoll set: %s", strerror(errno));
+		free(reactor);
+		return NULL;
+	}
+
+	// Reactors must never block on accept.
+	fcntl(listener, F_SETFL, fcntl(listener, F_GETFL) | O_NONBLOCK);
+
+	// A shared listener wakes a single reactor per connection, not all of them
+	struct epoll_event event = {.events = EPOLLIN | (shared ? EPOLLEXCLUSIVE : 0), .data.fd = listener};
+	epoll_ctl(reactor->epoll, EPOLL_CTL_ADD, listener, &event);
+
+	// Never read: once stopped, it stays readable for every reactor
+	struct epoll_event stop = {.events = EPOLLIN, .data.fd = server->stop};
+	epoll_ctl(reactor->epoll, EPOLL_CTL_ADD, server->stop, &stop);
+
+	return reactor;
+}
+
+// ============================================================================================================
+//                                   ***** Public Functions  *****
+// ============================================================================================================
+
+int servidor_run_reactor(servidor_t *server, int reactors, reactor_handler_t handler)
+{
+	// One SO_REUSEPORT listener per reactor, so the kernel spreads connection bursts among them
+	int listeners[reactors > 1 ? reactors : 1];
+	bool shared = false;
+	listeners[0] = server->conexion.socket;
+
+	for (int i = 1; i < reactors; i++)
+	{
+		listeners[i] = conexion_escuchar_otra(&server->conexion);
+
+		// Without SO_REUSEPORT (a unix socket) they all wait on the server one
+		if (listeners[i] EQ ERROR)
+		{
+			listeners[i] = server->conexion.socket;
+			shared = true;
+		}
+	}
+
+	LOG_DEBUG("[Reactor] :=> Serving clients with %d reactor(s).", reactors);
+
+	// Each reactor has its own epoll set: a client is only ever served by the one that accepted it.
+	// Their own threads, not the server pool ones: they are joined once stopped
+	pthread_t threads[reactors > 1 ? reactors : 1];
+	intptr_t result = EXIT_SUCCESS;
+	int launched = 1;
+
+	for (; launched < reactors; launched++)
+	{
+		reactor_t *reactor = reactor_create(server, handler, listeners[launched], shared);
+
+		if (reactor EQ NULL)
+			break;
+
+		pthread_create(&threads[launched], NULL, reactor_loop, reactor);
+	}
+
+	reactor_t *reactor = launched >= reactors ? reactor_create(server, handler, listeners[0], shared) : NULL;
+
+	if (reactor)
+		result = (intptr_t)reactor_loop(reactor);
+	else
+	{
+		// The ones already running are not left behind
+		result = SERVER_RUNTIME_ERROR;
+		servidor_stop_reactor(server);
+	}
+
+	for (int i = 1; i < launched; i++)
+	{
+		void *stopped;
+		pthread_join(threads[i], &stopped);
+
+		if ((intptr_t)stopped != EXIT_SUCCESS)
+			result = SERVER_RUNTIME_ERROR;
+	}
+
+	// Listeners whose reactor was never created
+	for (int i = launched; i < reactors; i++)
+		if (listeners[i] != server->conexion.socket)
+			close(listeners[i]);
+
+	return (int)result;
+}
+
+void servidor_stop_reactor(servidor_t *server)
+{
+	uint64_t stop = 1;
+
+	if (write(server->stop, &stop, sizeof(stop)) EQ ERROR)
+	{
+		LOG_ERROR("[Reactor] :=> Could not stop the reactors: %s", strerror(errno));
+	}
+}
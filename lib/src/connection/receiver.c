@@ -0,0 +1,222 @@
+/**
+ * @file receiver.c
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Per-connection pooled receive buffer
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/socket.h>
+
+#include "receiver.h"
+#include "transport.h"
+#include "lib.h"
+
+// ============================================================================================================
+//                                   ***** Private Definitions  *****
+// ============================================================================================================
+
+// The receivers, indexed by socket.
+static receiver_t *receivers[RECEIVERS_MAX];
+
+/**
+ * @brief Tells if a pointer belongs to the receiver buffer.
+ *
+ * @param receiver the receiver
+ * @param slice a pointer
+ * @return true if it is a pooled slice
+ */
+static inline bool is_pooled(receiver_t *receiver, void *slice)
+{
+	return (char *)slice >= receiver->buffer && (char *)slice <= receiver->buffer + receiver->capacity;
+}
+
+/**
+ * @brief Makes room for the next bytes, moving the unread ones to the start of the buffer.
+ *
+ * @param receiver the receiver
+ * @param size the bytes needed
+ * @return true if the bytes fit in the buffer
+ */
+static bool make_room(receiver_t *receiver, size_t size)
+{
+	if (receiver->head + size <= receiver->capacity)
+		return true;
+
+	// Slices still point into the buffer, it can not be moved.
+	if (receiver->slices > 0 || size > receiver->capacity)
+		return false;
+
+	size_t unread = receiver->tail - receiver->head;
+	memmove(receiver->buffer, receiver->buffer + receiver->head, unread);
+	receiver->head = 0;
+	receiver->tail = unread;
+
+	return true;
+}
+
+/**
+ * @brief Reads from the socket, as much as fits, until the next bytes are buffered.
+ *
+ * @param receiver the receiver
+ * @param size the bytes needed
+ * @return the bytes buffered, 0 if the peer disconnected or ERROR
+ */
+static ssize_t fill(receiver_t *receiver, size_t size)
+{
+	while (receiver->tail - receiver->head < size)
+	{
+		ssize_t received = transport_recv(receiver->socket, receiver->buffer + receiver->tail, receiver->capacity - receiver->tail, 0);
+
+		if (received EQ ERROR && errno EQ EINTR)
+			continue;
+
+		if (received <= 0)
+			return received;
+
+		receiver->tail += received;
+	}
+
+	return receiver->tail - receiver->head;
+}
+
+// ============================================================================================================
+//                                   ***** Public Functions  *****
+// ============================================================================================================
+
+receiver_t *receiver_attach(int socket, size_t capacity)
+{
+	if (socket < 0 || socket >= RECEIVERS_MAX)
+		return NULL;
+
+	receiver_detach(socket);
+
+	receiver_t *receiver = malloc(sizeof(receiver_t));
+	receiver->socket = socket;
+	receiver->buffer = malloc(capacity);
+	receiver->capacity = capacity;
+	receiver->head = 0;
+	receiver->tail = 0;
+	receiver->slices = 0;
+
+	receivers[socket] = receiver;
+
+	return receiver;
+}
+
+void receiver_detach(int socket)
+{
+	receiver_t *receiver = receiver_of(socket);
+
+	if (receiver == NULL)
+		return;
+
+	receivers[socket] = NULL;
+	free(receiver->buffer);
+	free(receiver);
+}
+
+inline receiver_t *receiver_of(int socket)
+{
+	return socket >= 0 && socket < RECEIVERS_MAX ? receivers[socket] : NULL;
+}
+
+ssize_t receiver_recv(receiver_t *receiver, void *destination, size_t size)
+{
+	if (make_room(receiver, size))
+	{
+		ssize_t buffered = fill(receiver, size);
+
+		if (buffered <= 0)
+			return buffered;
+
+		memcpy(destination, receiver->buffer + receiver->head, size);
+		receiver->head += size;
+	}
+	else
+	{
+		// Does not fit: hand over what is buffered and read the rest straight from the socket.
+		size_t buffered = receiver->tail - receiver->head;
+		buffered = buffered > size ? size : buffered;
+		memcpy(destination, receiver->buffer + receiver->head, buffered);
+		receiver->head += buffered;
+
+		if (buffered < size)
+		{
+			ssize_t received = transport_recv(receiver->socket, (char *)destination + buffered, size - buffered, MSG_WAITALL);
+
+			if (received <= 0)
+				return received;
+		}
+	}
+
+	// Nothing left unread and nothing lent, start over.
+	if (receiver->head EQ receiver->tail && receiver->slices EQ 0)
+		receiver->head = receiver->tail = 0;
+
+	return size;
+}
+
+void *receiver_slice(receiver_t *receiver, size_t size)
+{
+	if (make_room(receiver, size))
+	{
+		if (fill(receiver, size) <= 0 && size > 0)
+			return NULL;
+
+		void *slice = receiver->buffer + receiver->head;
+		receiver->head += size;
+		receiver->slices++;
+
+		return slice;
+	}
+
+	// Larger than the free space, fallback to the heap.
+	void *slice = malloc(size);
+
+	if (receiver_recv(receiver, slice, size) <= 0)
+	{
+		free(slice);
+		return NULL;
+	}
+
+	return slice;
+}
+
+void receiver_release(receiver_t *receiver, void *slice)
+{
+	if (slice == NULL)
+		return;
+
+	if (!is_pooled(receiver, slice))
+	{
+		free(slice);
+		return;
+	}
+
+	if (--receiver->slices EQ 0 && receiver->head EQ receiver->tail)
+		receiver->head = receiver->tail = 0;
+}
+
+size_t receiver_pending(int socket)
+{
+	receiver_t *receiver = receiver_of(socket);
+
+	return receiver ? receiver->tail - receiver->head : 0;
+}
+
+void receiver_release_stream(int socket, void *stream)
+{
+	receiver_t *receiver = receiver_of(socket);
+
+	if (receiver)
+		receiver_release(receiver, stream);
+	else
+		free(stream);
+}
@@ -9,23 +9,48 @@
 #include <pthread.h>
 #include <errno.h>
 #include <signal.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/un.h>
+#include <sys/eventfd.h>
 
 #include "server.h"
+#include "receiver.h"
+#include "transport.h"
+#include "tuning.h"
+#include "cfg.h"
 #include "network.h"
 #include "accion.h"
 #include "log.h"
+#include "metrics.h"
 #include "thread_manager.h"
 
 // ============================================================================================================
 //                               ***** Conexion -  Definiciones *****
 // ============================================================================================================
 
+// El header del último frame recibido por socket: recibir_operacion lo lee, el payload se recibe después.
+static wire_header_t frames[RECEIVERS_MAX];
+
+/**
+ * Un hilo aceptador: su socket de escucha y la rutina de cada cliente.
+ */
+typedef struct Aceptador
+{
+	// El servidor
+	servidor_t *server;
+	// El socket de escucha, no bloqueante
+	int listener;
+	// La rutina del hilo de cada cliente
+	void *(*rutina)(void *);
+} aceptador_t;
+
 // ============================================================================================================
 //                               ***** Funciones Privadas - Declaraciones *****
 // ============================================================================================================
 
 /**
- * Recibe un opcode.
+ * Recibe el header de un frame y lo guarda para recibir su payload.
  *
  * @param socket el socket del cliente
  * @return el opcode o -1 si error
@@ -41,6 +66,42 @@ static int recibir_operacion(int socket);
  */
 static void *recibir_buffer(int socket, ssize_t *bytes);
 
+/**
+ * Recibe un buffer. Si el socket tiene un receptor asociado, devuelve un slice del mismo.
+ *
+ * @param socket el socket del cliente
+ * @param size el tamaño en bytes del buffer recibido
+ * @return referencia a un buffer, a liberar con servidor_liberar_stream
+ */
+static void *recibir_slice(int socket, ssize_t *bytes);
+
+/**
+ * Recibe bytes, desde el receptor asociado al socket si lo hay.
+ *
+ * @param socket el socket del cliente
+ * @param destino donde copiar
+ * @param size los bytes a recibir
+ * @return los bytes recibidos, 0 si se desconectó o -1 si error
+ */
+static ssize_t recibir(int socket, void *destino, size_t size);
+
+/**
+ * Lanza el hilo de un cliente aceptado.
+ *
+ * @param server el servidor
+ * @param rutina la rutina del hilo, que recibe un int * con el socket
+ * @param fd el socket del cliente
+ */
+static void lanzar(servidor_t *server, void *(*rutina)(void *), int fd);
+
+/**
+ * Espera clientes en un socket de escucha no bloqueante y los acepta de a tandas, para siempre.
+ *
+ * @param aceptador el aceptador_t, que se libera al terminar
+ * @return null ptr
+ */
+static void *aceptador(void *aceptador);
+
 // ============================================================================================================
 //                               ***** Funciones Privadas - Definiciones *****
 // ============================================================================================================
@@ -49,20 +110,46 @@ static void *recibir_buffer(int socket, ssize_t *bytes);
 //  Streams
 // ------------------------------------------------------------
 
+static ssize_t recibir(int socket, void *destino, size_t size)
+{
+	receiver_t *receiver = receiver_of(socket);
+
+	return receiver ? receiver_recv(receiver, destino, size) : transport_recv(socket, destino, size, MSG_WAITALL);
+}
+
 static int recibir_operacion(int socket)
 {
-	// Variable a Exportar Opcode - el número de operación.
-	int opcode;
+	// Buffer local header - el header sin decodificar
+	uint8_t buffer[WIRE_HEADER_SIZE];
 	// Valor de Retorno Bytes - Los bytes recibidos o -1 si error.
 	ssize_t recv_ret;
 
-	recv_ret = recv(socket, &opcode, sizeof(int), MSG_WAITALL);
+	recv_ret = recibir(socket, buffer, WIRE_HEADER_SIZE);
 
 	if (recv_ret <= 0)
 		return recv_ret;
 
-	else
-		return opcode;
+	if (socket >= RECEIVERS_MAX || !wire_header_decode(buffer, &frames[socket]))
+	{
+		LOG_ERROR("[Server] :=> Client <%d> sent a frame with an invalid header", socket);
+		return ERROR;
+	}
+
+	// Las ofertas de memoria compartida se responden acá; el handler sólo recibe el opcode, sin payload.
+	if (frames[socket].opcode EQ SHM_LINK)
+	{
+		ssize_t size;
+		char *name = recibir_buffer(socket, &size);
+
+		if (name EQ NULL)
+			return ERROR;
+
+		name[size > 0 ? size - 1 : 0] = '\0';
+		transport_shm_accept(socket, name, transport_shm_enabled());
+		free(name);
+	}
+
+	return frames[socket].opcode;
 }
 
 static void *recibir_buffer(int socket, ssize_t *bytes_size)
@@ -72,18 +159,13 @@ static void *recibir_buffer(int socket, ssize_t *bytes_size)
 	 */
 	void *buffer_stream;
 
-	// Variable local tamaño
-	size_t size = 0;
-
-	// Valor de Retorno bytes - Los bytes recibidos o ERROR
-	ssize_t recv_ret = recv(socket, &size, sizeof(int), MSG_WAITALL);
-
-	if (recv_ret EQ ERROR)
-		return NULL;
+	// Variable local tamaño - el largo anunciado en el header
+	size_t size = frames[socket].length;
 
 	buffer_stream = malloc(size);
 
-	recv_ret = recv(socket, buffer_stream, size, MSG_WAITALL);
+	// Valor de Retorno bytes - Los bytes recibidos o ERROR
+	ssize_t recv_ret = recibir(socket, buffer_stream, size);
 
 	if (recv_ret EQ ERROR)
 	{
@@ -96,6 +178,24 @@ static void *recibir_buffer(int socket, ssize_t *bytes_size)
 	return buffer_stream;
 }
 
+static void *recibir_slice(int socket, ssize_t *bytes_size)
+{
+	receiver_t *receiver = receiver_of(socket);
+
+	if (receiver == NULL)
+		return recibir_buffer(socket, bytes_size);
+
+	// Variable local tamaño - el largo anunciado en el header
+	size_t size = frames[socket].length;
+
+	void *slice = receiver_slice(receiver, size);
+
+	if (slice)
+		*bytes_size = size;
+
+	return slice;
+}
+
 // ============================================================================================================
 //                               ***** Funciones Públicas, Definiciones *****
 // ============================================================================================================
@@ -116,19 +216,30 @@ servidor_t servidor_create(char *ip, char *port)
 	// As no client would be connected - set to error.
 	server.client = -1;
 
+	// Nunca se lee: una vez escrito despierta a todos los reactores, incluso a los que todavía no arrancaron
+	server.stop = eventfd(0, EFD_CLOEXEC);
+
 	server.tm = new_thread_manager();
+	thread_manager_use_pool(&server.tm, hilos_trabajadores());
 
 	return server;
 }
 
 void servidor_destroy(servidor_t *server)
 {
+	// El socket unix de un servidor queda en el sistema de archivos hasta borrarlo
+	if (server && server->conexion.info_server && server->conexion.info_server->ai_family EQ AF_UNIX)
+		unlink(((struct sockaddr_un *)server->conexion.info_server->ai_addr)->sun_path);
+
 	if (server)
 		conexion_destroy(&server->conexion);
 
 	if (server->client > 0)
 		servidor_desconectar_cliente(server->client);
 
+	if (server->stop >= 0)
+		close(server->stop);
+
 	thread_manager_destroy(&server->tm);
 }
 
@@ -149,14 +260,76 @@ void servidor_run(servidor_t *server, void *(*interceptor)(void *))
 	fd = server_accept_client(server);
 
 	if (fd > 0)
+		lanzar(server, interceptor, fd);
+}
+
+int servidor_run_acceptors(servidor_t *server, int acceptors, void *(*interceptor)(void *))
+{
+	int listener = server->conexion.socket;
+	fcntl(listener, F_SETFL, fcntl(listener, F_GETFL) | O_NONBLOCK);
+
+	// El hilo llamador es el primer aceptador, con el socket original
+	for (int i = 1; i < acceptors; i++)
 	{
-		int *newfd = malloc(sizeof(int));
-		*newfd = fd;
-		thread_manager_launch(&server->tm, interceptor, (void *)newfd);
+		// Sin SO_REUSEPORT (un socket unix) comparten el socket original
+		int other = conexion_escuchar_otra(&server->conexion);
+
+		aceptador_t *acceptor = malloc(sizeof(aceptador_t));
+		*acceptor = (aceptador_t){.server = server, .listener = other != ERROR ? other : listener, .rutina = interceptor};
+
+		thread_manager_launch(&server->tm, aceptador, acceptor);
 	}
+
+	LOG_DEBUG("[Server] :=> Accepting clients with %d acceptor(s).", acceptors > 1 ? acceptors : 1);
+
+	aceptador_t *caller = malloc(sizeof(aceptador_t));
+	*caller = (aceptador_t){.server = server, .listener = listener, .rutina = interceptor};
+	aceptador(caller);
+
+	return SERVER_RUNTIME_ERROR;
 }
 
 int server_accept_client(servidor_t *server)
+{
+	return server_accept_client_from(server, server->conexion.socket);
+}
+
+static void lanzar(servidor_t *server, void *(*rutina)(void *), int fd)
+{
+	int *newfd = malloc(sizeof(int));
+	*newfd = fd;
+	thread_manager_launch(&server->tm, rutina, (void *)newfd);
+}
+
+static void *aceptador(void *data)
+{
+	aceptador_t *this = data;
+	struct pollfd listener = {.fd = this->listener, .events = POLLIN};
+
+	for (;;)
+	{
+		if (poll(&listener, 1, -1) EQ ERROR)
+		{
+			if (errno EQ EINTR)
+				continue;
+
+			LOG_ERROR("[Server] :=> Could not wait for clients: %s", strerror(errno));
+			break;
+		}
+
+		int fd;
+
+		// Acepta todo lo pendiente hasta EAGAIN
+		while ((fd = server_accept_client_from(this->server, this->listener)) > 0)
+			lanzar(this->server, this->rutina, fd);
+	}
+
+	free(this);
+
+	return NULL;
+}
+
+int server_accept_client_from(servidor_t *server, int listener)
 {
 
 	// Error number
@@ -169,18 +342,28 @@ int server_accept_client(servidor_t *server)
 
 	int fd = -1;
 
-	fd = accept(server->conexion.socket, (struct sockaddr *)&remoteaddr, &addrlen);
+	fd = accept(listener, (struct sockaddr *)&remoteaddr, &addrlen);
 
-	if (fd > 0)
+	if (fd > 0 && remoteaddr.ss_family EQ AF_UNIX)
+	{
+		LOG_DEBUG("[Server] :=> A new local connection is using socket <%d>.", fd);
+
+		transport_records_attach(fd);
+		atomic_store(&server->client, fd);
+	}
+	else if (fd > 0)
 	{
 		char remoteIP[INET6_ADDRSTRLEN];
 
+		// Pedidos y respuestas son frames chicos: que salgan según la configuración del módulo
+		socket_tuning_apply(fd, socket_tuning_from_config());
+
 		LOG_DEBUG("[Server] :=> A new connection from <%s> is using socket <%d>.",
 				  inet_ntop(remoteaddr.ss_family, get_in_addr((struct sockaddr *)&remoteaddr),
 							remoteIP, INET6_ADDRSTRLEN),
 				  fd);
 
-		server->client = fd;
+		atomic_store(&server->client, fd);
 	}
 	else
 	{
@@ -193,6 +376,7 @@ int server_accept_client(servidor_t *server)
 
 void servidor_desconectar_cliente(int socket)
 {
+	transport_detach(socket);
 	close(socket);
 }
 
@@ -205,6 +389,11 @@ inline int servidor_recibir_operacion(int socket)
 	return recibir_operacion(socket);
 }
 
+inline uint32_t servidor_id_recibido(int socket)
+{
+	return socket < RECEIVERS_MAX ? frames[socket].id : 0;
+}
+
 // ----------------------
 //  Mensajes
 // ----------------------
@@ -221,7 +410,12 @@ inline ssize_t servidor_enviar_mensaje(int socket, char *msg)
 
 inline void *servidor_recibir_stream(int socket, ssize_t *bytes)
 {
-	return recibir_buffer(socket, bytes);
+	return recibir_slice(socket, bytes);
+}
+
+inline void servidor_liberar_stream(int socket, void *stream)
+{
+	receiver_release_stream(socket, stream);
 }
 
 inline ssize_t servidor_enviar_stream(int opcode, int socket, void *stream, ssize_t size)
@@ -237,3 +431,20 @@ ssize_t servidor_enviar_accion(int socket, void *accion)
 {
 	return accion_enviar((accion_t *)accion, socket);
 }
+
+// ----------------------
+//  Métricas
+// ----------------------
+
+ssize_t servidor_enviar_metricas(int socket)
+{
+	// La foto cambia mientras se arma: primero el largo, después el texto (recortado si creció)
+	size_t largo = metrics_format(NULL, 0) + 1;
+	char *foto = malloc(largo);
+	metrics_format(foto, largo);
+
+	ssize_t bytes = enviar_stream(STATS, foto, strlen(foto) + 1, socket);
+	free(foto);
+
+	return bytes;
+}
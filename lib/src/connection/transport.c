@@ -0,0 +1,645 @@
+/**
+ * @file transport.c
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Per-socket transports: shared-memory links and record (SOCK_SEQPACKET) sockets
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <commons/string.h>
+
+#include "transport.h"
+#include "tuning.h"
+#include "conexion.h"
+#include "receiver.h"
+#include "cfg.h"
+#include "lib.h"
+#include "log.h"
+
+// ============================================================================================================
+//                                   ***** Private Definitions  *****
+// ============================================================================================================
+
+// The links, indexed by socket.
+static transport_t *transports[RECEIVERS_MAX];
+
+// Guards setting and clearing the links, so that a link is only ever taken down once.
+static pthread_mutex_t links = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief What is left of the last record read from a record socket.
+ *
+ */
+typedef struct RecordStage
+{
+	// The bytes, TRANSPORT_RECORD_MAX at most.
+	char *buffer;
+	// The first byte not handed out.
+	size_t head;
+	// One past the last byte.
+	size_t tail;
+	// Keeps the records of a frame together: another sender's cannot fall between them.
+	pthread_mutex_t sending;
+} record_stage_t;
+
+// The record stages, indexed by socket.
+static record_stage_t *stages[RECEIVERS_MAX];
+
+// Segments created by this process, to keep their names unique.
+static _Atomic uint32_t segments_created;
+
+// Room taken by a ring header, so that both rings start cache-line aligned.
+#define RING_HEADER_SIZE 64
+// The bytes of a ring, header included.
+#define RING_SIZE (RING_HEADER_SIZE + TRANSPORT_RING_CAPACITY)
+// The bytes of a segment: the client to server ring, then the server to client one.
+#define SEGMENT_SIZE (2 * RING_SIZE)
+
+_Static_assert(sizeof(shm_ring_t) <= RING_HEADER_SIZE, "The ring header does not fit");
+_Static_assert((TRANSPORT_RING_CAPACITY & (TRANSPORT_RING_CAPACITY - 1)) == 0, "The ring capacity must be a power of two");
+
+// Answers to a link offer.
+#define LINK_DECLINED 0
+#define LINK_ACCEPTED 1
+
+static inline shm_ring_t *ring_at(void *segment, int index)
+{
+	return (shm_ring_t *)((char *)segment + index * RING_SIZE);
+}
+
+// -----------------------------------------------------------
+//  Waiting
+// ------------------------------------------------------------
+
+/**
+ * @brief Sleeps until the ring moves past the sequence seen, or for TRANSPORT_POLL_MS at most.
+ * The futex is not private: the other side sleeps in another process.
+ *
+ * @param ring the ring
+ * @param seen the sequence seen before deciding to wait
+ */
+static void ring_wait(shm_ring_t *ring, uint32_t seen)
+{
+	struct timespec timeout = {.tv_sec = 0, .tv_nsec = TRANSPORT_POLL_MS * 1000000L};
+
+	atomic_fetch_add(&ring->waiters, 1);
+	syscall(SYS_futex, &ring->sequence, FUTEX_WAIT, seen, &timeout, NULL, 0);
+	atomic_fetch_sub(&ring->waiters, 1);
+}
+
+/**
+ * @brief Tells the other side the ring moved.
+ *
+ * @param ring the ring
+ */
+static void ring_notify(shm_ring_t *ring)
+{
+	atomic_fetch_add(&ring->sequence, 1);
+
+	if (atomic_load(&ring->waiters) > 0)
+		syscall(SYS_futex, &ring->sequence, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+/**
+ * @brief Tells if the peer left: either it closed the link or its socket end is gone (it may have crashed).
+ *
+ * @param transport the link
+ * @param ring the ring being waited on
+ * @return true if nothing else will move the ring
+ */
+static bool peer_gone(transport_t *transport, shm_ring_t *ring)
+{
+	if (atomic_load(&ring->closed))
+		return true;
+
+	char byte;
+	ssize_t peeked = recv(transport->socket, &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+
+	return peeked EQ 0 || (peeked EQ ERROR && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR);
+}
+
+// -----------------------------------------------------------
+//  Rings
+// ------------------------------------------------------------
+
+static void ring_init(shm_ring_t *ring)
+{
+	atomic_init(&ring->head, 0);
+	atomic_init(&ring->tail, 0);
+	atomic_init(&ring->sequence, 0);
+	atomic_init(&ring->waiters, 0);
+	atomic_init(&ring->closed, 0);
+	ring->capacity = TRANSPORT_RING_CAPACITY;
+}
+
+/**
+ * @brief Writes every byte, waiting for the consumer while the ring is full.
+ *
+ * @return the bytes written, or ERROR if the peer left
+ */
+static ssize_t ring_write(transport_t *transport, const char *bytes, size_t size)
+{
+	shm_ring_t *ring = transport->tx;
+	size_t written = 0;
+
+	while (written < size)
+	{
+		uint32_t seen = atomic_load(&ring->sequence);
+		uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+		uint32_t room = ring->capacity - (tail - atomic_load_explicit(&ring->head, memory_order_acquire));
+
+		if (room EQ 0)
+		{
+			if (peer_gone(transport, ring))
+				return ERROR;
+
+			ring_wait(ring, seen);
+			continue;
+		}
+
+		size_t chunk = size - written < room ? size - written : room;
+		uint32_t offset = tail & (ring->capacity - 1);
+		size_t first = chunk < ring->capacity - offset ? chunk : ring->capacity - offset;
+
+		memcpy(ring->data + offset, bytes + written, first);
+		memcpy(ring->data, bytes + written + first, chunk - first);
+
+		atomic_store_explicit(&ring->tail, tail + chunk, memory_order_release);
+		ring_notify(ring);
+
+		written += chunk;
+	}
+
+	return written;
+}
+
+/**
+ * @brief Reads up to size bytes, waiting while the ring is empty; with MSG_WAITALL until size are read.
+ *
+ * @return the bytes read, 0 if the peer left
+ */
+static ssize_t ring_read(transport_t *transport, char *bytes, size_t size, int flags)
+{
+	shm_ring_t *ring = transport->rx;
+	size_t done = 0;
+
+	while (done < size)
+	{
+		uint32_t seen = atomic_load(&ring->sequence);
+		uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+		uint32_t available = atomic_load_explicit(&ring->tail, memory_order_acquire) - head;
+
+		if (available EQ 0)
+		{
+			// Whatever arrived is enough unless told to wait for all of it.
+			if (done > 0 && !(flags & MSG_WAITALL))
+				break;
+
+			if (peer_gone(transport, ring))
+				return done;
+
+			ring_wait(ring, seen);
+			continue;
+		}
+
+		size_t chunk = size - done < available ? size - done : available;
+		uint32_t offset = head & (ring->capacity - 1);
+		size_t first = chunk < ring->capacity - offset ? chunk : ring->capacity - offset;
+
+		memcpy(bytes + done, ring->data + offset, first);
+		memcpy(bytes + done + first, ring->data, chunk - first);
+
+		atomic_store_explicit(&ring->head, head + chunk, memory_order_release);
+		ring_notify(ring);
+
+		done += chunk;
+	}
+
+	return done;
+}
+
+// -----------------------------------------------------------
+//  Records
+// ------------------------------------------------------------
+
+/**
+ * @brief Sends the segments as records of TRANSPORT_RECORD_MAX bytes at most; sendmsg takes each whole.
+ *
+ * @return the bytes sent or ERROR
+ */
+static ssize_t records_send(int socket, record_stage_t *stage, const struct iovec *segments, int count)
+{
+	struct iovec window[count];
+	ssize_t total = 0;
+
+	// The first segment not sent yet, and the bytes of it that were
+	int first = 0;
+	size_t skip = 0;
+
+	pthread_mutex_lock(&stage->sending);
+
+	while (first < count)
+	{
+		int parts = 0;
+		size_t bytes = 0;
+
+		for (int i = first; i < count && bytes < TRANSPORT_RECORD_MAX; i++)
+		{
+			size_t from = i EQ first ? skip : 0;
+			size_t left = segments[i].iov_len - from;
+			size_t take = left < TRANSPORT_RECORD_MAX - bytes ? left : TRANSPORT_RECORD_MAX - bytes;
+
+			window[parts++] = (struct iovec){.iov_base = (char *)segments[i].iov_base + from, .iov_len = take};
+			bytes += take;
+		}
+
+		if (bytes EQ 0)
+			break;
+
+		struct msghdr message = {.msg_iov = window, .msg_iovlen = parts};
+		ssize_t sent = sendmsg(socket, &message, MSG_NOSIGNAL);
+
+		if (sent EQ ERROR)
+		{
+			if (errno EQ EINTR)
+				continue;
+			total = ERROR;
+			break;
+		}
+
+		total += sent;
+
+		// Moves past the bytes of the record
+		while (first < count && (size_t)sent >= segments[first].iov_len - skip)
+		{
+			sent -= segments[first].iov_len - skip;
+			first++;
+			skip = 0;
+		}
+
+		skip += sent;
+	}
+
+	pthread_mutex_unlock(&stage->sending);
+
+	return total;
+}
+
+/**
+ * @brief Receives from a record socket: staged bytes first, then whole records, split between the buffer and the stage.
+ *
+ * @return the bytes received, 0 if the peer left or ERROR
+ */
+static ssize_t records_recv(int socket, record_stage_t *stage, char *buffer, size_t size, int flags)
+{
+	size_t done = 0;
+
+	while (done < size)
+	{
+		if (stage->head < stage->tail)
+		{
+			size_t staged = stage->tail - stage->head;
+			size_t chunk = size - done < staged ? size - done : staged;
+
+			memcpy(buffer + done, stage->buffer + stage->head, chunk);
+			stage->head += chunk;
+			done += chunk;
+			continue;
+		}
+
+		// Whatever arrived is enough unless told to wait for all of it.
+		if (done > 0 && !(flags & MSG_WAITALL))
+			break;
+
+		struct iovec parts[] = {
+			{.iov_base = buffer + done, .iov_len = size - done},
+			{.iov_base = stage->buffer, .iov_len = TRANSPORT_RECORD_MAX},
+		};
+		struct msghdr message = {.msg_iov = parts, .msg_iovlen = 2};
+
+		ssize_t received = recvmsg(socket, &message, flags & ~MSG_WAITALL);
+
+		if (received EQ ERROR && errno EQ EINTR)
+			continue;
+
+		if (received <= 0)
+			return done > 0 ? (ssize_t)done : received;
+
+		if (message.msg_flags & MSG_TRUNC)
+		{
+			LOG_ERROR("[Transport] :=> Socket <%d> received a record larger than %d bytes", socket, TRANSPORT_RECORD_MAX);
+			return ERROR;
+		}
+
+		if ((size_t)received > size - done)
+		{
+			stage->head = 0;
+			stage->tail = received - (size - done);
+			done = size;
+		}
+		else
+			done += received;
+	}
+
+	return done;
+}
+
+// -----------------------------------------------------------
+//  Links
+// ------------------------------------------------------------
+
+/**
+ * @brief Maps a segment and binds it to a socket.
+ *
+ * @param socket the socket
+ * @param fd the segment file descriptor
+ * @param creator whether this side created it (the client), which picks the ring it sends on
+ * @return the link, or NULL
+ */
+static transport_t *transport_map(int socket, int fd, bool creator)
+{
+	void *segment = mmap(NULL, SEGMENT_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+	if (segment EQ MAP_FAILED)
+		return NULL;
+
+	if (creator)
+	{
+		ring_init(ring_at(segment, 0));
+		ring_init(ring_at(segment, 1));
+	}
+
+	transport_t *transport = malloc(sizeof(transport_t));
+	transport->socket = socket;
+	transport->segment = segment;
+	transport->tx = ring_at(segment, creator ? 0 : 1);
+	transport->rx = ring_at(segment, creator ? 1 : 0);
+	pthread_mutex_init(&transport->sending, NULL);
+	pthread_mutex_init(&transport->receiving, NULL);
+	atomic_init(&transport->references, 1);
+
+	return transport;
+}
+
+static void transport_unmap(transport_t *transport)
+{
+	pthread_mutex_destroy(&transport->sending);
+	pthread_mutex_destroy(&transport->receiving);
+	munmap(transport->segment, SEGMENT_SIZE);
+	free(transport);
+}
+
+/**
+ * @brief Gets the link of a socket, holding it until transport_release: a detach meanwhile cannot unmap it.
+ *
+ * @return the link, or NULL if the socket is plain
+ */
+static transport_t *transport_acquire(int socket)
+{
+	if (socket < 0 || socket >= RECEIVERS_MAX)
+		return NULL;
+
+	pthread_mutex_lock(&links);
+	transport_t *transport = transports[socket];
+	if (transport)
+		atomic_fetch_add(&transport->references, 1);
+	pthread_mutex_unlock(&links);
+
+	return transport;
+}
+
+static void transport_release(transport_t *transport)
+{
+	if (atomic_fetch_sub(&transport->references, 1) EQ 1)
+		transport_unmap(transport);
+}
+
+// ============================================================================================================
+//                                   ***** Public Functions  *****
+// ============================================================================================================
+
+bool transport_shm_enabled(void)
+{
+	return string_equals_ignore_case(transporte(), "SHM");
+}
+
+int transport_shm_connect(int socket)
+{
+	if (socket < 0 || socket >= RECEIVERS_MAX)
+		return ERROR;
+
+	char name[NAME_MAX];
+	snprintf(name, sizeof(name), "/sski-%d-%d-%u", getpid(), socket, atomic_fetch_add(&segments_created, 1));
+
+	int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+
+	if (fd EQ ERROR)
+	{
+		LOG_ERROR("[Transport] :=> Could not create the shared memory segment %s: %s", name, strerror(errno));
+		return ERROR;
+	}
+
+	transport_t *transport = ftruncate(fd, SEGMENT_SIZE) EQ ERROR ? NULL : transport_map(socket, fd, true);
+	close(fd);
+
+	// The offer still travels through the socket, as does its answer.
+	uint32_t answer = LINK_DECLINED;
+
+	if (transport
+		&& enviar_stream(SHM_LINK, name, strlen(name) + 1, socket) > 0
+		&& recv(socket, &answer, sizeof(answer), MSG_WAITALL) EQ sizeof(answer)
+		&& answer EQ LINK_ACCEPTED)
+	{
+		pthread_mutex_lock(&links);
+		transports[socket] = transport;
+		pthread_mutex_unlock(&links);
+	}
+	else if (transport)
+	{
+		transport_unmap(transport);
+		transport = NULL;
+	}
+
+	// Both sides have it mapped by now (or never will): the name is no longer needed.
+	shm_unlink(name);
+
+	if (transport EQ NULL)
+		return ERROR;
+
+	LOG_DEBUG("[Transport] :=> Socket <%d> linked through shared memory %s", socket, name);
+
+	return SUCCESS;
+}
+
+int transport_shm_accept(int socket, const char *name, bool enabled)
+{
+	transport_t *transport = NULL;
+
+	if (enabled && socket >= 0 && socket < RECEIVERS_MAX)
+	{
+		int fd = shm_open(name, O_RDWR, 0600);
+
+		if (fd != ERROR)
+		{
+			transport = transport_map(socket, fd, false);
+			close(fd);
+		}
+		else
+			LOG_ERROR("[Transport] :=> Could not open the shared memory segment %s: %s", name, strerror(errno));
+	}
+
+	uint32_t answer = transport ? LINK_ACCEPTED : LINK_DECLINED;
+
+	if (send(socket, &answer, sizeof(answer), MSG_NOSIGNAL) != sizeof(answer))
+	{
+		if (transport)
+			transport_unmap(transport);
+
+		return ERROR;
+	}
+
+	if (transport EQ NULL)
+	{
+		LOG_WARNING("[Transport] :=> Client <%d> offered shared memory, staying on its socket", socket);
+		return ERROR;
+	}
+
+	pthread_mutex_lock(&links);
+	transports[socket] = transport;
+	pthread_mutex_unlock(&links);
+
+	LOG_DEBUG("[Transport] :=> Client <%d> linked through shared memory %s", socket, name);
+
+	return SUCCESS;
+}
+
+void transport_records_attach(int socket)
+{
+	if (socket < 0 || socket >= RECEIVERS_MAX || stages[socket])
+		return;
+
+	record_stage_t *stage = malloc(sizeof(record_stage_t));
+	stage->buffer = malloc(TRANSPORT_RECORD_MAX);
+	stage->head = stage->tail = 0;
+	pthread_mutex_init(&stage->sending, NULL);
+
+	stages[socket] = stage;
+}
+
+inline transport_t *transport_of(int socket)
+{
+	return socket >= 0 && socket < RECEIVERS_MAX ? transports[socket] : NULL;
+}
+
+void transport_detach(int socket)
+{
+	if (socket >= 0 && socket < RECEIVERS_MAX && stages[socket])
+	{
+		// Waits for a frame still leaving through it
+		pthread_mutex_lock(&stages[socket]->sending);
+		pthread_mutex_unlock(&stages[socket]->sending);
+		pthread_mutex_destroy(&stages[socket]->sending);
+
+		free(stages[socket]->buffer);
+		free(stages[socket]);
+		stages[socket] = NULL;
+	}
+
+	socket_tuning_forget(socket);
+
+	if (socket < 0 || socket >= RECEIVERS_MAX)
+		return;
+
+	// Looked up and cleared together: of two threads detaching the same socket, only one takes the link down
+	pthread_mutex_lock(&links);
+	transport_t *transport = transports[socket];
+	transports[socket] = NULL;
+	pthread_mutex_unlock(&links);
+
+	if (transport EQ NULL)
+		return;
+
+	// Wakes up the peer and any local thread still blocked on the link.
+	atomic_store(&transport->tx->closed, 1);
+	atomic_store(&transport->rx->closed, 1);
+	ring_notify(transport->tx);
+	ring_notify(transport->rx);
+
+	// The last of them to leave it unmaps it.
+	transport_release(transport);
+}
+
+ssize_t transport_send(int socket, const struct iovec *segments, int count)
+{
+	transport_t *transport = transport_acquire(socket);
+
+	if (transport EQ NULL && socket >= 0 && socket < RECEIVERS_MAX && stages[socket])
+		return records_send(socket, stages[socket], segments, count);
+
+	if (transport EQ NULL)
+	{
+		struct msghdr message = {.msg_iov = (struct iovec *)segments, .msg_iovlen = count};
+		ssize_t sent = sendmsg(socket, &message, MSG_NOSIGNAL);
+
+		socket_tuning_sent(socket);
+		return sent;
+	}
+
+	ssize_t total = 0;
+
+	pthread_mutex_lock(&transport->sending);
+
+	for (int i = 0; i < count && total != ERROR; i++)
+		if (ring_write(transport, segments[i].iov_base, segments[i].iov_len) EQ ERROR)
+			total = ERROR;
+		else
+			total += segments[i].iov_len;
+
+	pthread_mutex_unlock(&transport->sending);
+	transport_release(transport);
+
+	return total;
+}
+
+ssize_t transport_recv(int socket, void *buffer, size_t size, int flags)
+{
+	transport_t *transport = transport_acquire(socket);
+
+	if (transport EQ NULL && socket >= 0 && socket < RECEIVERS_MAX && stages[socket])
+		return records_recv(socket, stages[socket], buffer, size, flags);
+
+	if (transport EQ NULL)
+	{
+		// Whatever this side corked may be what the peer has to answer
+		if (!(flags & MSG_DONTWAIT))
+			socket_flush(socket);
+
+		ssize_t received = recv(socket, buffer, size, flags);
+
+		if (received > 0)
+			socket_tuning_received(socket);
+
+		return received;
+	}
+
+	pthread_mutex_lock(&transport->receiving);
+	ssize_t received = ring_read(transport, buffer, size, flags);
+	pthread_mutex_unlock(&transport->receiving);
+	transport_release(transport);
+
+	return received;
+}
@@ -0,0 +1,156 @@
+/**
+ * @file tuning.c
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Per-connection socket tuning: Nagle, corking and buffer sizes
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <string.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#include "tuning.h"
+#include "receiver.h"
+#include "cfg.h"
+#include "lib.h"
+#include "log.h"
+
+// ============================================================================================================
+//                                   ***** Private Definitions  *****
+// ============================================================================================================
+
+// Whether a socket is corked, indexed by socket.
+static bool corked[RECEIVERS_MAX];
+
+// Whether a corked socket holds bytes not flushed yet, indexed by socket.
+static _Atomic bool pending[RECEIVERS_MAX];
+
+// Whether a socket acknowledges right away, indexed by socket. Linux drops TCP_QUICKACK on its own.
+static bool quickack[RECEIVERS_MAX];
+
+/**
+ * @brief Tells if a socket is TCP.
+ *
+ * @param socket the socket
+ * @return true if it is
+ */
+static bool is_tcp(int socket)
+{
+	struct sockaddr_storage address;
+	socklen_t length = sizeof(address);
+
+	return getsockname(socket, (struct sockaddr *)&address, &length) != ERROR
+		   && (address.ss_family EQ AF_INET || address.ss_family EQ AF_INET6);
+}
+
+/**
+ * @brief setsockopt(2) of an int option, logging a refusal.
+ *
+ * @return SUCCESS or ERROR
+ */
+static int set_option(int socket, int level, int option, int value, const char *name)
+{
+	if (setsockopt(socket, level, option, &value, sizeof(value)) EQ ERROR)
+	{
+		LOG_WARNING("[Tuning] :=> Socket <%d> refused %s=%d: %s", socket, name, value, strerror(errno));
+		return ERROR;
+	}
+
+	return SUCCESS;
+}
+
+// ============================================================================================================
+//                                   ***** Public Functions  *****
+// ============================================================================================================
+
+socket_tuning_t socket_tuning_from_config(void)
+{
+	return (socket_tuning_t){
+		.nodelay = sin_demora(),
+		.cork = agrupar_envios(),
+		.send_buffer = buffer_envio(),
+		.receive_buffer = buffer_recepcion(),
+	};
+}
+
+int socket_tuning_buffers(int socket, socket_tuning_t tuning)
+{
+	int status = SUCCESS;
+
+	if (tuning.send_buffer > 0 && set_option(socket, SOL_SOCKET, SO_SNDBUF, tuning.send_buffer, "SO_SNDBUF") EQ ERROR)
+		status = ERROR;
+
+	if (tuning.receive_buffer > 0 && set_option(socket, SOL_SOCKET, SO_RCVBUF, tuning.receive_buffer, "SO_RCVBUF") EQ ERROR)
+		status = ERROR;
+
+	return status;
+}
+
+int socket_tuning_apply(int socket, socket_tuning_t tuning)
+{
+	if (!is_tcp(socket))
+		return SUCCESS;
+
+	int status = SUCCESS;
+
+	if (set_option(socket, IPPROTO_TCP, TCP_NODELAY, tuning.nodelay, "TCP_NODELAY") EQ ERROR)
+		status = ERROR;
+
+	// Replies are due right after a request: do not hold its ACK back waiting for one
+	if (tuning.nodelay && set_option(socket, IPPROTO_TCP, TCP_QUICKACK, 1, "TCP_QUICKACK") != ERROR && socket < RECEIVERS_MAX)
+		quickack[socket] = true;
+
+	if (tuning.cork && socket < RECEIVERS_MAX)
+	{
+		if (set_option(socket, IPPROTO_TCP, TCP_CORK, 1, "TCP_CORK") EQ ERROR)
+			status = ERROR;
+		else
+			corked[socket] = true;
+	}
+
+	return status;
+}
+
+void socket_tuning_sent(int socket)
+{
+	if (socket >= 0 && socket < RECEIVERS_MAX && corked[socket])
+		atomic_store(&pending[socket], true);
+}
+
+void socket_tuning_received(int socket)
+{
+	// It is not sticky: the kernel goes back to delayed ACKs, so it is armed again after every read
+	if (socket >= 0 && socket < RECEIVERS_MAX && quickack[socket])
+	{
+		int on = 1;
+		setsockopt(socket, IPPROTO_TCP, TCP_QUICKACK, &on, sizeof(on));
+	}
+}
+
+void socket_flush(int socket)
+{
+	if (socket < 0 || socket >= RECEIVERS_MAX || !corked[socket] || !atomic_exchange(&pending[socket], false))
+		return;
+
+	// Uncorking sends the partial segment right away; the socket is corked again for the next burst
+	int off = 0, on = 1;
+	setsockopt(socket, IPPROTO_TCP, TCP_CORK, &off, sizeof(off));
+	setsockopt(socket, IPPROTO_TCP, TCP_CORK, &on, sizeof(on));
+}
+
+void socket_tuning_forget(int socket)
+{
+	if (socket < 0 || socket >= RECEIVERS_MAX)
+		return;
+
+	corked[socket] = false;
+	quickack[socket] = false;
+	atomic_store(&pending[socket], false);
+}
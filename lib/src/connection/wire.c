@@ -0,0 +1,148 @@
+/**
+ * @file wire.c
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Wire format: frame header and payload codecs
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdlib.h>
+
+#include "wire.h"
+#include "lib.h"
+
+// ============================================================================================================
+//                                   ***** Public Functions  *****
+// ============================================================================================================
+
+// -----------------------------------------------------------
+//  Header
+// ------------------------------------------------------------
+
+void wire_header_encode(void *buffer, opcode_t opcode, uint32_t id, uint32_t length)
+{
+	uint8_t *header = buffer;
+
+	header[0] = WIRE_MAGIC;
+	header[1] = WIRE_VERSION;
+	header[2] = (uint16_t)opcode & 0xFF;
+	header[3] = (uint16_t)opcode >> 8;
+	wire_put_u32(header + 4, id);
+	wire_put_u32(header + 8, length);
+}
+
+bool wire_header_decode(const void *buffer, wire_header_t *header)
+{
+	const uint8_t *bytes = buffer;
+
+	if (bytes[0] != WIRE_MAGIC || bytes[1] != WIRE_VERSION)
+		return false;
+
+	header->opcode = bytes[2] | bytes[3] << 8;
+	header->id = wire_get_u32(bytes + 4);
+	header->length = wire_get_u32(bytes + 8);
+
+	return header->length <= WIRE_PAYLOAD_MAX;
+}
+
+// -----------------------------------------------------------
+//  Fixed-size fields
+// ------------------------------------------------------------
+
+void wire_put_u32(void *buffer, uint32_t value)
+{
+	uint8_t *bytes = buffer;
+
+	for (int i = 0; i < 4; i++)
+		bytes[i] = value >> (8 * i);
+}
+
+uint32_t wire_get_u32(const void *buffer)
+{
+	const uint8_t *bytes = buffer;
+
+	return (uint32_t)bytes[0] | (uint32_t)bytes[1] << 8 | (uint32_t)bytes[2] << 16 | (uint32_t)bytes[3] << 24;
+}
+
+// -----------------------------------------------------------
+//  Varints
+// ------------------------------------------------------------
+
+size_t wire_varint_size(uint32_t value)
+{
+	size_t size = 1;
+
+	while (value >= 0x80)
+	{
+		value >>= 7;
+		size++;
+	}
+
+	return size;
+}
+
+void wire_writer_init(wire_writer_t *writer, size_t capacity)
+{
+	writer->capacity = capacity > 0 ? capacity : WIRE_VARINT_MAX;
+	writer->buffer = malloc(writer->capacity);
+	writer->size = 0;
+}
+
+void wire_write_varint(wire_writer_t *writer, uint32_t value)
+{
+	if (writer->size + WIRE_VARINT_MAX > writer->capacity)
+	{
+		writer->capacity = 2 * writer->capacity + WIRE_VARINT_MAX;
+		writer->buffer = realloc(writer->buffer, writer->capacity);
+	}
+
+	// Seven bits at a time, lowest first; the high bit tells whether more follow
+	while (value >= 0x80)
+	{
+		writer->buffer[writer->size++] = (value & 0x7F) | 0x80;
+		value >>= 7;
+	}
+
+	writer->buffer[writer->size++] = value;
+}
+
+void wire_writer_destroy(wire_writer_t *writer)
+{
+	free(writer->buffer);
+	writer->buffer = NULL;
+	writer->size = writer->capacity = 0;
+}
+
+wire_reader_t wire_reader_create(const void *buffer, size_t size)
+{
+	return (wire_reader_t){.buffer = buffer, .size = buffer ? size : 0, .offset = 0, .failed = buffer == NULL};
+}
+
+uint32_t wire_read_varint(wire_reader_t *reader)
+{
+	uint32_t value = 0;
+
+	for (int i = 0; !reader->failed && i < WIRE_VARINT_MAX; i++)
+	{
+		if (reader->offset >= reader->size)
+			break;
+
+		uint8_t byte = reader->buffer[reader->offset++];
+
+		// The fifth byte only holds the 4 highest bits
+		if (i EQ WIRE_VARINT_MAX - 1 && byte > 0x0F)
+			break;
+
+		value |= (uint32_t)(byte & 0x7F) << (7 * i);
+
+		if ((byte & 0x80) == 0)
+			return value;
+	}
+
+	reader->failed = true;
+
+	return 0;
+}
@@ -11,6 +11,7 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 
 #include "instruction.h"
 #include "conexion.h"
@@ -48,65 +49,114 @@ void instruction_destroy(void *instruction)
 		free(instruction);
 }
 
-void *instruction_to_stream(void *instruction)
+void instruction_encode(instruction_t *instruction, wire_writer_t *writer)
 {
-	instruction_t *this = (instruction_t *)instruction;
-	void *stream = malloc(sizeof(instruction_t));
+	wire_write_varint(writer, instruction->icode);
+	wire_write_varint(writer, instruction->param0);
+	wire_write_varint(writer, instruction->param1);
+}
 
-	size_t offset = 0lu;
+instruction_t *instruction_decode(wire_reader_t *reader)
+{
+	uint32_t icode = wire_read_varint(reader);
+	uint32_t param0 = wire_read_varint(reader);
+	uint32_t param1 = wire_read_varint(reader);
 
-	memcpy(stream + offset, &this->icode, sizeof(instcode_t));
-	offset += sizeof(instcode_t);
-	memcpy(stream + offset, &this->param0, sizeof(uint32_t));
-	offset += sizeof(uint32_t);
-	memcpy(stream + offset, &this->param1, sizeof(uint32_t));
-	offset += sizeof(uint32_t);
+	if (reader->failed || icode >= NO_INSTRUCTION)
+	{
+		reader->failed = true;
+		return NULL;
+	}
 
-	return stream;
+	return instruction_create(icode, param0, param1);
+}
+
+void *instruction_to_stream(void *instruction)
+{
+	wire_writer_t writer;
+	wire_writer_init(&writer, 3 * WIRE_VARINT_MAX);
+	instruction_encode(instruction, &writer);
+
+	return writer.buffer;
 }
 
 instruction_t *instruction_from_stream(void *stream)
 {
-	instcode_t _icode = NO_INSTRUCTION;
-	uint32_t _param0 = 0u, _param1 = 0u;
-
-	size_t offset = 0lu;
-	memcpy(&_icode, stream, sizeof(instcode_t));
-	offset += sizeof(instcode_t);
-	memcpy(&_param0, stream + offset, sizeof(uint32_t));
-	offset += sizeof(uint32_t);
-	memcpy(&_param1, stream + offset, sizeof(uint32_t));
-	offset += sizeof(uint32_t);
-
-	return instruction_create(_icode, _param0, _param1);
+	wire_reader_t reader = wire_reader_create(stream, SIZE_MAX);
+
+	return instruction_decode(&reader);
 }
 
-void *instruction_list_from(void *stream)
+void instruction_list_encode(t_list *instructions, wire_writer_t *writer)
 {
-	t_list *list = list_create();
-	uint32_t size = 0;
-	size_t offset = 0;
+	wire_write_varint(writer, list_size(instructions));
 
-	memcpy(&size, stream, sizeof(uint32_t));
-	offset += sizeof(uint32_t);
+	void encode(void *instruction) { instruction_encode(instruction, writer); }
+	list_iterate(instructions, encode);
+}
+
+t_list *instruction_list_decode(wire_reader_t *reader)
+{
+	t_list *list = list_create();
+	uint32_t size = wire_read_varint(reader);
 
-	for (uint32_t i = 0; i < size; i++)
+	for (uint32_t i = 0; i < size && !reader->failed; i++)
 	{
-		list_smart_add(list, instruction_from_stream(stream + offset));
-		offset += sizeof(instruction_t);
+		instruction_t *instruction = instruction_decode(reader);
+
+		if (instruction)
+			list_smart_add(list, instruction);
 	}
 
 	return list;
 }
 
+uint32_t instruction_list_hash(t_list *instructions)
+{
+	// FNV-1a over every field of every instruction
+	uint32_t hash = 2166136261u;
+
+	void mix(uint32_t value)
+	{
+		for (int i = 0; i < 4; i++)
+		{
+			hash ^= (value >> (8 * i)) & 0xFF;
+			hash *= 16777619u;
+		}
+	}
+
+	void mix_instruction(void *element)
+	{
+		instruction_t *instruction = element;
+		mix(instruction->icode);
+		mix(instruction->param0);
+		mix(instruction->param1);
+	}
+
+	mix(list_size(instructions));
+	list_iterate(instructions, mix_instruction);
+
+	// 0 is left for "not hashed yet"
+	return hash ? hash : 1;
+}
+
+void *instruction_list_from(void *stream)
+{
+	wire_reader_t reader = wire_reader_create(stream, SIZE_MAX);
+
+	return instruction_list_decode(&reader);
+}
+
 ssize_t instruction_send(conexion_t is_conexion, instruction_t *is_instruction)
 {
-	// Local stream - el paquete serializado, requiere free(1)
-	void *stream = instruction_to_stream(is_instruction);
+	// Local writer - la instrucción serializada
+	wire_writer_t writer;
+	wire_writer_init(&writer, 3 * WIRE_VARINT_MAX);
+	instruction_encode(is_instruction, &writer);
 
-	ssize_t bytes_sent = conexion_enviar_stream(is_conexion, CMD, stream, sizeof(instruction_t));
+	ssize_t bytes_sent = conexion_enviar_stream(is_conexion, CMD, writer.buffer, writer.size);
 
-	free(stream);
+	wire_writer_destroy(&writer);
 
 	return bytes_sent;
 }
@@ -13,35 +13,15 @@
 #include "instruction_lambdas.h"
 #include "instruction.h"
 
-void *instructions_fold(t_list *list)
+void *instructions_fold(t_list *list, size_t *size)
 {
-	//  The stream seed.
-	void *stream = NULL;
-	// Elements count
-	uint32_t size = list_size(list);
-	// Size in Bytes of list
-	size_t insturctions_size = sizeof(instruction_t) * size;
-	// The stream serializer offset
-	uint32_t offset = 0;
+	// The stream writer, sized for the usual small operands.
+	wire_writer_t writer;
+	wire_writer_init(&writer, WIRE_VARINT_MAX + 4 * list_size(list));
 
-	stream = malloc(sizeof(uint32_t) + insturctions_size);
+	instruction_list_encode(list, &writer);
 
-	memcpy(stream, &size, sizeof(uint32_t));
-	offset += sizeof(uint32_t);
+	*size = writer.size;
 
-	// The streamerized list
-	t_list *stream_list = list_map(list, instruction_to_stream);
-
-	void *reducer(void *acc, void *next)
-	{
-		memcpy(acc + offset, next, sizeof(instruction_t));
-		offset += sizeof(instruction_t);
-		return acc;
-	}
-
-	void *ret = list_fold(stream_list, stream, reducer);
-
-	list_smart_fast_destroy(stream_list);
-
-	return ret;
+	return writer.buffer;
 }
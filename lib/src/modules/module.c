@@ -10,6 +10,7 @@
  */
 
 #include "module.h"
+#include "transport.h"
 #include "log.h"
 #include "lib.h"
 
@@ -32,6 +33,11 @@ int on_module_connect(void *connection, bool offline_mode)
 		}
 	}
 
+	conexion_t *conexion = connection;
+
+	if (transport_shm_enabled() && transport_shm_connect(conexion->socket) EQ ERROR)
+		LOG_WARNING("Shared memory link declined, using the socket.");
+
 	return SUCCESS;
 }
 
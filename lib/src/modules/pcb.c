@@ -12,7 +12,7 @@
 #include "pcb.h"
 #include "instruction.h"
 #include <string.h>
-#include "safe_queue.h"
+#include <stdint.h>
 #include "smartlist.h"
 
 pcb_t *new_pcb(uint32_t id, size_t size, uint32_t estimation)
@@ -27,42 +27,11 @@ pcb_t *new_pcb(uint32_t id, size_t size, uint32_t estimation)
 	pcb->pc = 0;					   // Número de la próxima instrucción a ejecutar
 	pcb->io = 0;					   // Tiempo de espera en el sistema de IO
 	pcb->real = 0;					   // Tiempo real de ejecución
+	pcb->program = 0;				   // Hash de las instrucciones, se calcula al enviarlas a CPU
+	queue_link_init(&pcb->link);	   // Enlaces de la cola de estado en la que espera
 	return pcb;
 }
 
-static inline bool _get_by_pid(uint32_t pid, pcb_t *pcb)
-{
-	return pcb->id == pid;
-}
-
-pcb_t *get_pcb_by_pid(t_list *pcbs, uint32_t pid)
-{
-	bool clojure(void *pcb) { return _get_by_pid(pid, (pcb_t *)pcb); }
-
-	return list_remove_by_condition(pcbs, clojure);
-}
-
-pcb_t *pcb_by_id(safe_queue_t *queue, uint32_t id)
-{
-	bool id_criteria(void *pcb) { return _get_by_pid(id, (pcb_t *)pcb); }
-
-	return safe_queue_find_by(queue, id_criteria);
-}
-
-bool pcb_exists(safe_queue_t *queue, uint32_t id)
-{
-	bool id_criteria(void *pcb) { return _get_by_pid(id, (pcb_t *)pcb); }
-
-	return safe_queue_any(queue, id_criteria);
-}
-
-pcb_t *pcb_remove_by_id(safe_queue_t *queue, uint32_t id)
-{
-	bool id_criteria(void *pcb) { return _get_by_pid(id, (pcb_t *)pcb); }
-
-	return safe_queue_remove_by(queue, id_criteria);
-}
-
 bool pcb_sort_by_estimation(void *e1, void *e2)
 {
 	return ((pcb_t *)e1)->estimation <= ((pcb_t *)e2)->estimation;
@@ -86,98 +55,124 @@ void pcb_destroy(void *pcb)
 	pcb = NULL;
 }
 
-void *pcb_to_stream(pcb_t *pcb)
+void pcb_encode_state(pcb_t *pcb, wire_writer_t *writer)
 {
-	// The size of the pcb to be sent
-	size_t pcb_size = pcb_bytes_size(pcb);
-
-	// The stream to serialize.
-	void *stream = malloc(pcb_size);
-	// The pointer offset.
-	size_t offset = 0;
-
 	/**
-	 * @brief The serialized stream will be:
+	 * @brief The serialized state will be, every field a varint:
 	 *
 	 * --------------------------------------------------------------
-	 * ID | STATUS | SIZE | ESTIMATION | PC | LVL1 - Table | <List_Count> | Instructions...
+	 * ID | STATUS + 1 | SIZE | ESTIMATION | PC | LVL1 - Table
 	 * --------------------------------------------------------------
 	 *
+	 * The status is shifted so that NONE (-1) is encoded as 0.
 	 */
-	memcpy(stream + offset, &pcb->id, sizeof(uint32_t));
-	offset += sizeof(uint32_t);
-	memcpy(stream + offset, &pcb->status, sizeof(pcb->status));
-	offset += sizeof(pcb->status);
-	memcpy(stream + offset, &pcb->size, sizeof(uint32_t));
-	offset += sizeof(uint32_t);
-	memcpy(stream + offset, &pcb->estimation, sizeof(uint32_t));
-	offset += sizeof(uint32_t);
-	memcpy(stream + offset, &pcb->pc, sizeof(uint32_t));
-	offset += sizeof(uint32_t);
-	memcpy(stream + offset, &pcb->page_table, sizeof(uint32_t));
-	offset += sizeof(uint32_t);
-	int list_count = list_size(pcb->instructions);
-	memcpy(stream + offset, &list_count, sizeof(uint32_t));
-	offset += sizeof(uint32_t);
-
-	// When list is empty, just return the stream.
-	if (list_count == 0)
-		return stream;
-
-	// Otherwise serialize the instructions: Convert the instructions to stream.
-	t_list *streams_list = list_map(pcb->instructions, instruction_to_stream);
-
-	// Copy them to the stream_buffer.
-	for (int i = 0; i < list_count; i++)
+	wire_write_varint(writer, pcb->id);
+	wire_write_varint(writer, pcb->status + 1);
+	wire_write_varint(writer, pcb->size);
+	wire_write_varint(writer, pcb->estimation);
+	wire_write_varint(writer, pcb->pc);
+	wire_write_varint(writer, pcb->page_table);
+}
+
+bool pcb_decode_state(wire_reader_t *reader, pcb_t *pcb)
+{
+	uint32_t id = wire_read_varint(reader);
+	int status = (int)wire_read_varint(reader) - 1;
+	uint32_t size = wire_read_varint(reader);
+	uint32_t estimation = wire_read_varint(reader);
+	uint32_t pc = wire_read_varint(reader);
+	uint32_t page_table = wire_read_varint(reader);
+
+	if (reader->failed || status < NONE || status > PCB_TERMINATED)
+	{
+		reader->failed = true;
+		return false;
+	}
+
+	pcb->id = id;
+	pcb->status = status;
+	pcb->size = size;
+	pcb->estimation = estimation;
+	pcb->pc = pc;
+	pcb->page_table = page_table;
+
+	return true;
+}
+
+void pcb_encode(pcb_t *pcb, wire_writer_t *writer)
+{
+	// [STATE][<List_Count>][Instructions...]
+	pcb_encode_state(pcb, writer);
+
+	if (pcb->instructions)
+		instruction_list_encode(pcb->instructions, writer);
+	else
+		wire_write_varint(writer, 0);
+}
+
+pcb_t *pcb_decode(wire_reader_t *reader)
+{
+	pcb_t *pcb = new_pcb(0, 0, 0);
+
+	if (!pcb_decode_state(reader, pcb))
 	{
-		instruction_t *instruction = list_get(streams_list, i);
+		pcb_destroy(pcb);
+		return NULL;
+	}
 
-		memcpy(stream + offset, instruction, sizeof(instruction_t));
-		offset += sizeof(instruction_t);
+	list_destroy(pcb->instructions);
+	pcb->instructions = instruction_list_decode(reader);
 
-		instruction = NULL;
+	if (reader->failed)
+	{
+		pcb_destroy(pcb);
+		return NULL;
 	}
 
-	// Destroy the stream_list.
-	list_smart_fast_destroy(streams_list);
+	return pcb;
+}
 
-	return stream;
+void *pcb_to_stream(pcb_t *pcb)
+{
+	wire_writer_t writer;
+	wire_writer_init(&writer, pcb_bytes_size(pcb));
+	pcb_encode(pcb, &writer);
+
+	return writer.buffer;
 }
 
 pcb_t *pcb_from_stream(void *stream)
 {
-	pcb_t *pcb = malloc(sizeof(pcb_t));
+	wire_reader_t reader = wire_reader_create(stream, SIZE_MAX);
 
-	size_t offset = 0;
-	memcpy(&pcb->id, stream + offset, sizeof(uint32_t));
-	offset += sizeof(uint32_t);
-	memcpy(&pcb->status, stream + offset, sizeof(pcb->status));
-	offset += sizeof(pcb->status);
-	memcpy(&pcb->size, stream + offset, sizeof(uint32_t));
-	offset += sizeof(uint32_t);
-	memcpy(&pcb->estimation, stream + offset, sizeof(uint32_t));
-	offset += sizeof(uint32_t);
-	memcpy(&pcb->pc, stream + offset, sizeof(uint32_t));
-	offset += sizeof(uint32_t);
-	memcpy(&pcb->page_table, stream + offset, sizeof(uint32_t));
-	offset += sizeof(uint32_t);
-	pcb->instructions = instruction_list_from(stream + offset);
-
-	return pcb;
+	return pcb_decode(&reader);
 }
 
 size_t pcb_bytes_size(pcb_t *pcb)
 {
 	// The PCB final size.
 	size_t size = 0;
-	// The size of [ID, SIZE, ESTIMATION, PC, LVL1 PT ID]
-	size += sizeof(uint32_t) * 5;
-	size += sizeof(pcb->status);
-	// Size of the List_SIZE value.
-	size += sizeof(uint32_t);
-	// The size of the instruction list.
-	if (pcb->instructions)
-		size += sizeof(instruction_t) * list_size(pcb->instructions);
+	// The size of [ID, STATUS, SIZE, ESTIMATION, PC, LVL1 PT ID]
+	size += wire_varint_size(pcb->id);
+	size += wire_varint_size(pcb->status + 1);
+	size += wire_varint_size(pcb->size);
+	size += wire_varint_size(pcb->estimation);
+	size += wire_varint_size(pcb->pc);
+	size += wire_varint_size(pcb->page_table);
+
+	// Size of the List_SIZE value and the instruction list.
+	int count = pcb->instructions ? list_size(pcb->instructions) : 0;
+	size += wire_varint_size(count);
+
+	// A single walk: list_get would go over the list again for every instruction
+	void add(void *element)
+	{
+		instruction_t *instruction = element;
+		size += wire_varint_size(instruction->icode) + wire_varint_size(instruction->param0) + wire_varint_size(instruction->param1);
+	}
+
+	if (count)
+		list_iterate(pcb->instructions, add);
 
 	return size;
 }
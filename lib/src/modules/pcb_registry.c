@@ -0,0 +1,130 @@
+/**
+ * @file pcb_registry.c
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Live PCBs indexed by PID
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdlib.h>
+
+#include "pcb_registry.h"
+#include "lib.h"
+
+pcb_registry_t *new_pcb_registry(uint32_t capacity)
+{
+	pcb_registry_t *registry = malloc(sizeof(pcb_registry_t));
+
+	pthread_mutex_init(&registry->_mtx, NULL);
+	registry->entries = calloc(capacity, sizeof(pcb_registry_entry_t));
+	registry->capacity = capacity;
+
+	return registry;
+}
+
+void pcb_registry_destroy(pcb_registry_t *registry, void (*destroyer)(void *))
+{
+	if (destroyer)
+		for (uint32_t pid = 0; pid < registry->capacity; pid++)
+			if (registry->entries[pid].pcb)
+				destroyer(registry->entries[pid].pcb);
+
+	pthread_mutex_destroy(&registry->_mtx);
+	free(registry->entries);
+	free(registry);
+}
+
+bool pcb_registry_add(pcb_registry_t *registry, pcb_t *pcb, pcb_queue_t queue)
+{
+	if (pcb->id >= registry->capacity)
+		return false;
+
+	pthread_mutex_lock(&registry->_mtx);
+
+	pcb_registry_entry_t *entry = &registry->entries[pcb->id];
+	bool added = entry->pcb EQ NULL;
+
+	if (added)
+	{
+		entry->pcb = pcb;
+		entry->queue = queue;
+	}
+
+	pthread_mutex_unlock(&registry->_mtx);
+
+	return added;
+}
+
+pcb_t *pcb_registry_get(pcb_registry_t *registry, uint32_t pid)
+{
+	if (pid >= registry->capacity)
+		return NULL;
+
+	pthread_mutex_lock(&registry->_mtx);
+	pcb_t *pcb = registry->entries[pid].pcb;
+	pthread_mutex_unlock(&registry->_mtx);
+
+	return pcb;
+}
+
+pcb_queue_t pcb_registry_queue(pcb_registry_t *registry, uint32_t pid)
+{
+	if (pid >= registry->capacity)
+		return PCB_QUEUE_NONE;
+
+	pthread_mutex_lock(&registry->_mtx);
+	pcb_queue_t queue = registry->entries[pid].pcb ? registry->entries[pid].queue : PCB_QUEUE_NONE;
+	pthread_mutex_unlock(&registry->_mtx);
+
+	return queue;
+}
+
+void pcb_registry_set(pcb_registry_t *registry, uint32_t pid, pcb_queue_t queue)
+{
+	if (pid >= registry->capacity)
+		return;
+
+	pthread_mutex_lock(&registry->_mtx);
+
+	if (registry->entries[pid].pcb)
+		registry->entries[pid].queue = queue;
+
+	pthread_mutex_unlock(&registry->_mtx);
+}
+
+pcb_t *pcb_registry_move(pcb_registry_t *registry, uint32_t pid, pcb_queue_t from, pcb_queue_t to)
+{
+	if (pid >= registry->capacity)
+		return NULL;
+
+	pthread_mutex_lock(&registry->_mtx);
+
+	pcb_registry_entry_t *entry = &registry->entries[pid];
+	pcb_t *pcb = entry->pcb && entry->queue EQ from ? entry->pcb : NULL;
+
+	if (pcb)
+		entry->queue = to;
+
+	pthread_mutex_unlock(&registry->_mtx);
+
+	return pcb;
+}
+
+pcb_t *pcb_registry_remove(pcb_registry_t *registry, uint32_t pid)
+{
+	if (pid >= registry->capacity)
+		return NULL;
+
+	pthread_mutex_lock(&registry->_mtx);
+
+	pcb_t *pcb = registry->entries[pid].pcb;
+	registry->entries[pid].pcb = NULL;
+	registry->entries[pid].queue = PCB_QUEUE_NONE;
+
+	pthread_mutex_unlock(&registry->_mtx);
+
+	return pcb;
+}
@@ -0,0 +1,218 @@
+/**
+ * @file read_mostly_list.c
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Read-mostly list implementation.
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdlib.h>
+
+#include "read_mostly_list.h"
+
+// ============================================================================================================
+//                               ***** Slots *****
+// ============================================================================================================
+
+// The slot of a position, allocating its chunk if asked to (only writers do, holding the lock)
+static _Atomic(void *) *slot(read_mostly_list_t *this, uint32_t index, bool allocate)
+{
+	uint32_t chunk = index / READ_MOSTLY_CHUNK;
+
+	if (chunk >= READ_MOSTLY_CHUNKS)
+		return NULL;
+
+	_Atomic(void *) *slots = atomic_load_explicit(&this->_chunks[chunk], memory_order_acquire);
+
+	if (slots == NULL && allocate)
+	{
+		slots = calloc(READ_MOSTLY_CHUNK, sizeof(_Atomic(void *)));
+		atomic_store_explicit(&this->_chunks[chunk], slots, memory_order_release);
+	}
+
+	return slots ? &slots[index % READ_MOSTLY_CHUNK] : NULL;
+}
+
+// A reader leaves a parity: the last one wakes up the grace period waiting for it, if any
+static void leave(read_mostly_list_t *this, uint32_t parity)
+{
+	if (atomic_fetch_sub(&this->_readers[parity], 1) == 1 && atomic_load(&this->_waiting))
+	{
+		// Taken so that the wake up can not fall between the waiter checking and sleeping
+		pthread_mutex_lock(&this->_grace);
+		pthread_cond_broadcast(&this->_left);
+		pthread_mutex_unlock(&this->_grace);
+	}
+}
+
+// Holding the lock
+static bool place(read_mostly_list_t *this, uint32_t index, void *element)
+{
+	_Atomic(void *) *target = slot(this, index, true);
+
+	if (target == NULL)
+		return false;
+
+	atomic_store_explicit(target, element, memory_order_release);
+
+	if (index >= atomic_load_explicit(&this->_size, memory_order_relaxed))
+		atomic_store_explicit(&this->_size, index + 1, memory_order_release);
+
+	return true;
+}
+
+// ============================================================================================================
+//                               ***** Memory Allocation *****
+// ============================================================================================================
+
+read_mostly_list_t *new_read_mostly_list(void)
+{
+	read_mostly_list_t *list = malloc(sizeof(read_mostly_list_t));
+	pthread_mutex_init(&list->_mtx, NULL);
+
+	for (uint32_t i = 0; i < READ_MOSTLY_CHUNKS; i++)
+		atomic_init(&list->_chunks[i], NULL);
+
+	atomic_init(&list->_size, 0);
+	atomic_init(&list->_epoch, 0);
+	atomic_init(&list->_readers[0], 0);
+	atomic_init(&list->_readers[1], 0);
+	pthread_mutex_init(&list->_grace, NULL);
+	pthread_cond_init(&list->_left, NULL);
+	atomic_init(&list->_waiting, false);
+
+	return list;
+}
+
+void read_mostly_list_destroy(read_mostly_list_t *this, void (*destroyer)(void *))
+{
+	for (uint32_t chunk = 0; chunk < READ_MOSTLY_CHUNKS; chunk++)
+	{
+		_Atomic(void *) *slots = atomic_load(&this->_chunks[chunk]);
+
+		if (slots == NULL)
+			continue;
+
+		if (destroyer)
+			for (uint32_t i = 0; i < READ_MOSTLY_CHUNK; i++)
+			{
+				void *element = atomic_load(&slots[i]);
+
+				if (element)
+					destroyer(element);
+			}
+
+		free(slots);
+	}
+
+	pthread_mutex_destroy(&this->_mtx);
+	pthread_mutex_destroy(&this->_grace);
+	pthread_cond_destroy(&this->_left);
+	free(this);
+}
+
+// ============================================================================================================
+//                               ***** Elements *****
+// ============================================================================================================
+
+void *read_mostly_list_get(read_mostly_list_t *this, uint32_t index)
+{
+	if (index >= atomic_load_explicit(&this->_size, memory_order_acquire))
+		return NULL;
+
+	_Atomic(void *) *source = slot(this, index, false);
+
+	return source ? atomic_load_explicit(source, memory_order_acquire) : NULL;
+}
+
+uint32_t read_mostly_list_size(read_mostly_list_t *this)
+{
+	return atomic_load_explicit(&this->_size, memory_order_acquire);
+}
+
+bool read_mostly_list_set(read_mostly_list_t *this, uint32_t index, void *element)
+{
+	pthread_mutex_lock(&this->_mtx);
+	bool placed = place(this, index, element);
+	pthread_mutex_unlock(&this->_mtx);
+
+	return placed;
+}
+
+uint32_t read_mostly_list_put(read_mostly_list_t *this, void *element, bool reuse)
+{
+	pthread_mutex_lock(&this->_mtx);
+
+	uint32_t size = atomic_load_explicit(&this->_size, memory_order_relaxed);
+	uint32_t index = size;
+
+	if (reuse)
+		for (uint32_t i = 0; i < size; i++)
+			if (atomic_load_explicit(slot(this, i, true), memory_order_relaxed) == NULL)
+			{
+				index = i;
+				break;
+			}
+
+	if (!place(this, index, element))
+		index = UINT32_MAX;
+
+	pthread_mutex_unlock(&this->_mtx);
+
+	return index;
+}
+
+void *read_mostly_list_take(read_mostly_list_t *this, uint32_t index)
+{
+	pthread_mutex_lock(&this->_mtx);
+	_Atomic(void *) *source = index < atomic_load(&this->_size) ? slot(this, index, false) : NULL;
+	void *element = source ? atomic_exchange(source, NULL) : NULL;
+	pthread_mutex_unlock(&this->_mtx);
+
+	if (element == NULL)
+		return NULL;
+
+	// Readers entering from now on can only find the empty slot: wait for the ones already inside.
+	// One grace period at a time, so that the parity waited for has no readers of an older one.
+	// Sleeping, as a read section may last as long as a swap
+	pthread_mutex_lock(&this->_grace);
+	uint32_t parity = atomic_fetch_add(&this->_epoch, 1) & 1;
+
+	// Published before checking: either this sees the count at 0, or the last reader sees it waiting
+	atomic_store(&this->_waiting, true);
+
+	while (atomic_load(&this->_readers[parity]) > 0)
+		pthread_cond_wait(&this->_left, &this->_grace);
+
+	atomic_store(&this->_waiting, false);
+	pthread_mutex_unlock(&this->_grace);
+
+	return element;
+}
+
+// ============================================================================================================
+//                               ***** Read Sections *****
+// ============================================================================================================
+
+uint32_t read_mostly_list_enter(read_mostly_list_t *this)
+{
+	for (;;)
+	{
+		uint32_t epoch = atomic_load(&this->_epoch);
+		atomic_fetch_add(&this->_readers[epoch & 1], 1);
+
+		// A grace period started meanwhile: counted in a stale parity, the next one would not wait for it
+		if (atomic_load(&this->_epoch) == epoch)
+			return epoch & 1;
+
+		leave(this, epoch & 1);
+	}
+}
+
+void read_mostly_list_leave(read_mostly_list_t *this, uint32_t token)
+{
+	leave(this, token & 1);
+}
@@ -0,0 +1,191 @@
+/**
+ * @file intrusive_queue.c
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Thread safe queue linking elements through a field of their own
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdlib.h>
+
+#include "intrusive_queue.h"
+#include "lib.h"
+
+// ============================================================================================================
+//                               ***** Links *****
+// ============================================================================================================
+
+static inline queue_link_t *link_of(intrusive_queue_t *queue, void *element)
+{
+	return (queue_link_t *)((char *)element + queue->_offset);
+}
+
+static inline void *element_of(intrusive_queue_t *queue, queue_link_t *link)
+{
+	return (char *)link - queue->_offset;
+}
+
+// Must hold the lock, and the link must be in this queue
+static void detach(intrusive_queue_t *queue, queue_link_t *link)
+{
+	link->prev->next = link->next;
+	link->next->prev = link->prev;
+	queue_link_init(link);
+	queue->_size--;
+}
+
+void queue_link_init(queue_link_t *link)
+{
+	link->prev = NULL;
+	link->next = NULL;
+	link->queue = NULL;
+}
+
+// ============================================================================================================
+//                               ***** Queue *****
+// ============================================================================================================
+
+intrusive_queue_t *new_intrusive_queue(size_t link_offset)
+{
+	intrusive_queue_t *queue = malloc(sizeof(intrusive_queue_t));
+
+	pthread_mutex_init(&queue->_mtx, NULL);
+	pthread_cond_init(&queue->_pushed, NULL);
+	queue->_head.prev = &queue->_head;
+	queue->_head.next = &queue->_head;
+	queue->_head.queue = queue;
+	queue->_offset = link_offset;
+	queue->_size = 0;
+
+	return queue;
+}
+
+void intrusive_queue_destroy(intrusive_queue_t *queue)
+{
+	while (queue->_head.next != &queue->_head)
+		detach(queue, queue->_head.next);
+
+	pthread_mutex_destroy(&queue->_mtx);
+	pthread_cond_destroy(&queue->_pushed);
+	free(queue);
+}
+
+bool intrusive_queue_push(intrusive_queue_t *queue, void *element)
+{
+	queue_link_t *link = link_of(queue, element);
+
+	pthread_mutex_lock(&queue->_mtx);
+
+	bool free_to_link = link->queue EQ NULL;
+
+	if (free_to_link)
+	{
+		link->prev = queue->_head.prev;
+		link->next = &queue->_head;
+		link->queue = queue;
+		queue->_head.prev->next = link;
+		queue->_head.prev = link;
+		queue->_size++;
+		pthread_cond_signal(&queue->_pushed);
+	}
+
+	pthread_mutex_unlock(&queue->_mtx);
+
+	return free_to_link;
+}
+
+void *intrusive_queue_pop(intrusive_queue_t *queue)
+{
+	void *element = NULL;
+
+	pthread_mutex_lock(&queue->_mtx);
+
+	if (queue->_size > 0)
+	{
+		queue_link_t *first = queue->_head.next;
+		detach(queue, first);
+		element = element_of(queue, first);
+	}
+
+	pthread_mutex_unlock(&queue->_mtx);
+
+	return element;
+}
+
+void *intrusive_queue_pop_wait(intrusive_queue_t *queue)
+{
+	pthread_mutex_lock(&queue->_mtx);
+
+	while (queue->_size EQ 0)
+		pthread_cond_wait(&queue->_pushed, &queue->_mtx);
+
+	queue_link_t *first = queue->_head.next;
+	detach(queue, first);
+
+	pthread_mutex_unlock(&queue->_mtx);
+
+	return element_of(queue, first);
+}
+
+void *intrusive_queue_pop_first(intrusive_queue_t *queue, bool (*comparator)(void *, void *))
+{
+	pthread_mutex_lock(&queue->_mtx);
+
+	while (queue->_size EQ 0)
+		pthread_cond_wait(&queue->_pushed, &queue->_mtx);
+
+	// One pass instead of sorting: only the first one leaves
+	queue_link_t *first = queue->_head.next;
+
+	for (queue_link_t *link = first->next; link != &queue->_head; link = link->next)
+		if (!comparator(element_of(queue, first), element_of(queue, link)))
+			first = link;
+
+	detach(queue, first);
+
+	pthread_mutex_unlock(&queue->_mtx);
+
+	return element_of(queue, first);
+}
+
+bool intrusive_queue_remove(intrusive_queue_t *queue, void *element)
+{
+	queue_link_t *link = link_of(queue, element);
+
+	pthread_mutex_lock(&queue->_mtx);
+
+	bool linked_here = link->queue EQ queue;
+
+	if (linked_here)
+		detach(queue, link);
+
+	pthread_mutex_unlock(&queue->_mtx);
+
+	return linked_here;
+}
+
+bool intrusive_queue_contains(intrusive_queue_t *queue, void *element)
+{
+	pthread_mutex_lock(&queue->_mtx);
+	bool linked_here = link_of(queue, element)->queue EQ queue;
+	pthread_mutex_unlock(&queue->_mtx);
+
+	return linked_here;
+}
+
+bool intrusive_queue_is_empty(intrusive_queue_t *queue)
+{
+	return intrusive_queue_size(queue) EQ 0;
+}
+
+size_t intrusive_queue_size(intrusive_queue_t *queue)
+{
+	pthread_mutex_lock(&queue->_mtx);
+	size_t size = queue->_size;
+	pthread_mutex_unlock(&queue->_mtx);
+
+	return size;
+}
@@ -0,0 +1,124 @@
+/**
+ * @file mpmc_queue.c
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Lock-free bounded multi-producer multi-consumer queue
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "mpmc_queue.h"
+#include "lib.h"
+
+// ============================================================================================================
+//                               ***** Elements *****
+// ============================================================================================================
+
+mpmc_queue_t *new_mpmc_queue(size_t capacity)
+{
+	size_t cells = 2;
+
+	while (cells < capacity)
+		cells <<= 1;
+
+	mpmc_queue_t *queue = aligned_alloc(MPMC_CACHE_LINE, sizeof(mpmc_queue_t));
+	queue->cells = malloc(cells * sizeof(mpmc_cell_t));
+	queue->mask = cells - 1;
+
+	for (size_t i = 0; i < cells; i++)
+		atomic_init(&queue->cells[i].sequence, i);
+
+	atomic_init(&queue->tail, 0);
+	atomic_init(&queue->head, 0);
+
+	return queue;
+}
+
+void mpmc_queue_destroy(mpmc_queue_t *queue, void (*destroyer)(void *))
+{
+	void *element;
+
+	while ((element = mpmc_queue_pop(queue)) != NULL)
+		if (destroyer)
+			destroyer(element);
+
+	free(queue->cells);
+	free(queue);
+}
+
+bool mpmc_queue_push(mpmc_queue_t *queue, void *element)
+{
+	size_t position = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+
+	for (;;)
+	{
+		mpmc_cell_t *cell = &queue->cells[position & queue->mask];
+		size_t sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+		intptr_t turn = (intptr_t)sequence - (intptr_t)position;
+
+		// The cell is free for this position: claim it
+		if (turn EQ 0)
+		{
+			if (atomic_compare_exchange_weak_explicit(&queue->tail, &position, position + 1, memory_order_relaxed, memory_order_relaxed))
+			{
+				cell->element = element;
+				atomic_store_explicit(&cell->sequence, position + 1, memory_order_release);
+				return true;
+			}
+		}
+		// Still holds the element of the previous lap: full
+		else if (turn < 0)
+			return false;
+		// Another producer took it: try the current tail
+		else
+			position = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+	}
+}
+
+void *mpmc_queue_pop(mpmc_queue_t *queue)
+{
+	size_t position = atomic_load_explicit(&queue->head, memory_order_relaxed);
+
+	for (;;)
+	{
+		mpmc_cell_t *cell = &queue->cells[position & queue->mask];
+		size_t sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+		intptr_t turn = (intptr_t)sequence - (intptr_t)(position + 1);
+
+		// The cell was filled for this position: claim it
+		if (turn EQ 0)
+		{
+			if (atomic_compare_exchange_weak_explicit(&queue->head, &position, position + 1, memory_order_relaxed, memory_order_relaxed))
+			{
+				void *element = cell->element;
+				// Free for the producer one lap ahead
+				atomic_store_explicit(&cell->sequence, position + queue->mask + 1, memory_order_release);
+				return element;
+			}
+		}
+		// Not filled yet: empty
+		else if (turn < 0)
+			return NULL;
+		// Another consumer took it: try the current head
+		else
+			position = atomic_load_explicit(&queue->head, memory_order_relaxed);
+	}
+}
+
+void *mpmc_queue_peek(mpmc_queue_t *queue)
+{
+	size_t position = atomic_load_explicit(&queue->head, memory_order_acquire);
+	mpmc_cell_t *cell = &queue->cells[position & queue->mask];
+
+	return atomic_load_explicit(&cell->sequence, memory_order_acquire) EQ position + 1 ? cell->element : NULL;
+}
+
+bool mpmc_queue_is_empty(mpmc_queue_t *queue)
+{
+	return mpmc_queue_peek(queue) EQ NULL;
+}
@@ -1,4 +1,5 @@
 #include <stdlib.h>
+#include <time.h>
 
 #include "safe_queue.h"
 #include "smartqueue.h"
@@ -12,6 +13,14 @@ new_safe_queue(void)
 {
 	safe_queue_t *q = malloc(sizeof(safe_queue_t));
 	pthread_mutex_init(&q->_mtx, NULL);
+
+	// Timed pops measure their deadline on the monotonic clock
+	pthread_condattr_t attributes;
+	pthread_condattr_init(&attributes);
+	pthread_condattr_setclock(&attributes, CLOCK_MONOTONIC);
+	pthread_cond_init(&q->_pushed, &attributes);
+	pthread_condattr_destroy(&attributes);
+
 	q->_queue = queue_create();
 	return q;
 }
@@ -19,6 +28,7 @@ new_safe_queue(void)
 void safe_queue_destroy(safe_queue_t *q, void (*destroyer)(void *))
 {
 	pthread_mutex_destroy(&q->_mtx);
+	pthread_cond_destroy(&q->_pushed);
 	queue_smart_destroy(q->_queue, destroyer);
 	free(q);
 }
@@ -27,6 +37,7 @@ void safe_queue_push(safe_queue_t *this, void *element)
 {
 	pthread_mutex_lock(&this->_mtx);
 	queue_smart_push(this->_queue, element);
+	pthread_cond_signal(&this->_pushed);
 	pthread_mutex_unlock(&this->_mtx);
 }
 
@@ -39,6 +50,59 @@ void *safe_queue_pop(safe_queue_t *this)
 	return e;
 }
 
+void *safe_queue_pop_wait(safe_queue_t *this)
+{
+	pthread_mutex_lock(&this->_mtx);
+
+	while (queue_is_empty(this->_queue))
+		pthread_cond_wait(&this->_pushed, &this->_mtx);
+
+	void *e = queue_pop(this->_queue);
+	pthread_mutex_unlock(&this->_mtx);
+	return e;
+}
+
+void *safe_queue_pop_timed(safe_queue_t *this, uint32_t timeout_ms)
+{
+	struct timespec deadline;
+	clock_gettime(CLOCK_MONOTONIC, &deadline);
+	deadline.tv_sec += timeout_ms / 1000;
+	deadline.tv_nsec += (timeout_ms % 1000) * 1000000l;
+
+	if (deadline.tv_nsec >= 1000000000l)
+	{
+		deadline.tv_sec++;
+		deadline.tv_nsec -= 1000000000l;
+	}
+
+	pthread_mutex_lock(&this->_mtx);
+
+	int timed_out = 0;
+
+	while (queue_is_empty(this->_queue) && !timed_out)
+		timed_out = pthread_cond_timedwait(&this->_pushed, &this->_mtx, &deadline);
+
+	void *e = queue_is_empty(this->_queue) ? NULL : queue_pop(this->_queue);
+	pthread_mutex_unlock(&this->_mtx);
+	return e;
+}
+
+int safe_queue_drain(safe_queue_t *this, void **elements, int max)
+{
+	pthread_mutex_lock(&this->_mtx);
+
+	while (queue_is_empty(this->_queue))
+		pthread_cond_wait(&this->_pushed, &this->_mtx);
+
+	int drained = 0;
+
+	while (drained < max && !queue_is_empty(this->_queue))
+		elements[drained++] = queue_pop(this->_queue);
+
+	pthread_mutex_unlock(&this->_mtx);
+	return drained;
+}
+
 bool safe_queue_is_empty(safe_queue_t *this)
 {
 	pthread_mutex_lock(&this->_mtx);
@@ -63,10 +63,17 @@ new_thread_manager()
 	pthread_mutex_init(&tm.mutex, NULL);
 	tm.init = true;
 	tm.size = 0;
+	tm.pool = NULL;
 
 	return tm;
 }
 
+void thread_manager_use_pool(thread_manager_t *tm, int workers)
+{
+	if (tm->init && tm->pool EQ NULL && workers > 0)
+		tm->pool = thread_pool_create(workers);
+}
+
 void thread_manager_destroy(thread_manager_t *tm)
 {
 	if (tm->init)
@@ -74,8 +81,12 @@ void thread_manager_destroy(thread_manager_t *tm)
 		thread_manager_end_threads(tm);
 		pthread_mutex_destroy(&tm->mutex);
 		free(tm->threads);
+
+		if (tm->pool)
+			thread_pool_shutdown(tm->pool);
 	}
 
+	tm->pool = NULL;
 	tm->threads = NULL;
 	tm->size = 0;
 	tm->init = false;
@@ -121,6 +132,10 @@ void thread_manager_launch(thread_manager_t *tm,
 						   void *__restrict args)
 {
 
+	// Un worker libre evita crear el hilo
+	if (tm->init && tm->pool && thread_pool_submit(tm->pool, thread_routine, args, tm))
+		return;
+
 	if (tm->init)
 	{
 		pthread_mutex_lock(&tm->mutex);
@@ -150,6 +165,10 @@ void thread_manager_lanzar(void *(*rutina)(void *), void *__restrict argumentos)
 
 int thread_manager_end_thread(thread_manager_t *tm)
 {
+	// El worker vuelve al pool cuando la rutina retorna
+	if (thread_pool_task_owner() EQ tm)
+		return EXIT_SUCCESS;
+
 	pthread_mutex_lock(&tm->mutex);
 	// Pthread ID.
 	ssize_t t_id = thread_manager_get_index(tm);
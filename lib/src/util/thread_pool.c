@@ -0,0 +1,208 @@
+/**
+ * @file thread_pool.c
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Fixed-size pool of worker threads
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdlib.h>
+
+#include "thread_pool.h"
+#include "lib.h"
+#include "log.h"
+
+// ============================================================================================================
+//                                   ***** Private Definitions  *****
+// ============================================================================================================
+
+// The owner of the task the calling worker runs.
+static __thread const void *current_owner;
+
+/**
+ * @brief Runs tasks until the pool shuts down.
+ *
+ * @param pool the pool
+ * @return null ptr
+ */
+static void *thread_pool_worker(void *pool);
+
+/**
+ * @brief Deallocates a pool no worker uses.
+ *
+ * @param pool the pool
+ */
+static void thread_pool_free(thread_pool_t *pool);
+
+// ============================================================================================================
+//                                   ***** Private Functions  *****
+// ============================================================================================================
+
+static void *thread_pool_worker(void *data)
+{
+	thread_pool_t *pool = data;
+
+	pthread_mutex_lock(&pool->mutex);
+
+	for (;;)
+	{
+		pool->idle++;
+		pthread_cond_broadcast(&pool->changed);
+
+		while (pool->queued EQ 0 && !pool->stopping)
+			pthread_cond_wait(&pool->ready, &pool->mutex);
+
+		pool->idle--;
+
+		if (pool->queued EQ 0)
+			break;
+
+		thread_pool_task_t task = pool->tasks[pool->head];
+		pool->head = (pool->head + 1) % pool->capacity;
+		pool->queued--;
+		pool->stats.busy++;
+
+		pthread_mutex_unlock(&pool->mutex);
+
+		current_owner = task.owner;
+		task.routine(task.args);
+		current_owner = NULL;
+
+		pthread_mutex_lock(&pool->mutex);
+
+		pool->stats.busy--;
+		pool->stats.completed++;
+	}
+
+	pool->alive--;
+	pool->stats.workers = pool->alive;
+
+	bool last = pool->alive EQ 0 && pool->abandoned;
+
+	pthread_cond_broadcast(&pool->changed);
+	pthread_mutex_unlock(&pool->mutex);
+
+	// Shutdown did not wait for the busy workers: the last one to leave cleans up
+	if (last)
+		thread_pool_free(pool);
+
+	return NULL;
+}
+
+static void thread_pool_free(thread_pool_t *pool)
+{
+	pthread_cond_destroy(&pool->ready);
+	pthread_cond_destroy(&pool->changed);
+	pthread_mutex_destroy(&pool->mutex);
+	free(pool->tasks);
+	free(pool);
+}
+
+// ============================================================================================================
+//                                   ***** Public Functions  *****
+// ============================================================================================================
+
+thread_pool_t *thread_pool_create(int workers)
+{
+	thread_pool_t *pool = calloc(1, sizeof(thread_pool_t));
+
+	pool->capacity = workers;
+	pool->tasks = calloc(workers, sizeof(thread_pool_task_t));
+	pthread_mutex_init(&pool->mutex, NULL);
+	pthread_cond_init(&pool->ready, NULL);
+	pthread_cond_init(&pool->changed, NULL);
+
+	pthread_mutex_lock(&pool->mutex);
+
+	for (int i = 0; i < workers; i++)
+	{
+		pthread_t worker;
+
+		if (pthread_create(&worker, NULL, thread_pool_worker, pool) != 0)
+		{
+			LOG_ERROR("[Thread-Pool] :=> Only %d of %d workers could be started.", pool->alive, workers);
+			break;
+		}
+
+		pthread_detach(worker);
+		pool->alive++;
+	}
+
+	pool->stats.workers = pool->alive;
+
+	while (pool->idle < pool->alive)
+		pthread_cond_wait(&pool->changed, &pool->mutex);
+
+	pthread_mutex_unlock(&pool->mutex);
+
+	if (pool->alive EQ 0)
+	{
+		thread_pool_free(pool);
+		return NULL;
+	}
+
+	return pool;
+}
+
+bool thread_pool_submit(thread_pool_t *pool, void *(*routine)(void *), void *args, const void *owner)
+{
+	pthread_mutex_lock(&pool->mutex);
+
+	// Every queued task has an idle worker on its way to it
+	bool taken = !pool->stopping && pool->queued < pool->idle;
+
+	if (taken)
+	{
+		pool->tasks[(pool->head + pool->queued) % pool->capacity] = (thread_pool_task_t){routine, args, owner};
+		pool->queued++;
+		pool->stats.submitted++;
+
+		if (pool->queued > pool->stats.peak_queued)
+			pool->stats.peak_queued = pool->queued;
+
+		pthread_cond_signal(&pool->ready);
+	}
+	else
+		pool->stats.rejected++;
+
+	pthread_mutex_unlock(&pool->mutex);
+
+	return taken;
+}
+
+const void *thread_pool_task_owner(void)
+{
+	return current_owner;
+}
+
+thread_pool_stats_t thread_pool_stats(thread_pool_t *pool)
+{
+	pthread_mutex_lock(&pool->mutex);
+	thread_pool_stats_t stats = pool->stats;
+	pthread_mutex_unlock(&pool->mutex);
+
+	return stats;
+}
+
+void thread_pool_shutdown(thread_pool_t *pool)
+{
+	pthread_mutex_lock(&pool->mutex);
+
+	pool->stopping = true;
+	pthread_cond_broadcast(&pool->ready);
+
+	// The queued tasks run first; then the idle workers leave
+	while (pool->alive > pool->stats.busy)
+		pthread_cond_wait(&pool->changed, &pool->mutex);
+
+	bool last = pool->alive EQ 0;
+	pool->abandoned = !last;
+
+	pthread_mutex_unlock(&pool->mutex);
+
+	if (last)
+		thread_pool_free(pool);
+}
@@ -0,0 +1,261 @@
+/**
+ * @file timer_wheel.c
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Cancelable timers fired by a single thread
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdlib.h>
+
+#include "timer_wheel.h"
+#include "lib.h"
+#include "log.h"
+
+// Entries the wheel starts with; it doubles them when they run out.
+#define TIMER_WHEEL_ENTRIES 64
+
+// ============================================================================================================
+//                                   ***** Private Definitions  *****
+// ============================================================================================================
+
+/**
+ * @brief Fires the timers as their ticks go by, until the wheel stops.
+ *
+ * @param wheel the wheel
+ * @return null ptr
+ */
+static void *timer_wheel_loop(void *wheel);
+
+/**
+ * @brief The tick it is now.
+ */
+static uint64_t now_tick(const timer_wheel_t *wheel)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	uint64_t elapsed_ms = (now.tv_sec - wheel->start.tv_sec) * 1000 + (now.tv_nsec - wheel->start.tv_nsec) / 1000000;
+
+	return elapsed_ms / wheel->tick_ms;
+}
+
+/**
+ * @brief When a tick begins.
+ */
+static struct timespec tick_time(const timer_wheel_t *wheel, uint64_t tick)
+{
+	uint64_t ns = wheel->start.tv_nsec + tick * wheel->tick_ms * 1000000ull;
+
+	return (struct timespec){.tv_sec = wheel->start.tv_sec + ns / 1000000000ull, .tv_nsec = ns % 1000000000ull};
+}
+
+/**
+ * @brief Takes an entry out of its bucket and gives it back to the free ones.
+ */
+static void release(timer_wheel_t *wheel, int32_t index)
+{
+	timer_entry_t *entry = &wheel->entries[index];
+	int32_t *slot = &wheel->slots[entry->expiry % TIMER_WHEEL_SLOTS];
+
+	if (entry->prev EQ -1)
+		*slot = entry->next;
+	else
+		wheel->entries[entry->prev].next = entry->next;
+
+	if (entry->next != -1)
+		wheel->entries[entry->next].prev = entry->prev;
+
+	entry->generation++;
+	entry->callback = NULL;
+	entry->next = wheel->free;
+	wheel->free = index;
+	wheel->armed--;
+}
+
+/**
+ * @brief Finds an expired timer in the bucket of a tick.
+ *
+ * @return its index or -1
+ */
+static int32_t expired(const timer_wheel_t *wheel, uint64_t tick)
+{
+	for (int32_t i = wheel->slots[tick % TIMER_WHEEL_SLOTS]; i != -1; i = wheel->entries[i].next)
+		if (wheel->entries[i].expiry <= tick)
+			return i;
+
+	return -1;
+}
+
+static void *timer_wheel_loop(void *data)
+{
+	timer_wheel_t *wheel = data;
+
+	pthread_mutex_lock(&wheel->mutex);
+
+	while (wheel->running)
+	{
+		if (wheel->armed EQ 0)
+		{
+			pthread_cond_wait(&wheel->changed, &wheel->mutex);
+			continue;
+		}
+
+		uint64_t now = now_tick(wheel);
+
+		while (wheel->tick < now && wheel->armed > 0)
+		{
+			int32_t index = expired(wheel, wheel->tick + 1);
+
+			if (index EQ -1)
+			{
+				wheel->tick++;
+				continue;
+			}
+
+			timer_callback_t callback = wheel->entries[index].callback;
+			void *argument = wheel->entries[index].data;
+			release(wheel, index);
+
+			// Unlocked, so the callback may schedule or cancel
+			pthread_mutex_unlock(&wheel->mutex);
+			callback(argument);
+			pthread_mutex_lock(&wheel->mutex);
+		}
+
+		if (wheel->armed > 0)
+		{
+			struct timespec next = tick_time(wheel, wheel->tick + 1);
+			pthread_cond_timedwait(&wheel->changed, &wheel->mutex, &next);
+		}
+	}
+
+	pthread_mutex_unlock(&wheel->mutex);
+
+	return NULL;
+}
+
+// ============================================================================================================
+//                                   ***** Public Functions  *****
+// ============================================================================================================
+
+timer_wheel_t *timer_wheel_create(uint32_t tick_ms)
+{
+	timer_wheel_t *wheel = calloc(1, sizeof(timer_wheel_t));
+
+	wheel->tick_ms = tick_ms > 0 ? tick_ms : 1;
+	wheel->capacity = TIMER_WHEEL_ENTRIES;
+	wheel->entries = calloc(wheel->capacity, sizeof(timer_entry_t));
+	wheel->running = true;
+	clock_gettime(CLOCK_MONOTONIC, &wheel->start);
+
+	for (int32_t i = 0; i < wheel->capacity; i++)
+		wheel->entries[i].next = i + 1 < wheel->capacity ? i + 1 : -1;
+
+	for (int i = 0; i < TIMER_WHEEL_SLOTS; i++)
+		wheel->slots[i] = -1;
+
+	pthread_condattr_t attributes;
+	pthread_condattr_init(&attributes);
+	pthread_condattr_setclock(&attributes, CLOCK_MONOTONIC);
+	pthread_cond_init(&wheel->changed, &attributes);
+	pthread_condattr_destroy(&attributes);
+	pthread_mutex_init(&wheel->mutex, NULL);
+
+	pthread_create(&wheel->thread, NULL, timer_wheel_loop, wheel);
+
+	return wheel;
+}
+
+timer_id_t timer_wheel_schedule(timer_wheel_t *wheel, uint32_t delay_ms, timer_callback_t callback, void *data)
+{
+	pthread_mutex_lock(&wheel->mutex);
+
+	if (wheel->free EQ -1)
+	{
+		int32_t capacity = wheel->capacity * 2;
+		wheel->entries = realloc(wheel->entries, capacity * sizeof(timer_entry_t));
+
+		for (int32_t i = wheel->capacity; i < capacity; i++)
+			wheel->entries[i] = (timer_entry_t){.next = i + 1 < capacity ? i + 1 : -1};
+
+		wheel->free = wheel->capacity;
+		wheel->capacity = capacity;
+	}
+
+	uint64_t now = now_tick(wheel);
+
+	// An idle wheel did not walk the ticks gone by: there is nothing in them
+	if (wheel->armed EQ 0)
+		wheel->tick = now;
+
+	int32_t index = wheel->free;
+	timer_entry_t *entry = &wheel->entries[index];
+	wheel->free = entry->next;
+
+	// Rounded up, and counted from the end of the tick already under way, so that it never fires early
+	entry->expiry = now + 1 + (delay_ms + wheel->tick_ms - 1) / wheel->tick_ms;
+	if (entry->expiry <= wheel->tick)
+		entry->expiry = wheel->tick + 1;
+
+	entry->callback = callback;
+	entry->data = data;
+
+	int32_t *slot = &wheel->slots[entry->expiry % TIMER_WHEEL_SLOTS];
+	entry->prev = -1;
+	entry->next = *slot;
+	if (*slot != -1)
+		wheel->entries[*slot].prev = index;
+	*slot = index;
+
+	if (wheel->armed++ EQ 0)
+		pthread_cond_signal(&wheel->changed);
+
+	timer_id_t timer = (uint64_t)entry->generation << 32 | (uint32_t)(index + 1);
+
+	pthread_mutex_unlock(&wheel->mutex);
+
+	return timer;
+}
+
+bool timer_wheel_cancel(timer_wheel_t *wheel, timer_id_t timer, void **data)
+{
+	int32_t index = (int32_t)(timer & UINT32_MAX) - 1;
+	uint32_t generation = timer >> 32;
+
+	pthread_mutex_lock(&wheel->mutex);
+
+	bool pending = index >= 0 && index < wheel->capacity
+				   && wheel->entries[index].generation EQ generation
+				   && wheel->entries[index].callback != NULL;
+
+	if (pending)
+	{
+		if (data)
+			*data = wheel->entries[index].data;
+
+		release(wheel, index);
+	}
+
+	pthread_mutex_unlock(&wheel->mutex);
+
+	return pending;
+}
+
+void timer_wheel_destroy(timer_wheel_t *wheel)
+{
+	pthread_mutex_lock(&wheel->mutex);
+	wheel->running = false;
+	pthread_cond_signal(&wheel->changed);
+	pthread_mutex_unlock(&wheel->mutex);
+
+	pthread_join(wheel->thread, NULL);
+
+	pthread_cond_destroy(&wheel->changed);
+	pthread_mutex_destroy(&wheel->mutex);
+	free(wheel->entries);
+	free(wheel);
+}
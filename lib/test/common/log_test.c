@@ -0,0 +1,110 @@
+/**
+ * @file log_test.c
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Asynchronous logger unit tests
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+#include "ctest.h"
+#include "lib.h"
+#include "log.h"
+
+#define LOGGERS 4
+#define MESSAGES 25000
+
+static void *log_messages(void *id)
+{
+	for (int n = 0; n < MESSAGES; n++)
+		LOG_INFO("seq %ld %d", (long)id, n);
+
+	return NULL;
+}
+
+static void *log_second(void *unused)
+{
+	(void)unused;
+	LOG_INFO("handoff second");
+
+	return NULL;
+}
+
+CTEST(log, when_manyThreadsLog_then_everyMessageIsWrittenInOrderOrCountedAsDropped)
+{
+	// log_init writes in <cwd>/log when run outside a module folder; one file per run, as runs may overlap
+	char name[32], path[64];
+	snprintf(name, sizeof(name), "log_test_%d", getpid());
+	snprintf(path, sizeof(path), "log/%s.log", name);
+
+	mkdir("log", 0755);
+	ASSERT_EQUAL(SUCCESS, log_init(name, false));
+
+	// One thread logs after another one did: the file keeps that order across their buffers.
+	// First, while no buffer is full, so that neither message can be dropped
+	pthread_t second;
+	LOG_INFO("handoff first");
+	pthread_create(&second, NULL, log_second, NULL);
+	pthread_join(second, NULL);
+
+	// Far faster than the writer: most are dropped, and counted
+	pthread_t threads[LOGGERS];
+
+	for (long i = 0; i < LOGGERS; i++)
+		pthread_create(&threads[i], NULL, log_messages, (void *)i);
+
+	for (int i = 0; i < LOGGERS; i++)
+		pthread_join(threads[i], NULL);
+
+	// Whatever is still buffered is written before closing
+	log_close();
+
+	FILE *file = fopen(path, "r");
+	ASSERT_NOT_NULL(file);
+
+	char line[1024];
+	long last[LOGGERS] = {-1, -1, -1, -1};
+	unsigned long written = 0, dropped = 0;
+	int first_at = -1, second_at = -1, at = 0;
+
+	while (fgets(line, sizeof(line), file))
+	{
+		char *seq = strstr(line, ": seq ");
+		char *full = strstr(line, "Log buffer full: ");
+		long id = 0, n = 0;
+
+		if (seq && sscanf(seq, ": seq %ld %ld", &id, &n) EQ 2)
+		{
+			// In order within each thread
+			ASSERT_TRUE(id >= 0 && id < LOGGERS);
+			ASSERT_TRUE(n > last[id]);
+			last[id] = n;
+			written++;
+		}
+		else if (full)
+			dropped += strtoul(full + strlen("Log buffer full: "), NULL, 10);
+		else if (strstr(line, "handoff first"))
+			first_at = at;
+		else if (strstr(line, "handoff second"))
+			second_at = at;
+
+		at++;
+	}
+
+	fclose(file);
+	unlink(path);
+	rmdir("log");
+
+	ASSERT_EQUAL(LOGGERS * MESSAGES, written + dropped);
+	ASSERT_TRUE(first_at >= 0);
+	ASSERT_TRUE(second_at > first_at);
+}
@@ -0,0 +1,92 @@
+/**
+ * @file metrics_test.c
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Metrics unit tests
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <pthread.h>
+#include <string.h>
+
+#include "ctest.h"
+#include "lib.h"
+#include "metrics.h"
+
+#define THREADS 4
+#define ADDS 10000
+
+static void *add_instructions(void *unused)
+{
+	(void)unused;
+
+	for (int i = 0; i < ADDS; i++)
+		metrics_add(METRIC_INSTRUCTIONS, 1);
+
+	return NULL;
+}
+
+CTEST(metrics, when_manyThreadsAddToACounter_then_nothingIsLost)
+{
+	uint64_t before = metrics_count(METRIC_INSTRUCTIONS);
+	pthread_t threads[THREADS];
+
+	for (int i = 0; i < THREADS; i++)
+		pthread_create(&threads[i], NULL, add_instructions, NULL);
+
+	for (int i = 0; i < THREADS; i++)
+		pthread_join(threads[i], NULL);
+
+	// The shards of the ended threads are adopted, not dropped
+	add_instructions(NULL);
+
+	ASSERT_EQUAL(before + (THREADS + 1) * ADDS, metrics_count(METRIC_INSTRUCTIONS));
+}
+
+CTEST(metrics, when_valuesAreRecorded_then_percentilesAreWithinABucket)
+{
+	for (uint64_t value = 1; value <= 1000; value++)
+		metrics_record(METRIC_SWAP_LATENCY, value);
+
+	ASSERT_EQUAL(1000, metrics_count(METRIC_SWAP_LATENCY));
+	ASSERT_EQUAL(1000, metrics_percentile(METRIC_SWAP_LATENCY, 1));
+	ASSERT_INTERVAL(500, 532, metrics_percentile(METRIC_SWAP_LATENCY, 0.5));
+	ASSERT_INTERVAL(990, 1000, metrics_percentile(METRIC_SWAP_LATENCY, 0.99));
+}
+
+CTEST(metrics, when_gaugesAndProcessCountersMove_then_theSnapshotShowsThem)
+{
+	metrics_gauge_set(METRIC_READY_QUEUE, 3);
+	metrics_gauge_add(METRIC_READY_QUEUE, -1);
+	metrics_add_process(METRIC_PAGE_FAULTS, 7, 2);
+	metrics_add_process(METRIC_PAGE_FAULTS, 9, 1);
+
+	ASSERT_EQUAL(2, metrics_gauge(METRIC_READY_QUEUE));
+	ASSERT_EQUAL(2, metrics_process_count(METRIC_PAGE_FAULTS, 7));
+	ASSERT_EQUAL(3, metrics_count(METRIC_PAGE_FAULTS));
+
+	char snapshot[4096];
+	size_t length = metrics_format(snapshot, sizeof(snapshot));
+
+	ASSERT_TRUE(length < sizeof(snapshot));
+	ASSERT_EQUAL(length, strlen(snapshot));
+	ASSERT_NOT_NULL(strstr(snapshot, "kernel.ready_queue 2\n"));
+	ASSERT_NOT_NULL(strstr(snapshot, "memory.page_faults 3 pid7=2 pid9=1\n"));
+
+	// Per-process gauges add up, and go back to 0 when a process ends
+	metrics_gauge_add_process(METRIC_PROCESS_FRAMES, 4, 3);
+	metrics_gauge_add_process(METRIC_PROCESS_FRAMES, 5, 2);
+	metrics_gauge_set_process(METRIC_PROCESS_FRAMES, 4, 0);
+	ASSERT_EQUAL(2, metrics_gauge(METRIC_PROCESS_FRAMES));
+	ASSERT_EQUAL(0, metrics_process_count(METRIC_PROCESS_FRAMES, 4));
+	metrics_format(snapshot, sizeof(snapshot));
+	ASSERT_NOT_NULL(strstr(snapshot, "memory.process_frames 2 pid5=2\n"));
+
+	// Too small: cut, but the length needed is still known
+	char small[8];
+	ASSERT_TRUE(metrics_format(small, sizeof(small)) >= length);
+	ASSERT_EQUAL(sizeof(small) - 1, strlen(small));
+}
@@ -0,0 +1,65 @@
+/**
+ * @file trace_test.c
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Trace recorder unit tests
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include "ctest.h"
+#include "lib.h"
+#include "trace.h"
+
+static FILE *open_own_trace(const char *app_name)
+{
+	char path[256];
+	snprintf(path, sizeof(path), "/tmp/%s.%ld%s", app_name, (long)syscall(SYS_gettid), TRACE_EXTENSION);
+
+	return fopen(path, "rb");
+}
+
+CTEST(trace, when_moreEventsThanRecordsAreTraced_then_theFileKeepsTheLastOnes)
+{
+	ASSERT_EQUAL(SUCCESS, trace_start("/tmp/", "trace_test", 4));
+
+	for (uint32_t pid = 0; pid < 6; pid++)
+		trace_event(TRACE_PROCESS_DISPATCHED, pid, pid * 10, 0);
+
+	trace_close();
+
+	// Off: nothing else is written
+	trace_event(TRACE_PROCESS_EXITED, 99, 0, 0);
+
+	FILE *file = open_own_trace("trace_test");
+	ASSERT_NOT_NULL(file);
+
+	trace_header_t header;
+	trace_record_t records[4];
+	ASSERT_EQUAL(1, fread(&header, sizeof(header), 1, file));
+	ASSERT_EQUAL(4, fread(records, sizeof(trace_record_t), 4, file));
+	fclose(file);
+
+	ASSERT_STR(TRACE_MAGIC, header.magic);
+	ASSERT_EQUAL(4, header.capacity);
+	ASSERT_EQUAL(6, header.written);
+	ASSERT_EQUAL(syscall(SYS_gettid), header.thread);
+
+	// Records 4 and 5 overwrote 0 and 1
+	for (uint32_t n = 2; n < 6; n++)
+	{
+		trace_record_t *record = &records[n % 4];
+		ASSERT_EQUAL(TRACE_PROCESS_DISPATCHED, record->event);
+		ASSERT_EQUAL(n, record->pid);
+		ASSERT_EQUAL(n * 10, record->args[0]);
+	}
+
+	ASSERT_TRUE(records[2].timestamp <= records[1].timestamp);
+	ASSERT_STR("DISPATCHED", trace_event_name(TRACE_PROCESS_DISPATCHED));
+}
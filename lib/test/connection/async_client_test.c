@@ -0,0 +1,149 @@
+/**
+ * @file async_client_test.c
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Pipelined client unit tests
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+
+#include "async_client.h"
+#include "server.h"
+#include "sem.h"
+#include "ctest.h"
+
+/**
+ * @brief Receives a request as the server would: [VALUE], its id in the header.
+ */
+static void receive_request(int socket, uint32_t *id, uint32_t *value)
+{
+	ssize_t bytes = 0;
+	servidor_recibir_operacion(socket);
+	*id = servidor_id_recibido(socket);
+	uint32_t *stream = servidor_recibir_stream(socket, &bytes);
+	*value = stream[0];
+	free(stream);
+}
+
+/**
+ * @brief Replies a request as the server would, echoing its id.
+ */
+static void reply_request(int socket, uint32_t id, uint32_t value)
+{
+	struct iovec segments[] = {{.iov_base = &value, .iov_len = sizeof(value)}};
+	enviar_frame(PKG, id, segments, 1, socket);
+}
+
+static sem_t called;
+static uint32_t callback_value;
+
+static void on_reply(void *reply, ssize_t size, void *data)
+{
+	(void)data;
+	callback_value = size EQ sizeof(uint32_t) ? *(uint32_t *)reply : 0;
+	SIGNAL(&called);
+}
+
+CTEST(async_client, when_repliesComeOutOfOrder_then_eachFutureGetsItsOwn)
+{
+	int fds[2];
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == -1)
+		ASSERT_FAIL();
+
+	conexion_t conexion = {.socket = fds[0], .conectado = true};
+	async_client_t *client = async_client_create(conexion, 2);
+
+	uint32_t first = 10, second = 20;
+	struct iovec first_segments[] = {{.iov_base = &first, .iov_len = sizeof(first)}};
+	struct iovec second_segments[] = {{.iov_base = &second, .iov_len = sizeof(second)}};
+
+	// Both requests are in flight before any reply.
+	async_request_t *first_request = async_client_submit(client, PKG, first_segments, 1, NULL, NULL);
+	async_request_t *second_request = async_client_submit(client, PKG, second_segments, 1, NULL, NULL);
+	ASSERT_NOT_NULL(first_request);
+	ASSERT_NOT_NULL(second_request);
+
+	uint32_t first_id, second_id, value;
+	receive_request(fds[1], &first_id, &value);
+	ASSERT_EQUAL(10, value);
+	receive_request(fds[1], &second_id, &value);
+	ASSERT_EQUAL(20, value);
+
+	reply_request(fds[1], second_id, 200);
+	reply_request(fds[1], first_id, 100);
+
+	ssize_t size = 0;
+	uint32_t *reply = async_request_wait(client, first_request, &size);
+	ASSERT_EQUAL(sizeof(uint32_t), size);
+	ASSERT_EQUAL(100, *reply);
+	async_client_release(client, reply);
+
+	reply = async_request_wait(client, second_request, &size);
+	ASSERT_EQUAL(200, *reply);
+	async_client_release(client, reply);
+
+	close(fds[1]);
+	async_client_destroy(client);
+	close(fds[0]);
+}
+
+CTEST(async_client, when_submittedWithCallback_then_itIsCalledWithTheReply)
+{
+	int fds[2];
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == -1)
+		ASSERT_FAIL();
+
+	sem_init(&called, SHARE_BETWEEN_THREADS, 0);
+
+	conexion_t conexion = {.socket = fds[0], .conectado = true};
+	async_client_t *client = async_client_create(conexion, 1);
+
+	uint32_t value = 7;
+	struct iovec segments[] = {{.iov_base = &value, .iov_len = sizeof(value)}};
+	ASSERT_EQUAL(SUCCESS, async_client_post(client, PKG, segments, 1, on_reply, NULL));
+
+	uint32_t id;
+	receive_request(fds[1], &id, &value);
+	reply_request(fds[1], id, value * 2);
+
+	WAIT(&called);
+	ASSERT_EQUAL(14, callback_value);
+
+	close(fds[1]);
+	async_client_destroy(client);
+	close(fds[0]);
+	sem_destroy(&called);
+}
+
+CTEST(async_client, when_connectionIsLost_then_requestsInFlightFail)
+{
+	int fds[2];
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == -1)
+		ASSERT_FAIL();
+
+	conexion_t conexion = {.socket = fds[0], .conectado = true};
+	async_client_t *client = async_client_create(conexion, 1);
+
+	uint32_t value = 1;
+	struct iovec segments[] = {{.iov_base = &value, .iov_len = sizeof(value)}};
+	async_request_t *request = async_client_submit(client, PKG, segments, 1, NULL, NULL);
+	ASSERT_NOT_NULL(request);
+
+	close(fds[1]);
+
+	ssize_t size = 0;
+	ASSERT_NULL(async_request_wait(client, request, &size));
+	ASSERT_EQUAL(ERROR, size);
+
+	// Nothing else can be sent: the caller is told so, not only its callback
+	ASSERT_EQUAL(ERROR, async_client_post(client, PKG, segments, 1, on_reply, NULL));
+
+	async_client_destroy(client);
+	close(fds[0]);
+}
@@ -0,0 +1,290 @@
+/**
+ * @file conexion_test.c
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Connection unit tests
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#include "conexion.h"
+#include "package.h"
+#include "receiver.h"
+#include "server.h"
+#include "memory_access.h"
+#include "instruction.h"
+#include "pcb.h"
+#include "ctest.h"
+
+CTEST(conexion, when_streamIsSentAsSegments_then_frameMatchesSerializedPackage)
+{
+	int fds[2];
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == -1)
+		ASSERT_FAIL();
+
+	uint32_t first = 10, second = 20, third = 30;
+	struct iovec segments[] = {
+		{.iov_base = &first, .iov_len = sizeof(uint32_t)},
+		{.iov_base = &second, .iov_len = sizeof(uint32_t)},
+		{.iov_base = &third, .iov_len = sizeof(uint32_t)},
+	};
+	uint32_t joined[] = {10, 20, 30};
+
+	package_t *package = new_package_for(RD, sizeof(joined), joined);
+	void *expected = package_serialize(package);
+	size_t expected_size = package_get_real_size(package);
+
+	ssize_t sent = enviar_stream_vector(RD, segments, 3, fds[0]);
+	ASSERT_EQUAL(expected_size, sent);
+
+	void *received = malloc(expected_size);
+	recv(fds[1], received, expected_size, MSG_WAITALL);
+	ASSERT_DATA(expected, expected_size, received, expected_size);
+
+	free(received);
+	free(expected);
+	package_destroy(package);
+	close(fds[0]);
+	close(fds[1]);
+}
+
+CTEST(conexion, when_pcbIsSent_then_canBeRecovered)
+{
+	int fds[2];
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == -1)
+		ASSERT_FAIL();
+
+	pcb_t *pcb = new_pcb(3, 128, 50);
+	pcb->pc = 2;
+	list_add(pcb->instructions, instruction_create(C_REQUEST_NO_OP, 0, 0));
+	list_add(pcb->instructions, instruction_create(C_REQUEST_IO, 100, 0));
+	list_add(pcb->instructions, instruction_create(C_REQUEST_EXIT, 0, 0));
+
+	void *serialized = pcb_to_stream(pcb);
+	enviar_stream(PCB, serialized, pcb_bytes_size(pcb), fds[0]);
+
+	wire_header_t header;
+	void *stream = conexion_recibir_frame(fds[1], &header);
+	ASSERT_EQUAL(PCB, header.opcode);
+	ASSERT_EQUAL(pcb_bytes_size(pcb), header.length);
+	ASSERT_DATA(serialized, pcb_bytes_size(pcb), stream, pcb_bytes_size(pcb));
+
+	wire_reader_t reader = wire_reader_create(stream, header.length);
+	pcb_t *recovered = pcb_decode(&reader);
+	ASSERT_FALSE(reader.failed);
+	ASSERT_EQUAL(header.length, reader.offset);
+	ASSERT_EQUAL(pcb->id, recovered->id);
+	ASSERT_EQUAL(pcb->pc, recovered->pc);
+	ASSERT_EQUAL(list_size(pcb->instructions), list_size(recovered->instructions));
+	ASSERT_EQUAL(C_REQUEST_IO, ((instruction_t *)list_get(recovered->instructions, 1))->icode);
+
+	free(serialized);
+	free(stream);
+	pcb_destroy(recovered);
+	pcb_destroy(pcb);
+	close(fds[0]);
+	close(fds[1]);
+}
+
+CTEST(conexion, when_receiverIsAttached_then_streamsAreSlicesOfItsBuffer)
+{
+	int fds[2];
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == -1)
+		ASSERT_FAIL();
+
+	receiver_t *receiver = receiver_attach(fds[1], RECEIVER_CAPACITY);
+	ASSERT_NOT_NULL(receiver);
+
+	// Both frames are read by the first recv.
+	uint32_t first = 7, second = 9;
+	enviar_stream(RD, &first, sizeof(first), fds[0]);
+	enviar_stream(WT, &second, sizeof(second), fds[0]);
+
+	ssize_t bytes = 0;
+	uint32_t *received = conexion_recibir_stream(fds[1], &bytes);
+	ASSERT_EQUAL(first, *received);
+	ASSERT_TRUE((char *)received >= receiver->buffer && (char *)received < receiver->buffer + receiver->capacity);
+	ASSERT_EQUAL(receiver->tail, 2 * (sizeof(uint32_t) + WIRE_HEADER_SIZE));
+	conexion_liberar_stream(fds[1], received);
+
+	received = conexion_recibir_stream(fds[1], &bytes);
+	ASSERT_EQUAL(second, *received);
+	conexion_liberar_stream(fds[1], received);
+
+	// Once every slice was released the ring starts over.
+	ASSERT_EQUAL(0, receiver->slices);
+	ASSERT_EQUAL(0, receiver->head);
+
+	receiver_detach(fds[1]);
+	ASSERT_NULL(receiver_of(fds[1]));
+	close(fds[0]);
+	close(fds[1]);
+}
+
+CTEST(conexion, when_streamDoesNotFitTheReceiver_then_isReceivedFromTheHeap)
+{
+	int fds[2];
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == -1)
+		ASSERT_FAIL();
+
+	receiver_t *receiver = receiver_attach(fds[1], 16);
+
+	char big[64];
+	memset(big, 'x', sizeof(big));
+	enviar_stream(PKG, big, sizeof(big), fds[0]);
+
+	ssize_t bytes = 0;
+	void *received = conexion_recibir_stream(fds[1], &bytes);
+	ASSERT_DATA((unsigned char *)big, sizeof(big), received, sizeof(big));
+	ASSERT_EQUAL(0, receiver->slices);
+	conexion_liberar_stream(fds[1], received);
+
+	receiver_detach(fds[1]);
+	close(fds[0]);
+	close(fds[1]);
+}
+
+CTEST(conexion, when_accessesAreBatched_then_oneFrameGoesAndResultsComeBackInOrder)
+{
+	int fds[2];
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == -1)
+		ASSERT_FAIL();
+
+	// The reply is queued beforehand, as Memory would answer it.
+	memory_access_result_t reply[] = {{.frame = 3, .value = 7}, {.frame = 5, .value = 9}};
+	enviar_stream(MEMORY_BATCH, reply, sizeof(reply), fds[1]);
+
+	memory_access_t accesses[] = {
+		{.pid = 1, .level = MEMORY_ACCESS_LVL_1, .table = 4, .index = 2, .offset = 8, .op = MEMORY_ACCESS_READ},
+		{.pid = 1, .level = MEMORY_ACCESS_FRAME, .index = 5, .offset = 0, .op = MEMORY_ACCESS_WRITE, .value = 9},
+	};
+	memory_access_result_t results[2];
+
+	conexion_t client = {.socket = fds[0], .conectado = true};
+	ASSERT_EQUAL(2, conexion_memory_batch(client, accesses, 2, results));
+	ASSERT_EQUAL(3, results[0].frame);
+	ASSERT_EQUAL(7, results[0].value);
+	ASSERT_EQUAL(5, results[1].frame);
+
+	ssize_t bytes = 0;
+	ASSERT_EQUAL(MEMORY_BATCH, servidor_recibir_operacion(fds[1]));
+	void *stream = servidor_recibir_stream(fds[1], &bytes);
+	ASSERT_EQUAL(sizeof(accesses), bytes);
+	ASSERT_DATA((unsigned char *)accesses, sizeof(accesses), stream, sizeof(accesses));
+
+	free(stream);
+	close(fds[0]);
+	close(fds[1]);
+}
+
+CTEST(conexion, when_theBatchReplyIsAnotherOperation_then_noResultIsTaken)
+{
+	int fds[2];
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == -1)
+		ASSERT_FAIL();
+
+	// Sized as two results, but it is not an answer to the batch
+	memory_access_result_t reply[] = {{.frame = 3, .value = 7}, {.frame = 5, .value = 9}};
+	enviar_stream(PKG, reply, sizeof(reply), fds[1]);
+
+	memory_access_t accesses[2] = {0};
+	memory_access_result_t results[2];
+
+	conexion_t client = {.socket = fds[0], .conectado = true};
+	ASSERT_EQUAL(ERROR, conexion_memory_batch(client, accesses, 2, results));
+
+	close(fds[0]);
+	close(fds[1]);
+}
+
+CTEST(conexion, when_addressIsUnixPath_then_framesKeepTheirBoundaries)
+{
+	char path[64];
+	sprintf(path, "unix:///tmp/sski-test-%d", getpid());
+
+	servidor_t server = servidor_create(path, "0");
+	ASSERT_EQUAL(SUCCESS, servidor_escuchar(&server));
+
+	conexion_t client = conexion_cliente_create(path, "0");
+	ASSERT_TRUE(conexion_conectar(&client) > 0);
+
+	int fd = server_accept_client(&server);
+	ASSERT_TRUE(fd > 0);
+
+	uint32_t value = 42;
+	conexion_enviar_stream(client, RD, &value, sizeof(value));
+
+	// The header read takes the whole record: the payload is already staged
+	ASSERT_EQUAL(RD, servidor_recibir_operacion(fd));
+	char byte;
+	ASSERT_EQUAL(ERROR, recv(fd, &byte, 1, MSG_DONTWAIT));
+
+	ssize_t bytes = 0;
+	uint32_t *received = servidor_recibir_stream(fd, &bytes);
+	ASSERT_EQUAL(sizeof(uint32_t), bytes);
+	ASSERT_EQUAL(42, *received);
+	free(received);
+
+	fd_send_value(fd, &value, sizeof(value));
+	received = connection_receive_value(client, sizeof(uint32_t));
+	ASSERT_EQUAL(42, *received);
+	free(received);
+
+	servidor_desconectar_cliente(fd);
+	conexion_destroy(&client);
+	server.client = -1;
+	servidor_destroy(&server);
+}
+
+CTEST(conexion, when_anotherListenerIsOpened_then_bothAcceptOnTheSamePort)
+{
+	servidor_t server = servidor_create("127.0.0.1", "0");
+	ASSERT_EQUAL(SUCCESS, servidor_escuchar(&server));
+
+	int other = conexion_escuchar_otra(&server.conexion);
+	ASSERT_TRUE(other > 0);
+
+	struct sockaddr_in address;
+	socklen_t length = sizeof(address);
+	getsockname(other, (struct sockaddr *)&address, &length);
+
+	char port[8];
+	sprintf(port, "%d", ntohs(address.sin_port));
+
+	fcntl(server.conexion.socket, F_SETFL, fcntl(server.conexion.socket, F_GETFL) | O_NONBLOCK);
+
+	conexion_t clients[16];
+	for (int i = 0; i < 16; i++)
+	{
+		clients[i] = conexion_cliente_create("127.0.0.1", port);
+		ASSERT_TRUE(conexion_conectar(&clients[i]) > 0);
+	}
+
+	// The kernel spreads the clients among the listeners: between them they take all
+	int accepted = 0, fd;
+	int listeners[] = {server.conexion.socket, other};
+
+	for (int i = 0; i < 2; i++)
+		while ((fd = server_accept_client_from(&server, listeners[i])) > 0)
+		{
+			servidor_desconectar_cliente(fd);
+			accepted++;
+		}
+
+	ASSERT_EQUAL(16, accepted);
+
+	for (int i = 0; i < 16; i++)
+		conexion_destroy(&clients[i]);
+
+	close(other);
+	server.client = -1;
+	servidor_destroy(&server);
+}
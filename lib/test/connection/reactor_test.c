@@ -0,0 +1,93 @@
+/**
+ * @file reactor_test.c
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Reactor server engine unit tests
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <arpa/inet.h>
+
+#include "reactor.h"
+#include "ctest.h"
+
+static servidor_t server;
+
+/**
+ * @brief Replies every stream with the amount of requests served in the session.
+ */
+static int counting_handler(int socket, void **session)
+{
+	int opcode = servidor_recibir_operacion(socket);
+
+	if (opcode <= 0)
+		return opcode;
+
+	if (*session == NULL)
+		*session = calloc(1, sizeof(uint32_t));
+
+	uint32_t *served = *session;
+	(*served)++;
+
+	ssize_t bytes = 0;
+	void *stream = servidor_recibir_stream(socket, &bytes);
+	servidor_liberar_stream(socket, stream);
+
+	servidor_enviar_stream(opcode, socket, served, sizeof(uint32_t));
+
+	return opcode;
+}
+
+static void *serve(void *result)
+{
+	*(int *)result = servidor_run_reactor(&server, 2, counting_handler);
+	return NULL;
+}
+
+CTEST(reactor, when_framesArriveTogether_then_everyOneIsServed)
+{
+	server = servidor_create("127.0.0.1", "0");
+	ASSERT_EQUAL(SUCCESS, servidor_escuchar(&server));
+
+	struct sockaddr_in address;
+	socklen_t length = sizeof(address);
+	getsockname(server.conexion.socket, (struct sockaddr *)&address, &length);
+	char port[8];
+	sprintf(port, "%d", ntohs(address.sin_port));
+
+	pthread_t thread;
+	int result = ERROR;
+	pthread_create(&thread, NULL, serve, &result);
+
+	conexion_t client = conexion_cliente_create("127.0.0.1", port);
+	ASSERT_TRUE(conexion_conectar(&client) > 0);
+
+	// Both requests leave before any reply is read.
+	uint32_t value = 1;
+	conexion_enviar_stream(client, PKG, &value, sizeof(value));
+	conexion_enviar_stream(client, PKG, &value, sizeof(value));
+
+	ssize_t bytes = 0;
+	uint32_t *served = conexion_recibir_stream(client.socket, &bytes);
+	ASSERT_EQUAL(1, *served);
+	free(served);
+
+	served = conexion_recibir_stream(client.socket, &bytes);
+	ASSERT_EQUAL(2, *served);
+	free(served);
+
+	// Every reactor ends, and their clients are closed
+	servidor_stop_reactor(&server);
+	pthread_join(thread, NULL);
+	ASSERT_EQUAL(EXIT_SUCCESS, result);
+	ASSERT_EQUAL(0, recv(client.socket, &value, sizeof(value), 0));
+
+	conexion_destroy(&client);
+	servidor_destroy(&server);
+}
@@ -0,0 +1,209 @@
+/**
+ * @file transport_test.c
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Shared-memory transport unit tests
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/socket.h>
+
+#include "transport.h"
+#include "conexion.h"
+#include "lib.h"
+#include "ctest.h"
+
+// Larger than a ring, so that it wraps while the other side reads.
+#define LARGE_PAYLOAD (3 * TRANSPORT_RING_CAPACITY + 7)
+
+static void *offer_link(void *socket)
+{
+	intptr_t linked = transport_shm_connect(*(int *)socket) EQ SUCCESS;
+	return (void *)linked;
+}
+
+/**
+ * @brief Answers the link offer sent by the client thread.
+ */
+static bool answer_offer(int fds[2], bool enabled)
+{
+	pthread_t client;
+	pthread_create(&client, NULL, offer_link, &fds[0]);
+
+	wire_header_t header;
+	char *name = conexion_recibir_frame(fds[1], &header);
+	bool offered = name != NULL && header.opcode EQ SHM_LINK;
+
+	transport_shm_accept(fds[1], name, enabled);
+	free(name);
+
+	void *linked;
+	pthread_join(client, &linked);
+
+	return offered && (bool)(intptr_t)linked;
+}
+
+static void *send_large(void *socket)
+{
+	char *payload = malloc(LARGE_PAYLOAD);
+
+	for (int i = 0; i < LARGE_PAYLOAD; i++)
+		payload[i] = i % 251;
+
+	enviar_stream(PKG, payload, LARGE_PAYLOAD, *(int *)socket);
+	free(payload);
+
+	return NULL;
+}
+
+CTEST(transport, when_linkIsAccepted_then_framesSkipTheSocket)
+{
+	int fds[2];
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == -1)
+		ASSERT_FAIL();
+
+	ASSERT_TRUE(answer_offer(fds, true));
+	ASSERT_NOT_NULL(transport_of(fds[0]));
+	ASSERT_NOT_NULL(transport_of(fds[1]));
+
+	uint32_t value = 42;
+	ASSERT_EQUAL(sizeof(value), fd_send_value(fds[1], &value, sizeof(value)));
+
+	// Nothing went through the socket
+	char byte;
+	ASSERT_EQUAL(ERROR, recv(fds[0], &byte, 1, MSG_PEEK | MSG_DONTWAIT));
+
+	conexion_t client = {.socket = fds[0], .conectado = true};
+	uint32_t *received = connection_receive_value(client, sizeof(uint32_t));
+	ASSERT_NOT_NULL(received);
+	ASSERT_EQUAL(42, *received);
+	free(received);
+
+	// A frame larger than the ring goes through while it is read
+	pthread_t sender;
+	pthread_create(&sender, NULL, send_large, &fds[0]);
+
+	wire_header_t header;
+	char *payload = conexion_recibir_frame(fds[1], &header);
+	pthread_join(sender, NULL);
+
+	ASSERT_NOT_NULL(payload);
+	ASSERT_EQUAL(LARGE_PAYLOAD, header.length);
+
+	bool intact = true;
+	for (int i = 0; i < LARGE_PAYLOAD; i++)
+		intact = intact && payload[i] EQ (char)(i % 251);
+
+	ASSERT_TRUE(intact);
+	free(payload);
+
+	// Once the client leaves, the server reads the end of the stream
+	conexion_desconectar(&client);
+	ASSERT_NULL(conexion_recibir_frame(fds[1], &header));
+
+	transport_detach(fds[1]);
+	close(fds[1]);
+}
+
+CTEST(transport, when_linkIsDeclined_then_theSocketIsStillUsed)
+{
+	int fds[2];
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == -1)
+		ASSERT_FAIL();
+
+	ASSERT_FALSE(answer_offer(fds, false));
+	ASSERT_NULL(transport_of(fds[0]));
+	ASSERT_NULL(transport_of(fds[1]));
+
+	uint32_t value = 7;
+	fd_send_value(fds[1], &value, sizeof(value));
+
+	conexion_t client = {.socket = fds[0], .conectado = true};
+	uint32_t *received = connection_receive_value(client, sizeof(uint32_t));
+	ASSERT_NOT_NULL(received);
+	ASSERT_EQUAL(7, *received);
+	free(received);
+
+	close(fds[0]);
+	close(fds[1]);
+}
+
+CTEST(transport, when_frameIsLargerThanARecord_then_itIsSentInSeveral)
+{
+	int fds[2];
+	if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds) == -1)
+		ASSERT_FAIL();
+
+	transport_records_attach(fds[0]);
+	transport_records_attach(fds[1]);
+
+	pthread_t sender;
+	pthread_create(&sender, NULL, send_large, &fds[0]);
+
+	wire_header_t header;
+	char *payload = conexion_recibir_frame(fds[1], &header);
+	pthread_join(sender, NULL);
+
+	ASSERT_NOT_NULL(payload);
+	ASSERT_EQUAL(LARGE_PAYLOAD, header.length);
+
+	bool intact = true;
+	for (int i = 0; i < LARGE_PAYLOAD; i++)
+		intact = intact && payload[i] EQ (char)(i % 251);
+
+	ASSERT_TRUE(intact);
+	free(payload);
+
+	transport_detach(fds[0]);
+	transport_detach(fds[1]);
+	close(fds[0]);
+	close(fds[1]);
+}
+
+CTEST(transport, when_twoThreadsSendOnARecordSocket_then_theirFramesDoNotInterleave)
+{
+	int fds[2];
+	if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds) == -1)
+		ASSERT_FAIL();
+
+	transport_records_attach(fds[0]);
+	transport_records_attach(fds[1]);
+
+	pthread_t senders[2];
+	for (int i = 0; i < 2; i++)
+		pthread_create(&senders[i], NULL, send_large, &fds[0]);
+
+	bool intact = true;
+	for (int frame = 0; frame < 2; frame++)
+	{
+		wire_header_t header;
+		char *payload = conexion_recibir_frame(fds[1], &header);
+
+		intact = intact && payload != NULL && header.length EQ LARGE_PAYLOAD;
+		for (int i = 0; intact && i < LARGE_PAYLOAD; i++)
+			intact = payload[i] EQ (char)(i % 251);
+
+		free(payload);
+
+		// A broken frame leaves the rest of the stream unreadable
+		if (!intact)
+			break;
+	}
+
+	transport_detach(fds[1]);
+	close(fds[1]);
+
+	for (int i = 0; i < 2; i++)
+		pthread_join(senders[i], NULL);
+
+	ASSERT_TRUE(intact);
+
+	transport_detach(fds[0]);
+	close(fds[0]);
+}
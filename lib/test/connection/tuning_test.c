@@ -0,0 +1,76 @@
+/**
+ * @file tuning_test.c
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Socket tuning unit tests
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdlib.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#include "tuning.h"
+#include "conexion.h"
+#include "server.h"
+#include "lib.h"
+#include "ctest.h"
+
+static int option(int socket, int level, int name)
+{
+	int value = 0;
+	socklen_t length = sizeof(value);
+	getsockopt(socket, level, name, &value, &length);
+	return value;
+}
+
+CTEST(tuning, when_socketIsCorked_then_framesWaitForTheFlush)
+{
+	servidor_t server = servidor_create("127.0.0.1", "0");
+	ASSERT_EQUAL(SUCCESS, servidor_escuchar(&server));
+
+	struct sockaddr_in address;
+	socklen_t length = sizeof(address);
+	getsockname(server.conexion.socket, (struct sockaddr *)&address, &length);
+
+	char port[8];
+	sprintf(port, "%d", ntohs(address.sin_port));
+
+	conexion_t client = conexion_cliente_create("127.0.0.1", port);
+	ASSERT_TRUE(conexion_conectar(&client) > 0);
+
+	int fd = server_accept_client(&server);
+	ASSERT_TRUE(fd > 0);
+
+	socket_tuning_t tuning = {.nodelay = true, .cork = true, .send_buffer = 64 * 1024};
+	ASSERT_EQUAL(SUCCESS, socket_tuning_buffers(client.socket, tuning));
+	ASSERT_EQUAL(SUCCESS, socket_tuning_apply(client.socket, tuning));
+
+	ASSERT_TRUE(option(client.socket, IPPROTO_TCP, TCP_NODELAY));
+	ASSERT_TRUE(option(client.socket, IPPROTO_TCP, TCP_CORK));
+	// The kernel doubles it for its own bookkeeping
+	ASSERT_TRUE(option(client.socket, SOL_SOCKET, SO_SNDBUF) >= 64 * 1024);
+
+	uint32_t value = 42;
+	fd_send_value(client.socket, &value, sizeof(value));
+
+	// Corked: nothing left yet
+	struct pollfd peer = {.fd = fd, .events = POLLIN};
+	ASSERT_EQUAL(0, poll(&peer, 1, 50));
+
+	socket_flush(client.socket);
+	ASSERT_EQUAL(1, poll(&peer, 1, 50));
+
+	// And the socket is corked again
+	ASSERT_TRUE(option(client.socket, IPPROTO_TCP, TCP_CORK));
+
+	servidor_desconectar_cliente(fd);
+	conexion_destroy(&client);
+	server.client = -1;
+	servidor_destroy(&server);
+}
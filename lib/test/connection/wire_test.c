@@ -0,0 +1,90 @@
+/**
+ * @file wire_test.c
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Wire format unit tests
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdint.h>
+#include <sys/socket.h>
+
+#include "wire.h"
+#include "conexion.h"
+#include "ctest.h"
+
+CTEST(wire, when_varintsAreWritten_then_theyAreReadBackWithTheirSizes)
+{
+	uint32_t values[] = {0, 127, 128, 16383, 16384, UINT32_MAX};
+	size_t sizes[] = {1, 1, 2, 2, 3, WIRE_VARINT_MAX};
+
+	wire_writer_t writer;
+	wire_writer_init(&writer, 1);
+
+	for (int i = 0; i < 6; i++)
+	{
+		size_t before = writer.size;
+		wire_write_varint(&writer, values[i]);
+		ASSERT_EQUAL(sizes[i], writer.size - before);
+		ASSERT_EQUAL(sizes[i], wire_varint_size(values[i]));
+	}
+
+	wire_reader_t reader = wire_reader_create(writer.buffer, writer.size);
+
+	for (int i = 0; i < 6; i++)
+		ASSERT_EQUAL(values[i], wire_read_varint(&reader));
+
+	ASSERT_FALSE(reader.failed);
+
+	// Nothing left to read
+	ASSERT_EQUAL(0, wire_read_varint(&reader));
+	ASSERT_TRUE(reader.failed);
+
+	wire_writer_destroy(&writer);
+}
+
+CTEST(wire, when_varintOverflows_then_readerFails)
+{
+	uint8_t overlong[] = {0xFF, 0xFF, 0xFF, 0xFF, 0x1F};
+
+	wire_reader_t reader = wire_reader_create(overlong, sizeof(overlong));
+	wire_read_varint(&reader);
+
+	ASSERT_TRUE(reader.failed);
+}
+
+CTEST(wire, when_headerIsEncoded_then_isLittleEndian)
+{
+	uint8_t header[WIRE_HEADER_SIZE];
+	wire_header_encode(header, MEMORY_BATCH, 0x01020304, 0x0A0B);
+
+	uint8_t expected[WIRE_HEADER_SIZE] = {WIRE_MAGIC, WIRE_VERSION, MEMORY_BATCH, 0, 0x04, 0x03, 0x02, 0x01, 0x0B, 0x0A, 0, 0};
+	ASSERT_DATA(expected, WIRE_HEADER_SIZE, header, WIRE_HEADER_SIZE);
+
+	wire_header_t decoded;
+	ASSERT_TRUE(wire_header_decode(header, &decoded));
+	ASSERT_EQUAL(MEMORY_BATCH, decoded.opcode);
+	ASSERT_EQUAL(0x01020304, decoded.id);
+	ASSERT_EQUAL(0x0A0B, decoded.length);
+}
+
+CTEST(wire, when_frameHasAnotherVersion_then_isNotReceived)
+{
+	int fds[2];
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == -1)
+		ASSERT_FAIL();
+
+	uint8_t frame[WIRE_HEADER_SIZE + sizeof(uint32_t)] = {0};
+	wire_header_encode(frame, RD, 0, sizeof(uint32_t));
+	frame[1] = WIRE_VERSION + 1;
+	send(fds[0], frame, sizeof(frame), 0);
+
+	wire_header_t header;
+	ASSERT_NULL(conexion_recibir_frame(fds[1], &header));
+
+	close(fds[0]);
+	close(fds[1]);
+}
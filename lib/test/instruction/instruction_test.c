@@ -80,7 +80,11 @@ CTEST(instruction, when_instructions_fold_then_canBeRecovered)
 	list_smart_add(instructions, read_i);
 	list_smart_add(instructions, write_i);
 
-	void *folded = instructions_fold(instructions);
+	size_t size = 0;
+	void *folded = instructions_fold(instructions, &size);
+
+	// [COUNT] and three one byte varints per instruction
+	ASSERT_EQUAL(1 + 3 * 3, size);
 
 	t_list *recovered = instruction_list_from(folded);
 
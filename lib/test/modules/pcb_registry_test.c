@@ -0,0 +1,57 @@
+/**
+ * @file pcb_registry_test.c
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief PCB registry unit tests
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include "ctest.h"
+#include "pcb_registry.h"
+
+CTEST(pcb_registry, when_pcbIsAdded_then_itIsFoundByPidUntilRemoved)
+{
+	pcb_registry_t *registry = new_pcb_registry(8);
+	pcb_t *pcb = new_pcb(3, 4096, 10000);
+
+	ASSERT_TRUE(pcb_registry_add(registry, pcb, PCB_QUEUE_ADMISSION));
+	ASSERT_EQUAL((intptr_t)pcb, (intptr_t)pcb_registry_get(registry, 3));
+	ASSERT_EQUAL(PCB_QUEUE_ADMISSION, pcb_registry_queue(registry, 3));
+
+	// Taken or out of range
+	pcb_t *other = new_pcb(3, 4096, 10000), *far = new_pcb(8, 4096, 10000);
+	ASSERT_FALSE(pcb_registry_add(registry, other, PCB_QUEUE_NEW));
+	ASSERT_FALSE(pcb_registry_add(registry, far, PCB_QUEUE_NEW));
+	ASSERT_NULL(pcb_registry_get(registry, 8));
+
+	ASSERT_EQUAL((intptr_t)pcb, (intptr_t)pcb_registry_remove(registry, 3));
+	ASSERT_NULL(pcb_registry_get(registry, 3));
+	ASSERT_EQUAL(PCB_QUEUE_NONE, pcb_registry_queue(registry, 3));
+
+	pcb_registry_destroy(registry, pcb_destroy);
+	pcb_destroy(pcb);
+	pcb_destroy(other);
+	pcb_destroy(far);
+}
+
+CTEST(pcb_registry, when_pcbIsMoved_then_onlyTheQueueItIsInMatches)
+{
+	pcb_registry_t *registry = new_pcb_registry(8);
+	pcb_t *pcb = new_pcb(1, 4096, 10000);
+
+	pcb_registry_add(registry, pcb, PCB_QUEUE_BLOCKED);
+
+	// The first claim wins, the second finds it elsewhere
+	ASSERT_EQUAL((intptr_t)pcb, (intptr_t)pcb_registry_move(registry, 1, PCB_QUEUE_BLOCKED, PCB_QUEUE_BLOCKED_SUS));
+	ASSERT_NULL(pcb_registry_move(registry, 1, PCB_QUEUE_BLOCKED, PCB_QUEUE_NONE));
+	ASSERT_EQUAL(PCB_QUEUE_BLOCKED_SUS, pcb_registry_queue(registry, 1));
+
+	pcb_registry_set(registry, 1, PCB_QUEUE_READY);
+	ASSERT_EQUAL(PCB_QUEUE_READY, pcb_registry_queue(registry, 1));
+
+	// Still registered: deallocated along with the registry
+	pcb_registry_destroy(registry, pcb_destroy);
+}
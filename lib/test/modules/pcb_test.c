@@ -46,6 +46,45 @@ CTEST(pcb, when_pcbToStream_then_canBeRecovered)
 	pcb_destroy(recovered);
 }
 
+CTEST(pcb, when_streamIsTruncated_then_pcbIsNotRecovered)
+{
+	pcb_t *pcb = new_pcb(1, 4096, 10000);
+	fill_list(pcb->instructions);
+
+	void *stream = pcb_to_stream(pcb);
+	wire_reader_t reader = wire_reader_create(stream, pcb_bytes_size(pcb) - 1);
+
+	ASSERT_NULL(pcb_decode(&reader));
+	ASSERT_TRUE(reader.failed);
+
+	free(stream);
+	pcb_destroy(pcb);
+}
+
+CTEST(pcb, when_statusIsOutOfRange_then_pcbIsNotRecovered)
+{
+	// Statuses below NONE and above PCB_TERMINATED, as they would be shifted on the wire
+	uint32_t statuses[] = {UINT32_MAX, (uint32_t)INT32_MIN, PCB_TERMINATED + 2};
+
+	for (size_t i = 0; i < sizeof(statuses) / sizeof(statuses[0]); i++)
+	{
+		wire_writer_t writer;
+		wire_writer_init(&writer, 16);
+		wire_write_varint(&writer, 1);
+		wire_write_varint(&writer, statuses[i]);
+
+		for (int field = 0; field < 5; field++)
+			wire_write_varint(&writer, 0);
+
+		wire_reader_t reader = wire_reader_create(writer.buffer, writer.size);
+
+		ASSERT_NULL(pcb_decode(&reader));
+		ASSERT_TRUE(reader.failed);
+
+		wire_writer_destroy(&writer);
+	}
+}
+
 CTEST(pcb, when_pcb_has_less_estimation_goes_first)
 {
 	uint32_t id = rand(), size = rand(), estimation = rand();
@@ -0,0 +1,98 @@
+/**
+ * @file intrusive_queue_test.c
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Intrusive queue unit tests
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdint.h>
+
+#include "ctest.h"
+#include "intrusive_queue.h"
+
+typedef struct Item
+{
+	int value;
+	queue_link_t link;
+} item_t;
+
+static bool lower_or_equal(void *a, void *b)
+{
+	return ((item_t *)a)->value <= ((item_t *)b)->value;
+}
+
+CTEST(intrusive_queue, when_elementsArePushed_then_theyArePoppedInOrder)
+{
+	intrusive_queue_t *queue = new_intrusive_queue(offsetof(item_t, link));
+	item_t items[3];
+
+	for (int i = 0; i < 3; i++)
+	{
+		items[i].value = i;
+		queue_link_init(&items[i].link);
+		ASSERT_TRUE(intrusive_queue_push(queue, &items[i]));
+	}
+
+	// Already queued: it cannot be in two places
+	ASSERT_FALSE(intrusive_queue_push(queue, &items[1]));
+	ASSERT_EQUAL(3, intrusive_queue_size(queue));
+
+	for (int i = 0; i < 3; i++)
+		ASSERT_EQUAL((intptr_t)&items[i], (intptr_t)intrusive_queue_pop(queue));
+
+	ASSERT_NULL(intrusive_queue_pop(queue));
+	ASSERT_TRUE(intrusive_queue_is_empty(queue));
+
+	intrusive_queue_destroy(queue);
+}
+
+CTEST(intrusive_queue, when_elementIsRemovedFromTheMiddle_then_itCanMoveToAnotherQueue)
+{
+	intrusive_queue_t *blocked = new_intrusive_queue(offsetof(item_t, link));
+	intrusive_queue_t *suspended = new_intrusive_queue(offsetof(item_t, link));
+	item_t items[3];
+
+	for (int i = 0; i < 3; i++)
+	{
+		items[i].value = i;
+		queue_link_init(&items[i].link);
+		intrusive_queue_push(blocked, &items[i]);
+	}
+
+	ASSERT_FALSE(intrusive_queue_remove(suspended, &items[1]));
+	ASSERT_TRUE(intrusive_queue_remove(blocked, &items[1]));
+	ASSERT_FALSE(intrusive_queue_contains(blocked, &items[1]));
+
+	ASSERT_TRUE(intrusive_queue_push(suspended, &items[1]));
+	ASSERT_TRUE(intrusive_queue_contains(suspended, &items[1]));
+
+	ASSERT_EQUAL((intptr_t)&items[0], (intptr_t)intrusive_queue_pop(blocked));
+	ASSERT_EQUAL((intptr_t)&items[2], (intptr_t)intrusive_queue_pop(blocked));
+	ASSERT_EQUAL((intptr_t)&items[1], (intptr_t)intrusive_queue_pop(suspended));
+
+	intrusive_queue_destroy(blocked);
+	intrusive_queue_destroy(suspended);
+}
+
+CTEST(intrusive_queue, when_poppingTheFirst_then_theLowestLeavesAndTiesKeepTheirOrder)
+{
+	intrusive_queue_t *queue = new_intrusive_queue(offsetof(item_t, link));
+	item_t items[4] = {{.value = 5}, {.value = 2}, {.value = 7}, {.value = 2}};
+
+	for (int i = 0; i < 4; i++)
+	{
+		queue_link_init(&items[i].link);
+		intrusive_queue_push(queue, &items[i]);
+	}
+
+	ASSERT_EQUAL((intptr_t)&items[1], (intptr_t)intrusive_queue_pop_first(queue, lower_or_equal));
+	ASSERT_EQUAL((intptr_t)&items[3], (intptr_t)intrusive_queue_pop_first(queue, lower_or_equal));
+	ASSERT_EQUAL((intptr_t)&items[0], (intptr_t)intrusive_queue_pop_first(queue, lower_or_equal));
+	ASSERT_EQUAL((intptr_t)&items[2], (intptr_t)intrusive_queue_pop_wait(queue));
+
+	intrusive_queue_destroy(queue);
+}
@@ -0,0 +1,102 @@
+/**
+ * @file mpmc_queue_test.c
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Lock-free queue unit tests
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdint.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "ctest.h"
+#include "mpmc_queue.h"
+
+#define PRODUCERS 4
+#define PER_PRODUCER 5000
+
+static _Atomic uintptr_t consumed_sum;
+static _Atomic int consumed;
+
+static void *produce(void *queue)
+{
+	for (uintptr_t i = 1; i <= PER_PRODUCER; i++)
+		while (!mpmc_queue_push(queue, (void *)i))
+			sched_yield();
+
+	return NULL;
+}
+
+static void *consume(void *queue)
+{
+	while (consumed < PRODUCERS * PER_PRODUCER)
+	{
+		void *element = mpmc_queue_pop(queue);
+
+		if (element)
+		{
+			consumed_sum += (uintptr_t)element;
+			consumed++;
+		}
+		else
+			sched_yield();
+	}
+
+	return NULL;
+}
+
+CTEST(mpmc_queue, when_elementsArePushed_then_theyArePoppedInOrderUntilFull)
+{
+	mpmc_queue_t *queue = new_mpmc_queue(3);
+
+	ASSERT_TRUE(mpmc_queue_is_empty(queue));
+	ASSERT_NULL(mpmc_queue_pop(queue));
+
+	// Rounded up to 4
+	for (uintptr_t i = 1; i <= 4; i++)
+		ASSERT_TRUE(mpmc_queue_push(queue, (void *)i));
+
+	ASSERT_FALSE(mpmc_queue_push(queue, (void *)5));
+	ASSERT_EQUAL(1, (uintptr_t)mpmc_queue_peek(queue));
+
+	for (uintptr_t i = 1; i <= 4; i++)
+		ASSERT_EQUAL(i, (uintptr_t)mpmc_queue_pop(queue));
+
+	// The cells are reused on the next lap
+	ASSERT_TRUE(mpmc_queue_push(queue, (void *)6));
+	ASSERT_FALSE(mpmc_queue_is_empty(queue));
+	ASSERT_EQUAL(6, (uintptr_t)mpmc_queue_pop(queue));
+
+	mpmc_queue_destroy(queue, NULL);
+}
+
+CTEST(mpmc_queue, when_manyThreadsShareIt_then_everyElementIsPoppedOnce)
+{
+	mpmc_queue_t *queue = new_mpmc_queue(64);
+	pthread_t producers[PRODUCERS], consumers[PRODUCERS];
+
+	consumed_sum = 0;
+	consumed = 0;
+
+	for (int i = 0; i < PRODUCERS; i++)
+	{
+		pthread_create(&producers[i], NULL, produce, queue);
+		pthread_create(&consumers[i], NULL, consume, queue);
+	}
+
+	for (int i = 0; i < PRODUCERS; i++)
+	{
+		pthread_join(producers[i], NULL);
+		pthread_join(consumers[i], NULL);
+	}
+
+	ASSERT_EQUAL(PRODUCERS * PER_PRODUCER, consumed);
+	ASSERT_EQUAL((uintptr_t)PRODUCERS * PER_PRODUCER * (PER_PRODUCER + 1) / 2, consumed_sum);
+	ASSERT_TRUE(mpmc_queue_is_empty(queue));
+
+	mpmc_queue_destroy(queue, NULL);
+}
@@ -0,0 +1,156 @@
+/**
+ * @file read_mostly_list_test.c
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Read-mostly list unit tests
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdint.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ctest.h"
+#include "read_mostly_list.h"
+#include "lib.h"
+
+#define WRITES 2000
+
+static _Atomic bool writing;
+
+static void *read_while_written(void *list)
+{
+	uint32_t reads = 0;
+
+	// Every slot seen holds what was published for it
+	while (writing || reads EQ 0)
+	{
+		uint32_t size = read_mostly_list_size(list);
+
+		for (uint32_t i = 0; i < size; i++)
+		{
+			uintptr_t element = (uintptr_t)read_mostly_list_get(list, i);
+
+			if (element != 0 && element != i + 1)
+				return (void *)1;
+		}
+
+		reads++;
+		sched_yield();
+	}
+
+	return NULL;
+}
+
+CTEST(read_mostly_list, when_slotsAreEmptied_then_putReusesThemOnlyIfAsked)
+{
+	read_mostly_list_t *list = new_read_mostly_list();
+
+	ASSERT_NULL(read_mostly_list_get(list, 0));
+	ASSERT_EQUAL(0, read_mostly_list_put(list, (void *)1, true));
+	ASSERT_EQUAL(1, read_mostly_list_put(list, (void *)2, true));
+	ASSERT_EQUAL(2, read_mostly_list_put(list, (void *)3, true));
+
+	ASSERT_TRUE(read_mostly_list_set(list, 1, NULL));
+	ASSERT_NULL(read_mostly_list_get(list, 1));
+	ASSERT_EQUAL(3, read_mostly_list_size(list));
+
+	ASSERT_EQUAL(3, read_mostly_list_put(list, (void *)4, false));
+	ASSERT_EQUAL(1, read_mostly_list_put(list, (void *)5, true));
+	ASSERT_EQUAL(5, (uintptr_t)read_mostly_list_get(list, 1));
+
+	// Across chunks, and past the most it can hold
+	ASSERT_TRUE(read_mostly_list_set(list, READ_MOSTLY_CHUNK + 1, (void *)6));
+	ASSERT_EQUAL(READ_MOSTLY_CHUNK + 2, read_mostly_list_size(list));
+	ASSERT_NULL(read_mostly_list_get(list, READ_MOSTLY_CHUNK));
+	ASSERT_EQUAL(6, (uintptr_t)read_mostly_list_get(list, READ_MOSTLY_CHUNK + 1));
+	ASSERT_FALSE(read_mostly_list_set(list, READ_MOSTLY_CHUNK * READ_MOSTLY_CHUNKS, (void *)7));
+
+	read_mostly_list_destroy(list, NULL);
+}
+
+CTEST(read_mostly_list, when_readWhileWritten_then_readersSeeOnlyPublishedElements)
+{
+	read_mostly_list_t *list = new_read_mostly_list();
+	pthread_t readers[2];
+	void *result = NULL;
+
+	writing = true;
+
+	for (int i = 0; i < 2; i++)
+		pthread_create(&readers[i], NULL, read_while_written, list);
+
+	for (uintptr_t i = 0; i < WRITES; i++)
+	{
+		read_mostly_list_put(list, (void *)(i + 1), false);
+
+		if (i % 3 EQ 0)
+			read_mostly_list_set(list, i, NULL);
+	}
+
+	writing = false;
+
+	for (int i = 0; i < 2; i++)
+	{
+		pthread_join(readers[i], &result);
+		ASSERT_NULL(result);
+	}
+
+	ASSERT_EQUAL(WRITES, read_mostly_list_size(list));
+	read_mostly_list_destroy(list, NULL);
+}
+
+static _Atomic bool taken;
+// The CPU time the taker spent, in microseconds
+static _Atomic long taker_cpu;
+
+static void *take_slot(void *list)
+{
+	struct timespec start, end;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &start);
+
+	void *element = read_mostly_list_take(list, 0);
+	atomic_store(&taken, true);
+
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &end);
+	atomic_store(&taker_cpu, (end.tv_sec - start.tv_sec) * 1000000L + (end.tv_nsec - start.tv_nsec) / 1000);
+
+	return element;
+}
+
+CTEST(read_mostly_list, when_takenWhileRead_then_itWaitsForTheReader)
+{
+	read_mostly_list_t *list = new_read_mostly_list();
+	pthread_t taker;
+	void *result = NULL;
+
+	read_mostly_list_put(list, (void *)1, true);
+	atomic_store(&taken, false);
+
+	uint32_t token = read_mostly_list_enter(list);
+	ASSERT_EQUAL(1, (uintptr_t)read_mostly_list_get(list, 0));
+	pthread_create(&taker, NULL, take_slot, list);
+
+	// The slot empties at once, but the element is only handed back once the reader leaves
+	while (read_mostly_list_get(list, 0) != NULL)
+		sched_yield();
+
+	usleep(100000);
+	ASSERT_FALSE(atomic_load(&taken));
+
+	read_mostly_list_leave(list, token);
+	pthread_join(taker, &result);
+
+	ASSERT_TRUE(atomic_load(&taken));
+	ASSERT_EQUAL(1, (uintptr_t)result);
+	// It slept while the reader was inside, it did not spin
+	ASSERT_TRUE(atomic_load(&taker_cpu) < 20000);
+	ASSERT_NULL(read_mostly_list_take(list, 0));
+
+	read_mostly_list_destroy(list, NULL);
+}
@@ -0,0 +1,90 @@
+/**
+ * @file safe_queue_test.c
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Safe queue blocking operations unit tests
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "ctest.h"
+#include "safe_queue.h"
+
+static void *push_later(void *queue)
+{
+	usleep(20 * 1000);
+	safe_queue_push(queue, (void *)3);
+	safe_queue_push(queue, (void *)1);
+	safe_queue_push(queue, (void *)2);
+	return NULL;
+}
+
+CTEST(safe_queue, when_popWaitsOnAnEmptyQueue_then_aPushWakesIt)
+{
+	safe_queue_t *queue = new_safe_queue();
+	pthread_t producer;
+
+	pthread_create(&producer, NULL, push_later, queue);
+	ASSERT_EQUAL(3, (uintptr_t)safe_queue_pop_wait(queue));
+	pthread_join(producer, NULL);
+
+	// The rest in the order they were pushed
+	ASSERT_EQUAL(1, (uintptr_t)safe_queue_pop_wait(queue));
+	ASSERT_EQUAL(2, (uintptr_t)safe_queue_pop_wait(queue));
+	ASSERT_TRUE(safe_queue_is_empty(queue));
+
+	safe_queue_destroy(queue, NULL);
+}
+
+CTEST(safe_queue, when_nothingIsPushedInTime_then_timedPopReturnsNull)
+{
+	safe_queue_t *queue = new_safe_queue();
+
+	ASSERT_NULL(safe_queue_pop_timed(queue, 10));
+
+	safe_queue_push(queue, (void *)1);
+	ASSERT_EQUAL(1, (uintptr_t)safe_queue_pop_timed(queue, 10));
+
+	safe_queue_destroy(queue, NULL);
+}
+
+CTEST(safe_queue, when_aPushArrivesInTime_then_timedPopTakesIt)
+{
+	safe_queue_t *queue = new_safe_queue();
+	pthread_t producer;
+
+	pthread_create(&producer, NULL, push_later, queue);
+	ASSERT_EQUAL(3, (uintptr_t)safe_queue_pop_timed(queue, 2000));
+	pthread_join(producer, NULL);
+
+	ASSERT_EQUAL(1, (uintptr_t)safe_queue_pop(queue));
+	ASSERT_EQUAL(2, (uintptr_t)safe_queue_pop(queue));
+
+	safe_queue_destroy(queue, NULL);
+}
+
+CTEST(safe_queue, when_drained_then_upToMaxElementsAreTakenInOrder)
+{
+	safe_queue_t *queue = new_safe_queue();
+	void *elements[2];
+	pthread_t producer;
+
+	pthread_create(&producer, NULL, push_later, queue);
+	pthread_join(producer, NULL);
+
+	ASSERT_EQUAL(2, safe_queue_drain(queue, elements, 2));
+	ASSERT_EQUAL(3, (uintptr_t)elements[0]);
+	ASSERT_EQUAL(1, (uintptr_t)elements[1]);
+
+	ASSERT_EQUAL(1, safe_queue_drain(queue, elements, 2));
+	ASSERT_EQUAL(2, (uintptr_t)elements[0]);
+	ASSERT_TRUE(safe_queue_is_empty(queue));
+
+	safe_queue_destroy(queue, NULL);
+}
@@ -0,0 +1,127 @@
+/**
+ * @file thread_pool_test.c
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Thread pool unit tests
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <semaphore.h>
+
+#include "ctest.h"
+#include "thread_pool.h"
+#include "thread_manager.h"
+
+static sem_t done;
+static sem_t release;
+
+static void *count_task(void *data)
+{
+	__atomic_add_fetch((int *)data, 1, __ATOMIC_SEQ_CST);
+	sem_post(&done);
+	return NULL;
+}
+
+static void *blocking_task(void *data)
+{
+	(void)data;
+	sem_post(&done);
+	sem_wait(&release);
+	return NULL;
+}
+
+static thread_manager_t *ending_manager;
+static int ended = ERROR;
+
+static void *ending_task(void *data)
+{
+	(void)data;
+	// On a worker it returns instead of exiting the thread
+	ended = thread_manager_end_thread(ending_manager);
+	sem_post(&done);
+	return NULL;
+}
+
+/**
+ * @brief Waits until the pool has its workers idle again.
+ */
+static void wait_idle(thread_pool_t *pool)
+{
+	while (thread_pool_stats(pool).busy > 0)
+		usleep(1000);
+}
+
+CTEST(thread_pool, when_tasksAreSubmitted_then_workersAreReused)
+{
+	sem_init(&done, 0, 0);
+	thread_pool_t *pool = thread_pool_create(2);
+	ASSERT_NOT_NULL(pool);
+
+	int count = 0;
+
+	for (int i = 0; i < 50; i++)
+	{
+		// The worker may still be on its way back to the queue
+		while (!thread_pool_submit(pool, count_task, &count, NULL))
+			usleep(100);
+
+		sem_wait(&done);
+	}
+
+	wait_idle(pool);
+
+	thread_pool_stats_t stats = thread_pool_stats(pool);
+	ASSERT_EQUAL(50, count);
+	ASSERT_EQUAL(2, stats.workers);
+	ASSERT_EQUAL(50, stats.submitted);
+	ASSERT_EQUAL(50, stats.completed);
+
+	thread_pool_shutdown(pool);
+	sem_destroy(&done);
+}
+
+CTEST(thread_pool, when_everyWorkerIsBusy_then_tasksAreRefused)
+{
+	sem_init(&done, 0, 0);
+	sem_init(&release, 0, 0);
+	thread_pool_t *pool = thread_pool_create(1);
+
+	ASSERT_TRUE(thread_pool_submit(pool, blocking_task, NULL, NULL));
+	sem_wait(&done);
+
+	ASSERT_FALSE(thread_pool_submit(pool, blocking_task, NULL, NULL));
+	ASSERT_EQUAL(1, thread_pool_stats(pool).rejected);
+
+	// Shutting down with a busy worker leaves it the pool to free
+	thread_pool_shutdown(pool);
+	sem_post(&release);
+
+	sem_destroy(&done);
+}
+
+CTEST(thread_pool, when_managerHasAPool_then_endingTheThreadKeepsTheWorker)
+{
+	sem_init(&done, 0, 0);
+	thread_manager_t tm = new_thread_manager();
+	thread_manager_use_pool(&tm, 1);
+	ASSERT_NOT_NULL(tm.pool);
+
+	ending_manager = &tm;
+	thread_manager_launch(&tm, ending_task, NULL);
+	sem_wait(&done);
+	wait_idle(tm.pool);
+
+	thread_pool_stats_t stats = thread_pool_stats(tm.pool);
+	ASSERT_EQUAL(EXIT_SUCCESS, ended);
+	ASSERT_EQUAL(1, stats.workers);
+	ASSERT_EQUAL(1, stats.completed);
+	ASSERT_EQUAL(0, tm.size);
+
+	thread_manager_destroy(&tm);
+	sem_destroy(&done);
+}
@@ -0,0 +1,93 @@
+/**
+ * @file timer_wheel_test.c
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Timer wheel unit tests
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <unistd.h>
+#include <semaphore.h>
+
+#include "ctest.h"
+#include "timer_wheel.h"
+
+static sem_t fired;
+static int order[4];
+static int fired_count;
+
+static void record(void *data)
+{
+	order[fired_count++] = (int)(intptr_t)data;
+	sem_post(&fired);
+}
+
+static uint64_t elapsed_ms(struct timespec since)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - since.tv_sec) * 1000 + (now.tv_nsec - since.tv_nsec) / 1000000;
+}
+
+CTEST(timer_wheel, when_timersExpire_then_theyFireInDeadlineOrderAndNeverEarly)
+{
+	sem_init(&fired, 0, 0);
+	fired_count = 0;
+	timer_wheel_t *wheel = timer_wheel_create(1);
+
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	// The last one is more than a lap away
+	timer_wheel_schedule(wheel, 30, record, (void *)3);
+	timer_wheel_schedule(wheel, 10, record, (void *)1);
+	timer_wheel_schedule(wheel, 20, record, (void *)2);
+	timer_wheel_schedule(wheel, TIMER_WHEEL_SLOTS + 40, record, (void *)4);
+
+	for (int i = 0; i < 4; i++)
+		sem_wait(&fired);
+
+	ASSERT_TRUE(elapsed_ms(start) >= TIMER_WHEEL_SLOTS + 40);
+	ASSERT_EQUAL(1, order[0]);
+	ASSERT_EQUAL(2, order[1]);
+	ASSERT_EQUAL(3, order[2]);
+	ASSERT_EQUAL(4, order[3]);
+
+	timer_wheel_destroy(wheel);
+	sem_destroy(&fired);
+}
+
+CTEST(timer_wheel, when_timerIsCanceled_then_itNeverFires)
+{
+	sem_init(&fired, 0, 0);
+	fired_count = 0;
+	timer_wheel_t *wheel = timer_wheel_create(1);
+
+	timer_id_t canceled = timer_wheel_schedule(wheel, 10, record, (void *)1);
+	timer_wheel_schedule(wheel, 20, record, (void *)2);
+
+	void *data = NULL;
+	ASSERT_TRUE(timer_wheel_cancel(wheel, canceled, &data));
+	ASSERT_EQUAL(1, (int)(intptr_t)data);
+
+	// Twice, or once it fired, there is nothing to cancel
+	ASSERT_FALSE(timer_wheel_cancel(wheel, canceled, NULL));
+	ASSERT_FALSE(timer_wheel_cancel(wheel, TIMER_NONE, NULL));
+
+	sem_wait(&fired);
+	usleep(20 * 1000);
+
+	ASSERT_EQUAL(1, fired_count);
+	ASSERT_EQUAL(2, order[0]);
+
+	// The entry of the canceled timer is reused: its old id still does not match
+	timer_id_t reused = timer_wheel_schedule(wheel, 1000, record, (void *)3);
+	ASSERT_FALSE(timer_wheel_cancel(wheel, canceled, NULL));
+	ASSERT_TRUE(timer_wheel_cancel(wheel, reused, NULL));
+
+	timer_wheel_destroy(wheel);
+	sem_destroy(&fired);
+}
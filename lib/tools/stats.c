@@ -0,0 +1,292 @@
+/**
+ * @file stats.c
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Live metrics of a running system: asks the kernel, the CPU and the memory for a STATS snapshot.
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ * Usage: stats.out [seconds], from build/ as the modules, which reads their addresses from config/.
+ * Without seconds it prints a single report, with throughputs averaged since each module started; with them it
+ * keeps printing one every that many seconds, with throughputs over the last interval.
+ * The CPU is asked on its interrupt port: the dispatch one answers the PCBs to its last client.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "cfg.h"
+#include "conexion.h"
+#include "lib.h"
+
+// ============================================================================================================
+//                               ***** Definitions *****
+// ============================================================================================================
+
+/**
+ * @brief A module to ask, and what it answered last.
+ *
+ */
+typedef struct Module
+{
+	char *name;
+	char *ip;
+	char *port;
+	// The text of its last snapshot, NULL if it did not answer.
+	char *snapshot;
+	// The swap bytes of the previous snapshot, for the throughput of an interval.
+	uint64_t swapped_out;
+	uint64_t swapped_in;
+} module_t;
+
+enum
+{
+	KERNEL,
+	CPU,
+	MEMORY,
+	MODULES
+};
+
+// ============================================================================================================
+//                               ***** Reading *****
+// ============================================================================================================
+
+/**
+ * @brief Reads the address a module listens on from its config.
+ *
+ */
+static int read_address(module_t *module, char *(*port)(void))
+{
+	if (config_init(module->name) EQ ERROR)
+		return ERROR;
+
+	module->ip = strdup(ip());
+	module->port = strdup(port());
+	config_close();
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Asks a module for its snapshot, with its config loaded: the socket tuning and transport are read from it.
+ *
+ * @return the snapshot, to free, or NULL if it did not answer
+ */
+static char *query(module_t *module)
+{
+	if (config_init(module->name) EQ ERROR)
+		return NULL;
+
+	conexion_t connection = conexion_cliente_create(module->ip, module->port);
+	char *snapshot = NULL;
+
+	if (conexion_conectar(&connection) != ERROR && conexion_enviar_stream_vector(connection, STATS, NULL, 0) > 0)
+	{
+		wire_header_t header;
+		void *payload = conexion_recibir_frame(connection.socket, &header);
+
+		if (payload && header.opcode EQ STATS)
+			snapshot = strndup(payload, header.length);
+
+		conexion_liberar_stream(connection.socket, payload);
+	}
+
+	conexion_destroy(&connection);
+	config_close();
+
+	return snapshot;
+}
+
+/**
+ * @brief Finds the line of a metric in a snapshot.
+ *
+ * @return where its values begin, or NULL if it is not there
+ */
+static const char *find(const char *snapshot, const char *metric)
+{
+	size_t length = strlen(metric);
+
+	for (const char *line = snapshot; line && *line; line = strchr(line, '\n') ? strchr(line, '\n') + 1 : NULL)
+		if (strncmp(line, metric, length) EQ 0 && line[length] EQ ' ')
+			return line + length + 1;
+
+	return NULL;
+}
+
+/**
+ * @brief A value of a metric: its first one, or one of its fields (count, p99...).
+ *
+ */
+static uint64_t value(const char *snapshot, const char *metric, const char *field)
+{
+	const char *values = find(snapshot, metric);
+
+	if (values EQ NULL)
+		return 0;
+
+	if (field)
+	{
+		char key[32];
+		snprintf(key, sizeof(key), " %s=", field);
+
+		// Searched from the space before the first value, so that "p9=" never matches "p99="
+		const char *found = strstr(values - 1, key);
+		const char *end = strchr(values, '\n');
+
+		if (found EQ NULL || (end && found > end))
+			return 0;
+
+		values = found + strlen(key);
+	}
+
+	return strtoull(values, NULL, 10);
+}
+
+/**
+ * @brief The per-process values of a metric, as they are in the snapshot.
+ *
+ */
+static void print_processes(const char *snapshot, const char *metric)
+{
+	const char *values = find(snapshot, metric);
+	const char *first = values ? strchr(values, ' ') : NULL;
+	const char *end = values ? strchr(values, '\n') : NULL;
+
+	if (first && (end EQ NULL || first < end))
+		printf("%.*s", (int)(end ? end - first : (long)strlen(first)), first);
+	else
+		printf(" none");
+}
+
+static uint64_t uptime(const char *snapshot)
+{
+	const char *after = strstr(snapshot, " after ");
+
+	return after ? strtoull(after + strlen(" after "), NULL, 10) : 0;
+}
+
+// ============================================================================================================
+//                               ***** Writing *****
+// ============================================================================================================
+
+static double ratio(uint64_t part, uint64_t total)
+{
+	return total ? 100.0 * (double)part / (double)total : 0;
+}
+
+static void print_kernel(const char *s)
+{
+	printf("  queues        ready=%lu blocked=%lu suspended=%lu\n", (unsigned long)value(s, "kernel.ready_queue", NULL),
+		   (unsigned long)value(s, "kernel.blocked_queue", NULL), (unsigned long)value(s, "kernel.suspended_queue", NULL));
+	printf("  ready wait    p50=%luus p99=%luus max=%luus\n", (unsigned long)value(s, "kernel.dispatch_latency_us", "p50"),
+		   (unsigned long)value(s, "kernel.dispatch_latency_us", "p99"), (unsigned long)value(s, "kernel.dispatch_latency_us", "max"));
+	printf("  cpu bursts    %lu, p50=%lums | preemptions=%lu suspensions=%lu\n", (unsigned long)value(s, "kernel.cpu_burst_ms", "count"),
+		   (unsigned long)value(s, "kernel.cpu_burst_ms", "p50"), (unsigned long)value(s, "kernel.preemptions", NULL),
+		   (unsigned long)value(s, "kernel.suspensions", NULL));
+}
+
+static void print_cpu(const char *s)
+{
+	uint64_t hits = value(s, "cpu.tlb_hits", NULL), misses = value(s, "cpu.tlb_misses", NULL);
+
+	printf("  instructions  %lu\n", (unsigned long)value(s, "cpu.instructions", NULL));
+	printf("  tlb           hits=%lu misses=%lu hit ratio=%.1f%% replacements=%lu\n", (unsigned long)hits, (unsigned long)misses,
+		   ratio(hits, hits + misses), (unsigned long)value(s, "cpu.tlb_replacements", NULL));
+	printf("  memory rtt    p50=%luus p99=%luus max=%luus\n", (unsigned long)value(s, "cpu.memory_request_latency_us", "p50"),
+		   (unsigned long)value(s, "cpu.memory_request_latency_us", "p99"), (unsigned long)value(s, "cpu.memory_request_latency_us", "max"));
+}
+
+/**
+ * @brief Prints the memory report; swap throughput is over the interval if there was a previous snapshot.
+ *
+ */
+static void print_memory(module_t *memory, unsigned interval)
+{
+	const char *s = memory->snapshot;
+	uint64_t out = value(s, "memory.swap_out_bytes", NULL), in = value(s, "memory.swap_in_bytes", NULL);
+	uint64_t seconds = interval ? interval : uptime(s);
+
+	if (!interval)
+		memory->swapped_out = memory->swapped_in = 0;
+
+	printf("  accesses      reads=%lu writes=%lu\n", (unsigned long)value(s, "memory.reads", NULL), (unsigned long)value(s, "memory.writes", NULL));
+	printf("  frames        in use=%lu, by process:", (unsigned long)value(s, "memory.frames_in_use", NULL));
+	print_processes(s, "memory.process_frames");
+	printf("\n  page faults   %lu, by process:", (unsigned long)value(s, "memory.page_faults", NULL));
+	print_processes(s, "memory.page_faults");
+	printf("\n  swap          out=%lu B (%.1f KB/s) in=%lu B (%.1f KB/s) p99=%luus, %lu replacements\n",
+		   (unsigned long)out, seconds ? (double)(out - memory->swapped_out) / 1024.0 / (double)seconds : 0,
+		   (unsigned long)in, seconds ? (double)(in - memory->swapped_in) / 1024.0 / (double)seconds : 0,
+		   (unsigned long)value(s, "memory.swap_latency_us", "p99"), (unsigned long)value(s, "memory.frame_replacements", NULL));
+
+	memory->swapped_out = out;
+	memory->swapped_in = in;
+}
+
+// ============================================================================================================
+//                               ***** Main *****
+// ============================================================================================================
+
+int main(int argc, char *argv[])
+{
+	unsigned interval = argc > 1 ? (unsigned)atoi(argv[1]) : 0;
+	module_t modules[MODULES] = {[KERNEL] = {.name = "kernel"}, [CPU] = {.name = "cpu"}, [MEMORY] = {.name = "memory"}};
+
+	if (argc > 2 || (argc EQ 2 && interval EQ 0))
+	{
+		fprintf(stderr, "Usage: %s [seconds]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	if (read_address(&modules[KERNEL], puerto_escucha) EQ ERROR || read_address(&modules[CPU], puerto_escucha_interrupt) EQ ERROR || read_address(&modules[MEMORY], puerto_escucha) EQ ERROR)
+	{
+		fprintf(stderr, "Could not read the configs of the modules\n");
+		return EXIT_FAILURE;
+	}
+
+	for (bool first = true;; first = false)
+	{
+		for (int i = 0; i < MODULES; i++)
+		{
+			module_t *module = &modules[i];
+			free(module->snapshot);
+			module->snapshot = query(module);
+
+			printf("%-7s %s:%s", module->name, module->ip, module->port);
+
+			if (module->snapshot EQ NULL)
+			{
+				printf("  not answering\n");
+				continue;
+			}
+
+			printf("  up %lus\n", (unsigned long)uptime(module->snapshot));
+
+			if (i EQ KERNEL)
+				print_kernel(module->snapshot);
+			else if (i EQ CPU)
+				print_cpu(module->snapshot);
+			else
+				print_memory(module, first ? 0 : interval);
+		}
+
+		if (!interval)
+			break;
+
+		printf("\n");
+		fflush(stdout);
+		sleep(interval);
+	}
+
+	for (int i = 0; i < MODULES; i++)
+	{
+		free(modules[i].ip);
+		free(modules[i].port);
+		free(modules[i].snapshot);
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,237 @@
+/**
+ * @file trace_decode.c
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Offline decoder of the trace files: merges them in time order into Chrome trace JSON.
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ * Usage: trace_decode.out log/kernel.123.trace log/cpu.456.trace ... > run.json, then open run.json in
+ * chrome://tracing or Perfetto.
+ * Each PCB is a process there; CPU bursts and IO bursts are slices, everything else an instant.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "trace.h"
+
+// ============================================================================================================
+//                               ***** Definitions *****
+// ============================================================================================================
+
+// Events with no PCB go to a track per module, past any PID.
+#define MODULE_TRACK 100000u
+
+/**
+ * @brief How an event is drawn: a slice begins ('B') or ends ('E'), or it is an instant ('i').
+ *
+ */
+typedef struct EventFormat
+{
+	char phase;
+	// The slice it opens or closes, NULL for instants.
+	const char *slice;
+	// The names of its arguments, NULL if unused.
+	const char *args[2];
+} event_format_t;
+
+static const event_format_t FORMATS[TRACE_EVENTS] = {
+	[TRACE_PROCESS_ADMITTED] = {'i', NULL, {"page_table", "resumed"}},
+	[TRACE_PROCESS_DISPATCHED] = {'B', "RUNNING", {"estimation_ms", NULL}},
+	[TRACE_PROCESS_RETURNED] = {'E', "RUNNING", {"real_ms", "status"}},
+	[TRACE_PROCESS_PREEMPTED] = {'i', NULL, {"remaining_ms", NULL}},
+	[TRACE_PROCESS_BLOCKED] = {'i', NULL, {"io_ms", "estimation_ms"}},
+	[TRACE_PROCESS_UNBLOCKED] = {'i', NULL, {NULL, NULL}},
+	[TRACE_PROCESS_EXITED] = {'i', NULL, {"page_table", NULL}},
+	[TRACE_PROCESS_SUSPENDED] = {'i', NULL, {"max_blocked_ms", NULL}},
+	[TRACE_PROCESS_SUSPENDED_READY] = {'i', NULL, {NULL, NULL}},
+	[TRACE_IO_STARTED] = {'B', "IO", {"io_ms", "suspended"}},
+	[TRACE_IO_FINISHED] = {'E', "IO", {NULL, NULL}},
+	[TRACE_TLB_HIT] = {'i', NULL, {"page", "frame"}},
+	[TRACE_TLB_MISS] = {'i', NULL, {"page", NULL}},
+	[TRACE_TLB_REPLACED] = {'i', NULL, {"old_page", "new_page"}},
+	[TRACE_PAGE_FAULT] = {'i', NULL, {"table_lvl_2", "index"}},
+	[TRACE_FRAME_REPLACED] = {'i', NULL, {"replaced_frame", "new_frame"}},
+	[TRACE_PAGE_UNSWAPPED] = {'i', NULL, {"frame", "table_lvl_2"}},
+};
+
+/**
+ * @brief A record and the thread that wrote it.
+ *
+ */
+typedef struct Entry
+{
+	trace_record_t record;
+	uint32_t thread;
+} entry_t;
+
+typedef struct Entries
+{
+	entry_t *all;
+	size_t size;
+	size_t capacity;
+} entries_t;
+
+// ============================================================================================================
+//                               ***** Reading *****
+// ============================================================================================================
+
+static void add(entries_t *entries, trace_record_t *record, uint32_t thread)
+{
+	if (entries->size == entries->capacity)
+	{
+		entries->capacity = entries->capacity ? entries->capacity * 2 : 4096;
+		entries->all = realloc(entries->all, entries->capacity * sizeof(entry_t));
+	}
+
+	entries->all[entries->size++] = (entry_t){.record = *record, .thread = thread};
+}
+
+/**
+ * @brief Adds the records still in a file, oldest first.
+ *
+ * @return the records read, or -1 if it is not a trace file
+ */
+static long read_file(const char *path, entries_t *entries)
+{
+	FILE *file = fopen(path, "rb");
+	trace_header_t header;
+
+	if (file == NULL)
+	{
+		perror(path);
+		return -1;
+	}
+
+	if (fread(&header, sizeof(header), 1, file) != 1 || memcmp(header.magic, TRACE_MAGIC, sizeof(TRACE_MAGIC)) != 0 || header.version != TRACE_VERSION || header.record_size != sizeof(trace_record_t) || header.capacity == 0)
+	{
+		fprintf(stderr, "%s: not a version %d trace file\n", path, TRACE_VERSION);
+		fclose(file);
+		return -1;
+	}
+
+	trace_record_t *ring = malloc(header.capacity * sizeof(trace_record_t));
+	uint64_t slots = fread(ring, sizeof(trace_record_t), header.capacity, file);
+	uint64_t first = header.written > header.capacity ? header.written - header.capacity : 0;
+	long read = 0;
+
+	for (uint64_t n = first; n < header.written; n++)
+		if (n % header.capacity < slots)
+		{
+			add(entries, &ring[n % header.capacity], header.thread);
+			read++;
+		}
+
+	if (header.written > header.capacity)
+		fprintf(stderr, "%s: %lu older events were overwritten\n", path, (unsigned long)first);
+
+	free(ring);
+	fclose(file);
+
+	return read;
+}
+
+// ============================================================================================================
+//                               ***** Writing *****
+// ============================================================================================================
+
+static int by_time(const void *a, const void *b)
+{
+	uint64_t x = ((const entry_t *)a)->record.timestamp, y = ((const entry_t *)b)->record.timestamp;
+
+	return (x > y) - (x < y);
+}
+
+static uint32_t track_of(trace_record_t *record)
+{
+	return record->pid == UINT32_MAX ? MODULE_TRACK + record->module : record->pid;
+}
+
+static int by_track(const void *a, const void *b)
+{
+	uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+
+	return (x > y) - (x < y);
+}
+
+static void write_track_names(entries_t *entries)
+{
+	uint32_t *tracks = malloc(entries->size * sizeof(uint32_t));
+
+	for (size_t i = 0; i < entries->size; i++)
+		tracks[i] = track_of(&entries->all[i].record);
+
+	qsort(tracks, entries->size, sizeof(uint32_t), by_track);
+
+	for (size_t i = 0; i < entries->size; i++)
+	{
+		if (i > 0 && tracks[i] == tracks[i - 1])
+			continue;
+
+		if (tracks[i] >= MODULE_TRACK)
+			printf("{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":%u,\"args\":{\"name\":\"%s\"}},\n", tracks[i], trace_module_name(tracks[i] - MODULE_TRACK));
+		else
+			printf("{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":%u,\"args\":{\"name\":\"PCB #%u\"}},\n", tracks[i], tracks[i]);
+	}
+
+	free(tracks);
+}
+
+static void write_event(entry_t *entry, uint64_t origin, bool last)
+{
+	trace_record_t *record = &entry->record;
+	uint64_t since = record->timestamp - origin;
+	event_format_t format = record->event < TRACE_EVENTS ? FORMATS[record->event] : (event_format_t){'i', NULL, {"arg0", "arg1"}};
+
+	printf("{\"ph\":\"%c\",\"name\":\"%s\",\"pid\":%u,\"tid\":%u,\"ts\":%lu.%03lu,",
+		   format.phase, format.slice ? format.slice : trace_event_name(record->event), track_of(record), entry->thread,
+		   (unsigned long)(since / 1000), (unsigned long)(since % 1000));
+
+	if (format.phase == 'i')
+		printf("\"s\":\"t\",");
+
+	printf("\"args\":{\"module\":\"%s\",\"event\":\"%s\"", trace_module_name(record->module), trace_event_name(record->event));
+
+	for (int i = 0; i < 2; i++)
+		if (format.args[i])
+			printf(",\"%s\":%lu", format.args[i], (unsigned long)record->args[i]);
+
+	printf("}}%s\n", last ? "" : ",");
+}
+
+// ============================================================================================================
+//                               ***** Main *****
+// ============================================================================================================
+
+int main(int argc, char *argv[])
+{
+	if (argc < 2)
+	{
+		fprintf(stderr, "Usage: %s <file.trace>... > trace.json\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	entries_t entries = {0};
+
+	for (int i = 1; i < argc; i++)
+		read_file(argv[i], &entries);
+
+	// Every file is a single thread, already in order: sorting merges them
+	qsort(entries.all, entries.size, sizeof(entry_t), by_time);
+
+	printf("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	write_track_names(&entries);
+
+	for (size_t i = 0; i < entries.size; i++)
+		write_event(&entries.all[i], entries.all[0].record.timestamp, i + 1 == entries.size);
+
+	printf("]}\n");
+
+	fprintf(stderr, "%lu events from %d files\n", (unsigned long)entries.size, argc - 1);
+	free(entries.all);
+
+	return EXIT_SUCCESS;
+}
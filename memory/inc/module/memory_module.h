@@ -5,6 +5,7 @@
 #include "cfg.h"
 #include "operands.h"
 #include "safe_list.h"
+#include "read_mostly_list.h"
 #include "log.h"
 
 typedef struct Memory
@@ -30,11 +31,14 @@ typedef struct Memory
 	// Number of Frames in the memory
 	uint32_t no_of_frames;
 
-	// Tables of Level I
-	safe_list_t *tables_lvl_1;
+	// Serializes every change to the frames, the table entries and the swap files: read sections only look up
+	pthread_mutex_t frames_mutex;
 
-	// Tables of Level II
-	safe_list_t *tables_lvl_2;
+	// Tables of Level I (read by every CPU request, written only on process creation and deletion)
+	read_mostly_list_t *tables_lvl_1;
+
+	// Tables of Level II (likewise)
+	read_mostly_list_t *tables_lvl_2;
 
 	// Metadata for SWAP files
 	safe_list_t *swap_data;
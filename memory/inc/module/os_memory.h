@@ -14,6 +14,34 @@
 #include "memory_module.h"
 #include "page_table.h"
 
+/**
+ * @brief A read section over both page table lists: see tables_read_begin.
+ *
+ */
+typedef struct TablesRead
+{
+	uint32_t lvl_1;
+	uint32_t lvl_2;
+} tables_read_t;
+
+/**
+ * @brief Starts reading the page tables: a process deleted meanwhile frees its tables only after
+ * tables_read_end. Wraps every request that keeps a table it looked up.
+ * Only for looking up: changing a frame or a table entry takes memory->frames_mutex as well.
+ *
+ * @param memory the Memory Module Instance
+ * @return the section, to end it
+ */
+tables_read_t tables_read_begin(memory_t *memory);
+
+/**
+ * @brief Ends a read section of the page tables.
+ *
+ * @param memory the Memory Module Instance
+ * @param read what tables_read_begin returned
+ */
+void tables_read_end(memory_t *memory, tables_read_t read);
+
 /**
  * @brief Create a new process object
  *
@@ -43,10 +71,11 @@ uint32_t find_free_frame(memory_t *memory);
  *
  * @param memory the Memory Module Instance
  * @param index	the index of the table
+ * @param row the entry of the page the frame is for
  * @param frame the frame to create
- * @return the index at wich was created
+ * @return the index at wich was created, or UINT32_MAX if the entry already had a frame
  */
-uint32_t create_frame_for_table(memory_t *memory, uint32_t index, uint32_t frame);
+uint32_t create_frame_for_table(memory_t *memory, uint32_t index, uint32_t row, uint32_t frame);
 
 /**
  * @brief Writes in the Main Memory
@@ -78,14 +78,31 @@ create_big_table(void *memory, uint32_t table_index);
 #define LOG_TABLE_HEADER() LOG_DEBUG("\tINDEX\t|Frame\t|U\t|P\t|M\t|")
 
 /**
- * @brief Logs a Big Table
+ * @brief Logs a Big Table, only when logging DEBUG: otherwise the loop is not even compiled or run
  *
  */
-#define LOG_TABLE(rows, table)              \
-	{                                       \
-		LOG_TABLE_HEADER();                 \
-		for (uint32_t i = 0; i < rows; i++) \
-			LOG_ENTRY(table, i);            \
+#define LOG_TABLE(rows, table)                  \
+	if (LOG_ENABLED(DEBUG))                     \
+	{                                           \
+		LOG_TABLE_HEADER();                     \
+		for (uint32_t i = 0; i < rows; i++)     \
+			LOG_ENTRY(table, i);                \
 	}
 
+/**
+ * @brief Logs every row of a table, joining its LEVEL II tables first; call it through PRINT_TABLE
+ *
+ * @param memory_ref the module
+ * @param table_index the LEVEL I table
+ */
 void print_table(void *memory_ref, uint32_t table_index);
+
+/**
+ * @brief Prints a table only when logging DEBUG, so that no big table is built to be discarded
+ *
+ */
+#define PRINT_TABLE(memory_ref, table_index)  \
+	if (LOG_ENABLED(DEBUG))                   \
+	{                                         \
+		print_table(memory_ref, table_index); \
+	}
@@ -49,3 +49,17 @@ void cpu_controller_send_frame(int fd);
  * @param fd
  */
 void cpu_controller_send_page_second_level(int fd);
+
+/**
+ * @brief Traduce una direccion logica recorriendo ambas tablas y envia a cpu el frame
+ *
+ * @param fd
+ */
+void cpu_controller_translate(int fd);
+
+/**
+ * @brief Resuelve un lote de accesos (MEMORY_BATCH) y envia a cpu sus resultados
+ *
+ * @param fd
+ */
+void cpu_controller_batch(int fd);
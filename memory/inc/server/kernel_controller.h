@@ -11,6 +11,15 @@
 
 #pragma once
 
+#include "thread_manager.h"
+
+/**
+ * @brief Starts the swap worker, which does the swap requests of the Kernel in order and off the serving threads.
+ *
+ * @param tm the thread manager to launch it with
+ */
+void kernel_controller_init(thread_manager_t *tm);
+
 /**
  * @brief Construct a new kernel controller swap object
  *
@@ -1,3 +1,12 @@
 #pragma once
 
+/**
+ * @brief Handles one request of a client (CPU or Kernel).
+ *
+ * @param fd the client socket
+ * @param session unused, memory clients keep no state
+ * @return the opcode handled, or <= 0 if the client disconnected
+ */
+int handle_request(int fd, void **session);
+
 void *routine(void *fd);
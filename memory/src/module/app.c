@@ -18,10 +18,14 @@
 #include "lib.h"
 #include "log.h"
 #include "cfg.h"
+#include "trace.h"
+#include "metrics.h"
 #include "thread_manager.h"
+#include "reactor.h"
 #include "memory_module.h"
 #include "memory_routines.h"
 #include "signals.h"
+#include "kernel_controller.h"
 #include "algorithms.h"
 
 // ============================================================================================================
@@ -55,11 +59,12 @@ static int on_init_memory(memory_t *memory)
 	// Init App
 	memory->server = servidor_create(ip(), puerto_escucha());
 	memory->tm = new_thread_manager();
+	kernel_controller_init(&memory->tm);
 
 	// Init Memory
 	memory->main_memory = malloc(tam_memoria());
-	memory->tables_lvl_1 = new_safe_list();
-	memory->tables_lvl_2 = new_safe_list();
+	memory->tables_lvl_1 = new_read_mostly_list();
+	memory->tables_lvl_2 = new_read_mostly_list();
 	memory->swap_data = new_safe_list();
 
 	// Init Frames
@@ -68,6 +73,7 @@ static int on_init_memory(memory_t *memory)
 	memory->max_rows = (uint32_t)entradas_por_tabla();
 	memory->no_of_frames = (uint32_t)tam_memoria() / (uint32_t)tam_pagina();
 	memory->frames = malloc(sizeof(bool) * memory->no_of_frames);
+	pthread_mutex_init(&memory->frames_mutex, NULL);
 	for (uint32_t i = 0; i < memory->no_of_frames; i++)
 	{
 		memory->frames[i] = false;
@@ -81,9 +87,10 @@ static void on_delete_memory(memory_t *memory)
 	servidor_destroy(&(memory->server));
 	thread_manager_destroy(&(memory->tm));
 	free(memory->main_memory);
-	safe_list_fast_destroy(memory->tables_lvl_1);
-	safe_list_fast_destroy(memory->tables_lvl_2);
+	read_mostly_list_destroy(memory->tables_lvl_1, free);
+	read_mostly_list_destroy(memory->tables_lvl_2, free);
 	safe_list_fast_destroy(memory->swap_data);
+	pthread_mutex_destroy(&memory->frames_mutex);
 }
 
 // ============================================================================================================
@@ -106,6 +113,11 @@ int on_init(memory_t *memory)
 
 	LOG_DEBUG("Configurations loaded.");
 
+	// Events are only recorded when TRAZA is set
+	trace_init(MODULE_NAME);
+	// Snapshots on SIGUSR1 and at exit
+	metrics_init(MODULE_NAME);
+
 	if (on_init_memory(memory) EQ EXIT_SUCCESS)
 	{
 		LOG_DEBUG("Memory initializated");
@@ -154,8 +166,8 @@ int serve(memory_t *memory)
 
 	LOG_DEBUG("Server listenning. Awaiting for connections.");
 
-	for (;;)
-		servidor_run(&(memory->server), routine);
+	if (reactores() > 0)
+		return servidor_run_reactor(&(memory->server), reactores(), handle_request);
 
-	return EXIT_SUCCESS;
+	return servidor_run_acceptors(&(memory->server), aceptadores(), routine);
 }
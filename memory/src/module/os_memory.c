@@ -17,6 +17,7 @@
 #include "page_table.h"
 #include "log.h"
 #include "swap.h"
+#include "metrics.h"
 
 // ============================================================================================================
 //                                   ***** Declarations  *****
@@ -42,14 +43,6 @@ uint32_t *create_lvl2_tables(memory_t *memory, uint32_t rows);
  */
 uint32_t create_table(memory_t *memory, uint32_t rows, uint32_t *ids);
 
-/**
- * @brief Finds the next available ID
- *
- * @param list the list of tables
- * @return an Id
- */
-uint32_t find_id(safe_list_t *safe_list, bool should_replace);
-
 /**
  * @brief Deletes a Process Related Tables
  *
@@ -70,6 +63,20 @@ void delete_level_2_table(memory_t *memory, uint32_t table_id);
 //                                   ***** Public Functions  *****
 // ============================================================================================================
 
+tables_read_t tables_read_begin(memory_t *memory)
+{
+	return (tables_read_t){
+		.lvl_1 = read_mostly_list_enter(memory->tables_lvl_1),
+		.lvl_2 = read_mostly_list_enter(memory->tables_lvl_2),
+	};
+}
+
+void tables_read_end(memory_t *memory, tables_read_t read)
+{
+	read_mostly_list_leave(memory->tables_lvl_2, read.lvl_2);
+	read_mostly_list_leave(memory->tables_lvl_1, read.lvl_1);
+}
+
 uint32_t create_new_process(memory_t *memory)
 {
 	return create_table(memory, memory->max_rows, create_lvl2_tables(memory, memory->max_rows));
@@ -80,19 +87,17 @@ void delete_process(memory_t *memory, uint32_t table_id)
 	delete_related_tables(memory, table_id);
 }
 
-uint32_t create_frame_for_table(memory_t *memory, uint32_t table_index, uint32_t frame)
+uint32_t create_frame_for_table(memory_t *memory, uint32_t table_index, uint32_t row, uint32_t frame)
 {
-	page_table_lvl_2_t *table = safe_list_get(memory->tables_lvl_2, table_index);
+	page_table_lvl_2_t *table = read_mostly_list_get(memory->tables_lvl_2, table_index);
 
-	for (uint32_t i = 0; i < memory->max_rows; i++)
+	// The entry of the page itself: any other free one would hand the frame to another page
+	if (table && row < memory->max_rows && table[row].frame == INVALID_FRAME)
 	{
-		if (table[i].frame == INVALID_FRAME)
-		{
-			table[i].present = true;
-			table[i].frame = frame;
-			table[i].use = true;
-			return i;
-		}
+		table[row].present = true;
+		table[row].frame = frame;
+		table[row].use = true;
+		return row;
 	}
 
 	return UINT32_MAX;
@@ -105,6 +110,7 @@ uint32_t find_free_frame(memory_t *memory)
 		if (memory->frames[i] == false)
 		{
 			memory->frames[i] = true;
+			metrics_gauge_add(METRIC_FRAMES_IN_USE, 1);
 			return i;
 		}
 	}
@@ -117,6 +123,7 @@ uint32_t *write_in_memory(memory_t *memory, uint32_t physical_address, uint32_t
 	uint32_t wait_time = (uint32_t)retardo_memoria() * 1000;
 	usleep(wait_time);
 	memcpy(memory->main_memory + physical_address, &value, sizeof(value));
+	metrics_add(METRIC_MEMORY_WRITES, 1);
 	return (uint32_t *)memory->main_memory + physical_address;
 }
 
@@ -126,17 +133,18 @@ uint32_t read_from_memory(memory_t *memory, uint32_t physical_address)
 	uint32_t wait_time = (uint32_t)retardo_memoria() * 1000;
 	usleep(wait_time);
 	memcpy(&value, memory->main_memory + physical_address, sizeof(value));
+	metrics_add(METRIC_MEMORY_READS, 1);
 	return value;
 }
 
 uint32_t
 get_table_lvl2_number(memory_t *memory, uint32_t frame)
 {
-	uint32_t size = (uint32_t)list_size(memory->tables_lvl_2->_list);
+	uint32_t size = read_mostly_list_size(memory->tables_lvl_2);
 
 	for (uint32_t i = 0; i < size; i++)
 	{
-		page_table_lvl_2_t *table = safe_list_get(memory->tables_lvl_2, i);
+		page_table_lvl_2_t *table = read_mostly_list_get(memory->tables_lvl_2, i);
 
 		if (table)
 			for (uint32_t j = 0; j < memory->max_rows; j++)
@@ -151,9 +159,9 @@ page_table_lvl_2_t *
 get_frame_ref(memory_t *memory, uint32_t frame)
 {
 	uint32_t id = get_table_lvl2_number(memory, frame);
-	page_table_lvl_2_t *table = safe_list_get(memory->tables_lvl_2, id);
+	page_table_lvl_2_t *table = read_mostly_list_get(memory->tables_lvl_2, id);
 
-	for (uint32_t i = 0; i < memory->max_rows; i++)
+	for (uint32_t i = 0; table && i < memory->max_rows; i++)
 	{
 		if (table[i].frame == frame)
 		{
@@ -243,17 +251,8 @@ uint32_t *create_lvl2_tables(memory_t *memory, uint32_t rows)
 	// Number of rows of the Level I Table (Equal to rows of Second Level Table)
 	for (uint32_t i = 0; i < rows; i++)
 	{
-		id = find_id(memory->tables_lvl_2, false);
 		table = new_page_table_lvl2(rows);
-
-		if ((uint32_t)safe_list_size(memory->tables_lvl_2) > id)
-		{
-			safe_list_replace(memory->tables_lvl_2, id, table);
-		}
-		else
-		{
-			safe_list_add_in_index(memory->tables_lvl_2, id, table);
-		}
+		id = read_mostly_list_put(memory->tables_lvl_2, table, false);
 
 		ids[i] = id;
 	}
@@ -263,7 +262,6 @@ uint32_t *create_lvl2_tables(memory_t *memory, uint32_t rows)
 
 uint32_t create_table(memory_t *memory, uint32_t rows, uint32_t *ids)
 {
-	uint32_t id = find_id(memory->tables_lvl_1, true);
 	page_table_lvl_1_t *table = new_page_table(rows);
 
 	for (uint32_t i = 0; i < rows; i++)
@@ -273,38 +271,13 @@ uint32_t create_table(memory_t *memory, uint32_t rows, uint32_t *ids)
 
 	free(ids);
 
-	if ((uint32_t)safe_list_size(memory->tables_lvl_1) > id)
-	{
-		safe_list_replace(memory->tables_lvl_1, id, table);
-	}
-	else
-	{
-		safe_list_add_in_index(memory->tables_lvl_1, id, table);
-	}
-
-	return id;
-}
-
-uint32_t find_id(safe_list_t *safe_list, bool should_replace)
-{
-	if (list_is_empty(safe_list->_list))
-		return 0;
-
-	if (should_replace)
-		for (uint32_t i = 0; i < (uint32_t)list_size(safe_list->_list); i++)
-		{
-			page_table_lvl_1_t *table = safe_list_get(safe_list, i);
-
-			if (table == NULL)
-				return i;
-		}
-
-	return list_size(safe_list->_list);
+	// Finding a free ID and taking it is atomic: two processes created at once never share one
+	return read_mostly_list_put(memory->tables_lvl_1, table, true);
 }
 
 void delete_related_tables(memory_t *memory, uint32_t table_id)
 {
-	page_table_lvl_1_t *table = list_get(memory->tables_lvl_1->_list, table_id);
+	page_table_lvl_1_t *table = read_mostly_list_get(memory->tables_lvl_1, table_id);
 
 	if (table == NULL)
 	{
@@ -313,7 +286,7 @@ void delete_related_tables(memory_t *memory, uint32_t table_id)
 	}
 
 	LOG_WARNING("\t-\tDeleting\tTable\t#%d\t-\t", table_id);
-	print_table(memory, table_id);
+	PRINT_TABLE(memory, table_id);
 
 	// Iterate over a LVL 1 Table
 	for (uint32_t i = 0; i < memory->max_rows; i++)
@@ -324,18 +297,23 @@ void delete_related_tables(memory_t *memory, uint32_t table_id)
 		LOG_TRACE("[Memory] :=> Table#%d[%d] Deleted", table_id, table[i].second_page);
 	}
 
-	// Replace with NULL in the list.
-	free(table);
-	list_replace(memory->tables_lvl_1->_list, table_id, NULL);
+	// Unreachable first, freed once no reader can still hold it
+	free(read_mostly_list_take(memory->tables_lvl_1, table_id));
 }
 
 void delete_level_2_table(memory_t *memory, uint32_t table_id)
 {
-	// Destroy a Second page
-	page_table_lvl_2_t *lvl2_table = list_get(memory->tables_lvl_2->_list, table_id);
-
 	LOG_TRACE("[Memory] :=> Deleting Table#%d (LVL2)", table_id);
 
+	// Unreachable first, freed once no reader can still hold it
+	page_table_lvl_2_t *lvl2_table = read_mostly_list_take(memory->tables_lvl_2, table_id);
+
+	if (lvl2_table == NULL)
+		return;
+
+	// Unreachable by now, but its frames are still shared with every other process
+	pthread_mutex_lock(&memory->frames_mutex);
+
 	// Iterate over a LVL 2 Table
 	for (uint32_t j = 0; j < memory->max_rows && j < memory->max_frames; j++)
 	{
@@ -347,12 +325,17 @@ void delete_level_2_table(memory_t *memory, uint32_t table_id)
 		}
 	}
 
+	pthread_mutex_unlock(&memory->frames_mutex);
 	free(lvl2_table);
-	list_replace(memory->tables_lvl_2->_list, table_id, NULL);
 }
 
 void delete_frame(memory_t *memory, uint32_t id)
 {
 	if (id <= memory->no_of_frames)
+	{
+		if (memory->frames[id])
+			metrics_gauge_add(METRIC_FRAMES_IN_USE, -1);
+
 		memory->frames[id] = false;
+	}
 }
@@ -49,7 +49,7 @@ create_big_table(void *memory_ref, uint32_t table_index)
 {
 	memory_t *memory = (memory_t *)memory_ref;
 
-	page_table_lvl_1_t *pt_1 = safe_list_get(memory->tables_lvl_1, table_index);
+	page_table_lvl_1_t *pt_1 = read_mostly_list_get(memory->tables_lvl_1, table_index);
 
 	if (pt_1 == NULL)
 	{
@@ -63,7 +63,7 @@ create_big_table(void *memory_ref, uint32_t table_index)
 
 	for (size_t i = 0, k = 0; i < memory->max_rows && k < total_rows; i++)
 	{
-		page_table_lvl_2_t *pt_2 = safe_list_get(memory->tables_lvl_2, pt_1[i].second_page);
+		page_table_lvl_2_t *pt_2 = read_mostly_list_get(memory->tables_lvl_2, pt_1[i].second_page);
 
 		for (size_t j = 0; j < memory->max_rows; j++, k++)
 		{
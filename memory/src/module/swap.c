@@ -13,6 +13,7 @@
 #include "os_memory.h"
 #include "fs.h"
 #include "cfg.h"
+#include "metrics.h"
 #include <time.h>
 #include <stdlib.h>
 #include <sys/stat.h>
@@ -36,6 +37,7 @@ void swap_frame(uint32_t frame, void *file_address, uint32_t *offset);
 
 void swap_frame_for_pcb(uint32_t pid, uint32_t frame)
 {
+	uint64_t start = metrics_now();
 	swap_data_t *swap_data = get_swap_data_for_pcb(&g_memory, pid);
 
 	if (swap_data == NULL)
@@ -72,12 +74,15 @@ void swap_frame_for_pcb(uint32_t pid, uint32_t frame)
 	close(fd);
 	page_table_lvl_2_t *frame_ref = get_frame_ref(&g_memory, frame);
 	frame_ref->present = false;
+	// The disk time, without the simulated delay
+	metrics_record(METRIC_SWAP_LATENCY, metrics_now() - start);
 	usleep(retardo_swap() * 1000);
 }
 
 void swap_pcb(void *pcb_ref)
 {
 
+	uint64_t start = metrics_now();
 	pcb_t *pcb = pcb_from_stream(pcb_ref);
 	free(pcb_ref);
 
@@ -129,6 +134,7 @@ void swap_pcb(void *pcb_ref)
 	free(big_table);
 	close(fd);
 	pcb_destroy(pcb);
+	metrics_record(METRIC_SWAP_LATENCY, metrics_now() - start);
 	usleep(retardo_swap() * 1000);
 }
 
@@ -152,6 +158,7 @@ void swap_frame(uint32_t frame, void *file_address, uint32_t *offset)
 	size_t swapped_frame_size = sizeof(uint32_t) + frame_size;
 
 	void *frame_stream = malloc(swapped_frame_size);
+	metrics_add(METRIC_SWAP_OUT_BYTES, swapped_frame_size);
 	memcpy(frame_stream, &frame, sizeof(uint32_t));
 	memcpy(frame_stream + sizeof(uint32_t), get_frame_address(&g_memory, frame), frame_size);
 	memcpy(file_address + *offset, frame_stream, swapped_frame_size);
@@ -161,7 +168,7 @@ void swap_frame(uint32_t frame, void *file_address, uint32_t *offset)
 
 void unswap_frame_for_pcb(uint32_t pid, uint32_t frame)
 {
-
+	uint64_t start = metrics_now();
 	int fd = open_file(pid);
 
 	if (fd == -1)
@@ -193,6 +200,7 @@ void unswap_frame_for_pcb(uint32_t pid, uint32_t frame)
 			void *frame_data = malloc(page_size);
 			memcpy(frame_data, file_address + i + sizeof(uint32_t), sizeof(page_size));
 			memcpy(g_memory.main_memory + (page_size * frame), frame_data, page_size);
+			metrics_add(METRIC_SWAP_IN_BYTES, swap_entry);
 			free(frame_data);
 			replace_index = i;
 			break;
@@ -214,11 +222,13 @@ void unswap_frame_for_pcb(uint32_t pid, uint32_t frame)
 	close(fd);
 	page_table_lvl_2_t *frame_ref = get_frame_ref(&g_memory, frame);
 	frame_ref->present = true;
+	metrics_record(METRIC_SWAP_LATENCY, metrics_now() - start);
 	usleep(retardo_swap() * 1000);
 }
 
 void unswap_pcb(uint32_t pid)
 {
+	uint64_t start = metrics_now();
 	swap_data_t *swap_data = get_swap_data_for_pcb(&g_memory, pid);
 
 	int fd = open_file(pid);
@@ -253,6 +263,7 @@ void unswap_pcb(uint32_t pid)
 			void *frame_data = malloc(page_size);
 			memcpy(frame_data, file_address + i + sizeof(uint32_t), sizeof(page_size));
 			memcpy(g_memory.main_memory + (page_size * frame_ref->frame), frame_data, page_size);
+			metrics_add(METRIC_SWAP_IN_BYTES, swap_entry);
 			free(frame_data);
 		}
 		else
@@ -264,5 +275,6 @@ void unswap_pcb(uint32_t pid)
 	msync(file_address, swap_data->size, MS_SYNC);
 	munmap(file_address, swap_data->size);
 	close(fd);
+	metrics_record(METRIC_SWAP_LATENCY, metrics_now() - start);
 	usleep(retardo_swap() * 1000);
 }
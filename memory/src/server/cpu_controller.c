@@ -15,6 +15,7 @@
 #include "server.h"
 #include "log.h"
 #include "operands.h"
+#include "memory_access.h"
 #include "memory_module.h"
 #include <time.h>
 #include <math.h>
@@ -22,6 +23,8 @@
 #include "os_memory.h"
 #include "swap.h"
 #include "page_table.h"
+#include "trace.h"
+#include "metrics.h"
 
 extern memory_t g_memory;
 
@@ -47,6 +50,44 @@ receive_physical_address(int socket);
 operands_t
 receive_operands(int socket, uint32_t *pid);
 
+/**
+ * @brief Reads the value stored at a physical address.
+ *
+ * @param physical_address the address
+ * @return the value or UINT32_MAX if the frame belongs to no table
+ */
+uint32_t
+read_physical_address(uint32_t physical_address);
+
+/**
+ * @brief Writes a value at a physical address, marking its frame as modified.
+ *
+ * @param physical_address the address
+ * @param value the value
+ * @return false if the frame belongs to no table
+ */
+bool write_physical_address(uint32_t physical_address, uint32_t value);
+
+/**
+ * @brief Walks both page table levels locally.
+ *
+ * @param pid the process
+ * @param id_table_1 its first level table
+ * @param page_number the page to translate
+ * @return the frame or UINT32_MAX
+ */
+uint32_t
+walk_page_tables(uint32_t pid, uint32_t id_table_1, uint32_t page_number);
+
+/**
+ * @brief Performs one access of a batch: translates it if needed, then reads or writes.
+ *
+ * @param access the access
+ * @return its result
+ */
+memory_access_result_t
+access_memory(memory_access_t *access);
+
 /**
  * @brief Obtains the value of a position
  *
@@ -88,26 +129,9 @@ void cpu_controller_read(int socket)
 	uint32_t physical_address = operands.op1;
 	LOG_TRACE("[CPU-CONTROLLER] :=> Reading Physical Address <%d>.", physical_address);
 
-	uint32_t frame = get_frame(physical_address);
-	uint32_t table_number_2 = get_table_lvl2_number(&g_memory, frame);
-	uint32_t value = UINT32_MAX;
-
-	// Frame DOES NOT EXIST
-	if (table_number_2 == UINT32_MAX)
-	{
-		LOG_ERROR("[CPU-CONTROLLER] :=> Invalid Frame <%d> not found in any table", frame);
-	}
-	else
-	{
-		page_table_lvl_2_t *frame_ref = get_frame_ref(&g_memory, frame);
-
-		if (frame_ref)
-			frame_ref->modified = false;
-
-		value = read_from_memory(&g_memory, physical_address);
-	}
-
-	LOG_INFO("[Memory] :=> Read Value <%d> from <%d>", value, physical_address);
+	tables_read_t tables = tables_read_begin(&g_memory);
+	uint32_t value = read_physical_address(physical_address);
+	tables_read_end(&g_memory, tables);
 
 	ssize_t bytes_sent = servidor_enviar_stream(RD, socket, &value, sizeof(value));
 
@@ -130,23 +154,9 @@ void cpu_controller_write(int socket)
 	uint32_t value = operands.op2;
 	LOG_TRACE("[CPU-CONTROLLER] :=> Writting into the Physical Address <%d>, Value <%d>", physical_address, value);
 
-	uint32_t frame = get_frame(physical_address);
-	LOG_DEBUG("[CPU-CONTROLLER] :=> Frame <%d>", frame);
-	uint32_t table_number_2 = get_table_lvl2_number(&g_memory, frame);
-
-	// Frame DOES NOT EXIST
-	if (table_number_2 == UINT32_MAX)
-	{
-		LOG_ERROR("[CPU-CONTROLLER] :=> Invalid Frame <%d> not found in any table", frame);
-		return;
-	}
-	page_table_lvl_2_t *frame_ref = get_frame_ref(&g_memory, frame);
-
-	if (frame_ref)
-		frame_ref->modified = true;
-
-	write_in_memory(&g_memory, physical_address, value);
-	LOG_INFO("[Memory] :=> Value <%d> written into Physical Address <%d> (Frame #%d)", value, physical_address, frame);
+	tables_read_t tables = tables_read_begin(&g_memory);
+	write_physical_address(physical_address, value);
+	tables_read_end(&g_memory, tables);
 
 	/*
 	Frame_size = 256
@@ -287,10 +297,14 @@ void cpu_controller_send_frame(int fd)
 	{
 		memcpy(&pid, stream, sizeof(pid));
 		operands_t values = operandos_from_stream(stream + sizeof(pid));
+		tables_read_t tables = tables_read_begin(&g_memory);
 		frame = obtain_frame(values.op1, values.op2, pid);
+		tables_read_end(&g_memory, tables);
 		LOG_TRACE("[CPU-CONTROLLER] :=> Frame obtained #%d", frame);
 	}
 
+	servidor_liberar_stream(fd, stream);
+
 	ssize_t bytes_sent = fd_send_value(fd, &frame, sizeof(frame));
 
 	if (bytes_sent > 0)
@@ -319,13 +333,17 @@ void cpu_controller_send_page_second_level(int fd)
 	{
 		operands_t values = operandos_from_stream(stream);
 		LOG_TRACE("[CPU-CONTROLLER] :=> Requested Table#%d[%d]...", values.op1, values.op2);
-		print_table(&g_memory, values.op1);
+		tables_read_t tables = tables_read_begin(&g_memory);
+		PRINT_TABLE(&g_memory, values.op1);
 		// If x >= 4 ? 3 : X;
 		uint32_t t1_sub = values.op2 >= g_memory.max_rows ? g_memory.max_rows - 1 : values.op2;
 		entry_second_level = obtain_second_page(values.op1, t1_sub);
+		tables_read_end(&g_memory, tables);
 		LOG_INFO("[CPU-CONTROLLER] :=> Table#%d[%d]= #%d", values.op1, t1_sub, entry_second_level);
 	}
 
+	servidor_liberar_stream(fd, stream);
+
 	ssize_t bytes_sent = fd_send_value(fd, &entry_second_level, sizeof(entry_second_level));
 	if (bytes_sent > 0)
 	{
@@ -337,6 +355,82 @@ void cpu_controller_send_page_second_level(int fd)
 	}
 }
 
+void cpu_controller_translate(int fd)
+{
+	ssize_t bytes_read = -1;
+	void *stream = servidor_recibir_stream(fd, &bytes_read);
+	uint32_t frame = UINT32_MAX;
+
+	if (bytes_read < (ssize_t)(3 * sizeof(uint32_t)))
+	{
+		LOG_ERROR("[CPU-CONTROLLER] :=> Could not read stream");
+	}
+	else
+	{
+		// [PID][TABLA LVL1][DIRECCION LOGICA]
+		uint32_t pid = UINT32_MAX;
+		memcpy(&pid, stream, sizeof(pid));
+		operands_t values = operandos_from_stream(stream + sizeof(pid));
+		LOG_TRACE("[CPU-CONTROLLER] :=> Translating Logical Address <%d> of Table#%d...", values.op2, values.op1);
+		tables_read_t tables = tables_read_begin(&g_memory);
+		frame = walk_page_tables(pid, values.op1, values.op2 / tam_pagina());
+		tables_read_end(&g_memory, tables);
+	}
+
+	servidor_liberar_stream(fd, stream);
+
+	ssize_t bytes_sent = fd_send_value(fd, &frame, sizeof(frame));
+
+	if (bytes_sent > 0)
+	{
+		LOG_DEBUG("[CPU-CONTROLLER] :=> Frame sent [%ld bytes]", bytes_sent);
+	}
+	else
+	{
+		LOG_ERROR("[CPU-CONTROLLER] :=> Sent nothing - THIS SHOULD NEVER HAPPEN");
+	}
+}
+
+void cpu_controller_batch(int fd)
+{
+	ssize_t bytes_read = -1;
+	void *stream = servidor_recibir_stream(fd, &bytes_read);
+	// [ACCESOS...]: the request id is echoed so that pipelined requests can be matched.
+	uint32_t id = servidor_id_recibido(fd);
+	int count = stream && bytes_read > 0 ? bytes_read / sizeof(memory_access_t) : 0;
+
+	memory_access_t *accesses = stream;
+	LOG_TRACE("[CPU-CONTROLLER] :=> Received batch #%d of %d accesses", id, count);
+
+	memory_access_result_t *results = malloc(count * sizeof(memory_access_result_t));
+
+	// In order: a later access may read what an earlier one wrote.
+	tables_read_t tables = tables_read_begin(&g_memory);
+
+	for (int i = 0; i < count; i++)
+		results[i] = access_memory(&accesses[i]);
+
+	tables_read_end(&g_memory, tables);
+
+	servidor_liberar_stream(fd, stream);
+
+	// [RESULTADOS...]
+	struct iovec segments[] = {{.iov_base = results, .iov_len = count * sizeof(memory_access_result_t)}};
+
+	ssize_t bytes_sent = enviar_frame(MEMORY_BATCH, id, segments, 1, fd);
+
+	if (bytes_sent > 0)
+	{
+		LOG_DEBUG("[CPU-CONTROLLER] :=> Batch #%d results sent [%ld bytes]", id, bytes_sent);
+	}
+	else
+	{
+		LOG_ERROR("[CPU-CONTROLLER] :=> Batch results could not be sent.");
+	}
+
+	free(results);
+}
+
 // ============================================================================================================
 //                                   ***** Private Functions  *****
 // ============================================================================================================
@@ -347,7 +441,7 @@ receive_physical_address(int socket)
 	ssize_t bytes_read = -1;
 	void *stream = servidor_recibir_stream(socket, &bytes_read);
 	uint32_t memory_position = *(uint32_t *)stream;
-	free(stream);
+	servidor_liberar_stream(socket, stream);
 	return memory_position;
 }
 
@@ -360,10 +454,125 @@ receive_operands(int socket, uint32_t *pid)
 	memcpy(pid, stream, sizeof(uint32_t));
 	operands_t operands;
 	memcpy(&operands, stream + sizeof(uint32_t), sizeof(operands_t));
-	free(stream);
+	servidor_liberar_stream(socket, stream);
 	return operands;
 }
 
+uint32_t
+read_physical_address(uint32_t physical_address)
+{
+	uint32_t frame = get_frame(physical_address);
+	uint32_t table_number_2 = get_table_lvl2_number(&g_memory, frame);
+	uint32_t value = UINT32_MAX;
+
+	// Frame DOES NOT EXIST
+	if (table_number_2 == UINT32_MAX)
+	{
+		LOG_ERROR("[CPU-CONTROLLER] :=> Invalid Frame <%d> not found in any table", frame);
+	}
+	else
+	{
+		pthread_mutex_lock(&g_memory.frames_mutex);
+		page_table_lvl_2_t *frame_ref = get_frame_ref(&g_memory, frame);
+
+		if (frame_ref)
+			frame_ref->modified = false;
+
+		pthread_mutex_unlock(&g_memory.frames_mutex);
+
+		value = read_from_memory(&g_memory, physical_address);
+	}
+
+	LOG_INFO("[Memory] :=> Read Value <%d> from <%d>", value, physical_address);
+
+	return value;
+}
+
+bool write_physical_address(uint32_t physical_address, uint32_t value)
+{
+	uint32_t frame = get_frame(physical_address);
+	LOG_DEBUG("[CPU-CONTROLLER] :=> Frame <%d>", frame);
+	uint32_t table_number_2 = get_table_lvl2_number(&g_memory, frame);
+
+	// Frame DOES NOT EXIST
+	if (table_number_2 == UINT32_MAX)
+	{
+		LOG_ERROR("[CPU-CONTROLLER] :=> Invalid Frame <%d> not found in any table", frame);
+		return false;
+	}
+	pthread_mutex_lock(&g_memory.frames_mutex);
+	page_table_lvl_2_t *frame_ref = get_frame_ref(&g_memory, frame);
+
+	if (frame_ref)
+		frame_ref->modified = true;
+
+	pthread_mutex_unlock(&g_memory.frames_mutex);
+
+	write_in_memory(&g_memory, physical_address, value);
+	LOG_INFO("[Memory] :=> Value <%d> written into Physical Address <%d> (Frame #%d)", value, physical_address, frame);
+
+	return true;
+}
+
+memory_access_result_t
+access_memory(memory_access_t *access)
+{
+	memory_access_result_t result = {.frame = access->index, .value = access->value};
+
+	if (access->level == MEMORY_ACCESS_LVL_1)
+	{
+		result.frame = walk_page_tables(access->pid, access->table, access->index);
+	}
+	else if (access->level == MEMORY_ACCESS_LVL_2)
+	{
+		// Same cost as a FRAME request.
+		usleep(retardo_memoria() * 1000);
+		result.frame = obtain_frame(access->table, access->index, access->pid);
+	}
+	else if (access->level != MEMORY_ACCESS_FRAME)
+	{
+		result.frame = UINT32_MAX;
+	}
+
+	if (result.frame == UINT32_MAX)
+	{
+		LOG_ERROR("[CPU-CONTROLLER] :=> Batch access to Table#%d[%d] (level %d) could not be translated", access->table, access->index, access->level);
+		result.frame = MEMORY_ACCESS_FAILED;
+		return result;
+	}
+
+	uint32_t physical_address = result.frame * tam_pagina() + access->offset;
+
+	if (access->op == MEMORY_ACCESS_READ)
+		result.value = read_physical_address(physical_address);
+	else if (!write_physical_address(physical_address, access->value))
+		result.frame = MEMORY_ACCESS_FAILED;
+
+	return result;
+}
+
+uint32_t
+walk_page_tables(uint32_t pid, uint32_t id_table_1, uint32_t page_number)
+{
+	uint32_t entries = entradas_por_tabla();
+	// Same clamp as a SND_PAGE request.
+	uint32_t entry_1 = page_number / entries;
+	entry_1 = entry_1 >= g_memory.max_rows ? g_memory.max_rows - 1 : entry_1;
+
+	// Two table accesses: the same cost as SND_PAGE and FRAME.
+	usleep(retardo_memoria() * 1000);
+	uint32_t id_table_2 = obtain_second_page(id_table_1, entry_1);
+
+	if (id_table_2 == UINT32_MAX)
+		return UINT32_MAX;
+
+	usleep(retardo_memoria() * 1000);
+	uint32_t frame = obtain_frame(id_table_2, page_number % entries, pid);
+	LOG_INFO("[CPU-CONTROLLER] :=> Page #%d of Table#%d -> Table#%d[%d] -> Frame #%d", page_number, id_table_1, id_table_2, page_number % entries, frame);
+
+	return frame;
+}
+
 uint32_t
 obtain_memory_value(uint32_t position)
 {
@@ -373,9 +582,15 @@ obtain_memory_value(uint32_t position)
 uint32_t
 obtain_second_page(uint32_t id_table_1, uint32_t index)
 {
-	page_table_lvl_1_t *table_lvl1 = safe_list_get(g_memory.tables_lvl_1, id_table_1);
+	page_table_lvl_1_t *table_lvl1 = read_mostly_list_get(g_memory.tables_lvl_1, id_table_1);
+
+	if (table_lvl1 == NULL)
+	{
+		LOG_ERROR("[CPU-CONTROLLER] :=> Table#%d does not exist (LVL1)", id_table_1);
+		return UINT32_MAX;
+	}
 
-	if (index > g_memory.max_rows)
+	if (index >= g_memory.max_rows)
 	{
 		LOG_ERROR("[CPU-CONTROLLER] :=> Index out of bounds for TABLE LVL 2");
 		return UINT32_MAX;
@@ -387,9 +602,15 @@ obtain_second_page(uint32_t id_table_1, uint32_t index)
 uint32_t
 obtain_frame(uint32_t id_table_2, uint32_t index, uint32_t pid)
 {
-	page_table_lvl_2_t *table_lvl2 = safe_list_get(g_memory.tables_lvl_2, id_table_2);
+	page_table_lvl_2_t *table_lvl2 = read_mostly_list_get(g_memory.tables_lvl_2, id_table_2);
+
+	if (table_lvl2 == NULL)
+	{
+		LOG_ERROR("[CPU-CONTROLLER] :=> Table#%d does not exist (LVL2)", id_table_2);
+		return UINT32_MAX;
+	}
 
-	if (index > g_memory.max_rows)
+	if (index >= g_memory.max_rows)
 	{
 		LOG_ERROR("[CPU-CONTROLLER] :=> Index out of bounds for FRAMES");
 		return UINT32_MAX;
@@ -397,7 +618,20 @@ obtain_frame(uint32_t id_table_2, uint32_t index, uint32_t pid)
 
 	if (!table_lvl2[index].present)
 	{
+		// Taking frames, replacing and swapping change what other CPU requests and the swap worker see
+		pthread_mutex_lock(&g_memory.frames_mutex);
+
+		// Another request may have brought the page in while this one waited
+		if (table_lvl2[index].present)
+		{
+			uint32_t frame = table_lvl2[index].frame;
+			pthread_mutex_unlock(&g_memory.frames_mutex);
+			return frame;
+		}
+
 		LOG_ERROR("[CPU-CONTROLLER] :=> Page Fault: Frame not allocated [Index=%d]", index);
+		trace_event(TRACE_PAGE_FAULT, pid, id_table_2, index);
+		metrics_add_process(METRIC_PAGE_FAULTS, pid, 1);
 		uint32_t new_frame = find_free_frame(&g_memory);
 		LOG_TRACE("[CPU-CONTROLLER] :=> FRAME FOUND: %d", new_frame);
 
@@ -405,6 +639,11 @@ obtain_frame(uint32_t id_table_2, uint32_t index, uint32_t pid)
 		{
 			LOG_ERROR("[CPU-CONTROLLER] :=> No free frames available (MAX=%d)", g_memory.no_of_frames);
 		}
+		else
+		{
+			// Counted as the process's from the moment it is taken, and no longer once it is freed
+			metrics_gauge_add_process(METRIC_PROCESS_FRAMES, pid, 1);
+		}
 
 		if (should_replace_frame(&g_memory, id_table_2))
 		{
@@ -414,6 +653,8 @@ obtain_frame(uint32_t id_table_2, uint32_t index, uint32_t pid)
 			uint32_t frame_to_replace = g_memory.frame_selector(&g_memory, id_table_1);
 			LOG_TRACE("[MEMORY] :=> Frame #%d should be replaced.", frame_to_replace);
 			replace_frame(pid, frame_to_replace);
+			trace_event(TRACE_FRAME_REPLACED, pid, frame_to_replace, new_frame);
+			metrics_add(METRIC_FRAME_REPLACEMENTS, 1);
 			LOG_INFO("[ALGORITHM] :=> Replaced Frame: #%d -> #%d", frame_to_replace, new_frame);
 		}
 		else
@@ -424,19 +665,25 @@ obtain_frame(uint32_t id_table_2, uint32_t index, uint32_t pid)
 		if (table_lvl2[index].frame == INVALID_FRAME)
 		{
 			LOG_TRACE("[MEMORY] :=> Frame #%d is free. Assigning", new_frame);
-			uint32_t created_at = create_frame_for_table(&g_memory, id_table_2, new_frame);
+			uint32_t created_at = create_frame_for_table(&g_memory, id_table_2, index, new_frame);
 			LOG_INFO("[Memory] :=> Table#%d[%d] = { Frame: %d ...}", id_table_2, created_at, new_frame);
 		}
 		else
 		{
 			LOG_WARNING("[MEMORY] :=> Frame already allocated, should unswap.");
 			delete_frame(&g_memory, new_frame);
+
+			if (new_frame != UINT32_MAX)
+				metrics_gauge_add_process(METRIC_PROCESS_FRAMES, pid, -1);
+
 			LOG_ERROR("[SWAP] :=> Access - UNSWAPPING");
 			unswap_frame_for_pcb(pid, table_lvl2[index].frame);
+			trace_event(TRACE_PAGE_UNSWAPPED, pid, table_lvl2[index].frame, id_table_2);
 			table_lvl2[index].use = true;
 			LOG_INFO("[Memory] :=> Table#%d[%d] = { Frame: %d ...} [UNSWAPPED]", id_table_2, index, table_lvl2[index].frame);
 		}
 		LOG_TRACE("[CPU-CONTROLLER] :=> RETURNING THE NEW FRAME: %d", new_frame);
+		pthread_mutex_unlock(&g_memory.frames_mutex);
 		return new_frame;
 	}
 	else
@@ -460,9 +707,9 @@ get_frame(uint32_t physical_address)
 
 bool frame_is_present(memory_t *memory, uint32_t table_number, uint32_t frame)
 {
-	page_table_lvl_2_t *table = safe_list_get(memory->tables_lvl_2, table_number);
+	page_table_lvl_2_t *table = read_mostly_list_get(memory->tables_lvl_2, table_number);
 
-	for (uint32_t i = 0; i < memory->max_rows; i++)
+	for (uint32_t i = 0; table && i < memory->max_rows; i++)
 	{
 		if (table[i].frame == frame)
 		{
@@ -478,14 +725,14 @@ bool should_replace_frame(memory_t *memory, uint32_t table_number_2)
 	LOG_TRACE("[Memory] :=> WE SHOULD REPLACE A FRAME");
 	uint32_t table_number = get_table_lvl1_number(memory, table_number_2);
 	LOG_DEBUG("[Memory] :=> TABLE NUMBER FOUND: %d", table_number);
-	page_table_lvl_1_t *table = safe_list_get(memory->tables_lvl_1, table_number);
-	print_table(memory, table_number);
+	page_table_lvl_1_t *table = read_mostly_list_get(memory->tables_lvl_1, table_number);
+	PRINT_TABLE(memory, table_number);
 	uint32_t count = 0;
 
 	LOG_WARNING("[Memory] :=> Should a frame be replaced at Table#%d?", table_number);
-	for (uint32_t i = 0; i < memory->max_rows; i++)
+	for (uint32_t i = 0; table && i < memory->max_rows; i++)
 	{
-		page_table_lvl_2_t *table_2 = safe_list_get(memory->tables_lvl_2, table[i].second_page);
+		page_table_lvl_2_t *table_2 = read_mostly_list_get(memory->tables_lvl_2, table[i].second_page);
 		if (table_2)
 			for (uint32_t j = 0; j < memory->max_rows; j++)
 			{
@@ -505,11 +752,11 @@ bool should_replace_frame(memory_t *memory, uint32_t table_number_2)
 uint32_t
 get_table_lvl1_number(memory_t *memory, uint32_t table_number_2)
 {
-	uint32_t size = (uint32_t)safe_list_size(memory->tables_lvl_1);
+	uint32_t size = read_mostly_list_size(memory->tables_lvl_1);
 	LOG_DEBUG("MEMORY :=> THE SIZE IS: %d", size);
 	for (uint32_t i = 0; i < size; i++)
 	{
-		page_table_lvl_1_t *table = safe_list_get(memory->tables_lvl_1, i);
+		page_table_lvl_1_t *table = read_mostly_list_get(memory->tables_lvl_1, i);
 
 		if (table)
 			for (uint32_t j = 0; j < memory->max_rows; j++)
@@ -527,9 +774,9 @@ get_table_lvl1_number(memory_t *memory, uint32_t table_number_2)
 void replace_frame(uint32_t pid, uint32_t frame_to_replace)
 {
 	uint32_t table_number_2 = get_table_lvl2_number(&g_memory, frame_to_replace);
-	page_table_lvl_2_t *table = safe_list_get(g_memory.tables_lvl_2, table_number_2);
+	page_table_lvl_2_t *table = read_mostly_list_get(g_memory.tables_lvl_2, table_number_2);
 
-	for (uint32_t i = 0; i < g_memory.max_rows; i++)
+	for (uint32_t i = 0; table && i < g_memory.max_rows; i++)
 	{
 		if (table[i].frame == frame_to_replace)
 		{
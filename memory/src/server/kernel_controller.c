@@ -23,6 +23,9 @@
 #include "log.h"
 #include "os_memory.h"
 #include "swap.h"
+#include "metrics.h"
+#include "safe_queue.h"
+#include "tuning.h"
 
 // ============================================================================================================
 //                                   ***** Declarations *****
@@ -30,14 +33,56 @@
 
 extern memory_t g_memory;
 
+/**
+ * @brief A Kernel request that goes through swap, done by the swap worker.
+ *
+ */
+typedef struct SwapJob
+{
+	// SWAP_PCB, RETRIEVE_SWAPPED_PCB or PROCESS_TERMINATED.
+	opcode_t opcode;
+	// The Kernel, to reply to.
+	int socket;
+	// The request id, echoed in the reply.
+	uint32_t id;
+	// A copy of the payload: the receiver slice is released on the serving thread.
+	void *stream;
+	ssize_t size;
+} swap_job_t;
+
+// The swap jobs, in arrival order: a single worker keeps them ordered among themselves.
+static safe_queue_t *swap_jobs;
+
+/**
+ * @brief Receives the payload of a swap request and queues it for the swap worker.
+ *
+ * @param socket the Kernel
+ * @param opcode the operation
+ */
+static void queue_swap_job(int socket, opcode_t opcode);
+
+/**
+ * @brief Does the swap jobs one at a time, forever, replying each as it ends.
+ *
+ * @return null ptr
+ */
+static void *swap_worker(void *unused);
+
+static uint32_t swap(swap_job_t *job);
+
+static uint32_t read_swap(swap_job_t *job);
+
+static uint32_t destroy_process_file(swap_job_t *job);
+
 /**
  * @brief Swaps a PCB into the memory
  *
  * @param pcb_stream to swap
- * @return memory position
+ * @param size the bytes of the stream: a PCB running past them is malformed
+ * @return SUCCESS, or ERROR if the PCB is malformed or could not be saved
  */
 uint32_t
-swap_pcb_(void *pcb_stream);
+swap_pcb_(void *pcb_stream, ssize_t size);
 
 pcb_t *
 retrieve_swapped_pcb(uint32_t pcb_id);
@@ -57,71 +102,48 @@ void delete_swapped_pcb(uint32_t pcb_id);
 uint32_t
 get_page_table(void);
 
+/**
+ * @brief Replies a Kernel request echoing its id, so that the Kernel memory channel matches it.
+ *
+ * @param socket the Kernel
+ * @param opcode the operation replied
+ * @param id the request id
+ * @param value the reply: a status or the page table
+ * @return the bytes sent
+ */
+static ssize_t reply(int socket, opcode_t opcode, uint32_t id, uint32_t value)
+{
+	struct iovec segment = {.iov_base = &value, .iov_len = sizeof(value)};
+
+	return enviar_frame(opcode, id, &segment, 1, socket);
+}
+
 // ============================================================================================================
 //                                   ***** Public Functions *****
 // ============================================================================================================
 
-void kernel_controller_swap(int socket)
+void kernel_controller_init(thread_manager_t *tm)
 {
-	ssize_t bytes_received = -1;
-
-	void *pcb_stream = servidor_recibir_stream(socket, &bytes_received);
-	LOG_TRACE("[Server] :=> A PCB was received to be swapped");
+	swap_jobs = new_safe_queue();
+	thread_manager_launch(tm, swap_worker, NULL);
+}
 
-	uint32_t swap_status = swap_pcb_(pcb_stream);
-	if (swap_status == SUCCESS)
-	{
-		LOG_TRACE("[Server] :=> PCB was SUCCESSSFULLY swapped");
-	}
-	else
-	{
-		LOG_TRACE("[Server] :=> Failed to swap PCB");
-	}
+// Swapping sleeps RETARDO_SWAP: done on the swap worker, so that a MEMORY_INIT behind it is served meanwhile
 
-	free(pcb_stream);
+void kernel_controller_swap(int socket)
+{
+	queue_swap_job(socket, SWAP_PCB);
 }
 
 void kernel_controller_read_swap(int socket)
 {
-	ssize_t bytes_received = -1;
-
-	uint32_t *pcb_id = (uint32_t *)servidor_recibir_stream(socket, &bytes_received);
-	LOG_TRACE("[Server] :=> A PCB ID #%d was received", *pcb_id);
-
-	unswap_pcb(*pcb_id);
-
-	free(pcb_id);
+	queue_swap_job(socket, RETRIEVE_SWAPPED_PCB);
 }
 
 void kernel_controller_destroy_process_file(int socket)
 {
-	ssize_t bytes_received = -1;
-
-	void *stream = servidor_recibir_stream(socket, &bytes_received);
-	LOG_TRACE("[Server] :=> Received %ld bytes", bytes_received);
-	uint32_t pcb_id = 0, table_id = 0;
-	memcpy(&pcb_id, stream, sizeof(uint32_t));
-	memcpy(&table_id, stream + sizeof(uint32_t), sizeof(uint32_t));
-	LOG_TRACE("[Server] :=> PCB #%d requested termination. Deleting Table #%d", pcb_id, table_id);
-	delete_process(&g_memory, table_id);
-	delete_swapped_pcb(pcb_id);
-	free(stream);
-	LOG_INFO("[Server] :=> PCB #%d deleted", pcb_id);
-
-	LOG_DEBUG("[Server] :=> \tCurrent\tTables(%d)", safe_list_size(g_memory.tables_lvl_1));
-	for (uint32_t i = 0; i < (uint32_t)safe_list_size(g_memory.tables_lvl_1); i++)
-	{
-		page_table_lvl_1_t *table = safe_list_get(g_memory.tables_lvl_1, i);
-		LOG_WARNING("\tTable\t#%d", i);
-		if (table == NULL)
-		{
-			LOG_ERROR("Table #%d was recently deleted", i);
-		}
-		else
-		{
-			print_table(&g_memory, i);
-		}
-	}
+	// Behind the swaps of the process, so that its swap data is not deleted under them
+	queue_swap_job(socket, PROCESS_TERMINATED);
 }
 
 void kernel_controller_memory_init(int socket)
@@ -132,6 +154,8 @@ void kernel_controller_memory_init(int socket)
 	if (bytes_received <= 0)
 	{
 		LOG_ERROR("[Server] :=> Could not receive PID");
+		// An empty reply, so that the Kernel does not wait for a page table forever
+		enviar_frame(MEMORY_INIT, servidor_id_recibido(socket), NULL, 0, socket);
 		return;
 	}
 
@@ -140,7 +164,7 @@ void kernel_controller_memory_init(int socket)
 	uint32_t pcb_size = operands.op2;
 	swap_data_t *swap_data = new_swap_data(pid, pcb_size);
 	safe_list_add(g_memory.swap_data, swap_data);
-	free(ref);
+	servidor_liberar_stream(socket, ref);
 
 	LOG_DEBUG("[Server] :=> Initializing PCB#%d [%dbytes]", pid, pcb_size);
 	LOG_TRACE("[Memory] :=> Creating SWAP file for PCB #%d...", pid);
@@ -151,7 +175,7 @@ void kernel_controller_memory_init(int socket)
 
 	LOG_INFO("[Server] :=> Page Table <%d> was obtained", page_table);
 
-	ssize_t bytes_sent = servidor_enviar_stream(MEMORY_INIT, socket, &page_table, sizeof(page_table));
+	ssize_t bytes_sent = reply(socket, MEMORY_INIT, servidor_id_recibido(socket), page_table);
 
 	if (bytes_sent <= 0)
 	{
@@ -160,10 +184,136 @@ void kernel_controller_memory_init(int socket)
 	else
 	{
 		LOG_DEBUG("[Server] :=> Page table <%d> was sent [%ld bytes]", page_table, bytes_sent);
-		LOG_DEBUG("[Server] :=> \tCurrent\tTables(%d)", safe_list_size(g_memory.tables_lvl_1));
-		for (uint32_t i = 0; i < (uint32_t)safe_list_size(g_memory.tables_lvl_1); i++)
+		// Same dump as when a process is deleted
+		if (LOG_ENABLED(DEBUG))
+		{
+			tables_read_t tables = tables_read_begin(&g_memory);
+			LOG_DEBUG("[Server] :=> \tCurrent\tTables(%d)", read_mostly_list_size(g_memory.tables_lvl_1));
+			for (uint32_t i = 0; i < read_mostly_list_size(g_memory.tables_lvl_1); i++)
+			{
+				page_table_lvl_1_t *table = read_mostly_list_get(g_memory.tables_lvl_1, i);
+				LOG_WARNING("\tTable\t#%d", i);
+				if (table == NULL)
+				{
+					LOG_ERROR("Table #%d was recently deleted", i);
+				}
+				else
+				{
+					print_table(&g_memory, i);
+				}
+			}
+			tables_read_end(&g_memory, tables);
+		}
+	}
+}
+
+// ============================================================================================================
+//                                   ***** Private Functions *****
+// ============================================================================================================
+
+static void queue_swap_job(int socket, opcode_t opcode)
+{
+	swap_job_t *job = malloc(sizeof(swap_job_t));
+	job->opcode = opcode;
+	job->socket = socket;
+	job->id = servidor_id_recibido(socket);
+	job->size = -1;
+
+	void *stream = servidor_recibir_stream(socket, &job->size);
+	job->stream = job->size > 0 ? malloc(job->size) : NULL;
+
+	if (job->stream)
+		memcpy(job->stream, stream, job->size);
+
+	servidor_liberar_stream(socket, stream);
+	safe_queue_push(swap_jobs, job);
+}
+
+static void *swap_worker(void *unused)
+{
+	(void)unused;
+
+	for (;;)
+	{
+		swap_job_t *job = safe_queue_pop_wait(swap_jobs);
+		uint32_t status = ERROR;
+
+		if (job->stream EQ NULL)
+		{
+			LOG_ERROR("[Server] :=> <%s> arrived without payload", opcode_to_string(job->opcode));
+		}
+		else if (job->opcode EQ SWAP_PCB)
+			status = swap(job);
+		else if (job->opcode EQ RETRIEVE_SWAPPED_PCB)
+			status = read_swap(job);
+		else
+			status = destroy_process_file(job);
+
+		// Sent under the socket send lock, so it does not interleave with a reply of the serving thread
+		reply(job->socket, job->opcode, job->id, status);
+		// The serving thread is not there to flush it
+		socket_flush(job->socket);
+
+		free(job->stream);
+		free(job);
+	}
+
+	return NULL;
+}
+
+static uint32_t swap(swap_job_t *job)
+{
+	LOG_TRACE("[Server] :=> A PCB was received to be swapped");
+
+	pthread_mutex_lock(&g_memory.frames_mutex);
+	uint32_t swap_status = swap_pcb_(job->stream, job->size);
+	pthread_mutex_unlock(&g_memory.frames_mutex);
+	if (swap_status == SUCCESS)
+	{
+		LOG_TRACE("[Server] :=> PCB was SUCCESSSFULLY swapped");
+	}
+	else
+	{
+		LOG_TRACE("[Server] :=> Failed to swap PCB");
+	}
+
+	return swap_status;
+}
+
+static uint32_t read_swap(swap_job_t *job)
+{
+	uint32_t pcb_id = *(uint32_t *)job->stream;
+	LOG_TRACE("[Server] :=> A PCB ID #%d was received", pcb_id);
+
+	tables_read_t tables = tables_read_begin(&g_memory);
+	pthread_mutex_lock(&g_memory.frames_mutex);
+	unswap_pcb(pcb_id);
+	pthread_mutex_unlock(&g_memory.frames_mutex);
+	tables_read_end(&g_memory, tables);
+
+	return SUCCESS;
+}
+
+static uint32_t destroy_process_file(swap_job_t *job)
+{
+	LOG_TRACE("[Server] :=> Received %ld bytes", job->size);
+	uint32_t pcb_id = 0, table_id = 0;
+	memcpy(&pcb_id, job->stream, sizeof(uint32_t));
+	memcpy(&table_id, job->stream + sizeof(uint32_t), sizeof(uint32_t));
+	LOG_TRACE("[Server] :=> PCB #%d requested termination. Deleting Table #%d", pcb_id, table_id);
+	delete_process(&g_memory, table_id);
+	delete_swapped_pcb(pcb_id);
+	metrics_gauge_set_process(METRIC_PROCESS_FRAMES, pcb_id, 0);
+	LOG_INFO("[Server] :=> PCB #%d deleted", pcb_id);
+
+	// Dump of every table, only worth building when logging DEBUG
+	if (LOG_ENABLED(DEBUG))
+	{
+		tables_read_t tables = tables_read_begin(&g_memory);
+		LOG_DEBUG("[Server] :=> \tCurrent\tTables(%d)", read_mostly_list_size(g_memory.tables_lvl_1));
+		for (uint32_t i = 0; i < read_mostly_list_size(g_memory.tables_lvl_1); i++)
 		{
-			page_table_lvl_1_t *table = safe_list_get(g_memory.tables_lvl_1, i);
+			page_table_lvl_1_t *table = read_mostly_list_get(g_memory.tables_lvl_1, i);
 			LOG_WARNING("\tTable\t#%d", i);
 			if (table == NULL)
 			{
@@ -174,12 +324,11 @@ void kernel_controller_memory_init(int socket)
 				print_table(&g_memory, i);
 			}
 		}
+		tables_read_end(&g_memory, tables);
 	}
-}
 
-// ============================================================================================================
-//                                   ***** Private Functions *****
-// ============================================================================================================
+	return SUCCESS;
+}
 
 pcb_t *
 retrieve_swapped_pcb(uint32_t pcb_id)
@@ -208,7 +357,8 @@ retrieve_swapped_pcb(uint32_t pcb_id)
 
 				memcpy(pcb_stream, file_address, sb.st_size);
 
-				pcb = pcb_from_stream(pcb_stream);
+				wire_reader_t reader = wire_reader_create(pcb_stream, sb.st_size);
+				pcb = pcb_decode(&reader);
 
 				munmap(file_address, sb.st_size);
 
@@ -223,18 +373,25 @@ retrieve_swapped_pcb(uint32_t pcb_id)
 }
 
 uint32_t
-swap_pcb_(void *pcb_stream)
+swap_pcb_(void *pcb_stream, ssize_t size)
 {
 	uint32_t status = ERROR;
 
-	pcb_t *pcb = pcb_from_stream(pcb_stream);
+	wire_reader_t reader = wire_reader_create(pcb_stream, size);
+	pcb_t *pcb = pcb_decode(&reader);
+
+	if (pcb == NULL)
+	{
+		LOG_ERROR("[SWAP] :=> The PCB to swap is malformed [%ld bytes]", size);
+		return ERROR;
+	}
 
 	int fd = open_file(pcb->id);
 
 	if (fd != -1)
 	{
-		status = SUCCESS;
-		off_t pct_stream_size = (off_t)pcb_bytes_size(pcb);
+		// The PCB as it arrived
+		off_t pct_stream_size = (off_t)reader.offset;
 
 		ftruncate(fd, pct_stream_size);
 
@@ -243,9 +400,12 @@ swap_pcb_(void *pcb_stream)
 		if (file_address == MAP_FAILED)
 		{
 			LOG_ERROR("[SWAP] :=> %s", strerror(errno));
+			close(fd);
+			pcb_destroy(pcb);
 			return ERROR;
 		}
 
+		status = SUCCESS;
 		LOG_INFO("[SWAP] :=> Mapping into <%p> %ld bytes", file_address, pct_stream_size);
 		LOG_WARNING("[SWAP] :=> Memcpying data related to PCB #%d", pcb->id);
 		memcpy(file_address, pcb_stream, pct_stream_size);
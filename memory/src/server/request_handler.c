@@ -3,6 +3,7 @@
 #include "memory_dispatcher.h"
 #include "kernel_controller.h"
 #include "cpu_controller.h"
+#include "receiver.h"
 
 // ============================================================================================================
 //                                   ***** Definitions  *****
@@ -26,94 +27,120 @@ static char *recibir_mensaje(int socket)
 //                                   ***** Public Functions  *****
 // ============================================================================================================
 
-void *routine(void *fd)
+int handle_request(int sender_fd, void **session)
 {
-	// client's socket (File Descriptor)
-	int sender_fd = 0;
-
-	memcpy((void *)&sender_fd, fd, sizeof(int));
+	// Memory clients keep no state between requests.
+	(void)session;
 
-	free(fd);
+	int opcode = servidor_recibir_operacion(sender_fd);
 
-	for (;;)
+	if (opcode <= 0)
 	{
-		int opcode = servidor_recibir_operacion(sender_fd);
-
-		if (opcode <= 0)
+		if (opcode == DC)
 		{
-			if (opcode == DC)
-			{
-				// Connection closed
-				LOG_WARNING("Client <%d> has ended connection", sender_fd);
-			}
-			else
-			{
-				LOG_ERROR("Error while recieving a message from Client <%d>", sender_fd);
-				LOG_DEBUG("Lost connection with Client <%d>", sender_fd);
-			}
-
-			servidor_desconectar_cliente(sender_fd);
-			thread_manager_end_thread(&g_memory.server.tm);
-
-			return NULL;
+			// Connection closed
+			LOG_WARNING("Client <%d> has ended connection", sender_fd);
 		}
 		else
 		{
-			LOG_TRACE("Client<%d>: Requests <%s> operation.", sender_fd, opcode_to_string(opcode));
+			LOG_ERROR("Error while recieving a message from Client <%d>", sender_fd);
+			LOG_DEBUG("Lost connection with Client <%d>", sender_fd);
+		}
 
-			switch (opcode)
-			{
+		return opcode;
+	}
+
+	LOG_TRACE("Client<%d>: Requests <%s> operation.", sender_fd, opcode_to_string(opcode));
 
-			case MEMORY_INIT:
-				kernel_controller_memory_init(sender_fd);
-				break;
+	switch (opcode)
+	{
 
-			case MSG:
-				dispatch_imprimir_mensaje((void *)recibir_mensaje(sender_fd));
-				break;
+	case MEMORY_INIT:
+		kernel_controller_memory_init(sender_fd);
+		break;
 
-			case RD:
-				cpu_controller_read(sender_fd);
-				break;
+	case MSG:
+		dispatch_imprimir_mensaje((void *)recibir_mensaje(sender_fd));
+		break;
 
-			case WT:
-				cpu_controller_write(sender_fd);
-				break;
+	case RD:
+		cpu_controller_read(sender_fd);
+		break;
 
-			case PROCESS_TERMINATED:
-				kernel_controller_destroy_process_file(sender_fd);
-				break;
+	case WT:
+		cpu_controller_write(sender_fd);
+		break;
 
-			case SWAP_PCB:
-				kernel_controller_swap(sender_fd);
-				break;
+	case PROCESS_TERMINATED:
+		kernel_controller_destroy_process_file(sender_fd);
+		break;
 
-			case RETRIEVE_SWAPPED_PCB:
-				kernel_controller_read_swap(sender_fd);
-				break;
+	case SWAP_PCB:
+		kernel_controller_swap(sender_fd);
+		break;
 
-			case SZ:
-				cpu_controller_send_size(sender_fd);
-				break;
+	case RETRIEVE_SWAPPED_PCB:
+		kernel_controller_read_swap(sender_fd);
+		break;
 
-			case ENTRIES:
-				cpu_controller_send_entries(sender_fd);
-				break;
+	case SZ:
+		cpu_controller_send_size(sender_fd);
+		break;
 
-			case FRAME:
-				cpu_controller_send_frame(sender_fd);
-				break;
+	case ENTRIES:
+		cpu_controller_send_entries(sender_fd);
+		break;
 
-			case SND_PAGE:
-				cpu_controller_send_page_second_level(sender_fd);
-				break;
+	case FRAME:
+		cpu_controller_send_frame(sender_fd);
+		break;
 
-			default:
-				LOG_ERROR("Client<%d>: Unrecognized operation code (%d)", sender_fd, opcode);
-				break;
-			}
-		}
+	case SND_PAGE:
+		cpu_controller_send_page_second_level(sender_fd);
+		break;
+
+	case TRANSLATE:
+		cpu_controller_translate(sender_fd);
+		break;
+
+	case MEMORY_BATCH:
+		cpu_controller_batch(sender_fd);
+		break;
+
+	// Answered by the connection layer
+	case SHM_LINK:
+		break;
+
+	case STATS:
+		servidor_enviar_metricas(sender_fd);
+		break;
+
+	default:
+		LOG_ERROR("Client<%d>: Unrecognized operation code (%d)", sender_fd, opcode);
+		break;
 	}
 
+	return opcode;
+}
+
+void *routine(void *fd)
+{
+	// client's socket (File Descriptor)
+	int sender_fd = 0;
+
+	memcpy((void *)&sender_fd, fd, sizeof(int));
+
+	free(fd);
+
+	// Operands arrive at every memory access: pool them instead of allocating each one.
+	receiver_attach(sender_fd, RECEIVER_CAPACITY);
+
+	while (handle_request(sender_fd, NULL) > 0)
+		;
+
+	receiver_detach(sender_fd);
+	servidor_desconectar_cliente(sender_fd);
+	thread_manager_end_thread(&g_memory.server.tm);
+
 	return NULL;
 }
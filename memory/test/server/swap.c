@@ -0,0 +1,31 @@
+/**
+ * @file swap.c
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Swapping PCBs out as the Kernel sends them
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdlib.h>
+
+#include "ctest.h"
+#include "lib.h"
+#include "pcb.h"
+
+uint32_t swap_pcb_(void *pcb_stream, ssize_t size);
+
+CTEST(swap, when_thePcbRunsPastTheBytesReceived_then_itIsNotSwapped)
+{
+	pcb_t *pcb = new_pcb(1, 4096, 10000);
+	void *stream = pcb_to_stream(pcb);
+
+	// Its last byte never arrived: nothing is read beyond the ones that did
+	ASSERT_EQUAL((uint32_t)ERROR, swap_pcb_(stream, pcb_bytes_size(pcb) - 1));
+	ASSERT_EQUAL((uint32_t)ERROR, swap_pcb_(stream, 0));
+
+	free(stream);
+	pcb_destroy(pcb);
+}
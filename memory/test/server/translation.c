@@ -0,0 +1,136 @@
+/**
+ * @file translation.c
+ * @author Tomás Sánchez <tosanchez@frba.utn.edu.ar>
+ * @brief Page table walks and the TRANSLATE endpoint
+ * @version 0.1
+ * @date 10-17-2022
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <sys/socket.h>
+#include <unistd.h>
+#include <commons/config.h>
+
+#include "ctest.h"
+#include "lib.h"
+#include "cfg.h"
+#include "server.h"
+#include "metrics.h"
+#include "memory_module.h"
+#include "os_memory.h"
+#include "page_table.h"
+#include "memory_access.h"
+#include "cpu_controller.h"
+
+#define PID 3
+
+extern memory_t g_memory;
+
+uint32_t walk_page_tables(uint32_t pid, uint32_t id_table_1, uint32_t page_number);
+uint32_t obtain_second_page(uint32_t id_table_1, uint32_t index);
+uint32_t obtain_frame(uint32_t id_table_2, uint32_t index, uint32_t pid);
+memory_access_result_t access_memory(memory_access_t *access);
+
+/**
+ * @brief A Memory with no process yet, as on_init_memory leaves it, without the table access delays.
+ */
+static void memory_setup(void)
+{
+	config_init("memory");
+	config_set_value(config_instance(), "RETARDO_MEMORIA", "0");
+
+	g_memory.main_memory = malloc(tam_memoria());
+	g_memory.tables_lvl_1 = new_read_mostly_list();
+	g_memory.tables_lvl_2 = new_read_mostly_list();
+	g_memory.swap_data = new_safe_list();
+	g_memory.max_frames = (uint32_t)marcos_por_proceso();
+	g_memory.max_rows = (uint32_t)entradas_por_tabla();
+	g_memory.no_of_frames = (uint32_t)tam_memoria() / (uint32_t)tam_pagina();
+	g_memory.frames = calloc(g_memory.no_of_frames, sizeof(bool));
+	pthread_mutex_init(&g_memory.frames_mutex, NULL);
+}
+
+static void memory_teardown(void)
+{
+	free(g_memory.main_memory);
+	read_mostly_list_destroy(g_memory.tables_lvl_1, free);
+	read_mostly_list_destroy(g_memory.tables_lvl_2, free);
+	safe_list_fast_destroy(g_memory.swap_data);
+	free(g_memory.frames);
+	pthread_mutex_destroy(&g_memory.frames_mutex);
+	config_close();
+}
+
+/**
+ * @brief Asks for a translation as the CPU does: [PID][TABLA LVL1][DIRECCION LOGICA], answered with the frame.
+ */
+static uint32_t translate(uint32_t table, uint32_t logical_address)
+{
+	int fds[2];
+	uint32_t pid = PID, frame = 0;
+
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == -1)
+		return 0;
+
+	struct iovec segments[] = {
+		{.iov_base = &pid, .iov_len = sizeof(uint32_t)},
+		{.iov_base = &table, .iov_len = sizeof(uint32_t)},
+		{.iov_base = &logical_address, .iov_len = sizeof(uint32_t)},
+	};
+
+	enviar_frame(TRANSLATE, 0, segments, 3, fds[0]);
+	servidor_recibir_operacion(fds[1]);
+	cpu_controller_translate(fds[1]);
+
+	if (recv(fds[0], &frame, sizeof(frame), MSG_WAITALL) != sizeof(frame))
+		frame = 0;
+
+	close(fds[0]);
+	close(fds[1]);
+
+	return frame;
+}
+
+CTEST(translation, when_aPageIsFirstTranslated_then_itFaultsOnceAndThenHits)
+{
+	memory_setup();
+	uint32_t table = create_new_process(&g_memory);
+	uint32_t page = g_memory.max_rows + 1;
+	uint64_t faults = metrics_process_count(METRIC_PAGE_FAULTS, PID);
+
+	// Fault: the page gets a free frame
+	uint32_t frame = translate(table, page * tam_pagina());
+	ASSERT_TRUE(frame < g_memory.no_of_frames);
+	ASSERT_TRUE(g_memory.frames[frame]);
+	ASSERT_EQUAL(faults + 1, metrics_process_count(METRIC_PAGE_FAULTS, PID));
+
+	// Hit: the same frame, from anywhere within the page, without another fault
+	ASSERT_EQUAL(frame, translate(table, page * tam_pagina() + tam_pagina() - 1));
+	ASSERT_EQUAL(frame, walk_page_tables(PID, table, page));
+	ASSERT_EQUAL(faults + 1, metrics_process_count(METRIC_PAGE_FAULTS, PID));
+
+	memory_teardown();
+}
+
+CTEST(translation, when_aTableOrIndexIsOutOfRange_then_thereIsNoFrame)
+{
+	memory_setup();
+	uint32_t table = create_new_process(&g_memory);
+	uint32_t lvl2 = obtain_second_page(table, 0);
+
+	ASSERT_EQUAL(UINT32_MAX, translate(table + 1, 0));
+	ASSERT_EQUAL(UINT32_MAX, obtain_second_page(table, g_memory.max_rows));
+	ASSERT_EQUAL(UINT32_MAX, obtain_frame(lvl2, g_memory.max_rows, PID));
+
+	// A zeroed batch access has no level: it is not taken as frame 0
+	memory_access_t zeroed = {0};
+	ASSERT_EQUAL(MEMORY_ACCESS_FAILED, access_memory(&zeroed).frame);
+
+	// Nothing was taken on the way
+	for (uint32_t i = 0; i < g_memory.no_of_frames; i++)
+		ASSERT_FALSE(g_memory.frames[i]);
+
+	memory_teardown();
+}